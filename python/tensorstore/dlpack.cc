@@ -0,0 +1,221 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pybind11/pybind11.h>
+// Other headers must be included after pybind11 to ensure header-order
+// inclusion constraints are satisfied.
+
+#include "python/tensorstore/dlpack.h"
+
+// Other headers
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+
+#include "tensorstore/array.h"
+#include "tensorstore/data_type.h"
+#include "tensorstore/index.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_python {
+namespace {
+
+namespace py = ::pybind11;
+
+// Definitions from dlpack.h, version 1.0.
+
+struct DLDevice {
+  int32_t device_type;
+  int32_t device_id;
+};
+
+enum DLDataTypeCode : uint8_t {
+  kDLInt = 0,
+  kDLUInt = 1,
+  kDLFloat = 2,
+  kDLBfloat = 4,
+  kDLComplex = 5,
+  kDLBool = 6,
+};
+
+struct DLDataType {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+};
+
+struct DLTensor {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  int64_t* strides;
+  uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(DLManagedTensor* self);
+};
+
+struct DLPackVersion {
+  uint32_t major;
+  uint32_t minor;
+};
+
+struct DLManagedTensorVersioned {
+  DLPackVersion version;
+  void* manager_ctx;
+  void (*deleter)(DLManagedTensorVersioned* self);
+  uint64_t flags;
+  DLTensor dl_tensor;
+};
+
+constexpr uint64_t kDLPackFlagBitmaskReadOnly = 1;
+constexpr uint64_t kDLPackFlagBitmaskIsCopied = 2;
+
+constexpr const char kDLTensorCapsuleName[] = "dltensor";
+constexpr const char kDLTensorVersionedCapsuleName[] = "dltensor_versioned";
+
+bool GetDLDataType(DataType dtype, DLDataType& dl_dtype) {
+  uint8_t code;
+  switch (dtype.id()) {
+    case DataTypeId::bool_t:
+      code = kDLBool;
+      break;
+    case DataTypeId::int8_t:
+    case DataTypeId::int16_t:
+    case DataTypeId::int32_t:
+    case DataTypeId::int64_t:
+      code = kDLInt;
+      break;
+    case DataTypeId::uint8_t:
+    case DataTypeId::uint16_t:
+    case DataTypeId::uint32_t:
+    case DataTypeId::uint64_t:
+      code = kDLUInt;
+      break;
+    case DataTypeId::float16_t:
+    case DataTypeId::float32_t:
+    case DataTypeId::float64_t:
+      code = kDLFloat;
+      break;
+    case DataTypeId::bfloat16_t:
+      code = kDLBfloat;
+      break;
+    case DataTypeId::complex64_t:
+    case DataTypeId::complex128_t:
+      code = kDLComplex;
+      break;
+    default:
+      return false;
+  }
+  dl_dtype.code = code;
+  dl_dtype.bits = static_cast<uint8_t>(dtype.size() * 8);
+  dl_dtype.lanes = 1;
+  return true;
+}
+
+/// Owns the exported array and the DLPack structures describing it.
+///
+/// `Managed` is either `DLManagedTensor` or `DLManagedTensorVersioned`.
+template <typename Managed>
+struct DLPackContext {
+  Managed managed;
+  SharedArray<const void> array;
+  std::unique_ptr<int64_t[]> shape_and_strides;
+
+  static void Delete(Managed* managed) {
+    delete static_cast<DLPackContext*>(managed->manager_ctx);
+  }
+};
+
+// Deletes the tensor if the capsule was not consumed, as indicated by the
+// consumer renaming it.
+template <typename Managed, const char* Name>
+void DLPackCapsuleDestructor(PyObject* capsule) {
+  if (!PyCapsule_IsValid(capsule, Name)) return;
+  auto* managed = static_cast<Managed*>(PyCapsule_GetPointer(capsule, Name));
+  managed->deleter(managed);
+}
+
+template <typename Managed, const char* Name>
+py::capsule MakeCapsule(std::unique_ptr<DLPackContext<Managed>> context) {
+  PyObject* capsule = PyCapsule_New(&context->managed, Name,
+                                    &DLPackCapsuleDestructor<Managed, Name>);
+  if (!capsule) throw py::error_already_set();
+  // Now owned by the capsule.
+  context.release();
+  return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+template <typename Managed>
+std::unique_ptr<DLPackContext<Managed>> MakeContext(
+    SharedArray<const void> array) {
+  DLTensor tensor = {};
+  if (!GetDLDataType(array.dtype(), tensor.dtype)) {
+    throw py::buffer_error(tensorstore::StrCat(
+        "Data type ", array.dtype(), " is not supported by DLPack"));
+  }
+  auto context = std::make_unique<DLPackContext<Managed>>();
+  const DimensionIndex rank = array.rank();
+  context->shape_and_strides.reset(new int64_t[rank * 2]);
+  int64_t* shape = context->shape_and_strides.get();
+  int64_t* strides = shape + rank;
+  const Index element_size = array.dtype().size();
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    const Index byte_stride = array.byte_strides()[i];
+    if (byte_stride % element_size != 0) {
+      throw py::buffer_error(
+          "Array strides are not a multiple of the element size");
+    }
+    shape[i] = array.shape()[i];
+    strides[i] = byte_stride / element_size;
+  }
+  tensor.data = const_cast<void*>(array.data());
+  tensor.device = {kDLCPU, 0};
+  tensor.ndim = static_cast<int32_t>(rank);
+  tensor.shape = shape;
+  tensor.strides = strides;
+  tensor.byte_offset = 0;
+  context->array = std::move(array);
+  context->managed.dl_tensor = tensor;
+  context->managed.manager_ctx = context.get();
+  context->managed.deleter = &DLPackContext<Managed>::Delete;
+  return context;
+}
+
+}  // namespace
+
+py::capsule GetDLPackCapsule(SharedArray<const void> array, bool versioned,
+                             bool read_only, bool copied) {
+  if (!versioned) {
+    return MakeCapsule<DLManagedTensor, kDLTensorCapsuleName>(
+        MakeContext<DLManagedTensor>(std::move(array)));
+  }
+  auto context = MakeContext<DLManagedTensorVersioned>(std::move(array));
+  context->managed.version = {1, 0};
+  context->managed.flags = (read_only ? kDLPackFlagBitmaskReadOnly : 0) |
+                           (copied ? kDLPackFlagBitmaskIsCopied : 0);
+  return MakeCapsule<DLManagedTensorVersioned, kDLTensorVersionedCapsuleName>(
+      std::move(context));
+}
+
+}  // namespace internal_python
+}  // namespace tensorstore
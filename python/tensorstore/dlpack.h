@@ -0,0 +1,59 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYTHON_TENSORSTORE_DLPACK_H_
+#define PYTHON_TENSORSTORE_DLPACK_H_
+
+/// \file
+///
+/// Export of arrays as DLPack capsules.
+///
+/// Only the subset of the DLPack ABI (https://github.com/dmlc/dlpack) needed
+/// to export host memory is defined here.
+
+#include <pybind11/pybind11.h>
+// Other headers must be included after pybind11 to ensure header-order
+// inclusion constraints are satisfied.
+
+#include <stdint.h>
+
+#include "tensorstore/array.h"
+
+namespace tensorstore {
+namespace internal_python {
+
+/// DLPack device type of host memory.
+constexpr int32_t kDLCPU = 1;
+
+/// Returns a DLPack capsule that shares ownership of `array`.
+///
+/// \param array The array to export.
+/// \param versioned If `true`, returns a "dltensor_versioned" capsule, as
+///     required by DLPack 1.0, which indicates whether the data is read-only.
+///     Otherwise, returns a legacy "dltensor" capsule, in which case consumers
+///     may write to the data.
+/// \param read_only Indicates that consumers must not modify the data.
+///     Ignored if `versioned == false`.
+/// \param copied Indicates that `array` is a copy made for the consumer.
+///     Ignored if `versioned == false`.
+/// \throws pybind11::buffer_error if the data type of `array` is not supported
+///     by DLPack, or its strides are not a multiple of the element size.
+pybind11::capsule GetDLPackCapsule(SharedArray<const void> array,
+                                   bool versioned, bool read_only,
+                                   bool copied);
+
+}  // namespace internal_python
+}  // namespace tensorstore
+
+#endif  // PYTHON_TENSORSTORE_DLPACK_H_
@@ -325,13 +325,25 @@ Example:
     >>> store = await ts.KvStore.open({'driver': 'file', 'path': 'tmp/data'})
     >>> store + '/abc'
     KvStore({
-      'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+      'context': {
+        'file_io_concurrency': {},
+        'file_io_engine': {},
+        'file_io_group_commit': False,
+        'file_io_mmap': False,
+        'file_io_sync': True,
+      },
       'driver': 'file',
       'path': 'tmp/data/abc',
     })
     >>> store + 'abc'
     KvStore({
-      'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+      'context': {
+        'file_io_concurrency': {},
+        'file_io_engine': {},
+        'file_io_group_commit': False,
+        'file_io_mmap': False,
+        'file_io_sync': True,
+      },
       'driver': 'file',
       'path': 'tmp/dataabc',
     })
@@ -355,13 +367,25 @@ Example:
     >>> store = await ts.KvStore.open({'driver': 'file', 'path': 'tmp/data'})
     >>> store / 'abc'
     KvStore({
-      'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+      'context': {
+        'file_io_concurrency': {},
+        'file_io_engine': {},
+        'file_io_group_commit': False,
+        'file_io_mmap': False,
+        'file_io_sync': True,
+      },
       'driver': 'file',
       'path': 'tmp/data/abc',
     })
     >>> store / '/abc'
     KvStore({
-      'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+      'context': {
+        'file_io_concurrency': {},
+        'file_io_engine': {},
+        'file_io_group_commit': False,
+        'file_io_mmap': False,
+        'file_io_sync': True,
+      },
       'driver': 'file',
       'path': 'tmp/data/abc',
     })
@@ -1084,7 +1108,13 @@ Example:
     ... })
     >>> kvstore
     KvStore({
-      'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+      'context': {
+        'file_io_concurrency': {},
+        'file_io_engine': {},
+        'file_io_group_commit': False,
+        'file_io_mmap': False,
+        'file_io_sync': True,
+      },
       'driver': 'file',
       'path': 'tmp/data/',
     })
@@ -1101,13 +1131,25 @@ Example:
   >>> a.path = 'tmp/data/abc/'
   >>> a
   KvStore({
-    'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+    'context': {
+      'file_io_concurrency': {},
+      'file_io_engine': {},
+      'file_io_group_commit': False,
+      'file_io_mmap': False,
+      'file_io_sync': True,
+    },
     'driver': 'file',
     'path': 'tmp/data/abc/',
   })
   >>> b
   KvStore({
-    'context': {'file_io_concurrency': {}, 'file_io_sync': True},
+    'context': {
+      'file_io_concurrency': {},
+      'file_io_engine': {},
+      'file_io_group_commit': False,
+      'file_io_mmap': False,
+      'file_io_sync': True,
+    },
     'driver': 'file',
     'path': 'tmp/data/',
   })
@@ -1315,6 +1357,9 @@ Example:
   {'context': {},
    'driver': 'file',
    'file_io_concurrency': 'file_io_concurrency',
+   'file_io_engine': 'file_io_engine',
+   'file_io_group_commit': 'file_io_group_commit',
+   'file_io_mmap': 'file_io_mmap',
    'file_io_sync': 'file_io_sync',
    'path': 'tmp/dataset/abc/'}
 
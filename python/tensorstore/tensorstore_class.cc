@@ -23,6 +23,7 @@
 // Other headers
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -33,6 +34,7 @@
 #include "python/tensorstore/context.h"
 #include "python/tensorstore/data_type.h"
 #include "python/tensorstore/define_heap_type.h"
+#include "python/tensorstore/dlpack.h"
 #include "python/tensorstore/future.h"
 #include "python/tensorstore/homogeneous_tuple.h"
 #include "python/tensorstore/index.h"
@@ -52,6 +54,7 @@
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/array/array.h"
+#include "tensorstore/driver/read.h"
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/index_domain.h"
 #include "tensorstore/index_space/index_transform.h"
@@ -104,6 +107,20 @@ WriteFutures IssueCopyOrWrite(
   }
 }
 
+/// Reads into a new zero-origin array, or returns a read-only view of the
+/// cached data if possible.
+Future<SharedArray<const void>> ReadOrView(const TensorStore<>& self,
+                                           ContiguousLayoutOrder order) {
+  return MapFutureValue(
+      InlineExecutor{},
+      [](SharedOffsetArray<const void>& array)
+          -> Result<SharedArray<const void>> {
+        return ArrayOriginCast<zero_origin, container>(std::move(array));
+      },
+      internal::DriverReadIntoNewArrayOrView(
+          internal::TensorStoreAccess::handle(self), {order}));
+}
+
 constexpr auto ForwardOpenSetters = [](auto callback, auto... other_param) {
   WithSchemaKeywordArguments(
       callback, other_param..., open_setters::SetRead{},
@@ -443,8 +460,15 @@ Group:
 
   cls.def(
       "read",
-      [](Self& self, ContiguousLayoutOrder order)
-          -> PythonFutureWrapper<SharedArray<void>> {
+      [](Self& self, ContiguousLayoutOrder order,
+         bool zero_copy) -> PythonFutureWrapper<SharedArray<void>> {
+        if (zero_copy) {
+          // The result type differs only in that the array is read-only.
+          return PythonFutureWrapper<SharedArray<void>>(
+              PythonFutureWrapper<SharedArray<const void>>(
+                  ReadOrView(self.value, order), self.reference_manager())
+                  .value);
+        }
         return PythonFutureWrapper<SharedArray<void>>(
             tensorstore::Read<zero_origin>(self.value, {order}),
             self.reference_manager());
@@ -492,6 +516,13 @@ Args:
     :python:`'F'`
       Specifies Fortran order, i.e. colexicographic/column-major order.
 
+  zero_copy: If :python:`True`, returns a read-only array.  If the current
+    domain is contained in a single chunk held in the cache, and a transaction
+    is not used, the array is a view of the cached chunk rather than a copy,
+    and does not necessarily have the specified :py:param:`.order`.  The
+    chunk remains in the cache while the array is referenced.  Use
+    :py:obj:`numpy.ndarray.copy` to obtain a writable array.
+
 Returns:
   A future representing the asynchronous read result.
 
@@ -515,7 +546,7 @@ Group:
   I/O
 
 )",
-      py::arg("order") = "C");
+      py::arg("order") = "C", py::kw_only(), py::arg("zero_copy") = false);
 
   cls.def(
       "write",
@@ -814,9 +845,14 @@ Group:
   cls.def(
       "__array__",
       [](Self& self, std::optional<py::dtype> dtype,
-         std::optional<py::object> context) {
-        return ValueOrThrow(internal_python::InterruptibleWait(
-            tensorstore::Read<zero_origin>(self.value)));
+         std::optional<py::object> context,
+         std::optional<bool> copy) -> py::object {
+        if (copy == false) {
+          return GetNumpyArray(ValueOrThrow(internal_python::InterruptibleWait(
+              ReadOrView(self.value, c_order))));
+        }
+        return GetNumpyArray(ValueOrThrow(internal_python::InterruptibleWait(
+            tensorstore::Read<zero_origin>(self.value))));
       },
       R"(
 Automatic conversion to `numpy.ndarray` for interoperability with NumPy.
@@ -854,15 +890,104 @@ Examples:
    reading.  For large arrays, it may be better to partition the domain into
    blocks and process each block separately.
 
+If :python:`copy=False` is specified, as by :py:obj:`numpy.asarray` with
+:python:`copy=False`, the result is read-only and may be a view of a chunk held
+in the cache, as for :python:`self.read(zero_copy=True)`.
+
 See also:
 
    - :py:obj:`.read`
+   - :py:obj:`.__dlpack__`
 
 Group:
   I/O
 
 )",
-      py::arg("dtype") = std::nullopt, py::arg("context") = std::nullopt);
+      py::arg("dtype") = std::nullopt, py::arg("context") = std::nullopt,
+      py::arg("copy") = std::nullopt);
+
+  cls.def(
+      "__dlpack__",
+      [](Self& self, std::optional<py::object> stream,
+         std::optional<std::tuple<int, int>> max_version,
+         std::optional<std::tuple<int, int>> dl_device,
+         std::optional<bool> copy) -> py::capsule {
+        if (stream) {
+          throw py::buffer_error("stream must be None for CPU data");
+        }
+        if (dl_device && *dl_device != std::tuple<int, int>(kDLCPU, 0)) {
+          throw py::buffer_error("Only export to the CPU device is supported");
+        }
+        const bool versioned = max_version && std::get<0>(*max_version) >= 1;
+        if (!versioned || copy == true) {
+          // Consumers of legacy capsules may modify the data, and therefore
+          // receive a private copy.
+          if (copy == false) {
+            throw py::buffer_error(
+                "Exporting without a copy requires DLPack version 1.0 or "
+                "later, since the data is read-only");
+          }
+          auto array = ValueOrThrow(internal_python::InterruptibleWait(
+              tensorstore::Read<zero_origin>(self.value)));
+          return GetDLPackCapsule(std::move(array), versioned,
+                                  /*read_only=*/false, /*copied=*/true);
+        }
+        auto array = ValueOrThrow(internal_python::InterruptibleWait(
+            ReadOrView(self.value, c_order)));
+        return GetDLPackCapsule(std::move(array), versioned,
+                                /*read_only=*/true, /*copied=*/false);
+      },
+      R"(
+Exports the current domain as a DLPack capsule.
+
+Implements the `DLPack <https://dmlc.github.io/dlpack/latest/>`__ Python
+protocol, such that the data may be consumed by any framework that supports
+it, e.g. by :python:`numpy.from_dlpack(store)`.
+
+*Synchronously* reads from the current domain, as for :python:`self.read()`.
+If the consumer supports DLPack version 1.0, the exported data is read-only,
+and may be a view of a chunk held in the cache, as for
+:python:`self.read(zero_copy=True)`.  Otherwise, the exported data is a
+private copy that the consumer may modify.
+
+Args:
+  stream: Must be :python:`None`, since the data is in host memory.
+  max_version: Maximum DLPack version supported by the consumer.
+  dl_device: Device to which the data is exported.  Only the CPU device,
+    :python:`(1, 0)`, is supported.
+  copy: If :python:`True`, the data is always copied.  If :python:`False`,
+    the data is never copied beyond the read itself, which requires DLPack
+    version 1.0.
+
+Raises:
+  BufferError: If the data type is not supported by DLPack, or the export is
+    not possible with the specified options.
+
+See also:
+
+   - :py:obj:`.__dlpack_device__`
+   - :py:obj:`.read`
+
+Group:
+  I/O
+
+)",
+      py::kw_only(), py::arg("stream") = std::nullopt,
+      py::arg("max_version") = std::nullopt,
+      py::arg("dl_device") = std::nullopt, py::arg("copy") = std::nullopt);
+
+  cls.def(
+      "__dlpack_device__",
+      [](Self& self) { return std::tuple<int, int>(kDLCPU, 0); },
+      R"(
+Returns the DLPack device of the data exported by :py:obj:`.__dlpack__`.
+
+The data is always exported in host memory, indicated by :python:`(1, 0)`.
+
+Group:
+  I/O
+
+)");
 
   cls.def(
       "resolve",
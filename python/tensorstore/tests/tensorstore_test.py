@@ -182,6 +182,57 @@ async def test_memory_n5_cache_open():
   }).result()
 
 
+async def test_read_zero_copy():
+  t = await ts.open(
+      {
+          "driver": "zarr",
+          "kvstore": {"driver": "memory"},
+          "context": {"cache_pool": {"total_bytes_limit": 1000000}},
+          "recheck_cached_data": False,
+          "metadata": {"chunks": [4, 4]},
+      },
+      dtype=ts.uint32,
+      shape=[8, 8],
+      create=True,
+  )
+  expected = np.arange(16, dtype=np.uint32).reshape(4, 4)
+  await t[0:4, 4:8].write(expected)
+
+  # A read contained in a single chunk is a view of the cached chunk.
+  a = await t[0:4, 4:8].read(zero_copy=True)
+  np.testing.assert_equal(a, expected)
+  assert not a.flags.writeable
+  b = await t[1:3, 4:8].read(zero_copy=True)
+  np.testing.assert_equal(b, expected[1:3])
+  assert np.shares_memory(a, b)
+  assert np.shares_memory(a, t[0:4, 4:8].__array__(copy=False))
+
+  # A read spanning multiple chunks is copied, but is still read-only.
+  c = await t[0:4, 2:6].read(zero_copy=True)
+  np.testing.assert_equal(c[:, 2:], expected[:, :2])
+  assert not c.flags.writeable
+  assert not np.shares_memory(a, c)
+
+  # The default read is a writable copy.
+  d = await t[0:4, 4:8].read()
+  assert d.flags.writeable
+  assert not np.shares_memory(a, d)
+
+
+async def test_dlpack():
+  t = ts.array(np.arange(6, dtype=np.int32).reshape(2, 3))
+  assert t.__dlpack_device__() == (1, 0)
+  np.testing.assert_equal(np.from_dlpack(t), t.read().result())
+  assert type(t.__dlpack__(max_version=(1, 0))).__name__ == "PyCapsule"
+
+  with pytest.raises(BufferError):
+    t.__dlpack__(copy=False)
+  with pytest.raises(BufferError):
+    t.__dlpack__(dl_device=(2, 0))
+  with pytest.raises(BufferError):
+    ts.array([1, {"a": 2}], dtype=ts.json).__dlpack__()
+
+
 async def test_open_error_message():
   with pytest.raises(
       ValueError, match='.*Error parsing object member "driver": .*'
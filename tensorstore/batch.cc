@@ -0,0 +1,92 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/batch.h"
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+
+namespace tensorstore {
+namespace internal_batch {
+
+class BatchImpl {
+ public:
+  ~BatchImpl() {
+    // No other handles exist, so no locking is required.  Entries are
+    // submitted in creation order; submitting an entry may add reads to a
+    // different batch but never to this one.
+    for (auto& entry : entries_) {
+      entry->Submit();
+    }
+  }
+
+  Batch::Entry& GetEntry(
+      const void* key, const void* type,
+      absl::FunctionRef<std::unique_ptr<Batch::Entry>()> make_entry) {
+    absl::MutexLock lock(&mutex_);
+    auto [it, inserted] = index_.try_emplace(std::make_pair(key, type));
+    if (inserted) {
+      entries_.push_back(make_entry());
+      it->second = entries_.back().get();
+    }
+    return *it->second;
+  }
+
+  std::atomic<size_t> reference_count_{0};
+
+ private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::pair<const void*, const void*>, Batch::Entry*>
+      index_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<Batch::Entry>> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+void intrusive_ptr_increment(BatchImpl* p) {
+  p->reference_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void intrusive_ptr_decrement(BatchImpl* p) {
+  if (p->reference_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete p;
+  }
+}
+
+}  // namespace internal_batch
+
+Batch::Entry::~Entry() = default;
+
+Batch Batch::New() {
+  return Batch(internal::IntrusivePtr<internal_batch::BatchImpl>(
+      new internal_batch::BatchImpl));
+}
+
+Batch::Entry& Batch::GetEntryImpl(
+    const void* key, const void* type,
+    absl::FunctionRef<std::unique_ptr<Entry>()> make_entry) const {
+  assert(impl_);
+  return impl_->GetEntry(key, type, make_entry);
+}
+
+}  // namespace tensorstore
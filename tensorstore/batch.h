@@ -0,0 +1,137 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_BATCH_H_
+#define TENSORSTORE_BATCH_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+
+namespace tensorstore {
+
+namespace internal_batch {
+class BatchImpl;
+void intrusive_ptr_increment(BatchImpl* p);
+void intrusive_ptr_decrement(BatchImpl* p);
+}  // namespace internal_batch
+
+/// Groups read operations so that they may be performed more efficiently.
+///
+/// Read operations that specify a batch may be deferred until the batch is
+/// submitted, which happens once the last `Batch` handle referring to it is
+/// destroyed or released.  Drivers that support batching use this to combine
+/// the deferred reads, e.g. to read the index of a sharded format only once
+/// and to merge byte range reads of the same object into fewer requests.
+/// Drivers that do not support batching ignore the batch and perform each
+/// read immediately.
+///
+/// .. warning::
+///
+///    A future returned by a batched read may not become ready until the batch
+///    is submitted.  Waiting on such a future while still holding a handle to
+///    the batch may deadlock.
+///
+/// Example::
+///
+///     std::vector<Future<kvstore::ReadResult>> futures;
+///     {
+///       kvstore::ReadOptions options;
+///       options.batch = Batch::New();
+///       for (const auto& key : keys) {
+///         futures.push_back(kvstore::Read(store, key, options));
+///       }
+///     }  // Batch submitted here.
+///
+/// \ingroup core
+class Batch {
+ public:
+  /// Special type that indicates a null batch.
+  struct no_batch_t {
+    explicit no_batch_t() = default;
+  };
+
+  /// Base class for the per-driver state associated with a batch.
+  ///
+  /// Entries are submitted, in the order in which they were created, when the
+  /// batch is submitted, and then destroyed.
+  class Entry {
+   public:
+    virtual ~Entry();
+
+    /// Issues the operations collected by this entry.
+    virtual void Submit() = 0;
+  };
+
+  /// Creates a null batch.
+  ///
+  /// Operations that specify a null batch are performed immediately.
+  ///
+  /// \id no_batch
+  constexpr Batch(no_batch_t) noexcept {}
+
+  /// Returns a new batch.
+  static Batch New();
+
+  /// Returns `true` if this is not a null batch.
+  explicit operator bool() const { return static_cast<bool>(impl_); }
+
+  /// Releases this handle, submitting the batch if this was the last handle.
+  ///
+  /// \post `!*this`
+  void Release() { impl_.reset(); }
+
+  /// Returns the entry of type `EntryType` associated with `key`, calling
+  /// `make_entry()` to create it if it does not already exist.
+  ///
+  /// The returned reference remains valid until the batch is submitted.
+  ///
+  /// \dchecks `*this`
+  template <typename EntryType, typename MakeEntry>
+  EntryType& GetEntry(const void* key, MakeEntry&& make_entry) const {
+    return static_cast<EntryType&>(
+        GetEntryImpl(key, &entry_type_tag<EntryType>, [&] {
+          return std::unique_ptr<Entry>(make_entry());
+        }));
+  }
+
+  friend bool operator==(const Batch& a, const Batch& b) {
+    return a.impl_ == b.impl_;
+  }
+  friend bool operator!=(const Batch& a, const Batch& b) { return !(a == b); }
+
+ private:
+  template <typename EntryType>
+  static inline constexpr char entry_type_tag = 0;
+
+  explicit Batch(internal::IntrusivePtr<internal_batch::BatchImpl> impl)
+      : impl_(std::move(impl)) {}
+
+  Entry& GetEntryImpl(const void* key, const void* type,
+                      absl::FunctionRef<std::unique_ptr<Entry>()> make_entry)
+      const;
+
+  internal::IntrusivePtr<internal_batch::BatchImpl> impl_;
+};
+
+/// Special value that indicates a null batch.
+///
+/// \relates Batch
+constexpr inline Batch::no_batch_t no_batch{};
+
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_BATCH_H_
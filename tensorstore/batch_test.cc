@@ -0,0 +1,79 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/batch.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+using ::tensorstore::Batch;
+using ::tensorstore::no_batch;
+using ::testing::ElementsAre;
+
+struct LogEntry : public Batch::Entry {
+  LogEntry(std::vector<std::string>& log, std::string name)
+      : log(log), name(std::move(name)) {}
+  void Submit() override { log.push_back(name); }
+  std::vector<std::string>& log;
+  std::string name;
+  int count = 0;
+};
+
+struct OtherEntry : public LogEntry {
+  using LogEntry::LogEntry;
+};
+
+TEST(BatchTest, NoBatch) {
+  Batch batch = no_batch;
+  EXPECT_FALSE(batch);
+  EXPECT_EQ(batch, Batch(no_batch));
+}
+
+TEST(BatchTest, SubmitOnRelease) {
+  std::vector<std::string> log;
+  int key1, key2;
+  {
+    auto batch = Batch::New();
+    EXPECT_TRUE(batch);
+    auto& a = batch.GetEntry<LogEntry>(
+        &key1, [&] { return new LogEntry(log, "a"); });
+    auto& b = batch.GetEntry<LogEntry>(
+        &key2, [&] { return new LogEntry(log, "b"); });
+    EXPECT_NE(&a, &b);
+    ++a.count;
+    // Same key and type returns the existing entry.
+    auto& a2 = batch.GetEntry<LogEntry>(
+        &key1, [&] { return new LogEntry(log, "a2"); });
+    EXPECT_EQ(&a, &a2);
+    EXPECT_EQ(1, a2.count);
+    // Same key but different type creates a new entry.
+    auto& c = batch.GetEntry<OtherEntry>(
+        &key1, [&] { return new OtherEntry(log, "c"); });
+    EXPECT_NE(static_cast<LogEntry*>(&c), &a);
+
+    auto batch_copy = batch;
+    batch.Release();
+    EXPECT_FALSE(batch);
+    EXPECT_THAT(log, ::testing::IsEmpty());
+  }
+  EXPECT_THAT(log, ElementsAre("a", "b", "c"));
+}
+
+}  // namespace
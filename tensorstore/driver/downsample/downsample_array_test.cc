@@ -14,8 +14,12 @@
 
 #include "tensorstore/driver/downsample/downsample_array.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
@@ -386,6 +390,77 @@ TEST(DownsampleArrayTest, ModeJson) {
               Optional(MakeArray<::nlohmann::json>({json_t(3)})));
 }
 
+// Computes the median and mode of each 2x2x2 cell of `source` by sorting the
+// cell values, and compares them to the results of `DownsampleArray`.  The
+// shape of `source` is not a multiple of the downsample factors, such that
+// cells of 1, 2, 4, and 8 elements are covered.
+template <typename T>
+void TestSmallCellMedianAndMode() {
+  auto source = tensorstore::AllocateArray<T>({5, 4, 3});
+  // Small range of values, to ensure repeated values.
+  uint32_t state = 1;
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      for (int k = 0; k < 3; ++k) {
+        state = state * 1103515245 + 12345;
+        source(i, j, k) = static_cast<T>((state >> 16) % 5) - 2;
+      }
+    }
+  }
+  auto expected_median = tensorstore::AllocateArray<T>({3, 2, 2});
+  auto expected_mode = tensorstore::AllocateArray<T>({3, 2, 2});
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      for (int k = 0; k < 2; ++k) {
+        std::vector<T> values;
+        for (int ii = 2 * i; ii < std::min(5, 2 * i + 2); ++ii) {
+          for (int jj = 2 * j; jj < 2 * j + 2; ++jj) {
+            for (int kk = 2 * k; kk < std::min(3, 2 * k + 2); ++kk) {
+              values.push_back(source(ii, jj, kk));
+            }
+          }
+        }
+        std::sort(values.begin(), values.end());
+        expected_median(i, j, k) = values[(values.size() - 1) / 2];
+        // The smallest of the most frequent values.
+        T mode = values[0];
+        size_t mode_count = 0;
+        for (size_t begin = 0, end; begin < values.size(); begin = end) {
+          for (end = begin; end < values.size() && values[end] == values[begin];
+               ++end) {
+          }
+          if (end - begin > mode_count) {
+            mode = values[begin];
+            mode_count = end - begin;
+          }
+        }
+        expected_mode(i, j, k) = mode;
+      }
+    }
+  }
+  EXPECT_THAT(
+      DownsampleArray(source, {{2, 2, 2}}, DownsampleMethod::kMedian),
+      Optional(tensorstore::MatchesArray(expected_median)));
+  EXPECT_THAT(DownsampleArray(source, {{2, 2, 2}}, DownsampleMethod::kMode),
+              Optional(tensorstore::MatchesArray(expected_mode)));
+}
+
+TEST(DownsampleArrayTest, SmallCellMedianAndModeInt8) {
+  TestSmallCellMedianAndMode<int8_t>();
+}
+
+TEST(DownsampleArrayTest, SmallCellMedianAndModeUint16) {
+  TestSmallCellMedianAndMode<uint16_t>();
+}
+
+TEST(DownsampleArrayTest, SmallCellMedianAndModeInt32) {
+  TestSmallCellMedianAndMode<int32_t>();
+}
+
+TEST(DownsampleArrayTest, SmallCellMedianAndModeUint64) {
+  TestSmallCellMedianAndMode<uint64_t>();
+}
+
 // Tests the downsampling behaves correctly when multiple blocks along
 // downsampled dimensions are needed.
 TEST(DownsampleArrayTest, MultipleBlocks) {
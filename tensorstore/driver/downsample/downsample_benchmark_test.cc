@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdint.h>
+
 #include <vector>
 
 #include <benchmark/benchmark.h>
@@ -41,9 +43,9 @@ using ::tensorstore::internal_downsample::DownsampleBounds;
 
 void BenchmarkDownsample(::benchmark::State& state, DataType dtype,
                          DownsampleMethod downsample_method,
-                         DimensionIndex rank, Index downsample_factor,
+                         std::vector<Index> downsample_factors,
                          Index block_size) {
-  std::vector<Index> downsample_factors(rank, downsample_factor);
+  const DimensionIndex rank = downsample_factors.size();
   std::vector<Index> block_shape(rank, block_size);
   absl::BitGen gen;
   BoxView<> base_domain(block_shape);
@@ -87,14 +89,44 @@ TENSORSTORE_GLOBAL_INITIALIZER {
                                     downsample_factor, "_BlockSize", block_size)
                     .c_str(),
                 [=](auto& state) {
-                  BenchmarkDownsample(state, dtype, downsample_method, rank,
-                                      downsample_factor, block_size);
+                  BenchmarkDownsample(
+                      state, dtype, downsample_method,
+                      std::vector<Index>(rank, downsample_factor), block_size);
                 });
           }
         }
       }
     }
   }
+
+  // Median and mode downsampling of integer volumes, such as segmentations,
+  // with the small downsample factors used to build multiscale pyramids.
+  for (const DataType dtype :
+       {DataType(tensorstore::dtype_v<uint8_t>),
+        DataType(tensorstore::dtype_v<uint16_t>),
+        DataType(tensorstore::dtype_v<uint32_t>),
+        DataType(tensorstore::dtype_v<uint64_t>)}) {
+    for (const DownsampleMethod downsample_method :
+         {DownsampleMethod::kMedian, DownsampleMethod::kMode}) {
+      for (const std::vector<Index>& downsample_factors :
+           {std::vector<Index>{2, 2, 2}, std::vector<Index>{2, 2, 1}}) {
+        for (const Index block_size : {64, 128}) {
+          ::benchmark::RegisterBenchmark(
+              tensorstore::StrCat("DownsampleArray_", dtype, "_",
+                                  downsample_method, "_Factors",
+                                  downsample_factors[0], "x",
+                                  downsample_factors[1], "x",
+                                  downsample_factors[2], "_BlockSize",
+                                  block_size)
+                  .c_str(),
+              [=](auto& state) {
+                BenchmarkDownsample(state, dtype, downsample_method,
+                                    downsample_factors, block_size);
+              });
+        }
+      }
+    }
+  }
 }
 
 }  // namespace
@@ -423,12 +423,97 @@ struct StoreReductionTraitsBase {
   }
 };
 
+/// Sorting networks used to sort the stored input values of small
+/// downsampling cells, such as the 2x2x2 and 2x2x1 cells that are typical for
+/// segmentation volumes.  Each pair `(i, j)` with `i < j` denotes a
+/// compare-exchange of elements `i` and `j`.
+using SortingNetworkComparator = std::pair<uint8_t, uint8_t>;
+
+constexpr SortingNetworkComparator kSortingNetwork2[] = {{0, 1}};
+constexpr SortingNetworkComparator kSortingNetwork3[] = {
+    {0, 2}, {0, 1}, {1, 2}};
+constexpr SortingNetworkComparator kSortingNetwork4[] = {
+    {0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}};
+constexpr SortingNetworkComparator kSortingNetwork5[] = {
+    {0, 3}, {1, 4}, {0, 2}, {1, 3}, {0, 1}, {2, 4}, {1, 2}, {3, 4}, {2, 3}};
+constexpr SortingNetworkComparator kSortingNetwork6[] = {
+    {0, 5}, {1, 3}, {2, 4}, {1, 2}, {3, 4}, {0, 3},
+    {2, 5}, {0, 1}, {2, 3}, {4, 5}, {1, 2}, {3, 4}};
+constexpr SortingNetworkComparator kSortingNetwork7[] = {
+    {0, 6}, {2, 3}, {4, 5}, {0, 2}, {1, 4}, {3, 6}, {0, 1}, {2, 5},
+    {3, 4}, {1, 2}, {4, 6}, {2, 3}, {4, 5}, {1, 2}, {3, 4}, {5, 6}};
+constexpr SortingNetworkComparator kSortingNetwork8[] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6},
+    {3, 7}, {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5},
+    {1, 4}, {3, 6}, {1, 2}, {3, 4}, {5, 6}};
+
+template <typename Element, size_t N>
+inline void ApplySortingNetwork(
+    Element* values, const SortingNetworkComparator (&network)[N]) {
+  for (const auto& [i, j] : network) {
+    // Computed without branches, which avoids the mispredictions that
+    // dominate the cost of `std::sort` for a small number of random values.
+    const Element a = values[i];
+    const Element b = values[j];
+    values[i] = std::min(a, b);
+    values[j] = std::max(a, b);
+  }
+}
+
+/// Sorts `input` using a sorting network if it has at most 8 elements.
+///
+/// \returns `true` if `input` was sorted, or `false` if `input` is too large.
+template <typename Element>
+bool SortUsingNetwork(span<Element> input) {
+  Element* values = input.data();
+  switch (input.size()) {
+    case 0:
+    case 1:
+      return true;
+    case 2:
+      ApplySortingNetwork(values, kSortingNetwork2);
+      return true;
+    case 3:
+      ApplySortingNetwork(values, kSortingNetwork3);
+      return true;
+    case 4:
+      ApplySortingNetwork(values, kSortingNetwork4);
+      return true;
+    case 5:
+      ApplySortingNetwork(values, kSortingNetwork5);
+      return true;
+    case 6:
+      ApplySortingNetwork(values, kSortingNetwork6);
+      return true;
+    case 7:
+      ApplySortingNetwork(values, kSortingNetwork7);
+      return true;
+    case 8:
+      ApplySortingNetwork(values, kSortingNetwork8);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// Sorting networks are only used for integer types: for floating-point
+/// types, `std::min` and `std::max` do not define a consistent ordering in the
+/// presence of NaN values.
+template <typename Element>
+constexpr bool kUseSortingNetwork = std::is_integral_v<Element>;
+
 template <typename Element>
 struct ReductionTraits<DownsampleMethod::kMedian, Element,
                        std::enable_if_t<IsOrderingSupported<Element>::value>>
     : public StoreReductionTraitsBase<DownsampleMethod::kMedian, Element> {
   static void ComputeOutput(Element& output, span<Element> input) {
     auto median_it = input.begin() + (input.size() - 1) / 2;
+    if constexpr (kUseSortingNetwork<Element>) {
+      if (SortUsingNetwork(input)) {
+        output = *median_it;
+        return;
+      }
+    }
     std::nth_element(input.begin(), median_it, input.end());
     output = *median_it;
   }
@@ -455,7 +540,13 @@ struct ReductionTraits<DownsampleMethod::kMode, Element>
   static void ComputeOutput(Element& output, span<Element> input) {
     // Sort in order to determine the number of times each distinct value is
     // repeated.
-    std::sort(input.begin(), input.end(), CompareForMode<Element>{});
+    if constexpr (kUseSortingNetwork<Element>) {
+      if (!SortUsingNetwork(input)) {
+        std::sort(input.begin(), input.end(), CompareForMode<Element>{});
+      }
+    } else {
+      std::sort(input.begin(), input.end(), CompareForMode<Element>{});
+    }
     Index most_frequent_index = 0;
     size_t most_frequent_count = 1;
     size_t cur_count = 1;
@@ -0,0 +1,226 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/driver/downsample/downsample_pyramid.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorstore/array.h"
+#include "tensorstore/box.h"
+#include "tensorstore/chunk_layout.h"
+#include "tensorstore/downsample_method.h"
+#include "tensorstore/driver/downsample/downsample_array.h"
+#include "tensorstore/index.h"
+#include "tensorstore/index_interval.h"
+#include "tensorstore/index_space/dim_expression.h"
+#include "tensorstore/internal/integer_overflow.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/tensorstore.h"
+#include "tensorstore/util/division.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_downsample {
+namespace {
+
+/// State of a `DownsamplePyramid` operation.
+///
+/// The base domain is partitioned into a regular grid of blocks, which are
+/// processed in order of their linear index by up to `concurrency` concurrent
+/// chains.  Each chain claims the next block when its previous block has been
+/// written.  The promise becomes ready with the first error, or once all
+/// chains have finished and released their references to the state.
+struct PyramidState : public internal::AtomicReferenceCount<PyramidState> {
+  TensorStore<> base;
+  std::vector<DownsamplePyramidLevel> levels;
+  DownsampleMethod method;
+  Box<> domain;
+  std::vector<Index> block_shape;
+  // Block grid coordinates of the first block, and number of blocks, in each
+  // dimension.
+  std::vector<Index> grid_origin;
+  std::vector<Index> grid_shape;
+  Index num_blocks;
+  std::atomic<Index> next_block{0};
+  Promise<void> promise;
+
+  Box<> GetBlock(Index block_index) const {
+    const DimensionIndex rank = domain.rank();
+    Box<> block(rank);
+    for (DimensionIndex i = rank - 1; i >= 0; --i) {
+      const Index cell = grid_origin[i] + block_index % grid_shape[i];
+      block_index /= grid_shape[i];
+      block[i] = Intersect(
+          domain[i],
+          IndexInterval::UncheckedSized(cell * block_shape[i], block_shape[i]));
+    }
+    return block;
+  }
+
+  void StartNextBlock() {
+    if (!promise.result_needed()) return;
+    const Index block_index = next_block.fetch_add(1);
+    if (block_index >= num_blocks) return;
+    auto read_future =
+        tensorstore::Read(base | AllDims().BoxSlice(GetBlock(block_index)));
+    read_future.Force();
+    read_future.ExecuteWhenReady(
+        [self = internal::IntrusivePtr<PyramidState>(this)](
+            ReadyFuture<SharedOffsetArray<void>> future) {
+          self->ProcessBlock(future.result());
+        });
+  }
+
+  void ProcessBlock(Result<SharedOffsetArray<void>> block) {
+    if (!block.ok()) {
+      promise.SetResult(block.status());
+      return;
+    }
+    SharedOffsetArray<const void> source = *std::move(block);
+    std::vector<AnyFuture> write_futures;
+    write_futures.reserve(levels.size());
+    for (const auto& level : levels) {
+      auto downsampled =
+          DownsampleArray(source, level.downsample_factors, method);
+      if (!downsampled.ok()) {
+        promise.SetResult(downsampled.status());
+        return;
+      }
+      source = *std::move(downsampled);
+      write_futures.push_back(
+          tensorstore::Write(source,
+                             level.store | AllDims().BoxSlice(source.domain()))
+              .commit_future);
+    }
+    auto written = WaitAllFuture(write_futures);
+    written.Force();
+    written.ExecuteWhenReady(
+        [self = internal::IntrusivePtr<PyramidState>(this)](
+            ReadyFuture<void> future) {
+          if (!future.status().ok()) {
+            self->promise.SetResult(future.status());
+            return;
+          }
+          self->StartNextBlock();
+        });
+  }
+};
+
+absl::Status ValidateLevels(DimensionIndex rank,
+                            span<const DownsamplePyramidLevel> levels,
+                            span<Index> total_factors) {
+  std::fill(total_factors.begin(), total_factors.end(), 1);
+  for (const auto& level : levels) {
+    if (level.downsample_factors.size() != rank) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Number of downsample factors (", level.downsample_factors.size(),
+          ") does not match base rank (", rank, ")"));
+    }
+    if (level.store.rank() != rank) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Rank of level (", level.store.rank(),
+          ") does not match base rank (", rank, ")"));
+    }
+    for (DimensionIndex i = 0; i < rank; ++i) {
+      const Index factor = level.downsample_factors[i];
+      if (factor <= 0) {
+        return absl::InvalidArgumentError(tensorstore::StrCat(
+            "Invalid downsample factors ",
+            span(level.downsample_factors)));
+      }
+      if (internal::MulOverflow(total_factors[i], factor, &total_factors[i])) {
+        return absl::InvalidArgumentError(
+            "Product of downsample factors overflows");
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace internal_downsample
+
+Future<const void> DownsamplePyramid(TensorStore<> base,
+                                     std::vector<DownsamplePyramidLevel> levels,
+                                     DownsamplePyramidOptions options) {
+  using internal_downsample::PyramidState;
+  const DimensionIndex rank = base.rank();
+  std::vector<Index> total_factors(rank);
+  TENSORSTORE_RETURN_IF_ERROR(
+      internal_downsample::ValidateLevels(rank, levels, total_factors));
+
+  auto state = internal::MakeIntrusivePtr<PyramidState>();
+  state->domain = base.domain().box();
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    if (!IsFinite(state->domain[i])) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Cannot downsample base with unbounded domain ", base.domain()));
+    }
+  }
+  if (levels.empty() || state->domain.is_empty()) return MakeReadyFuture();
+
+  // Determine the block shape.
+  std::vector<Index>& block_shape = state->block_shape;
+  if (!options.block_shape.empty()) {
+    if (options.block_shape.size() != rank) {
+      return absl::InvalidArgumentError(tensorstore::StrCat(
+          "Block shape ", span(options.block_shape),
+          " does not match base rank (", rank, ")"));
+    }
+    block_shape = options.block_shape;
+  } else {
+    TENSORSTORE_ASSIGN_OR_RETURN(auto chunk_layout, base.chunk_layout());
+    auto read_chunk_shape = chunk_layout.read_chunk_shape();
+    block_shape.assign(rank, 0);
+    for (DimensionIndex i = 0; i < rank; ++i) {
+      block_shape[i] = read_chunk_shape[i];
+    }
+  }
+  state->grid_origin.resize(rank);
+  state->grid_shape.resize(rank);
+  state->num_blocks = 1;
+  for (DimensionIndex i = 0; i < rank; ++i) {
+    Index& size = block_shape[i];
+    if (size <= 0) size = state->domain.shape()[i];
+    size = CeilOfRatio(size, total_factors[i]) * total_factors[i];
+    const Index first = FloorOfRatio(state->domain[i].inclusive_min(), size);
+    const Index last = FloorOfRatio(state->domain[i].inclusive_max(), size);
+    state->grid_origin[i] = first;
+    state->grid_shape[i] = last - first + 1;
+    state->num_blocks *= state->grid_shape[i];
+  }
+
+  state->base = std::move(base);
+  state->levels = std::move(levels);
+  state->method = options.method;
+  auto [promise, future] = PromiseFuturePair<void>::Make(MakeResult());
+  state->promise = std::move(promise);
+  const size_t concurrency = std::max(options.concurrency, size_t{1});
+  for (size_t i = 0; i < concurrency; ++i) {
+    state->StartNextBlock();
+  }
+  return std::move(future);
+}
+
+}  // namespace tensorstore
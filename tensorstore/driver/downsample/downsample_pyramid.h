@@ -0,0 +1,84 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_DRIVER_DOWNSAMPLE_DOWNSAMPLE_PYRAMID_H_
+#define TENSORSTORE_DRIVER_DOWNSAMPLE_DOWNSAMPLE_PYRAMID_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "tensorstore/downsample_method.h"
+#include "tensorstore/index.h"
+#include "tensorstore/tensorstore.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+
+/// Level of a multi-resolution pyramid computed by `DownsamplePyramid`.
+struct DownsamplePyramidLevel {
+  /// Target to which the level is written.  The domain must contain the
+  /// domain of the previous level (or of the base) downsampled by
+  /// `downsample_factors`.
+  TensorStore<> store;
+
+  /// Downsample factors relative to the previous level, or to the base for
+  /// the first level.  The size must equal the rank of the base.
+  std::vector<Index> downsample_factors;
+};
+
+/// Options for `DownsamplePyramid`.
+struct DownsamplePyramidOptions {
+  DownsampleMethod method = DownsampleMethod::kMean;
+
+  /// Shape of the blocks in which the base is read.  Each dimension is
+  /// rounded up to a multiple of the product of the downsample factors of all
+  /// levels, such that every block maps to whole cells of every level.
+  ///
+  /// If empty, the read chunk shape of the base is used; dimensions without a
+  /// chunk size span the full base domain.
+  std::vector<Index> block_shape;
+
+  /// Maximum number of blocks processed concurrently.  Memory usage is
+  /// bounded by roughly `concurrency` times the size of a block.
+  size_t concurrency = 4;
+};
+
+/// Computes a multi-resolution pyramid from `base` in a single pass.
+///
+/// The base is read once, block by block.  Each block is downsampled in
+/// memory by the factors of the first level, the result is downsampled by the
+/// factors of the second level, and so on; each result is written to the
+/// `store` of its level.  This is equivalent to downsampling each level from
+/// the previous level, but avoids re-reading the previous levels.
+///
+/// Example::
+///
+///     TENSORSTORE_RETURN_IF_ERROR(
+///         DownsamplePyramid(base, {{level1, {2, 2, 1}}, {level2, {2, 2, 1}}})
+///             .result());
+///
+/// \param base The base array.  Must have finite bounds.
+/// \param levels The levels to compute, from highest to lowest resolution.
+/// \param options Specifies the downsample method and block size.
+/// \returns A future that becomes ready once all levels have been written,
+///     or with the first error that occurred.  Levels may be partially
+///     written if an error occurs.
+Future<const void> DownsamplePyramid(TensorStore<> base,
+                                     std::vector<DownsamplePyramidLevel> levels,
+                                     DownsamplePyramidOptions options = {});
+
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_DRIVER_DOWNSAMPLE_DOWNSAMPLE_PYRAMID_H_
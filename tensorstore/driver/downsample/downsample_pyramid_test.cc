@@ -0,0 +1,135 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/driver/downsample/downsample_pyramid.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "tensorstore/array.h"
+#include "tensorstore/box.h"
+#include "tensorstore/context.h"
+#include "tensorstore/downsample.h"
+#include "tensorstore/downsample_method.h"
+#include "tensorstore/driver/array/array.h"
+#include "tensorstore/index.h"
+#include "tensorstore/tensorstore.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::BoxView;
+using ::tensorstore::Context;
+using ::tensorstore::DownsampleMethod;
+using ::tensorstore::DownsamplePyramid;
+using ::tensorstore::DownsamplePyramidOptions;
+using ::tensorstore::Index;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::TensorStore;
+
+// Returns a store holding a zero-initialized array with domain `domain`.
+template <typename T>
+TensorStore<> MakeStore(BoxView<> domain) {
+  return tensorstore::FromArray(
+             Context::Default(),
+             tensorstore::AllocateArray<T>(domain, tensorstore::c_order,
+                                           tensorstore::value_init))
+      .value();
+}
+
+// Returns the domain of `store` downsampled by `factors`.
+tensorstore::Box<> DownsampledDomain(const TensorStore<>& store,
+                                     std::vector<Index> factors,
+                                     DownsampleMethod method) {
+  return tensorstore::Box<>(
+      tensorstore::Downsample(store, factors, method).value().domain().box());
+}
+
+TEST(DownsamplePyramidTest, Mean) {
+  auto base_array = tensorstore::AllocateArray<float>({8, 12});
+  for (Index i = 0; i < 8; ++i) {
+    for (Index j = 0; j < 12; ++j) base_array(i, j) = i * 12 + j;
+  }
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, tensorstore::FromArray(Context::Default(), base_array));
+  auto level1 = MakeStore<float>(BoxView({4, 6}));
+  auto level2 = MakeStore<float>(BoxView({2, 2}));
+
+  TENSORSTORE_ASSERT_OK(
+      DownsamplePyramid(base, {{level1, {2, 2}}, {level2, {2, 3}}}).result());
+
+  EXPECT_EQ(tensorstore::Read(tensorstore::Downsample(base, {2, 2},
+                                                      DownsampleMethod::kMean))
+                .value(),
+            tensorstore::Read(level1).value());
+  EXPECT_EQ(tensorstore::Read(tensorstore::Downsample(level1, {2, 3},
+                                                      DownsampleMethod::kMean))
+                .value(),
+            tensorstore::Read(level2).value());
+}
+
+TEST(DownsamplePyramidTest, StrideWithPartialBlocks) {
+  auto base_array =
+      tensorstore::AllocateArray<int32_t>(BoxView({1, -3}, {9, 7}));
+  for (Index i = 1; i < 10; ++i) {
+    for (Index j = -3; j < 4; ++j) base_array(i, j) = i * 100 + j;
+  }
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base, tensorstore::FromArray(Context::Default(), base_array));
+  auto level1 = MakeStore<int32_t>(
+      DownsampledDomain(base, {2, 2}, DownsampleMethod::kStride));
+  auto level2 = MakeStore<int32_t>(
+      DownsampledDomain(level1, {3, 1}, DownsampleMethod::kStride));
+
+  DownsamplePyramidOptions options;
+  options.method = DownsampleMethod::kStride;
+  options.block_shape = {2, 2};
+  options.concurrency = 3;
+  TENSORSTORE_ASSERT_OK(
+      DownsamplePyramid(base, {{level1, {2, 2}}, {level2, {3, 1}}}, options)
+          .result());
+
+  EXPECT_EQ(tensorstore::Read(tensorstore::Downsample(
+                                  base, {2, 2}, DownsampleMethod::kStride))
+                .value(),
+            tensorstore::Read(level1).value());
+  EXPECT_EQ(tensorstore::Read(tensorstore::Downsample(
+                                  base, {6, 2}, DownsampleMethod::kStride))
+                .value(),
+            tensorstore::Read(level2).value());
+}
+
+TEST(DownsamplePyramidTest, InvalidFactors) {
+  auto base = MakeStore<float>(BoxView({4, 4}));
+  auto level = MakeStore<float>(BoxView({2, 2}));
+  EXPECT_THAT(DownsamplePyramid(base, {{level, {2}}}).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            ".*does not match base rank.*"));
+  EXPECT_THAT(DownsamplePyramid(base, {{level, {2, 0}}}).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "Invalid downsample factors.*"));
+}
+
+TEST(DownsamplePyramidTest, TargetTooSmall) {
+  auto base = MakeStore<float>(BoxView({4, 4}));
+  auto level = MakeStore<float>(BoxView({1, 2}));
+  EXPECT_THAT(DownsamplePyramid(base, {{level, {2, 2}}}).result(),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
+}  // namespace
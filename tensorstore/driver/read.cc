@@ -16,10 +16,13 @@
 
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <type_traits>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorstore/array.h"
 #include "tensorstore/box.h"
 #include "tensorstore/container_kind.h"
@@ -32,7 +35,9 @@
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/alignment.h"
 #include "tensorstore/index_space/index_transform.h"
+#include "tensorstore/index_space/output_index_method.h"
 #include "tensorstore/index_space/transformed_array.h"
+#include "tensorstore/internal/cache/chunk_cache.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/lock_collection.h"
 #include "tensorstore/internal/nditerable.h"
@@ -41,6 +46,7 @@
 #include "tensorstore/internal/nditerable_transformed_array.h"
 #include "tensorstore/internal/nditerable_util.h"
 #include "tensorstore/internal/tagged_ptr.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/internal/type_traits.h"
 #include "tensorstore/open_mode.h"
 #include "tensorstore/progress.h"
@@ -134,7 +140,8 @@ struct ReadChunkOp {
         state->SetError(_));
     absl::Status copy_status =
         internal::CopyReadChunk(chunk.impl, std::move(chunk.transform),
-                                state->data_type_conversion, target);
+                                state->data_type_conversion, target,
+                                state->executor);
     if (copy_status.ok()) {
       state->UpdateProgress(ProductOfExtents(target.shape()));
     } else {
@@ -225,11 +232,165 @@ struct DriverReadIntoNewInitiateOp {
   }
 };
 
+/// Local state for `DriverReadIntoNewArrayOrView`.
+///
+/// The first chunk received is held until either a second chunk is received,
+/// in which case the target array is allocated and all chunks are copied as
+/// for `DriverReadIntoNewArray`, or the read completes, in which case the
+/// result is a view of the cached data of the single chunk if possible.
+struct ReadOrViewState
+    : public internal::AtomicReferenceCount<ReadOrViewState> {
+  using State = ReadState<SharedOffsetArray<const void>>;
+  IntrusivePtr<State> state;
+  IndexTransform<> source_transform;
+  ContiguousLayoutOrder target_layout_order;
+
+  absl::Mutex mutex;
+  std::optional<ReadChunkOp<SharedOffsetArray<const void>>> first_chunk
+      ABSL_GUARDED_BY(mutex);
+  bool copying ABSL_GUARDED_BY(mutex) = false;
+  bool failed ABSL_GUARDED_BY(mutex) = false;
+
+  void SetError(absl::Status error) {
+    {
+      absl::MutexLock lock(&mutex);
+      failed = true;
+    }
+    state->SetError(std::move(error));
+  }
+
+  // Allocates the target array, into which all chunks are copied.
+  void StartCopying() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    copying = true;
+    auto array =
+        AllocateArray(source_transform.domain().box(), target_layout_order,
+                      default_init, state->source_driver->dtype());
+    state->target = array;
+    // Unlike `SetDeferredResult`, this permits a subsequent copy error to
+    // replace the result.
+    if (!failed) state->promise.raw_result() = std::move(array);
+  }
+
+  void AddChunk(ReadChunk chunk, IndexTransform<> cell_transform) {
+    ReadChunkOp<SharedOffsetArray<const void>> op{state, std::move(chunk),
+                                                  std::move(cell_transform)};
+    std::optional<ReadChunkOp<SharedOffsetArray<const void>>> first;
+    {
+      absl::MutexLock lock(&mutex);
+      if (!copying) {
+        if (!first_chunk) {
+          first_chunk = std::move(op);
+          return;
+        }
+        StartCopying();
+        first = std::move(first_chunk);
+        first_chunk.reset();
+      }
+    }
+    if (first) state->executor(*std::move(first));
+    state->executor(std::move(op));
+  }
+
+  void Done() {
+    std::optional<ReadChunkOp<SharedOffsetArray<const void>>> first;
+    bool viewed = false;
+    {
+      absl::MutexLock lock(&mutex);
+      if (copying || failed) return;
+      first = std::move(first_chunk);
+      first_chunk.reset();
+      if (first) {
+        if (auto view = GetView(*first); view.valid()) {
+          state->promise.raw_result() = std::move(view);
+          first.reset();
+          viewed = true;
+        }
+      }
+      if (!viewed) StartCopying();
+    }
+    if (first) {
+      state->executor(*std::move(first));
+    } else if (viewed) {
+      state->UpdateProgress(state->total_elements);
+    }
+  }
+
+  // Returns a view of the cached data of `op.chunk` over the entire domain, or
+  // an invalid array if that is not possible.
+  SharedOffsetArray<const void> GetView(
+      const ReadChunkOp<SharedOffsetArray<const void>>& op) {
+    auto array = GetCachedReadChunkArray(op.chunk.impl);
+    if (!array.valid()) return {};
+    // Maps the domain of the read to the cached array.
+    auto cell_inverse = InverseTransform(op.cell_transform);
+    if (!cell_inverse.ok()) return {};
+    auto transform = ComposeTransforms(op.chunk.transform, *cell_inverse);
+    if (!transform.ok() ||
+        transform->domain().box() != source_transform.domain().box()) {
+      return {};
+    }
+    for (const auto map : transform->output_index_maps()) {
+      // An index array map would require a copy.
+      if (map.method() == OutputIndexMethod::array) return {};
+    }
+    auto view = TransformArray(array, *transform);
+    if (!view.ok()) return {};
+    return *std::move(view);
+  }
+};
+
+/// FlowReceiver used by `DriverReadIntoNewArrayOrView`.
+struct ReadOrViewChunkReceiver {
+  IntrusivePtr<ReadOrViewState> state;
+  FutureCallbackRegistration cancel_registration;
+  void set_starting(AnyCancelReceiver cancel) {
+    cancel_registration =
+        state->state->promise.ExecuteWhenNotNeeded(std::move(cancel));
+  }
+  void set_stopping() { cancel_registration(); }
+  void set_done() { state->Done(); }
+  void set_error(absl::Status error) { state->SetError(std::move(error)); }
+  void set_value(ReadChunk chunk, IndexTransform<> cell_transform) {
+    state->AddChunk(std::move(chunk), std::move(cell_transform));
+  }
+};
+
+/// Callback used by `DriverReadIntoNewArrayOrView` to initiate the read once
+/// the source transform bounds have been resolved.
+struct DriverReadIntoNewOrViewInitiateOp {
+  IntrusivePtr<ReadOrViewState> state;
+  void operator()(Promise<SharedOffsetArray<const void>> promise,
+                  ReadyFuture<IndexTransform<>> source_transform_future) {
+    IndexTransform<> source_transform =
+        std::move(source_transform_future.value());
+
+    if (!IsFinite(source_transform.domain())) {
+      promise.SetResult(absl::InvalidArgumentError(tensorstore::StrCat(
+          "Read requires a finite domain, got ", source_transform.domain())));
+      return;
+    }
+
+    state->source_transform = source_transform;
+    state->state->promise = std::move(promise);
+    state->state->total_elements =
+        source_transform.input_domain().num_elements();
+
+    // Initiate the read on the driver.  The driver pointer remains in the
+    // state, since it determines the data type if the target is allocated.
+    auto source_driver = state->state->source_driver;
+    auto source_transaction = std::move(state->state->source_transaction);
+    source_driver->Read(std::move(source_transaction),
+                        std::move(source_transform),
+                        ReadOrViewChunkReceiver{std::move(state)});
+  }
+};
+
 }  // namespace
 
 Future<void> DriverRead(Executor executor, DriverHandle source,
                         TransformedSharedArray<void> target,
                         DriverReadOptions options) {
+  internal_tracing::Span span("DriverRead");
   TENSORSTORE_RETURN_IF_ERROR(
       internal::ValidateSupportsRead(source.driver.read_write_mode()));
   using State = ReadState<void>;
@@ -253,6 +414,8 @@ Future<void> DriverRead(Executor executor, DriverHandle source,
       state->source_transaction, std::move(source.transform),
       fix_resizable_bounds);
 
+  span.ExtendUntilReady(pair.promise);
+
   // Initiate the read once the bounds have been resolved.
   LinkValue(WithExecutor(std::move(executor),
                          DriverReadIntoExistingInitiateOp{std::move(state)}),
@@ -274,6 +437,7 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
     Executor executor, DriverHandle source, DataType target_dtype,
     ContiguousLayoutOrder target_layout_order,
     DriverReadIntoNewOptions options) {
+  internal_tracing::Span span("DriverReadIntoNewArray");
   TENSORSTORE_RETURN_IF_ERROR(
       internal::ValidateSupportsRead(source.driver.read_write_mode()));
   using State = ReadState<SharedOffsetArray<void>>;
@@ -294,6 +458,8 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
       state->source_transaction, std::move(source.transform),
       fix_resizable_bounds);
 
+  span.ExtendUntilReady(pair.promise);
+
   // Initiate the read once the bounds have been resolved.
   LinkValue(
       WithExecutor(std::move(executor),
@@ -313,10 +479,47 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
       {/*.progress_function=*/std::move(options.progress_function)});
 }
 
+Future<SharedOffsetArray<const void>> DriverReadIntoNewArrayOrView(
+    DriverHandle source, ReadIntoNewArrayOptions options) {
+  internal_tracing::Span span("DriverReadIntoNewArrayOrView");
+  TENSORSTORE_RETURN_IF_ERROR(
+      internal::ValidateSupportsRead(source.driver.read_write_mode()));
+  using State = ReadOrViewState::State;
+  IntrusivePtr<State> state(new State);
+  const DataType dtype = source.driver->dtype();
+  state->data_type_conversion = internal::GetDataTypeConverter(dtype, dtype);
+  state->executor = source.driver->data_copy_executor();
+  state->source_driver = std::move(source.driver);
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      state->source_transaction,
+      internal::AcquireOpenTransactionPtrOrError(source.transaction));
+  state->read_progress_function = std::move(options.progress_function);
+  auto or_view_state = internal::MakeIntrusivePtr<ReadOrViewState>();
+  or_view_state->state = state;
+  or_view_state->target_layout_order = options.layout_order;
+  auto pair = PromiseFuturePair<SharedOffsetArray<const void>>::Make();
+
+  // Resolve the bounds for `source.transform`.
+  auto transform_future = state->source_driver->ResolveBounds(
+      state->source_transaction, std::move(source.transform),
+      fix_resizable_bounds);
+
+  span.ExtendUntilReady(pair.promise);
+
+  // Initiate the read once the bounds have been resolved.
+  LinkValue(
+      WithExecutor(state->executor,
+                   DriverReadIntoNewOrViewInitiateOp{std::move(or_view_state)}),
+      std::move(pair.promise), std::move(transform_future));
+  return std::move(pair.future);
+}
+
 absl::Status CopyReadChunk(
     ReadChunk::Impl& chunk, IndexTransform<> chunk_transform,
     const DataTypeConversionLookupResult& chunk_conversion,
-    TransformedArray<void, dynamic_rank, view> target) {
+    TransformedArray<void, dynamic_rank, view> target,
+    const Executor& executor) {
+  internal_tracing::Span span("CopyReadChunk");
   DefaultNDIterableArena arena;
 
   TENSORSTORE_ASSIGN_OR_RETURN(
@@ -336,6 +539,7 @@ absl::Status CopyReadChunk(
   // Copy the chunk to the relevant portion of the target array.
   NDIterableCopier copier(*source_iterable, *target_iterable, target.shape(),
                           arena);
+  if (executor) return copier.Copy(executor);
   return copier.Copy();
 }
 
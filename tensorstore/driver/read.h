@@ -105,11 +105,26 @@ Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
 Future<SharedOffsetArray<void>> DriverReadIntoNewArray(
     DriverHandle source, ReadIntoNewArrayOptions options);
 
+/// Same as `DriverReadIntoNewArray`, except that if the domain of `source` is
+/// covered by a single chunk whose data is held in memory by the chunk cache,
+/// a read-only view of the cached data is returned without copying.
+///
+/// The view keeps the cache entry pinned while it is referenced, and does not
+/// necessarily have the layout specified by `options.layout_order`.  In all
+/// other cases, including transactional reads, the data is copied to a new
+/// array as by `DriverReadIntoNewArray`.
+Future<SharedOffsetArray<const void>> DriverReadIntoNewArrayOrView(
+    DriverHandle source, ReadIntoNewArrayOptions options);
+
 /// Copies `chunk` transformed by `chunk_transform` to `target`.
+///
+/// If `executor` is specified, large chunks are copied in parallel using it in
+/// addition to the calling thread.
 absl::Status CopyReadChunk(
     ReadChunk::Impl& chunk, IndexTransform<> chunk_transform,
     const DataTypeConversionLookupResult& chunk_conversion,
-    TransformedArray<void, dynamic_rank, view> target);
+    TransformedArray<void, dynamic_rank, view> target,
+    const Executor& executor = {});
 
 absl::Status CopyReadChunk(ReadChunk::Impl& chunk,
                            IndexTransform<> chunk_transform,
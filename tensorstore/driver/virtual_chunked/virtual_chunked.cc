@@ -54,8 +54,8 @@ class VirtualChunkedCache : public internal::ConcreteChunkCache {
    public:
     using OwningCache = VirtualChunkedCache;
     using internal::ChunkCache::Entry::Entry;
-    void DoRead(absl::Time staleness_bound) override {
-      GetOwningCache(*this).DoRead(*this, staleness_bound);
+    void DoRead(internal::AsyncCacheReadRequest request) override {
+      GetOwningCache(*this).DoRead(*this, request.staleness_bound);
     }
   };
   class TransactionNode : public internal::ChunkCache::TransactionNode {
@@ -82,8 +82,8 @@ class VirtualChunkedCache : public internal::ConcreteChunkCache {
 
     std::string Describe() override;
 
-    void DoRead(absl::Time staleness_bound) override {
-      GetOwningCache(*this).DoRead(*this, staleness_bound);
+    void DoRead(internal::AsyncCacheReadRequest request) override {
+      GetOwningCache(*this).DoRead(*this, request.staleness_bound);
     }
 
     void Commit() override;
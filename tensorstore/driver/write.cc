@@ -36,6 +36,7 @@
 #include "tensorstore/internal/nditerable_transformed_array.h"
 #include "tensorstore/internal/nditerable_util.h"
 #include "tensorstore/internal/tagged_ptr.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/internal/type_traits.h"
 #include "tensorstore/open_mode.h"
 #include "tensorstore/progress.h"
@@ -137,6 +138,7 @@ struct WriteChunkOp {
   WriteChunk chunk;
   IndexTransform<> cell_transform;
   void operator()() {
+    internal_tracing::Span span("WriteChunk");
     // Map the portion of the source array that corresponds to this chunk
     // to the index space expected by the chunk.
     TENSORSTORE_ASSIGN_OR_RETURN(
@@ -259,6 +261,7 @@ struct DriverWriteInitiateOp {
 WriteFutures DriverWrite(Executor executor,
                          TransformedSharedArray<const void> source,
                          DriverHandle target, DriverWriteOptions options) {
+  internal_tracing::Span span("DriverWrite");
   TENSORSTORE_RETURN_IF_ERROR(
       internal::ValidateSupportsWrite(target.driver.read_write_mode()));
   IntrusivePtr<WriteState> state(new WriteState);
@@ -290,6 +293,8 @@ WriteFutures DriverWrite(Executor executor,
       state->target_transaction, std::move(target.transform),
       fix_resizable_bounds);
 
+  span.ExtendUntilReady(copy_pair.promise);
+
   // Initiate the write once the bounds have been resolved.
   LinkValue(WithExecutor(std::move(executor),
                          DriverWriteInitiateOp{std::move(state)}),
@@ -25,6 +25,7 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/utility/utility.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/container/intrusive_linked_list.h"
 #include "tensorstore/internal/container/intrusive_red_black_tree.h"
@@ -104,7 +105,7 @@ const AsyncCache::ReadRequestState& GetEffectiveReadRequestState(
 
 template <typename EntryOrNode>
 void EntryOrNodeStartRead(EntryOrNode& entry_or_node,
-                          UniqueWriterLock<Entry> lock) {
+                          UniqueWriterLock<Entry> lock, const Batch& batch) {
   static_assert(std::is_same_v<EntryOrNode, Entry> ||
                 std::is_same_v<EntryOrNode, TransactionNode>);
   auto& request_state = entry_or_node.read_request_state_;
@@ -122,21 +123,25 @@ void EntryOrNodeStartRead(EntryOrNode& entry_or_node,
     return;
   }
   assert(request_state.issued.null());
-  auto staleness_bound = request_state.issued_time =
+  AsyncCacheReadRequest request;
+  request.staleness_bound = request_state.issued_time =
       std::exchange(request_state.queued_time, absl::InfinitePast());
+  request.batch = batch;
   request_state.issued = std::move(request_state.queued);
   lock.unlock();
   AcquireReadRequestReference(entry_or_node);
   ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
       << entry_or_node << "EntryOrNodeStartRead: calling DoRead";
-  entry_or_node.DoRead(staleness_bound);
+  entry_or_node.DoRead(std::move(request));
 }
 
 /// Starts a previously-requested read or writeback operation.
 ///
 /// This function is called when a read or writeback operation completes, or a
-/// new writeback is requested.
-void MaybeStartReadOrWriteback(Entry& entry, UniqueWriterLock<Entry> lock) {
+/// new writeback is requested.  The `batch`, if specified, is used for a read
+/// issued by this call.
+void MaybeStartReadOrWriteback(Entry& entry, UniqueWriterLock<Entry> lock,
+                               const Batch& batch = no_batch) {
   auto& read_request_state = entry.read_request_state_;
 
   if (TransactionNode* committing_transaction_node =
@@ -205,17 +210,19 @@ void MaybeStartReadOrWriteback(Entry& entry, UniqueWriterLock<Entry> lock) {
 
   if (read_request_state.issued.null()) {
     // Issue a read if requested.
-    EntryOrNodeStartRead(entry, std::move(lock));
+    EntryOrNodeStartRead(entry, std::move(lock), batch);
   }
 }
 
-void MaybeIssueRead(Entry& entry, UniqueWriterLock<Entry> lock) {
-  MaybeStartReadOrWriteback(entry, std::move(lock));
+void MaybeIssueRead(Entry& entry, UniqueWriterLock<Entry> lock,
+                    const Batch& batch) {
+  MaybeStartReadOrWriteback(entry, std::move(lock), batch);
 }
 
-void MaybeIssueRead(TransactionNode& node, UniqueWriterLock<Entry> lock) {
+void MaybeIssueRead(TransactionNode& node, UniqueWriterLock<Entry> lock,
+                    const Batch& batch) {
   if (!node.read_request_state_.issued.null()) return;
-  EntryOrNodeStartRead(node, std::move(lock));
+  EntryOrNodeStartRead(node, std::move(lock), batch);
 }
 
 template <typename EntryOrNode>
@@ -250,13 +257,14 @@ void SetReadState(EntryOrNode& entry_or_node, ReadState&& read_state,
 
 template <typename EntryOrNode>
 Future<const void> RequestRead(EntryOrNode& entry_or_node,
-                               absl::Time staleness_bound,
+                               const AsyncCacheReadRequest& options,
                                bool must_not_be_known_to_be_stale) {
   static_assert(std::is_same_v<EntryOrNode, Entry> ||
                 std::is_same_v<EntryOrNode, TransactionNode>);
   auto& entry = GetOwningEntry(entry_or_node);
   UniqueWriterLock lock(entry);
 
+  absl::Time staleness_bound = options.staleness_bound;
   auto& effective_request_state = GetEffectiveReadRequestState(entry_or_node);
   const auto existing_time = effective_request_state.read_state.stamp.time;
   if (existing_time != absl::InfinitePast() &&
@@ -290,7 +298,7 @@ Future<const void> RequestRead(EntryOrNode& entry_or_node,
   } else {
     future = GetFuture(request_state.queued);
   }
-  MaybeIssueRead(entry_or_node, std::move(lock));
+  MaybeIssueRead(entry_or_node, std::move(lock), options.batch);
   return future;
 }
 
@@ -331,7 +339,8 @@ void ResolveIssuedRead(EntryOrNode& entry_or_node, absl::Status status,
   assert(!status.ok() || time >= request_state.issued_time);
   {
     QueuedReadHandler queued_read_handler(request_state, time);
-    MaybeIssueRead(entry_or_node, std::move(lock));
+    // Queued reads are not associated with a batch.
+    MaybeIssueRead(entry_or_node, std::move(lock), no_batch);
     // Resolve promises after locks are released, to avoid running Future
     // callbacks with locks held.  It is possible that `issued` was already
     // resolved by a prior `ReadUpdate` call, in which case the call to
@@ -434,12 +443,12 @@ size_t AsyncCache::DoGetSizeInBytes(Cache::Entry* base_entry) {
          entry->read_request_state_.read_state_size;
 }
 
-Future<const void> AsyncCache::Entry::Read(absl::Time staleness_bound,
+Future<const void> AsyncCache::Entry::Read(AsyncCacheReadRequest request,
                                            bool must_not_be_known_to_be_stale) {
   ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
-      << *this << "Read: staleness_bound=" << staleness_bound
+      << *this << "Read: staleness_bound=" << request.staleness_bound
       << ", must_not_be_known_to_be_stale=" << must_not_be_known_to_be_stale;
-  return RequestRead(*this, staleness_bound, must_not_be_known_to_be_stale);
+  return RequestRead(*this, request, must_not_be_known_to_be_stale);
 }
 
 void AsyncCache::Entry::ReadSuccess(ReadState&& read_state) {
@@ -461,17 +470,17 @@ AsyncCache::TransactionNode::TransactionNode(Entry& entry)
       size_updated_(false) {}
 
 Future<const void> AsyncCache::TransactionNode::Read(
-    absl::Time staleness_bound, bool must_not_be_known_to_be_stale) {
+    AsyncCacheReadRequest request, bool must_not_be_known_to_be_stale) {
   ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
-      << *this << "Read: staleness_bound=" << staleness_bound
+      << *this << "Read: staleness_bound=" << request.staleness_bound
       << ", must_not_be_known_to_be_stale=" << must_not_be_known_to_be_stale;
   if (reads_committed_ &&
       (prepare_for_commit_state_.load(std::memory_order_acquire) !=
        PrepareForCommitState::kReadyForCommitCalled)) {
-    return RequestRead(GetOwningEntry(*this), staleness_bound,
+    return RequestRead(GetOwningEntry(*this), request,
                        must_not_be_known_to_be_stale);
   }
-  return RequestRead(*this, staleness_bound, must_not_be_known_to_be_stale);
+  return RequestRead(*this, request, must_not_be_known_to_be_stale);
 }
 
 void AsyncCache::TransactionNode::ReadSuccess(ReadState&& read_state) {
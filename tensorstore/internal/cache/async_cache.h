@@ -33,6 +33,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/container/intrusive_red_black_tree.h"
 #include "tensorstore/internal/intrusive_ptr.h"
@@ -52,6 +53,18 @@
 namespace tensorstore {
 namespace internal {
 
+/// Parameters of a read request on an `AsyncCache::Entry` or
+/// `AsyncCache::TransactionNode`.
+struct AsyncCacheReadRequest {
+  /// Limit on data staleness.
+  absl::Time staleness_bound = absl::InfiniteFuture();
+
+  /// Batch with which the read of the underlying storage may be combined.
+  ///
+  /// Only used if the request results in a read being issued immediately.
+  Batch batch{no_batch};
+};
+
 /// Abstract base class that extends `Cache` with asynchronous read and
 /// read-modify-write functionality based on optimistic concurrency.
 ///
@@ -85,7 +98,7 @@ namespace internal {
 ///        public:
 ///         using OwningCache = Derived;
 ///
-///         void DoRead(absl::Time staleness_bound) override;
+///         void DoRead(AsyncCacheReadRequest request) override;
 ///         size_t ComputeReadDataSizeInBytes(const void *read_data) override;
 ///       };
 ///
@@ -94,7 +107,7 @@ namespace internal {
 ///         using OwningCache = Derived;
 ///         using Base::TransactionNode::TransactionNode;
 ///
-///         void DoRead(absl::Time staleness_bound);
+///         void DoRead(AsyncCacheReadRequest request);
 ///         void DoWriteback() override;
 ///         void DoApply(absl::Time staleness_bound,
 ///                      ApplyReceiver receiver) override;
@@ -358,6 +371,16 @@ class AsyncCache : public Cache {
     ///     than `staleness_bound` is available, or to an error state if the
     ///     request failed.
     Future<const void> Read(absl::Time staleness_bound,
+                            bool must_not_be_known_to_be_stale = true) {
+      return Read(AsyncCacheReadRequest{staleness_bound},
+                  must_not_be_known_to_be_stale);
+    }
+
+    /// Requests data no older than `request.staleness_bound`.
+    ///
+    /// If a read of the underlying storage is required, it is combined with
+    /// `request.batch`.
+    Future<const void> Read(AsyncCacheReadRequest request,
                             bool must_not_be_known_to_be_stale = true);
 
     /// Obtains an existing or new transaction node for the specified entry and
@@ -418,8 +441,9 @@ class AsyncCache : public Cache {
     ///
     /// Derived classes must implement this method, and implementations must
     /// call (either immediately or asynchronously) `ReadSuccess` or `ReadError`
-    /// to signal completion.
-    virtual void DoRead(absl::Time staleness_bound) = 0;
+    /// to signal completion.  Implementations that support batching should add
+    /// the read to `request.batch`, if specified.
+    virtual void DoRead(AsyncCacheReadRequest request) = 0;
 
     /// Signals that the read request initiated by the most recent call to
     /// `DoRead` succeeded.
@@ -626,6 +650,15 @@ class AsyncCache : public Cache {
     /// Requests a read state for this transaction node that is current as of
     /// the specified `staleness_bound`.
     Future<const void> Read(absl::Time staleness_bound,
+                            bool must_not_be_known_to_be_stale = true) {
+      return Read(AsyncCacheReadRequest{staleness_bound},
+                  must_not_be_known_to_be_stale);
+    }
+
+    /// Requests a read state for this transaction node that is current as of
+    /// `request.staleness_bound`, combining any required read of the
+    /// underlying storage with `request.batch`.
+    Future<const void> Read(AsyncCacheReadRequest request,
                             bool must_not_be_known_to_be_stale = true);
 
     /// Requests initial or updated data from persistent storage for a single
@@ -637,8 +670,9 @@ class AsyncCache : public Cache {
     ///
     /// Derived classes must implement this method, and implementations must
     /// call (either immediately or asynchronously) `ReadSuccess` or `ReadError`
-    /// to signal completion.
-    virtual void DoRead(absl::Time staleness_bound) = 0;
+    /// to signal completion.  Implementations that support batching should add
+    /// the read to `request.batch`, if specified.
+    virtual void DoRead(AsyncCacheReadRequest request) = 0;
 
     /// Signals that the read request initiated by the most recent call to
     /// `DoRead` succeeded.
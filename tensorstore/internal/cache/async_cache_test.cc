@@ -24,6 +24,7 @@
 #include "absl/status/status.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/queue_testutil.h"
@@ -38,11 +39,13 @@
 
 namespace {
 
+using ::tensorstore::Batch;
 using ::tensorstore::Future;
 using ::tensorstore::no_transaction;
 using ::tensorstore::Transaction;
 using ::tensorstore::UniqueWriterLock;
 using ::tensorstore::internal::AsyncCache;
+using ::tensorstore::internal::AsyncCacheReadRequest;
 using ::tensorstore::internal::CachePool;
 using ::tensorstore::internal::GetCache;
 using ::tensorstore::internal::OpenTransactionPtr;
@@ -57,6 +60,7 @@ constexpr CachePool::Limits kSmallCacheLimits{10000000};
 struct RequestLog {
   struct ReadRequest {
     AsyncCache::Entry* entry;
+    Batch batch{tensorstore::no_batch};
     void Success(absl::Time time = absl::Now(),
                  std::shared_ptr<const size_t> value = {}) {
       entry->ReadSuccess(
@@ -122,8 +126,9 @@ class TestCache : public tensorstore::internal::AsyncCache {
           ->future();
     }
 
-    void DoRead(absl::Time staleness_bound) override {
-      GetOwningCache(*this).log_->reads.push(RequestLog::ReadRequest{this});
+    void DoRead(AsyncCacheReadRequest request) override {
+      GetOwningCache(*this).log_->reads.push(
+          RequestLog::ReadRequest{this, std::move(request.batch)});
     }
 
     size_t ComputeReadDataSizeInBytes(const void* data) override {
@@ -147,7 +152,7 @@ class TestCache : public tensorstore::internal::AsyncCache {
       SetReadsCommitted();
       return entry.do_initialize_transaction_error;
     }
-    void DoRead(absl::Time staleness_bound) override {
+    void DoRead(AsyncCacheReadRequest request) override {
       GetOwningCache(*this).log_->transaction_reads.push(
           RequestLog::TransactionReadRequest{this});
     }
@@ -345,6 +350,34 @@ TEST(AsyncCacheTest, ReadBasic) {
   }
 }
 
+TEST(AsyncCacheTest, ReadBatch) {
+  auto pool = CachePool::Make(kSmallCacheLimits);
+  RequestLog log;
+  auto cache = GetCache<TestCache>(
+      pool.get(), "", [&] { return std::make_unique<TestCache>(&log); });
+  auto entry = GetCacheEntry(cache, "a");
+
+  auto batch = Batch::New();
+  auto read_future = entry->Read({absl::InfiniteFuture(), batch});
+  ASSERT_FALSE(read_future.ready());
+  {
+    auto read_req = log.reads.pop();
+    // The batch is passed to `DoRead` for a read issued immediately.
+    EXPECT_EQ(batch, read_req.batch);
+    // A read requested while another is in progress is queued, and is issued
+    // without a batch.
+    auto read_time = UniqueNow();
+    auto read_future2 = entry->Read({absl::InfiniteFuture(), batch});
+    ASSERT_TRUE(log.reads.empty());
+    read_req.Success(read_time);
+    auto read_req2 = log.reads.pop();
+    EXPECT_FALSE(read_req2.batch);
+    read_req2.Success();
+    TENSORSTORE_EXPECT_OK(read_future2.result());
+  }
+  TENSORSTORE_EXPECT_OK(read_future.result());
+}
+
 TEST(AsyncCacheTest, ReadFailed) {
   auto pool = CachePool::Make(kSmallCacheLimits);
   RequestLog log;
@@ -17,13 +17,16 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cassert>
+#include <iterator>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <type_traits>
 #include <typeinfo>
 #include <utility>
@@ -34,6 +37,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/functional/function_ref.h"
+#include "absl/numeric/bits.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorstore/internal/cache/cache_pool_limits.h"
 #include "tensorstore/internal/container/intrusive_linked_list.h"
@@ -58,6 +62,27 @@ auto& miss_count = internal_metrics::Counter<int64_t>::New(
 auto& evict_count = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/evict_count", "Number of evictions from the cache.");
 
+// Metrics specific to `CachePoolEvictionPolicy::kSegmentedLru`.  The "segment"
+// field is one of "new" (an entry that has not yet been released),
+// "probationary", or "protected".
+auto& segmented_lru_hit_count =
+    internal_metrics::Counter<int64_t, std::string>::New(
+        "/tensorstore/cache/segmented_lru/hit_count", "segment",
+        "Number of cache hits, by eviction queue segment.");
+auto& segmented_lru_evict_count =
+    internal_metrics::Counter<int64_t, std::string>::New(
+        "/tensorstore/cache/segmented_lru/evict_count", "segment",
+        "Number of evictions from the cache, by eviction queue segment.");
+auto& segmented_lru_promote_count = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/segmented_lru/promote_count",
+    "Number of entries promoted to the protected segment.");
+auto& segmented_lru_demote_count = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/segmented_lru/demote_count",
+    "Number of entries demoted to the probationary segment.");
+
+constexpr const char* kLruSegmentNames[] = {"probationary", "protected", "new"};
+static_assert(std::size(kLruSegmentNames) == CachePoolImpl::kNotQueued + 1);
+
 using ::tensorstore::internal::PinnedCacheEntry;
 
 #if !defined(NDEBUG)
@@ -69,12 +94,35 @@ inline void DebugAssertMutexHeld(absl::Mutex* mutex) {}
 using LruListAccessor =
     internal::intrusive_linked_list::MemberAccessor<LruListNode>;
 
+namespace {
+/// Returns the number of LRU shards for a new cache pool: the number of
+/// hardware threads rounded up to a power of 2, but no more than 64.
+size_t GetNumLruShards() {
+  const size_t num_threads =
+      std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+  return std::min(size_t(64), absl::bit_ceil(num_threads));
+}
+}  // namespace
+
 CachePoolImpl::CachePoolImpl(const CachePool::Limits& limits)
     : limits_(limits),
       total_bytes_(0),
+      num_lru_shards_(GetNumLruShards()),
+      lru_clock_(0),
+      protected_bytes_(0),
+      // The protected segment may occupy at most 80% of the pool, to leave
+      // room for newly-added entries to be reused before they are evicted.
+      protected_bytes_limit_(limits.total_bytes_limit -
+                             limits.total_bytes_limit / 5),
       strong_references_(1),
       weak_references_(1) {
-  Initialize(LruListAccessor{}, &eviction_queue_);
+  lru_shards_.reset(new LruShard[num_lru_shards_]);
+  for (size_t i = 0; i < num_lru_shards_; ++i) {
+    for (auto& queue : lru_shards_[i].queues) {
+      Initialize(LruListAccessor{}, &queue.head);
+      queue.oldest_tick.store(kEmptyLruTick, std::memory_order_relaxed);
+    }
+  }
 }
 
 namespace {
@@ -110,86 +158,201 @@ inline CachePtr<Cache> AcquireCacheStrongPtr(CacheImpl* cache_impl) {
                          internal::adopt_object_ref);
 }
 
+// Updates the `oldest_tick` of the `segment` queue of `shard` after its front
+// may have changed.
+void UpdateOldestTick(CachePoolImpl::LruShard& shard,
+                      size_t segment) noexcept {
+  DebugAssertMutexHeld(&shard.mutex);
+  auto& queue = shard.queues[segment];
+  auto* head = &queue.head;
+  queue.oldest_tick.store(
+      head->next == head ? CachePoolImpl::kEmptyLruTick
+                         : static_cast<CacheEntryImpl*>(head->next)->lru_tick_,
+      std::memory_order_relaxed);
+}
+
 void UnlinkListNode(LruListNode* node) noexcept {
   Remove(LruListAccessor{}, node);
   Initialize(LruListAccessor{}, node);
 }
 
+// Removes `entry` from the eviction queue of `shard`, if it is in one.
+void RemoveFromEvictionQueue(CachePoolImpl* pool,
+                             CachePoolImpl::LruShard& shard,
+                             CacheEntryImpl* entry) noexcept {
+  DebugAssertMutexHeld(&shard.mutex);
+  if (OnlyContainsNode(LruListAccessor{}, entry)) return;
+  UnlinkListNode(entry);
+  const uint8_t segment = entry->lru_segment_.load(std::memory_order_relaxed);
+  if (segment == CachePoolImpl::kProtected) {
+    pool->protected_bytes_.fetch_sub(entry->lru_protected_bytes_,
+                                     std::memory_order_relaxed);
+  }
+  UpdateOldestTick(shard, segment);
+}
+
+// Adds `entry`, which must not be in an eviction queue, to the back of the
+// `segment` queue of `shard`.
+void LinkIntoEvictionQueue(CachePoolImpl* pool, CachePoolImpl::LruShard& shard,
+                           CacheEntryImpl* entry, uint8_t segment) noexcept {
+  DebugAssertMutexHeld(&shard.mutex);
+  entry->lru_segment_.store(segment, std::memory_order_relaxed);
+  entry->lru_tick_ = pool->lru_clock_.fetch_add(1, std::memory_order_relaxed);
+  if (segment == CachePoolImpl::kProtected) {
+    entry->lru_protected_bytes_ = entry->num_bytes_;
+    pool->protected_bytes_.fetch_add(entry->lru_protected_bytes_,
+                                     std::memory_order_relaxed);
+  }
+  InsertBefore(LruListAccessor{}, &shard.queues[segment].head, entry);
+  UpdateOldestTick(shard, segment);
+}
+
 void UnregisterEntryFromPool(CacheEntryImpl* entry,
                              CachePoolImpl* pool) noexcept {
-  DebugAssertMutexHeld(&pool->lru_mutex_);
-  UnlinkListNode(entry);
+  RemoveFromEvictionQueue(pool, pool->LruShardForEntry(entry), entry);
   pool->total_bytes_.fetch_sub(entry->num_bytes_, std::memory_order_relaxed);
 }
 
+// Called when the last reference to `entry` has been released.
 void AddToEvictionQueue(CachePoolImpl* pool, CacheEntryImpl* entry) noexcept {
-  DebugAssertMutexHeld(&pool->lru_mutex_);
-  auto* eviction_queue = &pool->eviction_queue_;
-  if (!OnlyContainsNode(LruListAccessor{}, entry)) {
-    Remove(LruListAccessor{}, entry);
+  auto& shard = pool->LruShardForEntry(entry);
+  RemoveFromEvictionQueue(pool, shard, entry);
+  uint8_t segment = entry->lru_segment_.load(std::memory_order_relaxed);
+  if (segment == CachePoolImpl::kNotQueued ||
+      pool->limits_.eviction_policy == CachePoolEvictionPolicy::kLru) {
+    segment = CachePoolImpl::kProbationary;
+  } else {
+    // The entry was reused since it was first released.
+    if (segment == CachePoolImpl::kProbationary) {
+      segmented_lru_promote_count.Increment();
+    }
+    segment = CachePoolImpl::kProtected;
   }
-  InsertBefore(LruListAccessor{}, eviction_queue, entry);
+  LinkIntoEvictionQueue(pool, shard, entry, segment);
 }
 
-void MaybeEvictEntries(CachePoolImpl* pool) noexcept {
-  DebugAssertMutexHeld(&pool->lru_mutex_);
+// Returns the shard containing the least recently used entry of `segment`, or
+// `nullptr` if the `segment` queues of all shards are empty.
+CachePoolImpl::LruShard* GetOldestLruShard(CachePoolImpl* pool,
+                                           size_t segment) noexcept {
+  CachePoolImpl::LruShard* oldest_shard = nullptr;
+  uint64_t oldest_tick = CachePoolImpl::kEmptyLruTick;
+  for (size_t i = 0; i < pool->num_lru_shards_; ++i) {
+    auto& shard = pool->lru_shards_[i];
+    uint64_t tick =
+        shard.queues[segment].oldest_tick.load(std::memory_order_relaxed);
+    if (tick < oldest_tick) {
+      oldest_tick = tick;
+      oldest_shard = &shard;
+    }
+  }
+  return oldest_shard;
+}
 
+// Moves the least recently used protected entries to the probationary segment
+// until `pool->protected_bytes_` is within its limit.
+//
+// Must be called without holding any `LruShard` mutex.
+void DemoteProtectedEntries(CachePoolImpl* pool) noexcept {
+  while (pool->protected_bytes_.load(std::memory_order_relaxed) >
+         pool->protected_bytes_limit_) {
+    auto* lru_shard = GetOldestLruShard(pool, CachePoolImpl::kProtected);
+    if (!lru_shard) break;
+    absl::MutexLock lru_lock(&lru_shard->mutex);
+    auto* head = &lru_shard->queues[CachePoolImpl::kProtected].head;
+    if (head->next == head) {
+      // Queue was emptied concurrently; `oldest_tick` has been updated.
+      continue;
+    }
+    auto* entry = static_cast<CacheEntryImpl*>(head->next);
+    RemoveFromEvictionQueue(pool, *lru_shard, entry);
+    LinkIntoEvictionQueue(pool, *lru_shard, entry,
+                          CachePoolImpl::kProbationary);
+    segmented_lru_demote_count.Increment();
+  }
+}
+
+// Evicts entries until `pool->total_bytes_` is within the limit.
+//
+// Must be called without holding any `LruShard` mutex.
+void MaybeEvictEntries(CachePoolImpl* pool) noexcept {
   std::array<CacheEntryImpl*, 64> entries_to_delete;
   size_t num_entries_to_delete = 0;
 
   const auto destroy_entries = [&] {
-    internal::ScopedWriterUnlock unlock(pool->lru_mutex_);
     for (size_t i = 0; i < num_entries_to_delete; ++i) {
       auto* entry = entries_to_delete[i];
-      // Hold a reference to `cache` before releasing the lru_mutex to ensure
-      // `cache` is not destroyed.
+      // Hold a reference to `cache` while deleting the entry to ensure `cache`
+      // is not destroyed.
       //
       // FIXME(jbms): Determine why this is necessary.
       CachePtr<Cache> cache = AcquireCacheStrongPtr(entry->cache_);
       delete Access::StaticCast<CacheEntry>(entry);
-      // Remove reference to cache while lru_mutex is unlocked.  This may cause
-      // the cache to be destroyed.
+      // Remove reference to cache while no `LruShard` mutex is held.  This may
+      // cause the cache to be destroyed.
       cache.reset();
     }
+    num_entries_to_delete = 0;
   };
 
+  const bool segmented =
+      pool->limits_.eviction_policy == CachePoolEvictionPolicy::kSegmentedLru;
+  if (segmented) DemoteProtectedEntries(pool);
+
   while (pool->total_bytes_.load(std::memory_order_acquire) >
          pool->limits_.total_bytes_limit) {
-    auto* queue = &pool->eviction_queue_;
-    if (queue->next == queue) {
-      // Queue empty.
-      break;
+    // Evict from the probationary segment first.
+    CachePoolImpl::LruShard* lru_shard = nullptr;
+    size_t segment = 0;
+    for (; segment < CachePoolImpl::kNumLruSegments; ++segment) {
+      if ((lru_shard = GetOldestLruShard(pool, segment))) break;
     }
-    auto* entry = static_cast<CacheEntryImpl*>(queue->next);
-    auto* cache = entry->cache_;
-    bool evict = false;
-    auto& shard = cache->ShardForKey(entry->key_);
-    if (absl::MutexLock lock(&shard.mutex);
-        entry->reference_count_.load(std::memory_order_acquire) == 0) {
-      [[maybe_unused]] size_t erase_count = shard.entries.erase(entry);
-      assert(erase_count == 1);
-      evict = true;
+    if (!lru_shard) {
+      // All queues empty.
+      break;
     }
-    if (!evict) {
-      // Entry is still in use, remove it from LRU eviction list.  For
-      // efficiency, entries aren't removed from the eviction list when the
-      // reference count increases.  It will be put back on the eviction list
-      // the next time the reference count becomes 0.  There is no race
-      // condition here because both `cache->entries_mutex_` and
-      // `pool->lru_mutex_` are held, and the reference count cannot increase
-      // from zero except while holding `cache->entries_mutex_`, and the
-      // reference count cannot decrease to zero except while holding
-      // `pool->lru_mutex_`.
-      UnlinkListNode(entry);
-      continue;
+    CacheEntryImpl* evicted_entry = nullptr;
+    {
+      absl::MutexLock lru_lock(&lru_shard->mutex);
+      auto* head = &lru_shard->queues[segment].head;
+      if (head->next == head) {
+        // Queue was emptied concurrently; `oldest_tick` has been updated.
+        continue;
+      }
+      auto* entry = static_cast<CacheEntryImpl*>(head->next);
+      auto* cache = entry->cache_;
+      auto& shard = cache->ShardForKey(entry->key_);
+      if (absl::MutexLock lock(&shard.mutex);
+          entry->reference_count_.load(std::memory_order_acquire) == 0) {
+        [[maybe_unused]] size_t erase_count = shard.entries.erase(entry);
+        assert(erase_count == 1);
+        evicted_entry = entry;
+      }
+      if (!evicted_entry) {
+        // Entry is still in use, remove it from LRU eviction list.  For
+        // efficiency, entries aren't removed from the eviction list when the
+        // reference count increases.  It will be put back on the eviction list
+        // the next time the reference count becomes 0.  There is no race
+        // condition here because both `shard.mutex` and `lru_shard->mutex` are
+        // held, and the reference count cannot increase from zero except while
+        // holding `shard.mutex`, and the reference count cannot decrease to
+        // zero except while holding `lru_shard->mutex`.
+        //
+        // The entry retains its segment, so that it is promoted when it is
+        // released again.
+        RemoveFromEvictionQueue(pool, *lru_shard, entry);
+        continue;
+      }
+      UnregisterEntryFromPool(entry, pool);
     }
-    UnregisterEntryFromPool(entry, pool);
     evict_count.Increment();
-    // Enqueue entry to be destroyed with `pool->lru_mutex_` released.
-    entries_to_delete[num_entries_to_delete++] = entry;
+    if (segmented) {
+      segmented_lru_evict_count.Increment(kLruSegmentNames[segment]);
+    }
+    // Enqueue entry to be destroyed with no `LruShard` mutex held.
+    entries_to_delete[num_entries_to_delete++] = evicted_entry;
     if (num_entries_to_delete == entries_to_delete.size()) {
       destroy_entries();
-      num_entries_to_delete = 0;
     }
   }
   destroy_entries();
@@ -199,6 +362,10 @@ void InitializeNewEntry(CacheEntryImpl* entry, CacheImpl* cache) noexcept {
   entry->cache_ = cache;
   entry->reference_count_.store(2, std::memory_order_relaxed);
   entry->num_bytes_ = 0;
+  entry->lru_tick_ = 0;
+  entry->lru_segment_.store(CachePoolImpl::kNotQueued,
+                            std::memory_order_relaxed);
+  entry->lru_protected_bytes_ = 0;
   Initialize(LruListAccessor{}, entry);
 }
 
@@ -206,7 +373,10 @@ void DestroyCache(CachePoolImpl* pool,
                   CacheImpl* cache) noexcept ABSL_NO_THREAD_SAFETY_ANALYSIS {
   if (pool) {
     if (HasLruCache(pool)) {
-      absl::MutexLock lru_lock(&pool->lru_mutex_);
+      // Entries of `cache` may be in the eviction queue of any shard.
+      for (size_t i = 0; i < pool->num_lru_shards_; ++i) {
+        pool->lru_shards_[i].mutex.Lock();
+      }
       for (auto& shard : cache->shards_) {
         absl::MutexLock lock(&shard.mutex);
         for (CacheEntryImpl* entry : shard.entries) {
@@ -218,6 +388,9 @@ void DestroyCache(CachePoolImpl* pool,
           UnregisterEntryFromPool(entry, pool);
         }
       }
+      for (size_t i = pool->num_lru_shards_; i-- > 0;) {
+        pool->lru_shards_[i].mutex.Unlock();
+      }
       // At this point, no external references to any entry are possible, and
       // the entries can safely be destroyed without holding any locks.
     } else {
@@ -327,7 +500,9 @@ void StrongPtrTraitsCacheEntry::decrement(CacheEntry* p) noexcept
     } else {
       auto lock = DecrementReferenceCountWithLock(
           entry->reference_count_,
-          [pool_impl]() -> absl::Mutex& { return pool_impl->lru_mutex_; },
+          [&]() -> absl::Mutex& {
+            return pool_impl->LruShardForEntry(entry).mutex;
+          },
           new_count,
           /*decrease_amount=*/2, /*lock_threshold=*/1);
       TENSORSTORE_INTERNAL_CACHE_DEBUG_REFCOUNT("CacheEntry:decrement", p,
@@ -335,6 +510,9 @@ void StrongPtrTraitsCacheEntry::decrement(CacheEntry* p) noexcept
       if (!lock) return;
       if (new_count == 0) {
         AddToEvictionQueue(pool_impl, entry);
+        lock.unlock();
+        // The reference to `cache` owned by `entry`, which is released below,
+        // ensures that `pool_impl` remains valid.
         MaybeEvictEntries(pool_impl);
       }
     }
@@ -405,6 +583,13 @@ PinnedCacheEntry<Cache> GetCacheEntryInternal(internal::Cache* cache,
     if (it != shard.entries.end()) {
       hit_count.Increment();
       auto* entry_impl = *it;
+      if (HasLruCache(cache_impl->pool_) &&
+          cache_impl->pool_->limits_.eviction_policy ==
+              CachePoolEvictionPolicy::kSegmentedLru) {
+        const uint8_t segment =
+            entry_impl->lru_segment_.load(std::memory_order_relaxed);
+        segmented_lru_hit_count.Increment(kLruSegmentNames[segment]);
+      }
       if (entry_impl->reference_count_.fetch_add(
               2, std::memory_order_acq_rel) <= 1) {
         // When the first strong reference to an entry is acquired, also acquire
@@ -590,7 +775,8 @@ void intrusive_ptr_decrement(CacheEntryWeakState* p)
   }
   auto pool_lock = DecrementReferenceCountWithLock(
       entry->reference_count_,
-      [pool]() -> absl::Mutex& { return pool->lru_mutex_; }, new_count,
+      [&]() -> absl::Mutex& { return pool->LruShardForEntry(entry).mutex; },
+      new_count,
       /*decrease_amount=*/1,
       /*lock_threshold=*/0);
   TENSORSTORE_INTERNAL_CACHE_DEBUG_REFCOUNT("CacheEntry:decrement", entry,
@@ -601,7 +787,13 @@ void intrusive_ptr_decrement(CacheEntryWeakState* p)
   // state if applicable.
   weak_lock = {};
   AddToEvictionQueue(pool, entry);
+  // `entry` does not own a reference to its cache, and may be evicted (and its
+  // cache destroyed) as soon as `pool_lock` is released.  Hold a weak
+  // reference to ensure `pool` remains valid.
+  AcquireWeakReference(pool);
+  pool_lock = {};
   MaybeEvictEntries(pool);
+  ReleaseWeakReference(pool);
 }
 
 internal::IntrusivePtr<CacheEntryWeakState> AcquireWeakCacheEntryReference(
@@ -648,7 +840,6 @@ void UpdateTotalBytes(CachePoolImpl& pool, ptrdiff_t change) {
       change <= 0) {
     return;
   }
-  absl::MutexLock lock(&pool.lru_mutex_);
   MaybeEvictEntries(&pool);
 }
 
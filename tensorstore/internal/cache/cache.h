@@ -108,6 +108,12 @@ class CachePool : private internal_cache::CachePoolImpl {
   /// Returns the limits of this cache pool.
   const Limits& limits() const { return limits_; }
 
+  /// Returns the total number of bytes currently accounted to entries of this
+  /// cache pool.
+  std::size_t total_bytes() const {
+    return total_bytes_.load(std::memory_order_relaxed);
+  }
+
   class WeakPtr;
 
   /// Reference-counted pointer to a cache pool that keeps in-use and recently
@@ -0,0 +1,95 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// Benchmarks contention on the cache pool when many threads acquire and
+/// release cache entries concurrently.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include "absl/strings/str_cat.h"
+#include "tensorstore/internal/cache/cache.h"
+
+namespace {
+
+using ::tensorstore::internal::Cache;
+using ::tensorstore::internal::CachePool;
+using ::tensorstore::internal::CachePtr;
+using ::tensorstore::internal::GetCache;
+using ::tensorstore::internal::GetCacheEntry;
+
+constexpr size_t kEntrySize = 1000;
+
+class BenchmarkCache : public Cache {
+ public:
+  class Entry : public Cache::Entry {
+   public:
+    using OwningCache = BenchmarkCache;
+  };
+
+  Entry* DoAllocateEntry() final { return new Entry; }
+  size_t DoGetSizeofEntry() final { return sizeof(Entry); }
+  size_t DoGetSizeInBytes(Cache::Entry* entry) final { return kEntrySize; }
+};
+
+// Shared by all threads of a benchmark run; initialized and reset by thread 0.
+CachePool::StrongPtr pool;
+CachePtr<BenchmarkCache> cache;
+std::vector<std::string> keys;
+
+// Each thread repeatedly acquires and releases entries from a key space of
+// `state.range(0)` keys, of which only a fraction `state.range(1) / 100` fit
+// within the pool's `total_bytes_limit`.  Misses allocate new entries and
+// evict old ones; hits move entries off and back onto the eviction queue.
+void BM_GetCacheEntry(benchmark::State& state) {
+  const size_t num_keys = state.range(0);
+  const size_t percent_cached = state.range(1);
+  if (state.thread_index() == 0) {
+    pool = CachePool::Make(
+        CachePool::Limits{num_keys * kEntrySize * percent_cached / 100});
+    cache = GetCache<BenchmarkCache>(
+        pool.get(), "", [] { return std::make_unique<BenchmarkCache>(); });
+    keys.resize(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) keys[i] = absl::StrCat(i);
+  }
+
+  // Cheap linear congruential generator; each thread visits keys in a
+  // different order.
+  size_t x = state.thread_index() * 7919 + 1;
+  for (auto s : state) {
+    x = x * 6364136223846793005u + 1442695040888963407u;
+    auto entry = GetCacheEntry(cache, keys[(x >> 33) % num_keys]);
+    benchmark::DoNotOptimize(entry);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) {
+    cache.reset();
+    pool = {};
+  }
+}
+
+BENCHMARK(BM_GetCacheEntry)
+    ->ArgNames({"keys", "percent_cached"})
+    ->Args({1024, 100})  // All hits once warm.
+    ->Args({1024, 50})   // Mix of hits and misses.
+    ->Args({1024, 0})    // All misses.
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+}  // namespace
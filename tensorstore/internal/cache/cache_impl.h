@@ -53,6 +53,7 @@ namespace internal_cache {
 using internal::Cache;
 using internal::CacheEntry;
 using internal::CachePool;
+using internal::CachePoolEvictionPolicy;
 using internal::CachePoolLimits;
 
 #define TENSORSTORE_INTERNAL_CACHE_DEBUG_REFCOUNT(method, p, new_count) \
@@ -119,6 +120,21 @@ class CacheEntryImpl : public internal_cache::LruListNode {
   // LRU cache state.
   size_t num_bytes_;
 
+  // Value of `CachePoolImpl::lru_clock_` when the entry was last added to the
+  // eviction queue.  Protected by the mutex of the entry's `LruShard`.
+  uint64_t lru_tick_;
+
+  // `CachePoolImpl::LruSegment` of the eviction queue to which the entry was
+  // last added, or `CachePoolImpl::kNotQueued` if its last reference has not
+  // yet been released.  Only modified while holding the mutex of the entry's
+  // `LruShard`, but may be read without it for metrics.
+  std::atomic<uint8_t> lru_segment_;
+
+  // Amount added to `CachePoolImpl::protected_bytes_` for this entry while it
+  // is in the protected eviction queue.  Protected by the mutex of the entry's
+  // `LruShard`.
+  size_t lru_protected_bytes_;
+
   // Each strong reference adds 2 to the reference count.  The least-significant
   // bit (LSB) indicates if there is at least one weak reference,
   // `weak_state_.load()->reference_count.load() > 0`.
@@ -220,14 +236,76 @@ class CachePoolImpl {
   CachePoolLimits limits_;
   std::atomic<size_t> total_bytes_;
 
-  // Protects access to `eviction_queue_`.  If `lru_mutex_` is held at the same
-  // time as `caches_mutex_`, `caches_mutex_` must be acquired first.  If
-  // `lru_mutex_` is held at the same time as `entries_mutex_`, `lru_mutex_`
-  // must be acquired first.
-  absl::Mutex lru_mutex_;
+  // Segments of the eviction queue.  With `CachePoolEvictionPolicy::kLru`,
+  // all entries are in the probationary segment.  With
+  // `CachePoolEvictionPolicy::kSegmentedLru`, an entry is admitted to the
+  // probationary segment when its last reference is first released, and moved
+  // to the protected segment when it is released again after having been
+  // reused.  Entries are evicted from the probationary segment first.  Once
+  // `protected_bytes_` exceeds `protected_bytes_limit_`, the least recently
+  // used protected entries are demoted back to the probationary segment.
+  enum LruSegment : uint8_t {
+    kProbationary = 0,
+    kProtected = 1,
+  };
+
+  constexpr static size_t kNumLruSegments = 2;
+
+  // Value of `CacheEntryImpl::lru_segment_` for an entry that has not yet
+  // been added to an eviction queue.
+  constexpr static uint8_t kNotQueued = kNumLruSegments;
+
+  // Entries that are not in use are kept in per-shard eviction queues, and the
+  // shard for an entry is determined by its address.  Releasing the last
+  // reference to an entry therefore only locks the mutex of a single shard.
+  //
+  // Each entry is stamped with a tick of the pool-wide `lru_clock_` when it is
+  // added to the eviction queue of its shard, and eviction always proceeds
+  // from the shard whose front entry has the smallest tick.  This preserves
+  // the least-recently-used eviction order of a single queue, up to races
+  // between concurrent releases and evictions.
+  struct ABSL_CACHELINE_ALIGNED LruShard {
+    // Protects access to `queues`.  If `mutex` is held at the same time as
+    // `caches_mutex_`, `caches_mutex_` must be acquired first.  If `mutex` is
+    // held at the same time as `CacheImpl::Shard::mutex`, `mutex` must be
+    // acquired first.  Multiple `LruShard` mutexes may only be held at the
+    // same time if they are acquired in order of increasing index.
+    absl::Mutex mutex;
+
+    struct Queue {
+      // next points to the front of the queue, which is the first to be
+      // evicted.
+      LruListNode head;
 
-  // next points to the front of the queue, which is the first to be evicted.
-  LruListNode eviction_queue_;
+      // `lru_tick_` of the front of the queue, or `kEmptyLruTick` if the queue
+      // is empty.  Only modified while holding `mutex`, but may be read
+      // without it to select the shard from which to evict.
+      std::atomic<uint64_t> oldest_tick;
+    };
+
+    // Indexed by `LruSegment`.
+    Queue queues[kNumLruSegments];
+  };
+
+  constexpr static uint64_t kEmptyLruTick = ~uint64_t(0);
+
+  std::unique_ptr<LruShard[]> lru_shards_;
+
+  // Number of elements of `lru_shards_`, always a power of 2.
+  size_t num_lru_shards_;
+
+  std::atomic<uint64_t> lru_clock_;
+
+  // Total `lru_protected_bytes_` of the entries in the protected eviction
+  // queues, and the limit beyond which they are demoted.  Only used with
+  // `CachePoolEvictionPolicy::kSegmentedLru`.
+  std::atomic<size_t> protected_bytes_;
+  size_t protected_bytes_limit_;
+
+  LruShard& LruShardForEntry(const CacheEntryImpl* entry) {
+    absl::Hash<const CacheEntryImpl*> h;
+    return lru_shards_[h(entry) & (num_lru_shards_ - 1)];
+  }
 
   // Protects access to `caches_`.
   absl::Mutex caches_mutex_;
@@ -20,12 +20,30 @@
 namespace tensorstore {
 namespace internal {
 
+/// Policy used to select entries of a cache pool for eviction.
+enum class CachePoolEvictionPolicy {
+  /// Evicts the least recently used entry.
+  kLru,
+
+  /// Segmented LRU: newly-added entries are admitted to a probationary
+  /// segment, and are only promoted to the protected segment once they are
+  /// used again after having been released.  Eviction proceeds from the
+  /// probationary segment first, so that data read only once, such as by a
+  /// sequential scan, does not displace frequently reused data.
+  kSegmentedLru,
+};
+
 /// Memory limit parameters for a cache pool.
 struct CachePoolLimits {
   std::size_t total_bytes_limit = 0;
+  CachePoolEvictionPolicy eviction_policy = CachePoolEvictionPolicy::kLru;
+
+  /// Maximum number of grid cells that a `ChunkCache` reads ahead of a
+  /// sequential traversal.  A value of `0` disables readahead.
+  std::size_t prefetch_cells = 0;
 
   constexpr static auto ApplyMembers = [](auto&& x, auto f) {
-    return f(x.total_bytes_limit);
+    return f(x.total_bytes_limit, x.eviction_policy, x.prefetch_cells);
   };
 };
 
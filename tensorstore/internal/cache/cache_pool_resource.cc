@@ -14,12 +14,16 @@
 
 #include "tensorstore/internal/cache/cache_pool_resource.h"
 
+#include <string_view>
+
 #include <nlohmann/json.hpp>
 #include "tensorstore/context.h"
 #include "tensorstore/context_resource_provider.h"
 #include "tensorstore/internal/cache/cache.h"
+#include "tensorstore/internal/cache/cache_pool_limits.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/util/result.h"
 
@@ -37,6 +41,20 @@ struct CachePoolResourceTraits
     return jb::Object(
         jb::Member("total_bytes_limit",
                    jb::Projection(&Spec::total_bytes_limit,
+                                  jb::DefaultValue([](auto* v) { *v = 0; }))),
+        jb::Member(
+            "eviction_policy",
+            jb::Projection(
+                &Spec::eviction_policy,
+                jb::DefaultValue(
+                    [](auto* v) { *v = CachePoolEvictionPolicy::kLru; },
+                    jb::Enum<CachePoolEvictionPolicy, std::string_view>({
+                        {CachePoolEvictionPolicy::kLru, "lru"},
+                        {CachePoolEvictionPolicy::kSegmentedLru,
+                         "segmented_lru"},
+                    })))),
+        jb::Member("prefetch_cells",
+                   jb::Projection(&Spec::prefetch_cells,
                                   jb::DefaultValue([](auto* v) { *v = 0; }))));
   }
   static Result<Resource> Create(const Spec& limits,
@@ -16,6 +16,7 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/status/status.h"
 #include <nlohmann/json.hpp>
 #include "tensorstore/context.h"
 #include "tensorstore/internal/cache/cache.h"
@@ -28,6 +29,7 @@ namespace {
 
 using ::tensorstore::Context;
 using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::CachePoolEvictionPolicy;
 using ::tensorstore::internal::CachePoolResource;
 
 TEST(CachePoolResourceTest, Default) {
@@ -50,6 +52,42 @@ TEST(CachePoolResourceTest, TotalBytesLimitOnly) {
                               {{"total_bytes_limit", 100}}));
   auto cache = Context::Default().GetResource(resource_spec).value();
   EXPECT_EQ(100u, (*cache)->limits().total_bytes_limit);
+  EXPECT_EQ(CachePoolEvictionPolicy::kLru,
+            (*cache)->limits().eviction_policy);
+}
+
+TEST(CachePoolResourceTest, SegmentedLru) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto resource_spec,
+      Context::Resource<CachePoolResource>::FromJson(
+          {{"total_bytes_limit", 100}, {"eviction_policy", "segmented_lru"}}));
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(100u, (*cache)->limits().total_bytes_limit);
+  EXPECT_EQ(CachePoolEvictionPolicy::kSegmentedLru,
+            (*cache)->limits().eviction_policy);
+  EXPECT_THAT(resource_spec.ToJson(),
+              ::testing::Optional(::nlohmann::json{
+                  {"total_bytes_limit", 100},
+                  {"eviction_policy", "segmented_lru"}}));
+}
+
+TEST(CachePoolResourceTest, PrefetchCells) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto resource_spec,
+      Context::Resource<CachePoolResource>::FromJson(
+          {{"total_bytes_limit", 100}, {"prefetch_cells", 4}}));
+  auto cache = Context::Default().GetResource(resource_spec).value();
+  EXPECT_EQ(4u, (*cache)->limits().prefetch_cells);
+  EXPECT_THAT(resource_spec.ToJson(),
+              ::testing::Optional(::nlohmann::json{{"total_bytes_limit", 100},
+                                                   {"prefetch_cells", 4}}));
+}
+
+TEST(CachePoolResourceTest, InvalidEvictionPolicy) {
+  EXPECT_THAT(Context::Resource<CachePoolResource>::FromJson(
+                  {{"eviction_policy", "fifo"}}),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            ".*\"eviction_policy\".*"));
 }
 
 }  // namespace
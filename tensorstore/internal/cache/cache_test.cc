@@ -22,11 +22,14 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/mutex.h"
@@ -37,6 +40,7 @@ namespace {
 using ::tensorstore::UniqueWriterLock;
 using ::tensorstore::internal::Cache;
 using ::tensorstore::internal::CachePool;
+using ::tensorstore::internal::CachePoolEvictionPolicy;
 using ::tensorstore::internal::CachePtr;
 using ::tensorstore::internal::GetCache;
 using ::tensorstore::internal::PinnedCacheEntry;
@@ -157,7 +161,26 @@ void AssertInvariants(const CachePool::StrongPtr& pool,
                       absl::flat_hash_set<Cache*> expected_caches)
     ABSL_NO_THREAD_SAFETY_ANALYSIS {
   auto* pool_impl = GetPoolImpl(pool);
-  auto eviction_queue_entries = GetEntrySet(&pool_impl->eviction_queue_);
+  absl::flat_hash_set<EntryIdentifier> eviction_queue_entries;
+  size_t expected_protected_bytes = 0;
+  for (size_t i = 0; i < pool_impl->num_lru_shards_; ++i) {
+    auto& lru_shard = pool_impl->lru_shards_[i];
+    for (size_t segment = 0; segment < CachePoolImpl::kNumLruSegments;
+         ++segment) {
+      for (const auto& entry : GetEntrySet(&lru_shard.queues[segment].head)) {
+        auto* entry_impl = static_cast<CacheEntryImpl*>(entry.second);
+        // Each entry must be in the queue of the shard determined by its
+        // address, and of the segment recorded in the entry.
+        EXPECT_EQ(&lru_shard, &pool_impl->LruShardForEntry(entry_impl));
+        EXPECT_EQ(segment, entry_impl->lru_segment_.load());
+        if (segment == CachePoolImpl::kProtected) {
+          expected_protected_bytes += entry_impl->lru_protected_bytes_;
+        }
+        eviction_queue_entries.insert(entry);
+      }
+    }
+  }
+  EXPECT_EQ(expected_protected_bytes, pool_impl->protected_bytes_.load());
 
   absl::flat_hash_set<EntryIdentifier> expected_eviction_queue_entries;
 
@@ -591,6 +614,105 @@ TEST_P(NamedOrAnonymousCacheTest, UpdateSizeNoEvict) {
               UnorderedElementsAre(Pair(cache_key, "a")));  // No change
 }
 
+// Tests that entries are evicted in least-recently-used order even though they
+// are distributed over multiple eviction queues.
+TEST(CacheTest, EvictLeastRecentlyUsed) {
+  constexpr size_t kNumEntries = 64;
+  constexpr size_t kEntrySize = 1000;
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = kNumEntries * kEntrySize + kEntrySize / 2;
+  auto pool = CachePool::Make(limits);
+  auto test_cache = GetTestCache(pool.get(), "cache", log);
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    GetCacheEntry(test_cache, std::to_string(i))->ChangeSize(kEntrySize);
+  }
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre());
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+
+  // Access the entries in reverse order, which makes "63" the least recently
+  // used entry.
+  for (size_t i = kNumEntries; i-- > 0;) {
+    GetCacheEntry(test_cache, std::to_string(i));
+  }
+
+  // Each new entry evicts the least recently used existing entry.
+  for (size_t i = 0; i < 4; ++i) {
+    GetCacheEntry(test_cache, absl::StrCat("new", i))->ChangeSize(kEntrySize);
+    EXPECT_THAT(log->entry_destroy_log,
+                ::testing::Contains(
+                    Pair("cache", std::to_string(kNumEntries - 1 - i))));
+    EXPECT_EQ(i + 1, log->entry_destroy_log.size());
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+}
+
+// Reuses a small set of "hot" entries, then scans through many entries that are
+// each used only once, and returns the keys of the "hot" entries that were
+// evicted.
+std::vector<std::string> GetHotEntriesEvictedByScan(
+    CachePoolEvictionPolicy eviction_policy) {
+  constexpr size_t kEntrySize = 1000;
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 10 * kEntrySize + kEntrySize / 2;
+  limits.eviction_policy = eviction_policy;
+  auto pool = CachePool::Make(limits);
+  auto test_cache = GetTestCache(pool.get(), "cache", log);
+  for (int i = 0; i < 4; ++i) {
+    GetCacheEntry(test_cache, absl::StrCat("hot", i))->ChangeSize(kEntrySize);
+  }
+  for (int i = 0; i < 4; ++i) {
+    GetCacheEntry(test_cache, absl::StrCat("hot", i));
+  }
+  for (int i = 0; i < 20; ++i) {
+    GetCacheEntry(test_cache, absl::StrCat("scan", i))->ChangeSize(kEntrySize);
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+  std::vector<std::string> evicted;
+  for (const auto& [cache_key, entry_key] : log->entry_destroy_log) {
+    if (absl::StartsWith(entry_key, "hot")) evicted.push_back(entry_key);
+  }
+  return evicted;
+}
+
+TEST(CacheTest, LruScanEvictsHotEntries) {
+  EXPECT_THAT(GetHotEntriesEvictedByScan(CachePoolEvictionPolicy::kLru),
+              UnorderedElementsAre("hot0", "hot1", "hot2", "hot3"));
+}
+
+TEST(CacheTest, SegmentedLruScanResistance) {
+  EXPECT_THAT(
+      GetHotEntriesEvictedByScan(CachePoolEvictionPolicy::kSegmentedLru),
+      ElementsAre());
+}
+
+TEST(CacheTest, SegmentedLruDemotesProtectedEntries) {
+  constexpr size_t kNumEntries = 10;
+  constexpr size_t kEntrySize = 1000;
+  auto log = std::make_shared<TestCache::RequestLog>();
+  CachePool::Limits limits;
+  limits.total_bytes_limit = kNumEntries * kEntrySize + kEntrySize / 2;
+  limits.eviction_policy = CachePoolEvictionPolicy::kSegmentedLru;
+  auto pool = CachePool::Make(limits);
+  auto test_cache = GetTestCache(pool.get(), "cache", log);
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    GetCacheEntry(test_cache, std::to_string(i))->ChangeSize(kEntrySize);
+  }
+  // Promote all entries.  Only 80% of the pool may be protected, so "0" and
+  // "1" are demoted back to the probationary segment.
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    GetCacheEntry(test_cache, std::to_string(i));
+  }
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+  EXPECT_EQ(8 * kEntrySize, GetPoolImpl(pool)->protected_bytes_.load());
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre());
+
+  GetCacheEntry(test_cache, "new")->ChangeSize(kEntrySize);
+  EXPECT_THAT(log->entry_destroy_log, ElementsAre(Pair("cache", "0")));
+  TENSORSTORE_INTERNAL_ASSERT_CACHE_INVARIANTS(pool, {test_cache.get()});
+}
+
 // Tests that having one cache hold a strong pointer to another cache does not
 // lead to a circular reference and memory leak (the actual test is done by the
 // heap leak checker or sanitizer).
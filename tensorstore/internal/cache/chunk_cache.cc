@@ -26,13 +26,17 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tensorstore/array.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/box.h"
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/chunk.h"
 #include "tensorstore/driver/chunk_receiver_utils.h"
 #include "tensorstore/index.h"
+#include "tensorstore/index_interval.h"
 #include "tensorstore/index_space/index_transform.h"
 #include "tensorstore/index_space/transformed_array.h"
 #include "tensorstore/internal/arena.h"
@@ -41,11 +45,13 @@
 #include "tensorstore/internal/cache/cache.h"
 #include "tensorstore/internal/elementwise_function.h"
 #include "tensorstore/internal/grid_partition.h"
+#include "tensorstore/internal/integer_overflow.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/memory.h"
 #include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/internal/nditerable.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/rank.h"
 #include "tensorstore/staleness_bound.h"
 #include "tensorstore/strided_layout.h"
@@ -57,6 +63,7 @@
 #include "tensorstore/util/extents.h"
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/iterate.h"
+#include "tensorstore/util/iterate_over_index_range.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
@@ -68,6 +75,15 @@ auto& num_writes = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/chunk_cache/writes", "Number of writes to ChunkCache.");
 auto& num_reads = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/cache/chunk_cache/reads", "Number of reads from ChunkCache.");
+auto& num_prefetches = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/chunk_cache/prefetch",
+    "Number of chunk reads issued by ChunkCache prefetching.");
+auto& num_prefetch_hits = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/chunk_cache/prefetch_hit",
+    "Number of prefetched chunks subsequently requested from ChunkCache.");
+auto& num_prefetch_waste = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/cache/chunk_cache/prefetch_waste",
+    "Number of prefetched chunks evicted without being requested.");
 
 namespace {
 
@@ -93,6 +109,61 @@ bool IsFullyOverwritten(ChunkCache::TransactionNode& node) {
   return true;
 }
 
+/// Returns `true` if the grid cell `grid_cell_indices` intersects the bounds of
+/// `component_spec`.
+bool IsGridCellInBounds(const ChunkGridSpecification::Component& component_spec,
+                        span<const Index> chunk_shape,
+                        span<const Index> grid_cell_indices) {
+  for (DimensionIndex grid_dim = 0; grid_dim < grid_cell_indices.size();
+       ++grid_dim) {
+    const DimensionIndex cell_dim =
+        component_spec.chunked_to_cell_dimensions[grid_dim];
+    const IndexInterval bounds = component_spec.component_bounds[cell_dim];
+    Index origin;
+    if (internal::MulOverflow(grid_cell_indices[grid_dim],
+                              chunk_shape[grid_dim], &origin) ||
+        origin >= bounds.exclusive_max() ||
+        origin + chunk_shape[grid_dim] <= bounds.inclusive_min()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Determines whether a read of the grid cells `cells` continues a sequential
+/// traversal from a previous read of the grid cells `prev`.
+///
+/// The traversal is sequential if `cells` differs from `prev` only along a
+/// single dimension, along which it advances without skipping any grid cells.
+///
+/// \param dim[out] Set to the dimension along which the traversal proceeds.
+/// \param forward[out] Set to `true` if the traversal proceeds in the
+///     direction of increasing indices.
+bool IsSequentialTraversal(BoxView<> prev, BoxView<> cells, DimensionIndex& dim,
+                           bool& forward) {
+  if (prev.rank() != cells.rank()) return false;
+  dim = -1;
+  for (DimensionIndex i = 0; i < cells.rank(); ++i) {
+    const IndexInterval p = prev[i];
+    const IndexInterval c = cells[i];
+    if (p == c) continue;
+    if (dim != -1) return false;
+    dim = i;
+    if (c.inclusive_min() >= p.inclusive_min() &&
+        c.inclusive_max() > p.inclusive_max() &&
+        c.inclusive_min() <= p.exclusive_max()) {
+      forward = true;
+    } else if (c.inclusive_max() <= p.inclusive_max() &&
+               c.inclusive_min() < p.inclusive_min() &&
+               c.exclusive_max() >= p.inclusive_min()) {
+      forward = false;
+    } else {
+      return false;
+    }
+  }
+  return dim != -1;
+}
+
 /// TensorStore Driver ReadChunk implementation for the chunk cache, for the
 /// case of a non-transactional read.
 ///
@@ -366,11 +437,21 @@ void ChunkCache::Read(
     IndexTransform<> transform, absl::Time staleness,
     AnyFlowReceiver<absl::Status, ReadChunk, IndexTransform<>> receiver) {
   assert(component_index >= 0 && component_index < grid().components.size());
+  // Remains open until the reads of all grid cells have completed.
+  internal_tracing::Span trace_span("ChunkCache::Read");
   const auto& component_spec = grid().components[component_index];
   // Shared state used while `Read` is in progress.
   using ReadOperationState = ChunkOperationState<ReadChunk>;
 
   auto state = MakeIntrusivePtr<ReadOperationState>(std::move(receiver));
+  // Bounding box of the grid cells that are read, used to detect sequential
+  // traversals if prefetching is enabled.
+  const bool prefetch = pool() && pool()->limits().prefetch_cells != 0;
+  Box<> read_cells(prefetch ? grid().grid_rank() : 0);
+  size_t num_read_cells = 0;
+  // Reads of all grid cells are combined into a single batch, which is
+  // submitted when this function returns.
+  const auto batch = Batch::New();
   auto status = PartitionIndexTransformOverRegularGrid(
       component_spec.chunked_to_cell_dimensions, grid().chunk_shape, transform,
       [&](span<const Index> grid_cell_indices,
@@ -379,9 +460,22 @@ void ChunkCache::Read(
           return absl::CancelledError("");
         }
         num_reads.Increment();
+        if (prefetch) {
+          for (DimensionIndex i = 0; i < read_cells.rank(); ++i) {
+            const auto cell_interval =
+                IndexInterval::UncheckedSized(grid_cell_indices[i], 1);
+            read_cells[i] = num_read_cells == 0
+                                ? cell_interval
+                                : Hull(read_cells[i], cell_interval);
+          }
+          ++num_read_cells;
+        }
         TENSORSTORE_ASSIGN_OR_RETURN(
             auto cell_to_source, ComposeTransforms(transform, cell_transform));
         auto entry = GetEntryForGridCell(*this, grid_cell_indices);
+        if (entry->prefetched.exchange(false, std::memory_order_relaxed)) {
+          num_prefetch_hits.Increment();
+        }
         // Arrange to call `set_value` on the receiver with a `ReadChunk`
         // corresponding to this grid cell once the read request completes
         // successfully.
@@ -391,12 +485,13 @@ void ChunkCache::Read(
         if (transaction) {
           TENSORSTORE_ASSIGN_OR_RETURN(auto node,
                                        GetTransactionNode(*entry, transaction));
-          read_future = node->IsUnconditional() ? MakeReadyFuture()
-                                                : node->Read(staleness);
+          read_future = node->IsUnconditional()
+                            ? MakeReadyFuture()
+                            : node->Read({staleness, batch});
           chunk.impl =
               ReadChunkTransactionImpl{component_index, std::move(node)};
         } else {
-          read_future = entry->Read(staleness);
+          read_future = entry->Read({staleness, batch});
           chunk.impl = ReadChunkImpl{component_index, std::move(entry)};
         }
         LinkValue(
@@ -411,6 +506,96 @@ void ChunkCache::Read(
       });
   if (!status.ok()) {
     state->SetError(std::move(status));
+    return;
+  }
+  if (num_read_cells != 0) {
+    MaybeReadAhead(component_index, read_cells, staleness);
+  }
+}
+
+void ChunkCache::Prefetch(size_t component_index, BoxView<> grid_cells,
+                          absl::Time staleness) {
+  assert(component_index >= 0 && component_index < grid().components.size());
+  assert(grid_cells.rank() == grid().grid_rank());
+  PrefetchCells(component_index, grid_cells, staleness, Batch::New(),
+                GetPrefetchCapacity(/*pending_cells=*/0));
+}
+
+size_t ChunkCache::GetPrefetchCapacity(size_t pending_cells) const {
+  auto* pool = this->pool();
+  if (!pool) return 0;
+  size_t cell_bytes = 0;
+  for (const auto& component_spec : grid().components) {
+    cell_bytes += component_spec.EstimateReadStateSizeInBytes(/*valid=*/true);
+  }
+  cell_bytes = std::max(cell_bytes, size_t(1));
+  const size_t limit_cells = pool->limits().total_bytes_limit / cell_bytes;
+  const size_t used_cells = pool->total_bytes() / cell_bytes + pending_cells;
+  return used_cells >= limit_cells ? 0 : limit_cells - used_cells;
+}
+
+size_t ChunkCache::PrefetchCells(size_t component_index, BoxView<> grid_cells,
+                                 absl::Time staleness, const Batch& batch,
+                                 size_t max_cells) {
+  const auto& component_spec = grid().components[component_index];
+  size_t num_cells = 0;
+  IterateOverIndexRange(grid_cells, [&](span<const Index> grid_cell_indices) {
+    if (num_cells == max_cells) return false;
+    if (!IsGridCellInBounds(component_spec, grid().chunk_shape,
+                            grid_cell_indices)) {
+      return true;
+    }
+    ++num_cells;
+    auto entry = GetEntryForGridCell(*this, grid_cell_indices);
+    {
+      // Skip grid cells for which the cached data already satisfies
+      // `staleness`.
+      const absl::Time existing_time =
+          AsyncCache::ReadLock<ReadData>(*entry).stamp().time;
+      if (existing_time != absl::InfinitePast() &&
+          existing_time >= staleness) {
+        return true;
+      }
+    }
+    num_prefetches.Increment();
+    entry->prefetched.store(true, std::memory_order_relaxed);
+    // The read holds a reference to the entry until it completes, after which
+    // the entry remains in the cache pool until evicted.
+    entry->Read({staleness, batch}).IgnoreFuture();
+    return true;
+  });
+  return num_cells;
+}
+
+void ChunkCache::MaybeReadAhead(size_t component_index, BoxView<> grid_cells,
+                                absl::Time staleness) {
+  DimensionIndex dim;
+  bool forward;
+  {
+    absl::MutexLock lock(&prefetch_mutex_);
+    const bool sequential =
+        IsSequentialTraversal(last_read_cells_, grid_cells, dim, forward);
+    last_read_cells_ = grid_cells;
+    if (!sequential) return;
+  }
+  size_t max_cells =
+      std::min(pool()->limits().prefetch_cells,
+               GetPrefetchCapacity(grid_cells.num_elements()));
+  // Prefetch the grid cells that follow `grid_cells` along `dim`, one
+  // hyperplane at a time, until `max_cells` grid cells have been visited or
+  // the bounds of the component are reached.
+  const auto batch = Batch::New();
+  Box<> next_cells(grid_cells);
+  next_cells[dim] = IndexInterval::UncheckedSized(
+      forward ? grid_cells[dim].exclusive_max()
+              : grid_cells[dim].inclusive_min() - 1,
+      1);
+  while (max_cells != 0) {
+    const size_t num_cells = PrefetchCells(component_index, next_cells,
+                                           staleness, batch, max_cells);
+    if (num_cells == 0) break;
+    max_cells -= num_cells;
+    next_cells.origin()[dim] += forward ? 1 : -1;
   }
 }
 
@@ -419,6 +604,7 @@ void ChunkCache::Write(
     IndexTransform<> transform,
     AnyFlowReceiver<absl::Status, WriteChunk, IndexTransform<>> receiver) {
   assert(component_index >= 0 && component_index < grid().components.size());
+  internal_tracing::Span trace_span("ChunkCache::Write");
   // In this implementation, chunks are always available for writing
   // immediately.  The entire stream of chunks is sent to the receiver before
   // this function returns.
@@ -481,6 +667,12 @@ absl::Status ChunkCache::TransactionNode::Delete() {
   return OnModified();
 }
 
+ChunkCache::Entry::~Entry() {
+  if (prefetched.load(std::memory_order_relaxed)) {
+    num_prefetch_waste.Increment();
+  }
+}
+
 Future<const void> ChunkCache::Entry::Delete(OpenTransactionPtr transaction) {
   TENSORSTORE_ASSIGN_OR_RETURN(auto node,
                                GetTransactionNode(*this, transaction));
@@ -607,5 +799,43 @@ void ChunkCache::TransactionNode::InvalidateReadState() {
   }
 }
 
+SharedOffsetArray<const void> GetCachedReadChunkArray(
+    const ReadChunk::Impl& chunk) {
+  const auto* impl = chunk.target<ReadChunkImpl>();
+  if (!impl) return {};
+  const auto& grid = GetOwningCache(*impl->entry).grid();
+  const auto& component_spec = grid.components[impl->component_index];
+  SharedArray<const void> read_array{ChunkCache::GetReadComponent(
+      AsyncCache::ReadLock<ChunkCache::ReadData>(*impl->entry).data(),
+      impl->component_index)};
+  if (!read_array.valid()) read_array = component_spec.fill_value;
+
+  StridedLayout<dynamic_rank, offset_origin> layout;
+  layout.set_rank(component_spec.rank());
+  grid.GetComponentOrigin(impl->component_index, impl->entry->cell_indices(),
+                          layout.origin());
+  std::copy(read_array.shape().begin(), read_array.shape().end(),
+            layout.shape().begin());
+  std::copy(read_array.byte_strides().begin(), read_array.byte_strides().end(),
+            layout.byte_strides().begin());
+
+  // The returned array keeps the entry pinned, in addition to the data.
+  struct PinnedData {
+    PinnedCacheEntry<ChunkCache> entry;
+    SharedArray<const void> array;
+  };
+  const void* data = read_array.data();
+  const DataType dtype = read_array.dtype();
+  std::shared_ptr<const void> pointer(
+      std::make_shared<PinnedData>(PinnedData{impl->entry,
+                                              std::move(read_array)}),
+      data);
+  const Index origin_byte_offset = layout.origin_byte_offset();
+  return SharedOffsetArray<const void>(
+      AddByteOffset(SharedElementPointer<const void>(std::move(pointer), dtype),
+                    -origin_byte_offset),
+      std::move(layout));
+}
+
 }  // namespace internal
 }  // namespace tensorstore
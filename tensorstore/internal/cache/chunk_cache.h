@@ -52,9 +52,14 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "tensorstore/array.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/box.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/driver/chunk.h"
 #include "tensorstore/index.h"
@@ -102,9 +107,16 @@ class ChunkCache : public AsyncCache {
       return GetOwningCache(*this).grid().components;
     }
 
+    ~Entry() override;
+
     Future<const void> Delete(internal::OpenTransactionPtr transaction);
 
     size_t ComputeReadDataSizeInBytes(const void* read_data) override;
+
+    /// Set when a read of this entry is issued by `Prefetch`, and cleared when
+    /// the entry is subsequently requested by `Read`.  Used to track whether
+    /// prefetched data is actually used.
+    std::atomic<bool> prefetched{false};
   };
 
   class TransactionNode : public AsyncCache::TransactionNode {
@@ -241,6 +253,44 @@ class ChunkCache : public AsyncCache {
 
   Future<const void> DeleteCell(span<const Index> grid_cell_indices,
                                 internal::OpenTransactionPtr transaction);
+
+  /// Issues reads of the grid cells in `grid_cells` that are not already
+  /// cached, without waiting for them to complete, so that a subsequent `Read`
+  /// of those cells does not have to wait for the underlying storage.
+  ///
+  /// Grid cells outside the bounds of the specified component are skipped.
+  /// The number of cells read is limited by the space remaining in the cache
+  /// pool; if the cache pool is disabled, this has no effect.
+  ///
+  /// \param component_index Component array index in the range
+  ///     `[0, grid().components.size())`, used to determine the bounds.
+  /// \param grid_cells Box of grid cell indices, of rank `grid().grid_rank()`.
+  /// \param staleness Cached data newer than `staleness` is not read again.
+  void Prefetch(size_t component_index, BoxView<> grid_cells,
+                absl::Time staleness);
+
+ private:
+  /// Returns the number of additional grid cells that may be prefetched
+  /// without exceeding the cache pool limit, given that `pending_cells` grid
+  /// cells are already being read.
+  size_t GetPrefetchCapacity(size_t pending_cells) const;
+
+  /// Issues reads of at most `max_cells` grid cells in `grid_cells`, as part
+  /// of `batch`.  Returns the number of in-bounds cells visited.
+  size_t PrefetchCells(size_t component_index, BoxView<> grid_cells,
+                       absl::Time staleness, const Batch& batch,
+                       size_t max_cells);
+
+  /// Detects a sequential traversal, given the bounding box `grid_cells` of
+  /// the grid cells requested by the current `Read`, and prefetches the grid
+  /// cells that follow.
+  void MaybeReadAhead(size_t component_index, BoxView<> grid_cells,
+                      absl::Time staleness);
+
+  absl::Mutex prefetch_mutex_;
+
+  /// Bounding box of the grid cells requested by the most recent `Read`.
+  Box<> last_read_cells_ ABSL_GUARDED_BY(prefetch_mutex_);
 };
 
 class ConcreteChunkCache : public ChunkCache {
@@ -256,6 +306,19 @@ class ConcreteChunkCache : public ChunkCache {
   Executor executor_;
 };
 
+/// Returns the cached data of a chunk received from a non-transactional
+/// `ChunkCache::Read`, without copying.
+///
+/// The returned array has the domain of the component array within the grid
+/// cell, which is the output space of `ReadChunk::transform`; if the chunk is
+/// not present, it is the fill value.  The array references the cache entry,
+/// which therefore remains in the cache for as long as the array is in use.
+///
+/// \returns An invalid array if `chunk` was not produced by a
+///     non-transactional `ChunkCache::Read`.
+SharedOffsetArray<const void> GetCachedReadChunkArray(
+    const ReadChunk::Impl& chunk);
+
 }  // namespace internal
 }  // namespace tensorstore
 
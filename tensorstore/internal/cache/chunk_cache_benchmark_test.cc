@@ -69,6 +69,7 @@ using ::tensorstore::SharedArrayView;
 using ::tensorstore::span;
 using ::tensorstore::StorageGeneration;
 using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::AsyncCacheReadRequest;
 using ::tensorstore::internal::CachePool;
 using ::tensorstore::internal::CachePtr;
 using ::tensorstore::internal::ChunkCache;
@@ -137,7 +138,7 @@ class BenchmarkCache : public ConcreteChunkCache {
   class Entry : public Base::Entry {
    public:
     using OwningCache = BenchmarkCache;
-    void DoRead(absl::Time staleness_bound) override {
+    void DoRead(AsyncCacheReadRequest request) override {
       GetOwningCache(*this).executor()([this] {
         const auto component_specs = this->component_specs();
         auto read_data = tensorstore::internal::make_shared_for_overwrite<
@@ -165,7 +166,7 @@ class BenchmarkCache : public ConcreteChunkCache {
       this->SetReadsCommitted();
       return Base::TransactionNode::DoInitialize(transaction);
     }
-    void DoRead(absl::Time staleness_bound) override {
+    void DoRead(AsyncCacheReadRequest request) override {
       ABSL_UNREACHABLE();  // COV_NF_LINE
     }
     void Commit() override {
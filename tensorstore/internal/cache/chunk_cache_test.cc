@@ -43,6 +43,7 @@
 #include "tensorstore/driver/driver.h"
 #include "tensorstore/driver/driver_handle.h"
 #include "tensorstore/driver/driver_testutil.h"
+#include "tensorstore/driver/read.h"
 #include "tensorstore/index.h"
 #include "tensorstore/index_space/dim_expression.h"
 #include "tensorstore/index_space/index_transform.h"
@@ -640,6 +641,131 @@ TEST_F(ChunkCacheTest, TwoDimensional) {
                                                   {3, 1, 2, 3, 1}})));
 }
 
+// Tests that a read covered by a single cached chunk returns a view of it.
+TEST_F(ChunkCacheTest, ReadIntoNewArrayOrView) {
+  // Dimension 0 is chunked with a size of 2.
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+  SetChunk({1}, {MakeArray<int>({5, 6})});
+  auto cache = MakeChunkCache();
+  auto read_or_view = [&](Index start, Index size) {
+    return tensorstore::internal::DriverReadIntoNewArrayOrView(
+        tensorstore::internal::TensorStoreAccess::handle(
+            (GetTensorStore(cache, absl::InfinitePast()) |
+             tensorstore::Dims(0).TranslateSizedInterval(start, size))
+                .value()),
+        {});
+  };
+
+  auto read_future = read_or_view(2, 2);
+  {
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(1));
+    r(memory_store);
+  }
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto view, read_future.result());
+  EXPECT_EQ(tensorstore::MakeOffsetArray({2}, {5, 6}), view);
+
+  // A subset of the same chunk is a view of the same data.  Since both arrays
+  // share the index space of the chunk, their base pointers are equal.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto sub_view, read_or_view(3, 1).result());
+  EXPECT_EQ(tensorstore::MakeOffsetArray({3}, {6}), sub_view);
+  EXPECT_EQ(view.data(), sub_view.data());
+
+  // A read spanning multiple chunks is copied.
+  auto copy_future = read_or_view(3, 2);
+  {
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(2));
+    r(memory_store);
+  }
+  EXPECT_THAT(copy_future.result(),
+              ::testing::Optional(tensorstore::MakeOffsetArray({3}, {6, 1})));
+}
+
+// Tests that reading consecutive chunks prefetches the chunks that follow.
+TEST_F(ChunkCacheTest, SequentialReadPrefetch) {
+  // Dimension 0 is chunked with a size of 2, and has bounds [0, 10).
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>({0}, {10})}});
+  CachePool::Limits limits;
+  limits.total_bytes_limit = 10000000;
+  limits.prefetch_cells = 2;
+  auto cache = MakeChunkCache({}, CachePool::Make(limits));
+  auto read_chunk = [&](Index chunk) {
+    return tensorstore::Read(
+        GetTensorStore(cache, absl::InfinitePast()) |
+        tensorstore::Dims(0).TranslateSizedInterval(chunk * 2, 2));
+  };
+
+  // The first read does not establish a traversal.
+  {
+    auto read_future = read_chunk(0);
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(0));
+    r(memory_store);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray({1, 2})));
+  }
+  EXPECT_TRUE(mock_store->read_requests.empty());
+
+  // The second read continues the traversal, and the next 2 chunks are
+  // prefetched.
+  {
+    auto read_future = read_chunk(1);
+    for (Index chunk : {1, 2, 3}) {
+      auto r = mock_store->read_requests.pop();
+      EXPECT_THAT(ParseKey(r.key), ElementsAre(chunk));
+      r(memory_store);
+    }
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray({1, 2})));
+  }
+  EXPECT_TRUE(mock_store->read_requests.empty());
+
+  // Chunk 2 is served from the cache, and only chunk 4 is prefetched since
+  // chunk 3 is already cached.
+  {
+    auto read_future = read_chunk(2);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray({1, 2})));
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(4));
+    r(memory_store);
+  }
+
+  // Prefetching stops at the bounds of the array.
+  {
+    auto read_future = read_chunk(3);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray({1, 2})));
+  }
+  {
+    auto read_future = read_chunk(4);
+    EXPECT_THAT(read_future.result(),
+                ::testing::Optional(tensorstore::MakeArray({1, 2})));
+  }
+  EXPECT_TRUE(mock_store->read_requests.empty());
+}
+
+// Tests that prefetching is limited by the space remaining in the cache pool.
+TEST_F(ChunkCacheTest, PrefetchLimitedByCachePool) {
+  grid = ChunkGridSpecification({ChunkGridSpecification::Component{
+      SharedArray<const void>(MakeArray<int>({1, 2})), Box<>(1)}});
+  CachePool::Limits limits;
+  // Space for 3 chunks of 8 bytes.
+  limits.total_bytes_limit = 24;
+  limits.prefetch_cells = 10;
+  auto cache = MakeChunkCache({}, CachePool::Make(limits));
+  cache->Prefetch(0, Box<>({5}, {10}), absl::InfinitePast());
+  for (Index chunk : {5, 6, 7}) {
+    auto r = mock_store->read_requests.pop();
+    EXPECT_THAT(ParseKey(r.key), ElementsAre(chunk));
+    r(memory_store);
+  }
+  EXPECT_TRUE(mock_store->read_requests.empty());
+}
+
 TEST_F(ChunkCacheTest, ReadRequestErrorBasic) {
   // Dimension 0 is chunked with a size of 2.
   grid = ChunkGridSpecification({ChunkGridSpecification::Component{
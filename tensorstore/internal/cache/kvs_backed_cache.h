@@ -33,6 +33,7 @@
 #include "absl/strings/cord.h"
 #include "absl/time/time.h"
 #include "tensorstore/internal/cache/async_cache.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/operations.h"
@@ -144,6 +145,7 @@ class KvsBackedCache : public Parent {
         ABSL_LOG_IF(INFO, TENSORSTORE_ASYNC_CACHE_DEBUG)
             << *entry_or_node_ << "DoDecode: " << read_result.stamp;
         KvsBackedCache_IncrementReadChangedMetric();
+        internal_tracing::Span span("KvsBackedCache::Decode");
         GetOwningEntry(*entry_or_node_)
             .DoDecode(std::move(read_result).optional_value(),
                       DecodeReceiverImpl<EntryOrNode>{
@@ -163,14 +165,19 @@ class KvsBackedCache : public Parent {
     ///
     /// If an error occurs, calls `ReadError` directly without invoking
     /// `DoDecode`.
-    void DoRead(absl::Time staleness_bound) final {
+    void DoRead(AsyncCacheReadRequest request) final {
+      // Remains open until the value has been decoded.
+      internal_tracing::Span span("KvsBackedCache::Read");
       kvstore::ReadOptions options;
-      options.staleness_bound = staleness_bound;
+      options.staleness_bound = request.staleness_bound;
+      options.batch = std::move(request.batch);
       auto read_state = AsyncCache::ReadLock<void>(*this).read_state();
       options.if_not_equal = std::move(read_state.stamp.generation);
       auto& cache = GetOwningCache(*this);
-      auto future = cache.kvstore_driver_->Read(this->GetKeyValueStoreKey(),
-                                                std::move(options));
+      auto key = this->GetKeyValueStoreKey();
+      if (span.is_recording()) span.SetAttribute("key", key);
+      auto future =
+          cache.kvstore_driver_->Read(std::move(key), std::move(options));
       execution::submit(
           std::move(future),
           ReadReceiverImpl<Entry>{this, std::move(read_state.data)});
@@ -229,10 +236,10 @@ class KvsBackedCache : public Parent {
       return absl::OkStatus();
     }
 
-    void DoRead(absl::Time staleness_bound) final {
+    void DoRead(AsyncCacheReadRequest request) final {
       auto read_state = AsyncCache::ReadLock<void>(*this).read_state();
       target_->KvsRead(
-          {std::move(read_state.stamp.generation), staleness_bound},
+          {std::move(read_state.stamp.generation), request.staleness_bound},
           typename Entry::template ReadReceiverImpl<TransactionNode>{
               this, std::move(read_state.data)});
     }
@@ -14,17 +14,175 @@
 
 #include "tensorstore/internal/compression/blosc.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include <blosc.h>
+#include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/internal/thread/thread_pool.h"
+#include "tensorstore/util/executor.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/str_cat.h"
 
 namespace tensorstore {
 namespace blosc {
+namespace {
+
+size_t GetMaxThreads() {
+  return std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+}
+
+// Returns the number of threads to use for encoding or decoding `nbytes` bytes
+// of uncompressed data.
+size_t GetNumThreads(size_t nbytes) {
+  if (nbytes < kParallelThresholdBytes) return 1;
+  return std::clamp(nbytes / kMinBytesPerThread, size_t(1), GetMaxThreads());
+}
+
+// Limits the number of threads used by all concurrent encode and decode
+// operations, in addition to the calling threads.
+//
+// Codecs are typically invoked concurrently on the threads of the
+// `data_copy_concurrency` executor, which by default are limited to the
+// hardware concurrency.  Sharing a single budget of that size, rather than
+// allowing each operation to use that many threads, bounds the total number of
+// threads even when many large buffers are processed at once.  Operations that
+// find the budget exhausted use only the calling thread.
+class ThreadBudget {
+ public:
+  // Acquires up to `n` threads, and returns the number acquired.
+  size_t Acquire(size_t n) {
+    absl::MutexLock lock(&mutex_);
+    n = std::min(n, available_);
+    available_ -= n;
+    return n;
+  }
+
+  void Release(size_t n) {
+    absl::MutexLock lock(&mutex_);
+    available_ += n;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  size_t available_ ABSL_GUARDED_BY(mutex_) = GetMaxThreads() - 1;
+};
+
+ThreadBudget& GetThreadBudget() {
+  static internal::NoDestructor<ThreadBudget> budget;
+  return *budget;
+}
+
+// Returns the executor on which the helper threads of parallel decode
+// operations run.  It uses the same shared thread pool as the
+// `data_copy_concurrency` context resource; the number of helpers is limited
+// by `GetThreadBudget()`.
+const Executor& GetDecodeExecutor() {
+  static internal::NoDestructor<Executor> executor(
+      internal::DetachedThreadPool(GetMaxThreads()));
+  return *executor;
+}
+
+// State shared by the threads of a parallel decode operation.
+//
+// The blocks of the compressed buffer are divided into tasks, which are
+// claimed both by the calling thread and by helpers submitted to the executor.
+// The calling thread only waits for tasks that have already been claimed, so
+// that decoding finishes even if no executor thread becomes available; helpers
+// that start afterwards find no remaining tasks and return without accessing
+// `input` or `output`.
+struct ParallelDecodeState {
+  const char* input;
+  char* output;
+  size_t typesize;
+  size_t items_per_task;
+  size_t num_items;
+  size_t num_tasks;
+
+  absl::Mutex mutex;
+  size_t next_task ABSL_GUARDED_BY(mutex) = 0;
+  size_t remaining_tasks ABSL_GUARDED_BY(mutex) = 0;
+  int error ABSL_GUARDED_BY(mutex) = 0;
+
+  bool done() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return remaining_tasks == 0;
+  }
+
+  // Decodes tasks until none remain unclaimed.
+  void Run() {
+    while (true) {
+      size_t task;
+      {
+        absl::MutexLock lock(&mutex);
+        if (next_task == num_tasks) return;
+        task = next_task++;
+      }
+      const size_t start = task * items_per_task;
+      const size_t nitems = std::min(items_per_task, num_items - start);
+      const int n = blosc_getitem(input, static_cast<int>(start),
+                                  static_cast<int>(nitems),
+                                  output + start * typesize);
+      absl::MutexLock lock(&mutex);
+      if (n < 0 && error == 0) error = n;
+      --remaining_tasks;
+    }
+  }
+};
+
+// Decodes `input` into `output`, which must have the decoded size.  Returns
+// the number of bytes decoded, or a blosc error code that is `<= 0`.
+int DecodeBlocks(std::string_view input, std::string& output) {
+  const size_t num_threads = GetNumThreads(output.size());
+  size_t typesize, nbytes, cbytes, blocksize;
+  int flags;
+  blosc_cbuffer_metainfo(input.data(), &typesize, &flags);
+  blosc_cbuffer_sizes(input.data(), &nbytes, &cbytes, &blocksize);
+  // Uncompressed buffers are just copied, and `blosc_getitem` can only
+  // address whole elements.
+  if (num_threads == 1 || (flags & BLOSC_MEMCPYED) || typesize == 0 ||
+      blocksize == 0 || blocksize % typesize != 0 || nbytes % typesize != 0) {
+    return blosc_decompress_ctx(input.data(), output.data(), output.size(),
+                                /*numinternalthreads=*/1);
+  }
+  // Use several tasks per thread to balance the load.
+  const size_t num_blocks = (nbytes + blocksize - 1) / blocksize;
+  const size_t blocks_per_task =
+      std::max(size_t(1), num_blocks / (num_threads * 4));
+  auto state = std::make_shared<ParallelDecodeState>();
+  state->input = input.data();
+  state->output = output.data();
+  state->typesize = typesize;
+  state->items_per_task = blocks_per_task * blocksize / typesize;
+  state->num_items = nbytes / typesize;
+  state->num_tasks = (num_blocks + blocks_per_task - 1) / blocks_per_task;
+  {
+    absl::MutexLock lock(&state->mutex);
+    state->remaining_tasks = state->num_tasks;
+  }
+  const size_t num_helpers = GetThreadBudget().Acquire(
+      std::min(num_threads, state->num_tasks) - 1);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    GetDecodeExecutor()([state] {
+      state->Run();
+      GetThreadBudget().Release(1);
+    });
+  }
+  state->Run();
+  state->mutex.LockWhen(
+      absl::Condition(state.get(), &ParallelDecodeState::done));
+  const int error = state->error;
+  state->mutex.Unlock();
+  return error < 0 ? error : static_cast<int>(nbytes);
+}
+
+}  // namespace
 
 Result<std::string> Encode(std::string_view input, const Options& options) {
   if (input.size() > BLOSC_MAX_BUFFERSIZE) {
@@ -37,10 +195,14 @@ Result<std::string> Encode(std::string_view input, const Options& options) {
   if (shuffle == -1) {
     shuffle = options.element_size == 1 ? BLOSC_BITSHUFFLE : BLOSC_SHUFFLE;
   }
+  // Blosc starts the additional threads itself.
+  const size_t extra_threads =
+      GetThreadBudget().Acquire(GetNumThreads(input.size()) - 1);
   const int n = blosc_compress_ctx(
       options.clevel, shuffle, options.element_size, input.size(), input.data(),
       output.data(), output.size(), options.compressor, options.blocksize,
-      /*numinternalthreads=*/1);
+      /*numinternalthreads=*/static_cast<int>(1 + extra_threads));
+  GetThreadBudget().Release(extra_threads);
   if (n < 0) {
     return absl::InternalError(
         tensorstore::StrCat("Internal blosc error: ", n));
@@ -56,9 +218,7 @@ Result<std::string> Decode(std::string_view input) {
   }
   std::string output(nbytes, '\0');
   if (nbytes > 0) {
-    const int n =
-        blosc_decompress_ctx(input.data(), output.data(), output.size(),
-                             /*numinternalthreads=*/1);
+    const int n = DecodeBlocks(input, output);
     if (n <= 0) {
       return absl::InvalidArgumentError(
           tensorstore::StrCat("Blosc error: ", n));
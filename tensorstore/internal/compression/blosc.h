@@ -57,8 +57,23 @@ struct Options {
   std::size_t element_size;
 };
 
+/// Inputs of at least `kParallelThresholdBytes` bytes (uncompressed) are
+/// encoded and decoded using multiple threads, each of which processes at least
+/// `kMinBytesPerThread` bytes.
+///
+/// The threads used in addition to the calling threads are drawn from a single
+/// process-wide budget, equal to the hardware concurrency (the default limit of
+/// the `data_copy_concurrency` context resource) minus one, that is shared by
+/// all concurrent encode and decode operations.  If the budget is exhausted,
+/// only the calling thread is used.
+constexpr std::size_t kParallelThresholdBytes = 4 * 1024 * 1024;
+constexpr std::size_t kMinBytesPerThread = 1024 * 1024;
+
 /// Compresses `input`.
 ///
+/// Inputs of at least `kParallelThresholdBytes` bytes may be compressed using
+/// multiple blosc threads.
+///
 /// \param input The input data to compress.
 /// \param options Specifies compression options.
 /// \error `absl::StatusCode::kInvalidArgument` if `input.size()` exceeds
@@ -67,6 +82,10 @@ Result<std::string> Encode(std::string_view input, const Options& options);
 
 /// Decompresses `input`.
 ///
+/// If the decompressed size is at least `kParallelThresholdBytes`, the blocks
+/// of `input` may be decompressed in parallel using the shared thread pool that
+/// also backs the `data_copy_concurrency` context resource.
+///
 /// \param input The input data to decompress.
 /// \error `absl::StatusCode::kInvalidArgument` if `input` is corrupt.
 Result<std::string> Decode(std::string_view input);
@@ -17,6 +17,7 @@
 #include <cstddef>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -87,6 +88,56 @@ TEST(BloscTest, EncodeDecode) {
   }
 }
 
+// Tests encoding and decoding of inputs that are large enough to be processed
+// by multiple threads.
+TEST(BloscTest, EncodeDecodeParallel) {
+  std::string array(2 * blosc::kParallelThresholdBytes + 4, '\0');
+  for (size_t i = 0; i < array.size(); ++i) {
+    array[i] = static_cast<char>((i * 7) % 251 / 16);
+  }
+  for (blosc::Options options : {
+           blosc::Options{"lz4", 5, -1, 0},
+           blosc::Options{"zstd", 1, BLOSC_SHUFFLE, 0},
+           blosc::Options{"lz4", 5, BLOSC_BITSHUFFLE, 65536},
+           // Uncompressed.
+           blosc::Options{"lz4", 0, BLOSC_NOSHUFFLE, 0},
+       }) {
+    // An element size of 3 does not evenly divide the input size.
+    for (const std::size_t element_size : {1, 3, 4}) {
+      options.element_size = element_size;
+      TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto encoded,
+                                       blosc::Encode(array, options));
+      TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto decoded, blosc::Decode(encoded));
+      EXPECT_EQ(array, decoded);
+    }
+  }
+}
+
+// Tests that concurrent operations, which share a limited number of additional
+// threads, produce correct results.
+TEST(BloscTest, EncodeDecodeParallelConcurrent) {
+  std::string array(2 * blosc::kParallelThresholdBytes, '\0');
+  for (size_t i = 0; i < array.size(); ++i) {
+    array[i] = static_cast<char>((i * 7) % 251 / 16);
+  }
+  const blosc::Options options{"lz4", 5, -1, 0, 4};
+  std::vector<std::thread> threads;
+  std::vector<std::string> decoded(8);
+  for (auto& output : decoded) {
+    threads.emplace_back([&] {
+      auto encoded = blosc::Encode(array, options);
+      if (!encoded.ok()) return;
+      if (auto result = blosc::Decode(*encoded); result.ok()) {
+        output = *std::move(result);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (const auto& output : decoded) {
+    EXPECT_EQ(array, output);
+  }
+}
+
 // Tests that the compressed data has the expected blosc complib.
 TEST(BloscTest, CheckComplib) {
   const std::string_view array =
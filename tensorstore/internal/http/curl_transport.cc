@@ -51,6 +51,7 @@
 #include "tensorstore/internal/metrics/histogram.h"
 #include "tensorstore/internal/no_destructor.h"
 #include "tensorstore/internal/thread/thread.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/util/future.h"
 
 namespace tensorstore {
@@ -83,6 +84,10 @@ auto& http_response_bytes =
 auto& http_active = internal_metrics::Gauge<int64_t>::New(
     "/tensorstore/http/active", "HTTP requests considered active");
 
+auto& http_event_loop_queue_depth = internal_metrics::Gauge<int64_t, int>::New(
+    "/tensorstore/http/event_loop_queue_depth", "loop",
+    "HTTP requests assigned to each curl event loop and not yet completed");
+
 auto& http_total_time_ms =
     internal_metrics::Histogram<internal_metrics::DefaultBucketer>::New(
         "/tensorstore/http/total_time_ms", "HTTP total latency (ms)");
@@ -107,6 +112,18 @@ int32_t GetMaxHttp2ConcurrentStreams() {
   return limit.value_or(4);  // New default streams.
 }
 
+// Number of curl event loops, each with a separate thread and curl_multi
+// handle.
+size_t GetDefaultCurlEventLoops() {
+  auto limit = internal::GetEnvValue<int32_t>("TENSORSTORE_CURL_EVENT_LOOPS");
+  if (limit && (*limit <= 0 || *limit > 64)) {
+    ABSL_LOG(WARNING) << "Failed to parse TENSORSTORE_CURL_EVENT_LOOPS: "
+                      << *limit;
+    limit = std::nullopt;
+  }
+  return limit.value_or(1);
+}
+
 // Cached configuration from environment variables.
 struct CurlConfig {
   bool verbose = internal::GetEnvValue<bool>("TENSORSTORE_CURL_VERBOSE")
@@ -297,6 +314,10 @@ struct CurlRequestState {
   static size_t CurlWriteCallback(void* contents, size_t size, size_t nmemb,
                                   void* userdata) {
     auto* self = static_cast<CurlRequestState*>(userdata);
+    // Abort the transfer once the response is no longer needed, e.g. when a
+    // hedged request has completed first.  Returning a value other than the
+    // number of bytes fails the transfer with CURLE_WRITE_ERROR.
+    if (!self->promise_.result_needed()) return 0;
     auto data =
         std::string_view(static_cast<char const*>(contents), size * nmemb);
     self->response_.payload.Append(data);
@@ -341,10 +362,15 @@ struct CurlRequestState {
   }
 };
 
+// Event loop which performs requests using a single curl_multi handle on a
+// dedicated thread.
 class MultiTransportImpl {
  public:
-  explicit MultiTransportImpl(std::shared_ptr<CurlHandleFactory> factory)
-      : factory_(std::move(factory)), multi_(factory_->CreateMultiHandle()) {
+  MultiTransportImpl(std::shared_ptr<CurlHandleFactory> factory,
+                     int loop_index)
+      : factory_(std::move(factory)),
+        multi_(factory_->CreateMultiHandle()),
+        loop_index_(loop_index) {
     assert(factory_);
     // Without any option, the CURL library multiplexes up to 100 http/2 streams
     // over a single connection. In practice there's a tradeoff between
@@ -365,21 +391,36 @@ class MultiTransportImpl {
     factory_->CleanupMultiHandle(std::move(multi_));
   }
 
+  // Starts `request`, keeping `span` open until it completes.
   Future<HttpResponse> StartRequest(const HttpRequest& request,
                                     absl::Cord payload,
                                     absl::Duration request_timeout,
-                                    absl::Duration connect_timeout);
+                                    absl::Duration connect_timeout,
+                                    const internal_tracing::Span& span);
 
   void FinishRequest(std::unique_ptr<CurlRequestState> state, CURLcode code);
 
+  // Returns the number of requests started and not yet completed.
+  int64_t queue_depth() const {
+    return queue_depth_.load(std::memory_order_relaxed);
+  }
+
   // Runs the thread loop.
   void Run();
 
   int64_t AddPendingTransfers();
   int64_t RemoveCompletedTransfers();
 
+  // Called when a request that was started is completed or abandoned.
+  void DecrementQueueDepth() {
+    queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+    http_event_loop_queue_depth.Decrement(loop_index_);
+  }
+
   std::shared_ptr<CurlHandleFactory> factory_;
   CurlMulti multi_;
+  const int loop_index_;
+  std::atomic<int64_t> queue_depth_{0};
 
   absl::Mutex mutex_;
   std::vector<std::unique_ptr<CurlRequestState>> pending_requests_;
@@ -390,7 +431,8 @@ class MultiTransportImpl {
 
 Future<HttpResponse> MultiTransportImpl::StartRequest(
     const HttpRequest& request, absl::Cord payload,
-    absl::Duration request_timeout, absl::Duration connect_timeout) {
+    absl::Duration request_timeout, absl::Duration connect_timeout,
+    const internal_tracing::Span& span) {
   assert(factory_);
   auto state = std::make_unique<CurlRequestState>(factory_);
   state->Prepare(request, std::move(payload), request_timeout, connect_timeout);
@@ -398,10 +440,15 @@ Future<HttpResponse> MultiTransportImpl::StartRequest(
 
   auto pair = PromiseFuturePair<HttpResponse>::Make();
   state->promise_ = std::move(pair.promise);
+  // The request is completed by the event loop thread, so the span must be
+  // extended before the state is handed to it.
+  span.ExtendUntilReady(state->promise_);
 
   // Add the handle to the curl_multi state.
   // TODO: Add an ExecuteWhenNotNeeded callback which removes
   // the handle from the pending / active requests set.
+  queue_depth_.fetch_add(1, std::memory_order_relaxed);
+  http_event_loop_queue_depth.Increment(loop_index_);
   {
     absl::MutexLock l(&mutex_);
     pending_requests_.push_back(std::move(state));
@@ -441,9 +488,10 @@ void MultiTransportImpl::FinishRequest(std::unique_ptr<CurlRequestState> state,
 
   if (code != CURLE_OK) {
     /// Transfer failed; set the status
-    ABSL_LOG(WARNING) << "Error [" << code << "]=" << curl_easy_strerror(code)
-                      << " in curl operation\n"
-                      << state->error_buffer_;
+    ABSL_LOG_IF(WARNING, state->promise_.result_needed())
+        << "Error [" << code << "]=" << curl_easy_strerror(code)
+        << " in curl operation\n"
+        << state->error_buffer_;
     state->promise_.SetResult(CurlCodeToStatus(code, state->error_buffer_));
     return;
   }
@@ -457,17 +505,19 @@ void MultiTransportImpl::Run() {
   // track active count separate from the curl_multi so it's available without
   // calling curl_multi_perform or similar.
   int64_t active_count = 0;
+  // Contribution of this loop to `http_active`, which is shared by all loops.
+  int running_handles = 0;
   for (;;) {
     // Add any pending transfers.
     active_count += AddPendingTransfers();
 
     // Perform work.
     {
-      int running_handles = 0;
       CURLMcode mcode;
       do {
+        const int prior_running_handles = running_handles;
         mcode = curl_multi_perform(multi_.get(), &running_handles);
-        http_active.Set(running_handles);
+        http_active.IncrementBy(running_handles - prior_running_handles);
       } while (mcode == CURLM_CALL_MULTI_PERFORM);
 
       if (mcode != CURLM_OK) {
@@ -506,7 +556,10 @@ int64_t MultiTransportImpl::AddPendingTransfers() {
   // Add any pending requests.
   for (auto& state : pending_requests_) {
     // This future has been cancelled before we even begin.
-    if (!state->promise_.result_needed()) continue;
+    if (!state->promise_.result_needed()) {
+      DecrementQueueDepth();
+      continue;
+    }
 
     // Set the CURLINFO_PRIVATE data to take pointer ownership.
     state->handle_.SetOption(CURLOPT_PRIVATE, state.get());
@@ -521,6 +574,7 @@ int64_t MultiTransportImpl::AddPendingTransfers() {
       // This shouldn't happen unless things have really gone pear-shaped.
       state->promise_.SetResult(
           CurlMCodeToStatus(mcode, "in curl_multi_add_handle"));
+      DecrementQueueDepth();
     }
   }
 
@@ -551,6 +605,7 @@ int64_t MultiTransportImpl::RemoveCompletedTransfers() {
       state->handle_.SetOption(CURLOPT_PRIVATE, nullptr);
 
       FinishRequest(std::move(state), result);
+      DecrementQueueDepth();
     }
   } while (m != nullptr);
 
@@ -559,13 +614,56 @@ int64_t MultiTransportImpl::RemoveCompletedTransfers() {
 
 }  // namespace
 
-class CurlTransport::Impl : public MultiTransportImpl {
+class CurlTransport::Impl {
  public:
-  using MultiTransportImpl::MultiTransportImpl;
+  Impl(std::shared_ptr<CurlHandleFactory> factory, size_t num_event_loops) {
+    assert(num_event_loops > 0);
+    loops_.reserve(num_event_loops);
+    for (size_t i = 0; i < num_event_loops; ++i) {
+      loops_.push_back(
+          std::make_unique<MultiTransportImpl>(factory, static_cast<int>(i)));
+    }
+  }
+
+  Future<HttpResponse> StartRequest(const HttpRequest& request,
+                                    absl::Cord payload,
+                                    absl::Duration request_timeout,
+                                    absl::Duration connect_timeout,
+                                    const internal_tracing::Span& span) {
+    return SelectLoop().StartRequest(request, std::move(payload),
+                                     request_timeout, connect_timeout, span);
+  }
+
+ private:
+  // Returns the loop with the fewest outstanding requests.  Ties are broken in
+  // round-robin order, such that idle loops are used evenly.
+  MultiTransportImpl& SelectLoop() {
+    const size_t num_loops = loops_.size();
+    if (num_loops == 1) return *loops_[0];
+    const size_t start =
+        next_loop_.fetch_add(1, std::memory_order_relaxed) % num_loops;
+    size_t best = start;
+    int64_t best_depth = loops_[start]->queue_depth();
+    for (size_t i = 1; i < num_loops && best_depth > 0; ++i) {
+      const size_t loop_i = (start + i) % num_loops;
+      const int64_t depth = loops_[loop_i]->queue_depth();
+      if (depth < best_depth) {
+        best = loop_i;
+        best_depth = depth;
+      }
+    }
+    return *loops_[best];
+  }
+
+  std::vector<std::unique_ptr<MultiTransportImpl>> loops_;
+  std::atomic<size_t> next_loop_{0};
 };
 
-CurlTransport::CurlTransport(std::shared_ptr<CurlHandleFactory> factory)
-    : impl_(std::make_unique<Impl>(std::move(factory))) {}
+CurlTransport::CurlTransport(std::shared_ptr<CurlHandleFactory> factory,
+                             size_t num_event_loops)
+    : impl_(std::make_unique<Impl>(
+          std::move(factory),
+          num_event_loops ? num_event_loops : GetDefaultCurlEventLoops())) {}
 
 CurlTransport::~CurlTransport() = default;
 
@@ -573,8 +671,14 @@ Future<HttpResponse> CurlTransport::IssueRequest(
     const HttpRequest& request, absl::Cord payload,
     absl::Duration request_timeout, absl::Duration connect_timeout) {
   assert(impl_);
+  internal_tracing::Span span("CurlTransport::IssueRequest");
+  if (span.is_recording()) {
+    span.SetAttribute("method", request.method);
+    span.SetAttribute("url", request.url);
+    span.SetAttribute("payload_bytes", static_cast<int64_t>(payload.size()));
+  }
   return impl_->StartRequest(request, std::move(payload), request_timeout,
-                             connect_timeout);
+                             connect_timeout, span);
 }
 
 namespace {
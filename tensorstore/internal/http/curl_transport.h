@@ -15,6 +15,8 @@
 #ifndef TENSORSTORE_INTERNAL_HTTP_CURL_TRANSPORT_H_
 #define TENSORSTORE_INTERNAL_HTTP_CURL_TRANSPORT_H_
 
+#include <stddef.h>
+
 #include <memory>
 
 #include "absl/time/time.h"
@@ -33,9 +35,20 @@ void InitializeCurlHandle(CURL* handle);
 
 /// Implementation of HttpTransport which uses libcurl via the curl_multi
 /// interface.
+///
+/// Requests are performed by one or more event loops, each with a separate
+/// thread and curl_multi handle.  Each request is assigned to the loop with the
+/// fewest outstanding requests.
 class CurlTransport : public HttpTransport {
  public:
-  explicit CurlTransport(std::shared_ptr<CurlHandleFactory> factory);
+  /// Constructs a transport.
+  ///
+  /// \param factory Factory used to create curl handles.
+  /// \param num_event_loops Number of event loops.  If `0`, the number is
+  ///     specified by the `TENSORSTORE_CURL_EVENT_LOOPS` environment variable,
+  ///     and defaults to `1`.
+  explicit CurlTransport(std::shared_ptr<CurlHandleFactory> factory,
+                         size_t num_event_loops = 0);
 
   ~CurlTransport() override;
 
@@ -20,18 +20,29 @@
 
 #include "tensorstore/internal/http/curl_transport.h"
 
+#include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/log/absl_check.h"
 #include "absl/log/absl_log.h"
 #include "absl/strings/str_cat.h"
+#include "tensorstore/internal/http/curl_factory.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/http/http_transport.h"
 #include "tensorstore/internal/http/transport_test_utils.h"
 #include "tensorstore/internal/thread/thread.h"
+#include "tensorstore/util/future.h"
 
+using ::tensorstore::internal_http::CurlTransport;
+using ::tensorstore::internal_http::GetDefaultCurlHandleFactory;
 using ::tensorstore::internal_http::HttpRequestBuilder;
+using ::tensorstore::internal_http::HttpResponse;
+using ::tensorstore::internal_http::HttpTransport;
 using ::tensorstore::transport_test_utils::AcceptNonBlocking;
 using ::tensorstore::transport_test_utils::AssertSend;
 using ::tensorstore::transport_test_utils::CloseSocket;
@@ -207,4 +218,53 @@ TEST_F(CurlTransportTest, Http1Resend) {
   }
 }
 
+// Tests that requests complete when they are spread across multiple event
+// loops.
+TEST_F(CurlTransportTest, MultipleEventLoops) {
+  std::shared_ptr<HttpTransport> transport = std::make_shared<CurlTransport>(
+      GetDefaultCurlHandleFactory(), /*num_event_loops=*/3);
+
+  auto socket = CreateBoundSocket();
+  ABSL_CHECK(socket.has_value());
+
+  auto hostport = FormatSocketAddress(*socket);
+  ABSL_CHECK(!hostport.empty());
+
+  static constexpr char kResponse[] =  //
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/html\r\n"
+      "Connection: close\r\n"
+      "\r\n"
+      "Hello";
+
+  constexpr int kNumRequests = 4;
+  tensorstore::internal::Thread serve_thread({"serve_thread"}, [&] {
+    for (int i = 0; i < kNumRequests; ++i) {
+      auto client_fd = AcceptNonBlocking(*socket);
+      ABSL_CHECK(client_fd.has_value());
+      std::string request;
+      while (request.empty()) {
+        request = ReceiveAvailable(*client_fd);
+      }
+      AssertSend(*client_fd, kResponse);
+      CloseSocket(*client_fd);
+    }
+  });
+
+  std::vector<tensorstore::Future<HttpResponse>> futures;
+  for (int i = 0; i < kNumRequests; ++i) {
+    futures.push_back(transport->IssueRequest(
+        HttpRequestBuilder("GET", absl::StrCat("http://", hostport, "/"))
+            .BuildRequest(),
+        absl::Cord()));
+  }
+  for (auto& future : futures) {
+    EXPECT_EQ(200, future.value().status_code);
+    EXPECT_EQ("Hello", future.value().payload);
+  }
+
+  serve_thread.Join();
+  CloseSocket(*socket);
+}
+
 }  // namespace
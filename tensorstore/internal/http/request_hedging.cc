@@ -0,0 +1,205 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/http/request_hedging.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/http/http_request.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/rate_limiter/rate_limiter.h"
+#include "tensorstore/internal/thread/schedule_at.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+using ::tensorstore::internal::IntrusivePtr;
+
+namespace tensorstore {
+namespace internal_http {
+namespace {
+
+auto& hedged_requests = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/http/hedged_requests", "Number of hedged requests issued");
+
+auto& hedged_requests_won = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/http/hedged_requests_won",
+    "Number of hedged requests which completed before the original request");
+
+/// State of a request issued by `IssueHedgedRequest`.
+///
+/// The `RateLimiterNode` is used to admit the hedged request; the slot is
+/// released once the state is destroyed.
+struct HedgedRequestState
+    : public internal::RateLimiterNode,
+      public internal::AtomicReferenceCount<HedgedRequestState> {
+  std::shared_ptr<RequestHedger> hedger;
+  std::shared_ptr<HttpTransport> transport;
+  std::shared_ptr<internal::RateLimiter> admission_queue;
+  HttpRequest request;
+  Promise<HttpResponse> promise;
+  bool hedge_admitted = false;
+
+  absl::Mutex mutex;
+  bool done ABSL_GUARDED_BY(mutex) = false;
+  // Registrations of the callbacks for the original and the hedged request.
+  FutureCallbackRegistration registrations[2] ABSL_GUARDED_BY(mutex);
+
+  ~HedgedRequestState() {
+    if (hedge_admitted) admission_queue->Finish(this);
+  }
+
+  void Issue(bool hedge) {
+    const absl::Time start_time = absl::Now();
+    auto registration =
+        transport->IssueRequest(request, {})
+            .ExecuteWhenReady([self = IntrusivePtr<HedgedRequestState>(this),
+                               hedge, start_time](
+                                  ReadyFuture<HttpResponse> response) {
+              self->OnResponse(hedge, start_time, response.result());
+            });
+    absl::MutexLock lock(&mutex);
+    if (done) {
+      // Dropping the last reference to the request cancels it.
+      registration.UnregisterNonBlocking();
+      return;
+    }
+    registrations[hedge] = std::move(registration);
+  }
+
+  // Unregisters the callbacks of any outstanding requests.
+  void CancelAll() {
+    FutureCallbackRegistration to_cancel[2];
+    {
+      absl::MutexLock lock(&mutex);
+      done = true;
+      std::swap(to_cancel, registrations);
+    }
+    for (auto& registration : to_cancel) {
+      registration.UnregisterNonBlocking();
+    }
+  }
+
+  void MaybeHedge() {
+    if (!promise.result_needed()) return;
+    intrusive_ptr_increment(this);  // adopted by HedgedRequestState::Admit.
+    admission_queue->Admit(this, &HedgedRequestState::Admit);
+  }
+
+  static void Admit(void* node) {
+    IntrusivePtr<HedgedRequestState> self(
+        reinterpret_cast<HedgedRequestState*>(node),
+        internal::adopt_object_ref);
+    self->hedge_admitted = true;
+    if (!self->promise.result_needed()) return;
+    hedged_requests.Increment();
+    self->Issue(/*hedge=*/true);
+  }
+
+  void OnResponse(bool hedge, absl::Time start_time,
+                  const Result<HttpResponse>& response) {
+    if (response.ok()) {
+      hedger->RecordLatency(absl::Now() - start_time);
+    }
+    if (promise.SetResult(response)) {
+      if (hedge) hedged_requests_won.Increment();
+      CancelAll();
+    }
+  }
+};
+
+}  // namespace
+
+RequestHedger::RequestHedger(RequestHedgingOptions options)
+    : options_(std::move(options)) {
+  latencies_.reserve(kMaxLatencySamples);
+}
+
+void RequestHedger::RecordLatency(absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  if (latencies_.size() < kMaxLatencySamples) {
+    latencies_.push_back(latency);
+    return;
+  }
+  latencies_[next_latency_] = latency;
+  next_latency_ = (next_latency_ + 1) % kMaxLatencySamples;
+}
+
+std::optional<absl::Duration> RequestHedger::GetHedgeDelay() {
+  std::vector<absl::Duration> latencies;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (latencies_.size() < kMinLatencySamples) return std::nullopt;
+    latencies = latencies_;
+  }
+  const size_t n = std::min(
+      latencies.size() - 1,
+      static_cast<size_t>(std::ceil(options_.percentile * latencies.size())) -
+          1);
+  std::nth_element(latencies.begin(), latencies.begin() + n, latencies.end());
+  return std::max(options_.min_delay, latencies[n]);
+}
+
+Future<HttpResponse> IssueHedgedRequest(
+    std::shared_ptr<RequestHedger> hedger,
+    std::shared_ptr<HttpTransport> transport, HttpRequest request,
+    std::shared_ptr<internal::RateLimiter> admission_queue) {
+  auto delay = hedger->GetHedgeDelay();
+  if (!delay) {
+    // Too few latencies are known to decide when to hedge; issue the request
+    // directly, but still record its latency.
+    const absl::Time start_time = absl::Now();
+    auto future = transport->IssueRequest(request, {});
+    future.ExecuteWhenReady([hedger = std::move(hedger), start_time](
+                                ReadyFuture<HttpResponse> response) {
+      if (response.result().ok()) {
+        hedger->RecordLatency(absl::Now() - start_time);
+      }
+    });
+    return future;
+  }
+
+  auto [promise, future] = PromiseFuturePair<HttpResponse>::Make();
+  auto state = internal::MakeIntrusivePtr<HedgedRequestState>();
+  state->hedger = std::move(hedger);
+  state->transport = std::move(transport);
+  state->admission_queue = std::move(admission_queue);
+  state->request = std::move(request);
+  state->promise = std::move(promise);
+  // The callback is destroyed once the result is set, which releases its
+  // reference to the state.
+  state->promise.ExecuteWhenNotNeeded(
+      [state = state] { state->CancelAll(); });
+  state->Issue(/*hedge=*/false);
+  internal::ScheduleAt(absl::Now() + *delay,
+                       [state = std::move(state)] { state->MaybeHedge(); });
+  return std::move(future);
+}
+
+}  // namespace internal_http
+}  // namespace tensorstore
@@ -0,0 +1,139 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_HTTP_REQUEST_HEDGING_H_
+#define TENSORSTORE_INTERNAL_HTTP_REQUEST_HEDGING_H_
+
+/// \file
+///
+/// Hedging of idempotent HTTP requests to reduce tail latency.
+///
+/// If no response to a request has been received once the request has been
+/// outstanding for longer than a given percentile of recently observed
+/// latencies, a duplicate (hedged) request is issued, and the first response
+/// received is used.
+
+#include <stddef.h>
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/cache_key/absl_time.h"  // IWYU pragma: keep
+#include "tensorstore/internal/http/http_request.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/json_binding/absl_time.h"  // IWYU pragma: keep
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/rate_limiter/rate_limiter.h"
+#include "tensorstore/serialization/absl_time.h"  // IWYU pragma: keep
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_http {
+
+/// Specifies when hedged requests are issued.
+struct RequestHedgingOptions {
+  /// Percentile of recently observed latencies after which a hedged request is
+  /// issued, in the range `(0, 1]`.
+  double percentile = 0.95;
+
+  /// Minimum delay before a hedged request is issued.
+  absl::Duration min_delay = absl::Milliseconds(10);
+
+  constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+    return f(x.percentile, x.min_delay);
+  };
+
+  static constexpr auto JsonBinder() {
+    namespace jb = ::tensorstore::internal_json_binding;
+    return jb::Object(
+        jb::Member(
+            "percentile",
+            jb::Projection(
+                &RequestHedgingOptions::percentile,
+                jb::DefaultValue(
+                    [](auto* v) { *v = RequestHedgingOptions{}.percentile; },
+                    jb::Validate([](const auto& options, const double* x) {
+                      if (!(*x > 0 && *x <= 1)) {
+                        return absl::InvalidArgumentError(tensorstore::StrCat(
+                            "percentile must be in the range (0, 1], but "
+                            "received: ",
+                            *x));
+                      }
+                      return absl::OkStatus();
+                    })))),
+        jb::Member("min_delay",
+                   jb::Projection(&RequestHedgingOptions::min_delay,
+                                  jb::DefaultValue([](auto* v) {
+                                    *v = RequestHedgingOptions{}.min_delay;
+                                  }))));
+  }
+};
+
+/// Tracks the latency of recent requests, and issues hedged requests based on
+/// it.
+///
+/// This class is thread-safe.
+class RequestHedger {
+ public:
+  /// Number of most recent latencies considered.
+  constexpr static size_t kMaxLatencySamples = 256;
+
+  /// Minimum number of latencies that must be recorded before requests are
+  /// hedged.
+  constexpr static size_t kMinLatencySamples = 16;
+
+  explicit RequestHedger(RequestHedgingOptions options);
+
+  const RequestHedgingOptions& options() const { return options_; }
+
+  /// Records the latency of a successful request.
+  void RecordLatency(absl::Duration latency);
+
+  /// Returns the delay after which a hedged request is issued, or
+  /// `std::nullopt` if too few latencies have been recorded.
+  std::optional<absl::Duration> GetHedgeDelay();
+
+ private:
+  const RequestHedgingOptions options_;
+
+  absl::Mutex mutex_;
+  // Ring buffer of the most recent latencies.
+  std::vector<absl::Duration> latencies_ ABSL_GUARDED_BY(mutex_);
+  size_t next_latency_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+/// Issues `request`, which must be idempotent, using `transport`.
+///
+/// If no response has been received after `hedger->GetHedgeDelay()`, issues a
+/// duplicate request once it is admitted by `admission_queue`.  The returned
+/// future becomes ready with the first response received, and the other
+/// request is cancelled.  The latency of each successful request is recorded
+/// in `hedger`.
+Future<HttpResponse> IssueHedgedRequest(
+    std::shared_ptr<RequestHedger> hedger,
+    std::shared_ptr<HttpTransport> transport, HttpRequest request,
+    std::shared_ptr<internal::RateLimiter> admission_queue);
+
+}  // namespace internal_http
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_HTTP_REQUEST_HEDGING_H_
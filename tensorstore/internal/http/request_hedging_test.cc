@@ -0,0 +1,229 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/http/request_hedging.h"
+
+#include <stddef.h>
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/http/http_request.h"
+#include "tensorstore/internal/http/http_response.h"
+#include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/rate_limiter/admission_queue.h"
+#include "tensorstore/internal/rate_limiter/rate_limiter.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace jb = ::tensorstore::internal_json_binding;
+using ::tensorstore::Future;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::Promise;
+using ::tensorstore::PromiseFuturePair;
+using ::tensorstore::internal::AdmissionQueue;
+using ::tensorstore::internal::RateLimiterNode;
+using ::tensorstore::internal_http::HttpRequest;
+using ::tensorstore::internal_http::HttpResponse;
+using ::tensorstore::internal_http::HttpTransport;
+using ::tensorstore::internal_http::IssueHedgedRequest;
+using ::tensorstore::internal_http::RequestHedger;
+using ::tensorstore::internal_http::RequestHedgingOptions;
+
+/// Transport which records requests, to be completed by the test.
+class FakeTransport : public HttpTransport {
+ public:
+  Future<HttpResponse> IssueRequest(const HttpRequest& request,
+                                    absl::Cord payload,
+                                    absl::Duration request_timeout,
+                                    absl::Duration connect_timeout) override {
+    auto [promise, future] = PromiseFuturePair<HttpResponse>::Make();
+    absl::MutexLock lock(&mutex_);
+    promises_.push_back(std::move(promise));
+    return std::move(future);
+  }
+
+  /// Waits until at least `n` requests have been issued.
+  bool WaitForRequests(size_t n, absl::Duration timeout) {
+    absl::MutexLock lock(&mutex_);
+    auto issued = [&] {
+      mutex_.AssertReaderHeld();
+      return promises_.size() >= n;
+    };
+    return mutex_.AwaitWithTimeout(absl::Condition(&issued), timeout);
+  }
+
+  size_t num_requests() {
+    absl::MutexLock lock(&mutex_);
+    return promises_.size();
+  }
+
+  Promise<HttpResponse> promise(size_t i) {
+    absl::MutexLock lock(&mutex_);
+    return promises_[i];
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<Promise<HttpResponse>> promises_;
+};
+
+HttpResponse MakeResponse(const char* payload) {
+  return HttpResponse{200, absl::Cord(payload)};
+}
+
+HttpRequest MakeRequest() {
+  HttpRequest request;
+  request.method = "GET";
+  request.url = "http://localhost/a";
+  return request;
+}
+
+std::shared_ptr<RequestHedger> MakeHedger(absl::Duration min_delay) {
+  RequestHedgingOptions options;
+  options.min_delay = min_delay;
+  auto hedger = std::make_shared<RequestHedger>(options);
+  for (size_t i = 0; i < RequestHedger::kMinLatencySamples; ++i) {
+    hedger->RecordLatency(absl::Microseconds(i));
+  }
+  return hedger;
+}
+
+TEST(RequestHedgerTest, HedgeDelay) {
+  RequestHedgingOptions options;
+  options.percentile = 0.5;
+  options.min_delay = absl::Milliseconds(1);
+  RequestHedger hedger(options);
+  EXPECT_EQ(std::nullopt, hedger.GetHedgeDelay());
+  for (int i = 1; i <= 100; ++i) {
+    hedger.RecordLatency(absl::Milliseconds(i));
+  }
+  EXPECT_EQ(absl::Milliseconds(50), hedger.GetHedgeDelay());
+
+  options.min_delay = absl::Seconds(1);
+  RequestHedger hedger2(options);
+  for (int i = 1; i <= 100; ++i) {
+    hedger2.RecordLatency(absl::Milliseconds(i));
+  }
+  EXPECT_EQ(absl::Seconds(1), hedger2.GetHedgeDelay());
+}
+
+TEST(RequestHedgerTest, OldLatenciesAreDiscarded) {
+  RequestHedgingOptions options;
+  options.percentile = 1;
+  options.min_delay = absl::ZeroDuration();
+  RequestHedger hedger(options);
+  hedger.RecordLatency(absl::Seconds(10));
+  for (size_t i = 0; i < RequestHedger::kMaxLatencySamples; ++i) {
+    hedger.RecordLatency(absl::Milliseconds(1));
+  }
+  EXPECT_EQ(absl::Milliseconds(1), hedger.GetHedgeDelay());
+}
+
+TEST(RequestHedgingOptionsTest, JsonBinding) {
+  EXPECT_THAT(jb::FromJson<RequestHedgingOptions>(
+                  {{"percentile", 1.5}}, RequestHedgingOptions::JsonBinder()),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            ".*percentile must be in the range .*"));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto options,
+      jb::FromJson<RequestHedgingOptions>(
+          {{"percentile", 0.9}, {"min_delay", "5ms"}},
+          RequestHedgingOptions::JsonBinder()));
+  EXPECT_EQ(0.9, options.percentile);
+  EXPECT_EQ(absl::Milliseconds(5), options.min_delay);
+}
+
+TEST(IssueHedgedRequestTest, NoHedgeWithoutLatencies) {
+  auto transport = std::make_shared<FakeTransport>();
+  auto hedger = std::make_shared<RequestHedger>(RequestHedgingOptions{});
+  auto future = IssueHedgedRequest(hedger, transport, MakeRequest(),
+                                   std::make_shared<AdmissionQueue>(0));
+  ASSERT_EQ(1, transport->num_requests());
+  transport->promise(0).SetResult(MakeResponse("a"));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto response, future.result());
+  EXPECT_EQ("a", response.payload);
+}
+
+TEST(IssueHedgedRequestTest, OriginalCompletesFirst) {
+  auto transport = std::make_shared<FakeTransport>();
+  auto future = IssueHedgedRequest(MakeHedger(absl::Hours(1)), transport,
+                                   MakeRequest(),
+                                   std::make_shared<AdmissionQueue>(0));
+  ASSERT_EQ(1, transport->num_requests());
+  transport->promise(0).SetResult(MakeResponse("a"));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto response, future.result());
+  EXPECT_EQ("a", response.payload);
+  EXPECT_EQ(1, transport->num_requests());
+}
+
+TEST(IssueHedgedRequestTest, HedgeCompletesFirst) {
+  auto transport = std::make_shared<FakeTransport>();
+  auto future = IssueHedgedRequest(MakeHedger(absl::Milliseconds(1)),
+                                   transport, MakeRequest(),
+                                   std::make_shared<AdmissionQueue>(0));
+  ASSERT_TRUE(transport->WaitForRequests(2, absl::Seconds(10)));
+  transport->promise(1).SetResult(MakeResponse("b"));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto response, future.result());
+  EXPECT_EQ("b", response.payload);
+
+  // The original request is cancelled.
+  EXPECT_FALSE(transport->promise(0).result_needed());
+}
+
+TEST(IssueHedgedRequestTest, Cancel) {
+  auto transport = std::make_shared<FakeTransport>();
+  auto future = IssueHedgedRequest(MakeHedger(absl::Milliseconds(1)),
+                                   transport, MakeRequest(),
+                                   std::make_shared<AdmissionQueue>(0));
+  ASSERT_TRUE(transport->WaitForRequests(2, absl::Seconds(10)));
+  future = {};
+  EXPECT_FALSE(transport->promise(0).result_needed());
+  EXPECT_FALSE(transport->promise(1).result_needed());
+}
+
+TEST(IssueHedgedRequestTest, AdmissionQueueLimit) {
+  auto transport = std::make_shared<FakeTransport>();
+  auto queue = std::make_shared<AdmissionQueue>(1);
+
+  // Occupy the only slot of the admission queue.
+  RateLimiterNode node;
+  queue->Admit(&node, [](void*) {});
+
+  auto future = IssueHedgedRequest(MakeHedger(absl::Milliseconds(1)),
+                                   transport, MakeRequest(), queue);
+  EXPECT_FALSE(transport->WaitForRequests(2, absl::Milliseconds(100)));
+
+  queue->Finish(&node);
+  ASSERT_TRUE(transport->WaitForRequests(2, absl::Seconds(10)));
+  transport->promise(0).SetResult(MakeResponse("a"));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto response, future.result());
+  EXPECT_EQ("a", response.payload);
+  EXPECT_FALSE(transport->promise(1).result_needed());
+}
+
+}  // namespace
@@ -0,0 +1,34 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/metrics/metrics_testutil.h"
+
+#include <stdint.h>
+
+#include <string_view>
+#include <variant>
+
+#include "tensorstore/internal/metrics/registry.h"
+
+namespace tensorstore {
+namespace internal_metrics {
+
+int64_t GetCounterValue(std::string_view name) {
+  auto metric = GetMetricRegistry().Collect(name);
+  if (!metric || metric->values.empty()) return 0;
+  return std::get<int64_t>(metric->values[0].value);
+}
+
+}  // namespace internal_metrics
+}  // namespace tensorstore
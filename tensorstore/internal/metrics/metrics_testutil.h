@@ -0,0 +1,32 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_METRICS_METRICS_TESTUTIL_H_
+#define TENSORSTORE_INTERNAL_METRICS_METRICS_TESTUTIL_H_
+
+#include <stdint.h>
+
+#include <string_view>
+
+namespace tensorstore {
+namespace internal_metrics {
+
+/// Returns the value of the `int64_t` counter metric registered under `name`
+/// in the global metric registry, or `0` if it has no value.
+int64_t GetCounterValue(std::string_view name);
+
+}  // namespace internal_metrics
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_METRICS_METRICS_TESTUTIL_H_
@@ -16,12 +16,15 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <utility>
 
 #include "absl/container/inlined_vector.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorstore/data_type.h"
 #include "tensorstore/index.h"
 #include "tensorstore/internal/arena.h"
@@ -30,6 +33,10 @@
 #include "tensorstore/internal/nditerable.h"
 #include "tensorstore/internal/nditerable_buffer_management.h"
 #include "tensorstore/internal/nditerable_util.h"
+#include "tensorstore/rank.h"
+#include "tensorstore/util/division.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/extents.h"
 #include "tensorstore/util/iterate.h"
 #include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
@@ -192,7 +199,8 @@ NDIterableCopier::NDIterableCopier(const NDIterable& input,
 NDIterableCopier::NDIterableCopier(
     const NDIterableCopyManager& iterable_copy_manager, span<const Index> shape,
     IterationConstraints constraints, Arena* arena)
-    : layout_info_(iterable_copy_manager, shape, constraints),
+    : iterable_copy_manager_(iterable_copy_manager),
+      layout_info_(iterable_copy_manager, shape, constraints),
       block_shape_(GetNDIterationBlockShape(
           iterable_copy_manager.GetWorkingMemoryBytesPerElement(
               layout_info_.layout_view()),
@@ -201,43 +209,177 @@ NDIterableCopier::NDIterableCopier(
                              {layout_info_.layout_view(), block_shape_},
                              arena) {}
 
-absl::Status NDIterableCopier::Copy() {
-  span<const Index> iteration_shape = layout_info_.iteration_shape;
-  std::fill_n(position_, iteration_shape.size(), static_cast<Index>(0));
-  if (layout_info_.empty) {
-    return absl::OkStatus();
-  }
+namespace {
+
+/// Copies the region of the iteration space of the specified `shape`, offset
+/// by `offset` along dimension `offset_dim`.
+///
+/// \param block_shape Maximum block shape supported by `copy_manager`.
+/// \param position[out] Set to one past the last position copied, relative to
+///     the start of the region.
+absl::Status CopyRegion(NDIteratorCopyManager& copy_manager,
+                        IterationBufferShape block_shape,
+                        span<const Index> shape, DimensionIndex offset_dim,
+                        Index offset, Index* position) {
+  const DimensionIndex rank = shape.size();
+  std::fill_n(position, rank, static_cast<Index>(0));
+  Index indices[kMaxRank];
   absl::Status copy_status;
-  if (Index inner_block_size = block_shape_[1];
-      inner_block_size != iteration_shape.back()) {
+  const auto copy_block = [&](IterationBufferShape copy_shape) {
+    std::copy_n(position, rank, indices);
+    indices[offset_dim] += offset;
+    return copy_manager.Copy(span<const Index>(indices, rank), copy_shape,
+                             &copy_status);
+  };
+  if (Index inner_block_size = std::min(block_shape[1], shape.back());
+      inner_block_size != shape.back()) {
     // Block shape is 1d, need to iterate over all dimensions including
     // innermost dimension.
-    assert(block_shape_[0] == 1);
+    assert(block_shape[0] == 1);
     for (Index block_size = inner_block_size; block_size;) {
-      if (!iterator_copy_manager_.Copy(
-              span<const Index>(position_, iteration_shape.size()),
-              {1, block_size}, &copy_status)) {
+      if (!copy_block({1, block_size})) {
         return GetElementCopyErrorStatus(std::move(copy_status));
       }
-      block_size = StepBufferPositionForward(iteration_shape, block_size,
-                                             inner_block_size, position_);
+      block_size = StepBufferPositionForward(shape, block_size,
+                                             inner_block_size, position);
     }
   } else {
     // Block shape is 2d, exclude innermost dimension from iteration.
-    const Index outer_block_size = block_shape_[0];
+    const Index outer_block_size = std::min(block_shape[0], shape[rank - 2]);
     for (Index block_size = outer_block_size; block_size;) {
-      if (!iterator_copy_manager_.Copy(
-              span<const Index>(position_, iteration_shape.size()),
-              {block_size, inner_block_size}, &copy_status)) {
+      if (!copy_block({block_size, inner_block_size})) {
         return GetElementCopyErrorStatus(std::move(copy_status));
       }
       block_size = StepBufferPositionForward(
-          iteration_shape.first(iteration_shape.size() - 1), block_size,
-          outer_block_size, position_);
+          shape.first(rank - 1), block_size, outer_block_size, position);
     }
   }
   return absl::OkStatus();
 }
 
+/// Maximum number of partitions into which a parallel copy is split.
+constexpr Index kMaxCopyPartitions = 64;
+
+/// State shared by the tasks of a parallel copy.
+///
+/// The iteration space is partitioned along `partition_dim`, and each task,
+/// including the calling thread, repeatedly claims the next partition until
+/// none remain.
+struct ParallelCopyState {
+  const NDIterableCopyManager* iterable_copy_manager;
+  NDIterable::IterationBufferLayoutView layout;
+  DimensionIndex partition_dim;
+  Index partition_size;
+  Index num_partitions;
+  std::atomic<Index> next_partition{0};
+  std::atomic<bool> failed{false};
+
+  absl::Mutex mutex;
+  // Number of tasks that have started and not yet finished.
+  Index num_active_tasks ABSL_GUARDED_BY(mutex) = 0;
+  // Set once the calling thread has finished, after which newly started tasks
+  // must not access `iterable_copy_manager` or `layout`.
+  bool done ABSL_GUARDED_BY(mutex) = false;
+  absl::Status status ABSL_GUARDED_BY(mutex);
+
+  void CopyPartitions(NDIteratorCopyManager& copy_manager) {
+    const span<const Index> iteration_shape = layout.iteration_shape;
+    Index shape[kMaxRank];
+    Index position[kMaxRank];
+    std::copy(iteration_shape.begin(), iteration_shape.end(), shape);
+    while (!failed.load(std::memory_order_relaxed)) {
+      const Index partition_i =
+          next_partition.fetch_add(1, std::memory_order_relaxed);
+      if (partition_i >= num_partitions) return;
+      const Index offset = partition_i * partition_size;
+      shape[partition_dim] =
+          std::min(partition_size, iteration_shape[partition_dim] - offset);
+      auto copy_status = CopyRegion(
+          copy_manager, layout.block_shape,
+          span<const Index>(shape, iteration_shape.size()), partition_dim,
+          offset, position);
+      if (!copy_status.ok()) {
+        absl::MutexLock lock(&mutex);
+        if (status.ok()) status = std::move(copy_status);
+        failed.store(true, std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+  void RunTask() {
+    {
+      absl::MutexLock lock(&mutex);
+      if (done) return;
+      ++num_active_tasks;
+    }
+    {
+      DefaultNDIterableArena arena;
+      NDIteratorCopyManager copy_manager(*iterable_copy_manager, layout,
+                                         arena);
+      CopyPartitions(copy_manager);
+    }
+    absl::MutexLock lock(&mutex);
+    --num_active_tasks;
+  }
+};
+
+}  // namespace
+
+absl::Status NDIterableCopier::Copy() {
+  span<const Index> iteration_shape = layout_info_.iteration_shape;
+  if (layout_info_.empty) {
+    std::fill_n(position_, iteration_shape.size(), static_cast<Index>(0));
+    return absl::OkStatus();
+  }
+  return CopyRegion(iterator_copy_manager_, block_shape_, iteration_shape,
+                    /*offset_dim=*/0, /*offset=*/0, position_);
+}
+
+absl::Status NDIterableCopier::Copy(const Executor& executor,
+                                    Index min_bytes_per_task) {
+  span<const Index> iteration_shape = layout_info_.iteration_shape;
+  if (layout_info_.empty || min_bytes_per_task <= 0) return Copy();
+
+  // Partition along the outermost dimension with an extent greater than 1,
+  // which is the innermost dimension if the iteration space is contiguous.
+  DimensionIndex partition_dim = 0;
+  while (partition_dim + 1 < iteration_shape.size() &&
+         iteration_shape[partition_dim] == 1) {
+    ++partition_dim;
+  }
+  const Index min_elements_per_task = CeilOfRatio(
+      min_bytes_per_task,
+      static_cast<Index>(iterable_copy_manager_.input()->dtype()->size));
+  Index num_partitions =
+      std::min({ProductOfExtents(iteration_shape) / min_elements_per_task,
+                iteration_shape[partition_dim], kMaxCopyPartitions});
+  if (num_partitions < 2) return Copy();
+
+  auto state = std::make_shared<ParallelCopyState>();
+  state->iterable_copy_manager = &iterable_copy_manager_;
+  state->layout = {layout_info_.layout_view(), block_shape_};
+  state->partition_dim = partition_dim;
+  state->partition_size =
+      CeilOfRatio(iteration_shape[partition_dim], num_partitions);
+  state->num_partitions =
+      CeilOfRatio(iteration_shape[partition_dim], state->partition_size);
+  for (Index i = 1; i < state->num_partitions; ++i) {
+    executor([state] { state->RunTask(); });
+  }
+  state->CopyPartitions(iterator_copy_manager_);
+
+  absl::MutexLock lock(&state->mutex);
+  state->done = true;
+  state->mutex.Await(absl::Condition(
+      +[](ParallelCopyState* state) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+           state->mutex) { return state->num_active_tasks == 0; },
+      state.get()));
+  TENSORSTORE_RETURN_IF_ERROR(state->status);
+  std::fill_n(position_, iteration_shape.size(), static_cast<Index>(0));
+  position_[0] = iteration_shape[0];
+  return absl::OkStatus();
+}
+
 }  // namespace internal
 }  // namespace tensorstore
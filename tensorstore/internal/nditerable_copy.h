@@ -33,6 +33,7 @@
 #include "tensorstore/internal/nditerable_buffer_management.h"
 #include "tensorstore/internal/nditerable_util.h"
 #include "tensorstore/rank.h"
+#include "tensorstore/util/executor.h"
 #include "tensorstore/util/iterate.h"
 #include "tensorstore/util/span.h"
 #include "tensorstore/util/status.h"
@@ -173,6 +174,24 @@ struct NDIterableCopier {
   /// Leaves `position()` at one past the last position copied.
   absl::Status Copy();
 
+  /// Default minimum number of bytes copied by each task when copying in
+  /// parallel.
+  constexpr static Index kDefaultMinBytesPerCopyTask = Index(4) << 20;
+
+  /// Same as above, but if at least `2 * min_bytes_per_task` bytes are copied,
+  /// partitions the iteration space and copies the partitions concurrently on
+  /// the calling thread and using `executor`.
+  ///
+  /// Each task obtains separate iterators from the `input` and `output`
+  /// iterables, which must support concurrent iteration over disjoint regions.
+  ///
+  /// Only waits for tasks that have already started, such that it is safe to
+  /// call from a task running on `executor`.
+  ///
+  /// If an error occurs, `position()` is unspecified.
+  absl::Status Copy(const Executor& executor,
+                    Index min_bytes_per_task = kDefaultMinBytesPerCopyTask);
+
   /// Returns the layout used for copying.
   const NDIterationLayoutInfo<>& layout_info() const { return layout_info_; }
 
@@ -192,6 +211,7 @@ struct NDIterableCopier {
                    span<const Index> shape, IterationConstraints constraints,
                    Arena* arena);
 
+  NDIterableCopyManager iterable_copy_manager_;
   NDIterationLayoutInfo<> layout_info_;
   IterationBufferShape block_shape_;
   Index position_[kMaxRank];
@@ -23,13 +23,17 @@
 #include "tensorstore/array.h"
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
+#include "tensorstore/index.h"
 #include "tensorstore/index_space/dim_expression.h"
 #include "tensorstore/index_space/transformed_array.h"
 #include "tensorstore/internal/arena.h"
 #include "tensorstore/internal/elementwise_function.h"
 #include "tensorstore/internal/nditerable_array.h"
 #include "tensorstore/internal/nditerable_copy.h"
+#include "tensorstore/internal/nditerable_elementwise_input_transform.h"
 #include "tensorstore/internal/nditerable_transformed_array.h"
+#include "tensorstore/internal/thread/thread_pool.h"
+#include "tensorstore/util/executor.h"
 #include "tensorstore/util/result.h"
 #include "tensorstore/util/status.h"
 
@@ -43,6 +47,10 @@
 
 namespace {
 
+using ::tensorstore::Index;
+using ::tensorstore::internal::GetArrayNDIterable;
+using ::tensorstore::internal::GetElementwiseInputTransformNDIterable;
+
 void DoCopyUnrolled(const uint8_t* TENSORSTORE_INTERNAL_RESTRICT src,
                     uint8_t* TENSORSTORE_INTERNAL_RESTRICT target,
                     int64_t inner_size, int64_t outer_size,
@@ -226,6 +234,51 @@ void DefineArgs(Bench* benchmark) {
   benchmark->Args({2000, 16});
 }
 
+// Copies a large array with data type conversion, which is representative of
+// reading a single large chunk into an array of a different data type.
+// `state.range(0)` specifies the number of threads, where `0` indicates a
+// serial copy.
+void BM_LargeCopyWithConversion(benchmark::State& state) {
+  const size_t num_threads = state.range(0);
+  constexpr Index kOuterSize = 1024;
+  constexpr Index kInnerSize = 16 * 1024;
+  auto source_array = tensorstore::AllocateArray<uint16_t>(
+      {kOuterSize, kInnerSize}, tensorstore::c_order, tensorstore::value_init);
+  auto target_array = tensorstore::AllocateArray<float>(
+      {kOuterSize, kInnerSize}, tensorstore::c_order, tensorstore::value_init);
+  auto convert = [](const uint16_t* source, float* target, void* arg) {
+    *target = *source;
+  };
+  tensorstore::internal::ElementwiseClosure<2, void*> closure =
+      tensorstore::internal::SimpleElementwiseFunction<
+          decltype(convert)(const uint16_t, float), void*>::Closure(&convert);
+  tensorstore::Executor executor;
+  if (num_threads) {
+    executor = tensorstore::internal::DetachedThreadPool(num_threads);
+  }
+  for (auto s : state) {
+    tensorstore::internal::Arena arena;
+    auto source_iterable = GetElementwiseInputTransformNDIterable(
+        {{GetArrayNDIterable(source_array, &arena)}},
+        tensorstore::dtype_v<float>, closure, &arena);
+    auto target_iterable = GetArrayNDIterable(target_array, &arena);
+    tensorstore::internal::NDIterableCopier copier(
+        *source_iterable, *target_iterable, target_array.shape(),
+        tensorstore::c_order, &arena);
+    TENSORSTORE_CHECK_OK(num_threads ? copier.Copy(executor) : copier.Copy());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          kOuterSize * kInnerSize * sizeof(float));
+}
+
+BENCHMARK(BM_LargeCopyWithConversion)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
 BENCHMARK(BM_Copy<kNDIter>)->Apply(DefineArgs);
 BENCHMARK(BM_Copy<kUnrolled>)->Apply(DefineArgs);
 BENCHMARK(BM_Copy<kSimple>)->Apply(DefineArgs);
@@ -18,10 +18,12 @@
 #include <new>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorstore/array.h"
 #include "tensorstore/contiguous_layout.h"
 #include "tensorstore/data_type.h"
@@ -37,6 +39,7 @@
 #include "tensorstore/internal/nditerable_elementwise_output_transform.h"
 #include "tensorstore/internal/nditerable_transformed_array.h"
 #include "tensorstore/internal/nditerable_util.h"
+#include "tensorstore/internal/thread/thread_pool.h"
 #include "tensorstore/rank.h"
 #include "tensorstore/util/iterate.h"
 #include "tensorstore/util/result.h"
@@ -216,4 +219,71 @@ TEST_P(MaybeUnitBlockSizeTest, InnerIndexArray) {
   EXPECT_EQ(expected, dest);
 }
 
+// Tests copying in parallel, with a small minimum task size such that the copy
+// is split into many partitions.
+TEST_P(MaybeUnitBlockSizeTest, Parallel) {
+  auto executor = tensorstore::internal::DetachedThreadPool(4);
+  for (const auto& shape : std::vector<std::vector<Index>>{
+           {1, 10000}, {100, 37}, {3, 50, 7}, {1, 1}}) {
+    SCOPED_TRACE(absl::StrCat("shape=", absl::StrJoin(shape, ",")).c_str());
+    auto source = tensorstore::AllocateArray<int>(shape);
+    auto dest = tensorstore::AllocateArray<int64_t>(
+        shape, tensorstore::c_order, tensorstore::value_init);
+    auto expected = tensorstore::AllocateArray<int64_t>(shape);
+    for (Index i = 0; i < source.num_elements(); ++i) {
+      source.data()[i] = static_cast<int>(i);
+      expected.data()[i] = 2 * i;
+    }
+    auto double_element = [](const int* source, int64_t* dest, void* arg) {
+      *dest = 2 * static_cast<int64_t>(*source);
+    };
+    tensorstore::internal::ElementwiseClosure<2, void*> closure =
+        tensorstore::internal::SimpleElementwiseFunction<
+            decltype(double_element)(const int, int64_t),
+            void*>::Closure(&double_element);
+    tensorstore::internal::Arena arena;
+    auto source_iterable = GetElementwiseInputTransformNDIterable(
+        {{GetTransformedArrayNDIterable(source, &arena).value()}},
+        dtype_v<int64_t>, closure, &arena);
+    auto dest_iterable = GetTransformedArrayNDIterable(dest, &arena).value();
+    tensorstore::internal::NDIterableCopier copier(
+        *source_iterable, *dest_iterable, dest.shape(), tensorstore::c_order,
+        &arena);
+    TENSORSTORE_ASSERT_OK(copier.Copy(executor, /*min_bytes_per_task=*/64));
+    EXPECT_EQ(expected, dest);
+  }
+}
+
+TEST(NDIterableCopyTest, ParallelError) {
+  auto executor = tensorstore::internal::DetachedThreadPool(4);
+  auto source = tensorstore::AllocateArray<int>({100, 100});
+  for (Index i = 0; i < source.num_elements(); ++i) {
+    source.data()[i] = static_cast<int>(i);
+  }
+  auto dest = tensorstore::AllocateArray<int>(source.shape());
+  auto dest_element_transform = [](const int* source, int* dest, void* arg) {
+    auto* status = static_cast<absl::Status*>(arg);
+    if (*source == 5000) {
+      *status = absl::UnknownError("5000");
+      return false;
+    }
+    *dest = *source;
+    return true;
+  };
+  tensorstore::internal::ElementwiseClosure<2, void*> dest_closure =
+      tensorstore::internal::SimpleElementwiseFunction<
+          decltype(dest_element_transform)(const int, int),
+          void*>::Closure(&dest_element_transform);
+  tensorstore::internal::Arena arena;
+  auto source_iterable = GetTransformedArrayNDIterable(source, &arena).value();
+  auto dest_iterable = GetElementwiseOutputTransformNDIterable(
+      GetTransformedArrayNDIterable(dest, &arena).value(), dtype_v<int>,
+      dest_closure, &arena);
+  tensorstore::internal::NDIterableCopier copier(
+      *source_iterable, *dest_iterable, dest.shape(), tensorstore::c_order,
+      &arena);
+  EXPECT_EQ(absl::UnknownError("5000"),
+            copier.Copy(executor, /*min_bytes_per_task=*/64));
+}
+
 }  // namespace
@@ -0,0 +1,135 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/tracing/chrome_trace_exporter.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include "absl/log/absl_log.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/env.h"
+#include "tensorstore/internal/global_initializer.h"
+#include "tensorstore/internal/os/error_code.h"
+#include "tensorstore/internal/thread/thread.h"
+#include "tensorstore/internal/tracing/tracing.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_tracing {
+
+::nlohmann::json GetChromeTraceEvent(const SpanRecord& record) {
+  ::nlohmann::json::object_t args;
+  for (const auto& [key, value] : record.attributes) {
+    std::visit([&, &key = key](const auto& v) { args[key] = v; }, value);
+  }
+  args["trace_id"] = record.trace_id;
+  args["span_id"] = record.span_id;
+  if (record.parent_span_id) {
+    args["parent_span_id"] = record.parent_span_id;
+  }
+  return {
+      {"name", record.name},
+      {"cat", "tensorstore"},
+      {"ph", "X"},
+      {"ts", absl::ToDoubleMicroseconds(record.start_time - absl::UnixEpoch())},
+      {"dur", absl::ToDoubleMicroseconds(record.end_time - record.start_time)},
+      {"pid", 1},
+      {"tid", record.thread_id},
+      {"args", std::move(args)},
+  };
+}
+
+Result<std::shared_ptr<ChromeTraceFileExporter>> ChromeTraceFileExporter::Open(
+    const std::string& path) {
+  FILE* file = fopen(path.c_str(), "w");
+  if (!file) {
+    return internal::StatusFromOsError(errno, "Failed to open trace file ",
+                                       tensorstore::QuoteString(path));
+  }
+  fputs("[\n", file);
+  return std::shared_ptr<ChromeTraceFileExporter>(
+      new ChromeTraceFileExporter(file));
+}
+
+ChromeTraceFileExporter::ChromeTraceFileExporter(FILE* file) : file_(file) {
+  writer_ = internal::Thread({"tensorstore_trace_writer"},
+                             [this] { WriteBufferedEvents(); });
+}
+
+ChromeTraceFileExporter::~ChromeTraceFileExporter() {
+  {
+    absl::MutexLock lock(&mutex_);
+    done_ = true;
+  }
+  writer_.Join();
+  fputs("\n]\n", file_);
+  fclose(file_);
+}
+
+void ChromeTraceFileExporter::Export(SpanRecord record) {
+  // Attribute values, such as keys, need not be valid UTF-8.
+  std::string event = GetChromeTraceEvent(record).dump(
+      /*indent=*/-1, /*indent_char=*/' ', /*ensure_ascii=*/false,
+      ::nlohmann::json::error_handler_t::replace);
+  absl::MutexLock lock(&mutex_);
+  if (!first_event_) buffer_.append(",\n");
+  first_event_ = false;
+  buffer_.append(event);
+}
+
+void ChromeTraceFileExporter::WriteBufferedEvents() {
+  std::string data;
+  bool done = false;
+  while (!done) {
+    {
+      absl::MutexLock lock(&mutex_);
+      auto ready = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return done_ || buffer_.size() >= kFlushThreshold;
+      };
+      mutex_.AwaitWithTimeout(absl::Condition(&ready), kFlushInterval);
+      data.swap(buffer_);
+      done = done_;
+    }
+    if (data.empty()) continue;
+    fwrite(data.data(), 1, data.size(), file_);
+    fflush(file_);
+    data.clear();
+  }
+}
+
+namespace {
+TENSORSTORE_GLOBAL_INITIALIZER {
+  auto path = internal::GetEnv("TENSORSTORE_TRACE_FILE");
+  if (!path || path->empty()) return;
+  auto exporter = ChromeTraceFileExporter::Open(*path);
+  if (!exporter.ok()) {
+    ABSL_LOG(WARNING) << exporter.status();
+    return;
+  }
+  SetTraceExporter(*std::move(exporter));
+}
+}  // namespace
+
+}  // namespace internal_tracing
+}  // namespace tensorstore
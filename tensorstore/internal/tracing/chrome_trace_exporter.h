@@ -0,0 +1,88 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_TRACING_CHROME_TRACE_EXPORTER_H_
+#define TENSORSTORE_INTERNAL_TRACING_CHROME_TRACE_EXPORTER_H_
+
+/// \file
+///
+/// Trace exporter that writes spans as Chrome trace events, viewable with
+/// chrome://tracing or https://ui.perfetto.dev.
+///
+/// If the `TENSORSTORE_TRACE_FILE` environment variable is set when a binary
+/// that links this library starts, an exporter writing to the specified file
+/// is installed automatically.
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/thread/thread.h"
+#include "tensorstore/internal/tracing/tracing.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_tracing {
+
+/// Returns the Chrome trace event ("complete" event) representing `record`.
+::nlohmann::json GetChromeTraceEvent(const SpanRecord& record);
+
+/// Writes spans to a file in the Chrome trace event JSON array format.
+///
+/// `Export` only appends the event to a buffer, which a background thread
+/// writes to the file once it exceeds `kFlushThreshold` bytes, and otherwise
+/// every `kFlushInterval`.  The file thus remains usable, apart from the most
+/// recent events, if the process exits without destroying the exporter; the
+/// trace event format permits the closing bracket of the array to be omitted.
+class ChromeTraceFileExporter : public TraceExporter {
+ public:
+  constexpr static size_t kFlushThreshold = 1 << 20;
+  constexpr static absl::Duration kFlushInterval = absl::Seconds(1);
+
+  /// Creates (or truncates) the file at `path`.
+  static Result<std::shared_ptr<ChromeTraceFileExporter>> Open(
+      const std::string& path);
+
+  /// Writes the buffered events, terminates the array and closes the file.
+  ~ChromeTraceFileExporter() override;
+
+  void Export(SpanRecord record) override;
+
+ private:
+  explicit ChromeTraceFileExporter(FILE* file);
+
+  void WriteBufferedEvents();
+
+  // Only accessed by the writer thread, and by the destructor once it has
+  // been joined.
+  FILE* const file_;
+
+  absl::Mutex mutex_;
+  std::string buffer_ ABSL_GUARDED_BY(mutex_);
+  bool first_event_ ABSL_GUARDED_BY(mutex_) = true;
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+
+  internal::Thread writer_;
+};
+
+}  // namespace internal_tracing
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_TRACING_CHROME_TRACE_EXPORTER_H_
@@ -0,0 +1,61 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/tracing/ring_buffer_exporter.h"
+
+#include <stddef.h>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/tracing/tracing.h"
+
+namespace tensorstore {
+namespace internal_tracing {
+
+RingBufferTraceExporter::RingBufferTraceExporter(size_t capacity)
+    : capacity_(capacity) {
+  assert(capacity > 0);
+}
+
+void RingBufferTraceExporter::Export(SpanRecord record) {
+  absl::MutexLock lock(&mutex_);
+  if (spans_.size() < capacity_) {
+    spans_.push_back(std::move(record));
+    return;
+  }
+  spans_[oldest_] = std::move(record);
+  oldest_ = (oldest_ + 1) % capacity_;
+}
+
+std::vector<SpanRecord> RingBufferTraceExporter::GetSpans() const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<SpanRecord> spans;
+  spans.reserve(spans_.size());
+  for (size_t i = 0; i < spans_.size(); ++i) {
+    spans.push_back(spans_[(oldest_ + i) % spans_.size()]);
+  }
+  return spans;
+}
+
+void RingBufferTraceExporter::Clear() {
+  absl::MutexLock lock(&mutex_);
+  spans_.clear();
+  oldest_ = 0;
+}
+
+}  // namespace internal_tracing
+}  // namespace tensorstore
@@ -0,0 +1,56 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_INTERNAL_TRACING_RING_BUFFER_EXPORTER_H_
+#define TENSORSTORE_INTERNAL_TRACING_RING_BUFFER_EXPORTER_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/tracing/tracing.h"
+
+namespace tensorstore {
+namespace internal_tracing {
+
+/// Trace exporter that retains the most recently completed spans in memory.
+class RingBufferTraceExporter : public TraceExporter {
+ public:
+  /// Constructs an exporter that retains at most `capacity` spans.
+  ///
+  /// \dchecks `capacity > 0`
+  explicit RingBufferTraceExporter(size_t capacity);
+
+  void Export(SpanRecord record) override;
+
+  /// Returns the retained spans, in the order in which they completed.
+  std::vector<SpanRecord> GetSpans() const;
+
+  /// Discards all retained spans.
+  void Clear();
+
+ private:
+  const size_t capacity_;
+  mutable absl::Mutex mutex_;
+  std::vector<SpanRecord> spans_ ABSL_GUARDED_BY(mutex_);
+  // Index of the oldest span in `spans_`, once `capacity_` spans are retained.
+  size_t oldest_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace internal_tracing
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_INTERNAL_TRACING_RING_BUFFER_EXPORTER_H_
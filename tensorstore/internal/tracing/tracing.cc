@@ -0,0 +1,167 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/tracing/tracing.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/no_destructor.h"
+
+namespace tensorstore {
+namespace internal_tracing {
+
+class SpanState {
+ public:
+  std::atomic<uint32_t> reference_count{0};
+
+  // Exporter to which the span is passed once it ends.  Inherited from the
+  // parent span, such that all spans of a trace use the same exporter.
+  std::shared_ptr<TraceExporter> exporter;
+
+  // Keeps the parent open until this span ends.
+  internal::IntrusivePtr<SpanState> parent;
+
+  // Attributes are only modified by the owning `Span`, which holds a
+  // reference, and are read once the last reference is released.
+  SpanRecord record;
+};
+
+namespace {
+
+struct ExporterState {
+  absl::Mutex mutex;
+  std::shared_ptr<TraceExporter> exporter ABSL_GUARDED_BY(mutex);
+};
+
+ExporterState& GetExporterState() {
+  static internal::NoDestructor<ExporterState> state;
+  return *state;
+}
+
+// Set while an exporter is installed, to avoid acquiring the mutex when
+// tracing is disabled.
+std::atomic<bool> tracing_enabled{false};
+
+std::atomic<uint64_t> next_span_id{1};
+std::atomic<uint64_t> next_thread_id{1};
+
+// Current span of this thread.  Owns a reference.
+ABSL_CONST_INIT thread_local SpanState* current_span = nullptr;
+
+ABSL_CONST_INIT thread_local uint64_t thread_id = 0;
+
+uint64_t GetThreadId() {
+  if (thread_id == 0) {
+    thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+  }
+  return thread_id;
+}
+
+std::shared_ptr<TraceExporter> GetTraceExporter() {
+  if (!tracing_enabled.load(std::memory_order_acquire)) return nullptr;
+  auto& state = GetExporterState();
+  absl::MutexLock lock(&state.mutex);
+  return state.exporter;
+}
+
+}  // namespace
+
+void intrusive_ptr_increment(SpanState* p) {
+  p->reference_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void intrusive_ptr_decrement(SpanState* p) {
+  if (p->reference_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  p->record.end_time = absl::Now();
+  p->exporter->Export(std::move(p->record));
+  delete p;
+}
+
+TraceExporter::~TraceExporter() = default;
+
+void SetTraceExporter(std::shared_ptr<TraceExporter> exporter) {
+  auto& state = GetExporterState();
+  absl::MutexLock lock(&state.mutex);
+  tracing_enabled.store(exporter != nullptr, std::memory_order_release);
+  state.exporter = std::move(exporter);
+}
+
+bool IsTracingEnabled() {
+  return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+TraceContext::TraceContext(ThreadInitType) : span_(current_span) {}
+
+void SwapCurrentTraceContext(TraceContext* context) {
+  SpanState* span = context->span_.release();
+  context->span_.reset(current_span, internal::adopt_object_ref);
+  current_span = span;
+}
+
+Span::Span(std::string_view name) : previous_(nullptr) {
+  SpanState* parent = current_span;
+  std::shared_ptr<TraceExporter> exporter;
+  if (parent) {
+    exporter = parent->exporter;
+  } else {
+    exporter = GetTraceExporter();
+    if (!exporter) return;
+  }
+  state_ = new SpanState;
+  state_->exporter = std::move(exporter);
+  state_->parent.reset(parent);
+  auto& record = state_->record;
+  record.name = std::string(name);
+  record.span_id = next_span_id.fetch_add(1, std::memory_order_relaxed);
+  record.trace_id = parent ? parent->record.trace_id : record.span_id;
+  record.parent_span_id = parent ? parent->record.span_id : 0;
+  record.thread_id = GetThreadId();
+  record.start_time = absl::Now();
+  previous_.span_.reset(state_);
+  SwapCurrentTraceContext(&previous_);
+}
+
+Span::~Span() {
+  if (!state_) return;
+  // Restores the previous context; `previous_` then holds the reference to
+  // this span, which is released when `previous_` is destroyed.
+  SwapCurrentTraceContext(&previous_);
+}
+
+void Span::SetAttribute(std::string_view key, std::string value) {
+  if (!state_) return;
+  state_->record.attributes.emplace_back(std::string(key), std::move(value));
+}
+
+void Span::SetAttribute(std::string_view key, int64_t value) {
+  if (!state_) return;
+  state_->record.attributes.emplace_back(std::string(key), value);
+}
+
+}  // namespace internal_tracing
+}  // namespace tensorstore
@@ -15,19 +15,155 @@
 #ifndef TENSORSTORE_INTERNAL_TRACING_TRACING_H_
 #define TENSORSTORE_INTERNAL_TRACING_TRACING_H_
 
+/// \file
+///
+/// Lightweight tracing of asynchronous operations.
+///
+/// A `Span` records a named operation.  While a `Span` object is in scope, it
+/// is the *current span* of the thread, and spans created on the same thread
+/// are recorded as its children.
+///
+/// The current span is propagated to asynchronous continuations: future
+/// callbacks and executor tasks capture the `TraceContext` of the thread that
+/// registered them, and install it while they run.  A span therefore remains
+/// open, and its end time is recorded, only once the `Span` object has been
+/// destroyed and all continuations registered while it was current have
+/// completed.
+///
+/// Completed spans are passed to the `TraceExporter` installed by
+/// `SetTraceExporter`.  When no exporter is installed, spans are not recorded
+/// and the overhead is limited to checking an atomic flag.
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "tensorstore/internal/intrusive_ptr.h"
 
 namespace tensorstore {
 namespace internal_tracing {
 
-struct TraceContext {
+class SpanState;
+void intrusive_ptr_increment(SpanState* p);
+void intrusive_ptr_decrement(SpanState* p);
+
+/// Value of a span attribute.
+using SpanAttributeValue = std::variant<int64_t, std::string>;
+
+/// Completed span, as passed to a `TraceExporter`.
+struct SpanRecord {
+  std::string name;
+
+  /// Identifier of the root span of the trace.
+  uint64_t trace_id = 0;
+
+  /// Unique identifier of the span.
+  uint64_t span_id = 0;
+
+  /// Identifier of the parent span, or `0` for a root span.
+  uint64_t parent_span_id = 0;
+
+  /// Identifier of the thread on which the span was started.
+  uint64_t thread_id = 0;
+
+  absl::Time start_time;
+  absl::Time end_time;
+
+  std::vector<std::pair<std::string, SpanAttributeValue>> attributes;
+};
+
+/// Receives completed spans.
+///
+/// `Export` may be called concurrently from any thread, including while
+/// internal locks are held, and must not block or call back into TensorStore.
+class TraceExporter {
+ public:
+  virtual ~TraceExporter();
+  virtual void Export(SpanRecord record) = 0;
+};
+
+/// Installs the global exporter, replacing any existing exporter.
+///
+/// Specifying `nullptr` disables tracing.  Spans started before the exporter
+/// was replaced are still passed to the previous exporter.
+void SetTraceExporter(std::shared_ptr<TraceExporter> exporter);
+
+/// Returns `true` if a trace exporter is installed.
+bool IsTracingEnabled();
+
+/// Trace context captured by asynchronous continuations.
+class TraceContext {
+ public:
   struct ThreadInitType {};
   inline static constexpr ThreadInitType kThread{};
-  explicit TraceContext(ThreadInitType) {}
+
+  /// Captures the current span of this thread.
+  explicit TraceContext(ThreadInitType);
   TraceContext() = delete;
+
+ private:
+  explicit TraceContext(internal::IntrusivePtr<SpanState> span)
+      : span_(std::move(span)) {}
+
+  friend class Span;
+  friend void SwapCurrentTraceContext(TraceContext* context);
+  internal::IntrusivePtr<SpanState> span_;
 };
 
-inline void SwapCurrentTraceContext(TraceContext* context) {}
+/// Exchanges `*context` with the trace context of the current thread.
+///
+/// Callers install a captured context before running a continuation, and
+/// swap again afterwards to restore the previous context.
+void SwapCurrentTraceContext(TraceContext* context);
+
+/// Records a named operation as a child of the current span, and makes it the
+/// current span of this thread while the `Span` object is in scope.
+///
+/// `Span` objects must be destroyed on the thread on which they were created,
+/// in the reverse order of construction.
+class Span {
+ public:
+  explicit Span(std::string_view name);
+  ~Span();
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  /// Returns `true` if the span is recorded, i.e. a trace exporter was
+  /// installed when it was started.  Callers may use this to avoid computing
+  /// attributes that would be discarded.
+  bool is_recording() const { return state_ != nullptr; }
+
+  /// Adds an attribute to the span.  Has no effect if `!is_recording()`.
+  void SetAttribute(std::string_view key, std::string value);
+  void SetAttribute(std::string_view key, int64_t value);
+
+  /// Keeps the span open until the result of `promise` is set or is no longer
+  /// needed, for operations that complete without running a continuation
+  /// registered by the caller, such as those completed by an I/O thread.  Must
+  /// be called while this span is the current span.
+  ///
+  /// Only a callback on the promise is registered, such that the span does not
+  /// affect `promise.result_needed()`.
+  template <typename PromiseType>
+  void ExtendUntilReady(const PromiseType& promise) const {
+    if (!state_) return;
+    // The callback captures the current trace context, i.e. this span, and is
+    // destroyed once the result is set or no longer needed.
+    promise.ExecuteWhenNotNeeded([] {});
+  }
+
+ private:
+  // Previous context of the thread, restored by the destructor.
+  TraceContext previous_;
+  SpanState* state_ = nullptr;
+};
 
 }  // namespace internal_tracing
 }  // namespace tensorstore
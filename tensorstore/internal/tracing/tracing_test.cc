@@ -0,0 +1,265 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/internal/tracing/tracing.h"
+
+#include <stdint.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/json_gtest.h"
+#include "tensorstore/internal/testing/scoped_directory.h"
+#include "tensorstore/internal/thread/thread_pool.h"
+#include "tensorstore/internal/tracing/chrome_trace_exporter.h"
+#include "tensorstore/internal/tracing/ring_buffer_exporter.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+
+namespace {
+
+using ::tensorstore::MatchesJson;
+using ::tensorstore::PromiseFuturePair;
+using ::tensorstore::ReadyFuture;
+using ::tensorstore::internal_testing::ScopedTemporaryDirectory;
+using ::tensorstore::internal_tracing::ChromeTraceFileExporter;
+using ::tensorstore::internal_tracing::GetChromeTraceEvent;
+using ::tensorstore::internal_tracing::IsTracingEnabled;
+using ::tensorstore::internal_tracing::RingBufferTraceExporter;
+using ::tensorstore::internal_tracing::SetTraceExporter;
+using ::tensorstore::internal_tracing::Span;
+using ::tensorstore::internal_tracing::SpanAttributeValue;
+using ::tensorstore::internal_tracing::SpanRecord;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::Pair;
+
+class TracingTest : public ::testing::Test {
+ protected:
+  void SetUp() override { SetTraceExporter(exporter_); }
+  void TearDown() override { SetTraceExporter(nullptr); }
+
+  std::vector<std::string> GetSpanNames() {
+    std::vector<std::string> names;
+    for (const auto& span : exporter_->GetSpans()) names.push_back(span.name);
+    return names;
+  }
+
+  std::shared_ptr<RingBufferTraceExporter> exporter_ =
+      std::make_shared<RingBufferTraceExporter>(100);
+};
+
+TEST_F(TracingTest, Nested) {
+  EXPECT_TRUE(IsTracingEnabled());
+  {
+    Span outer("outer");
+    EXPECT_TRUE(outer.is_recording());
+    outer.SetAttribute("key", "value");
+    {
+      Span inner("inner");
+      inner.SetAttribute("size", int64_t{42});
+    }
+    EXPECT_THAT(GetSpanNames(), ElementsAre("inner"));
+  }
+  { Span other("other"); }
+
+  auto spans = exporter_->GetSpans();
+  ASSERT_EQ(3, spans.size());
+  const auto& inner = spans[0];
+  const auto& outer = spans[1];
+  const auto& other = spans[2];
+  EXPECT_EQ("outer", outer.name);
+  EXPECT_EQ(0, outer.parent_span_id);
+  EXPECT_EQ(outer.span_id, outer.trace_id);
+  EXPECT_EQ(outer.span_id, inner.parent_span_id);
+  EXPECT_EQ(outer.trace_id, inner.trace_id);
+  EXPECT_NE(outer.trace_id, other.trace_id);
+  EXPECT_EQ(0, other.parent_span_id);
+  EXPECT_LE(outer.start_time, inner.start_time);
+  EXPECT_LE(inner.end_time, outer.end_time);
+  EXPECT_THAT(outer.attributes,
+              ElementsAre(Pair("key", SpanAttributeValue("value"))));
+  EXPECT_THAT(inner.attributes,
+              ElementsAre(Pair("size", SpanAttributeValue(int64_t{42}))));
+}
+
+TEST_F(TracingTest, PropagatesToFutureCallbacks) {
+  auto pair = PromiseFuturePair<int>::Make();
+  {
+    Span outer("outer");
+    pair.future.ExecuteWhenReady(
+        [](ReadyFuture<int> future) { Span callback("callback"); });
+  }
+  // The pending callback keeps `outer` open.
+  EXPECT_THAT(GetSpanNames(), ElementsAre());
+  pair.promise.SetResult(1);
+
+  auto spans = exporter_->GetSpans();
+  ASSERT_THAT(spans, ElementsAre(Field(&SpanRecord::name, "callback"),
+                                 Field(&SpanRecord::name, "outer")));
+  EXPECT_EQ(spans[1].span_id, spans[0].parent_span_id);
+}
+
+TEST_F(TracingTest, PropagatesAcrossExecutor) {
+  auto executor = tensorstore::internal::DetachedThreadPool(1);
+  absl::Notification done;
+  {
+    Span outer("outer");
+    executor([&] {
+      { Span task("task"); }
+      done.Notify();
+    });
+  }
+  done.WaitForNotification();
+  // `outer` ends once the task has been destroyed by the thread pool.
+  while (exporter_->GetSpans().size() < 2) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+
+  auto spans = exporter_->GetSpans();
+  ASSERT_THAT(spans, ElementsAre(Field(&SpanRecord::name, "task"),
+                                 Field(&SpanRecord::name, "outer")));
+  EXPECT_EQ(spans[1].span_id, spans[0].parent_span_id);
+  EXPECT_NE(spans[1].thread_id, spans[0].thread_id);
+}
+
+TEST_F(TracingTest, ExtendUntilReady) {
+  auto pair = PromiseFuturePair<void>::Make();
+  {
+    Span span("span");
+    span.ExtendUntilReady(pair.promise);
+  }
+  EXPECT_THAT(GetSpanNames(), ElementsAre());
+  pair.promise.SetResult(absl::OkStatus());
+  EXPECT_THAT(GetSpanNames(), ElementsAre("span"));
+}
+
+TEST_F(TracingTest, ExtendUntilReadyNotNeeded) {
+  auto pair = PromiseFuturePair<void>::Make();
+  {
+    Span span("span");
+    span.ExtendUntilReady(pair.promise);
+  }
+  EXPECT_TRUE(pair.promise.result_needed());
+  pair.future = {};
+  EXPECT_FALSE(pair.promise.result_needed());
+  EXPECT_THAT(GetSpanNames(), ElementsAre("span"));
+}
+
+TEST_F(TracingTest, RingBufferWrapsAround) {
+  exporter_ = std::make_shared<RingBufferTraceExporter>(2);
+  SetTraceExporter(exporter_);
+  for (const char* name : {"a", "b", "c"}) {
+    Span span(name);
+  }
+  EXPECT_THAT(GetSpanNames(), ElementsAre("b", "c"));
+  { Span span("d"); }
+  EXPECT_THAT(GetSpanNames(), ElementsAre("c", "d"));
+  exporter_->Clear();
+  EXPECT_THAT(GetSpanNames(), ElementsAre());
+  { Span span("e"); }
+  EXPECT_THAT(GetSpanNames(), ElementsAre("e"));
+}
+
+TEST(TracingDisabledTest, NotRecording) {
+  EXPECT_FALSE(IsTracingEnabled());
+  Span span("span");
+  EXPECT_FALSE(span.is_recording());
+  span.SetAttribute("key", "value");
+}
+
+TEST(ChromeTraceEventTest, Basic) {
+  SpanRecord record;
+  record.name = "ChunkCache::Read";
+  record.trace_id = 1;
+  record.span_id = 2;
+  record.parent_span_id = 1;
+  record.thread_id = 3;
+  record.start_time = absl::FromUnixMicros(1000);
+  record.end_time = absl::FromUnixMicros(1500);
+  record.attributes.emplace_back("key", std::string("a/b"));
+  record.attributes.emplace_back("bytes", int64_t{10});
+  EXPECT_THAT(GetChromeTraceEvent(record),
+              MatchesJson({
+                  {"name", "ChunkCache::Read"},
+                  {"cat", "tensorstore"},
+                  {"ph", "X"},
+                  {"ts", 1000.0},
+                  {"dur", 500.0},
+                  {"pid", 1},
+                  {"tid", 3},
+                  {"args",
+                   {{"key", "a/b"},
+                    {"bytes", 10},
+                    {"trace_id", 1},
+                    {"span_id", 2},
+                    {"parent_span_id", 1}}},
+              }));
+}
+
+TEST(ChromeTraceFileExporterTest, InvalidUtf8) {
+  ScopedTemporaryDirectory tempdir;
+  const std::string path = tempdir.path() + "/trace.json";
+  {
+    auto exporter = ChromeTraceFileExporter::Open(path);
+    ASSERT_TRUE(exporter.ok()) << exporter.status();
+    SpanRecord record;
+    record.name = "kvstore::Read";
+    record.attributes.emplace_back("key", std::string("a\xff" "b"));
+    (*exporter)->Export(std::move(record));
+  }
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  auto events = ::nlohmann::json::parse(contents.str(), nullptr,
+                                        /*allow_exceptions=*/false);
+  ASSERT_TRUE(events.is_array()) << contents.str();
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ("a\xef\xbf\xbd" "b", events[0]["args"]["key"]);
+}
+
+TEST(ChromeTraceFileExporterTest, ExceedsFlushThreshold) {
+  ScopedTemporaryDirectory tempdir;
+  const std::string path = tempdir.path() + "/trace.json";
+  constexpr size_t kNumEvents = 10000;
+  {
+    auto exporter = ChromeTraceFileExporter::Open(path);
+    ASSERT_TRUE(exporter.ok()) << exporter.status();
+    for (size_t i = 0; i < kNumEvents; ++i) {
+      SpanRecord record;
+      record.name = "kvstore::Read";
+      record.attributes.emplace_back("key", std::string(200, 'a'));
+      (*exporter)->Export(std::move(record));
+    }
+  }
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  EXPECT_LT(ChromeTraceFileExporter::kFlushThreshold, contents.str().size());
+  auto events = ::nlohmann::json::parse(contents.str(), nullptr,
+                                        /*allow_exceptions=*/false);
+  ASSERT_TRUE(events.is_array());
+  EXPECT_EQ(kNumEvents, events.size());
+}
+
+}  // namespace
@@ -0,0 +1,266 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/batch_util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_kvstore_batch {
+namespace {
+
+auto& batch_read = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/batch/read",
+    "Reads issued for batched reads, after combining byte ranges");
+
+auto& batch_request = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/batch/request", "Reads added to a batch");
+
+struct PendingRead {
+  kvstore::Key key;
+  kvstore::ReadOptions options;
+  Promise<kvstore::ReadResult> promise;
+};
+
+/// Returns `true` if `a` and `b` may be served by the same read.
+bool IsCompatible(const PendingRead& a, const PendingRead& b) {
+  return a.key == b.key && a.options.if_equal == b.options.if_equal &&
+         a.options.if_not_equal == b.options.if_not_equal;
+}
+
+class BatchReadEntry : public Batch::Entry {
+ public:
+  explicit BatchReadEntry(kvstore::DriverPtr driver, int64_t max_gap_bytes)
+      : driver_(std::move(driver)), max_gap_bytes_(max_gap_bytes) {}
+
+  void Add(PendingRead request) {
+    absl::MutexLock lock(&mutex_);
+    requests_.push_back(std::move(request));
+  }
+
+  void Submit() override {
+    std::vector<PendingRead> requests;
+    {
+      absl::MutexLock lock(&mutex_);
+      requests.swap(requests_);
+    }
+    batch_request.IncrementBy(requests.size());
+    // Order the reads such that compatible reads are adjacent.
+    std::sort(requests.begin(), requests.end(),
+              [](const PendingRead& a, const PendingRead& b) {
+                return std::tie(a.key, a.options.if_equal.value,
+                                a.options.if_not_equal.value) <
+                       std::tie(b.key, b.options.if_equal.value,
+                                b.options.if_not_equal.value);
+              });
+    for (size_t begin = 0, end; begin < requests.size(); begin = end) {
+      end = begin + 1;
+      while (end < requests.size() &&
+             IsCompatible(requests[begin], requests[end])) {
+        ++end;
+      }
+      SubmitGroup(span(requests.data() + begin, end - begin));
+    }
+  }
+
+ private:
+  /// Issues the reads for a group of compatible requests.
+  void SubmitGroup(span<PendingRead> group) {
+    kvstore::ReadOptions options;
+    options.if_equal = group[0].options.if_equal;
+    options.if_not_equal = group[0].options.if_not_equal;
+    options.staleness_bound = group[0].options.staleness_bound;
+    std::vector<ByteRangeReadRequest> byte_range_requests;
+    for (auto& request : group) {
+      if (!request.promise.result_needed()) continue;
+      if (request.options.byte_range.IsSuffixLength()) {
+        // Suffix lengths cannot be combined with other byte ranges without
+        // knowing the size of the value.
+        Issue(request.key, std::move(request.options),
+              std::move(request.promise));
+        continue;
+      }
+      options.staleness_bound =
+          std::max(options.staleness_bound, request.options.staleness_bound);
+      byte_range_requests.push_back(
+          {request.options.byte_range, std::move(request.promise)});
+    }
+    const kvstore::Key& key = group[0].key;
+    CoalesceByteRangeRequests(
+        byte_range_requests, max_gap_bytes_,
+        [&](OptionalByteRangeRequest merged,
+            span<ByteRangeReadRequest> merged_group) {
+          options.byte_range = merged;
+          if (merged_group.size() == 1) {
+            Issue(key, options, std::move(merged_group[0].promise));
+            return;
+          }
+          batch_read.Increment();
+          driver_->Read(key, options)
+              .ExecuteWhenReady(
+                  [driver = driver_, key, options,
+                   requests = std::vector<ByteRangeReadRequest>(
+                       std::make_move_iterator(merged_group.begin()),
+                       std::make_move_iterator(merged_group.end()))](
+                      ReadyFuture<kvstore::ReadResult> future) mutable {
+                    auto& result = future.result();
+                    if (result.status().code() ==
+                        absl::StatusCode::kOutOfRange) {
+                      // At least one of the byte ranges is not valid for the
+                      // value; retry individually to determine which.
+                      for (auto& request : requests) {
+                        options.byte_range = request.byte_range;
+                        LinkResult(std::move(request.promise),
+                                   driver->Read(key, options));
+                      }
+                      return;
+                    }
+                    ResolveCoalescedRequests(options.byte_range, requests,
+                                             result);
+                  });
+        });
+  }
+
+  void Issue(const kvstore::Key& key, kvstore::ReadOptions options,
+             Promise<kvstore::ReadResult> promise) {
+    batch_read.Increment();
+    LinkResult(std::move(promise), driver_->Read(key, std::move(options)));
+  }
+
+  kvstore::DriverPtr driver_;
+  int64_t max_gap_bytes_;
+  absl::Mutex mutex_;
+  std::vector<PendingRead> requests_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+void CoalesceByteRangeRequests(
+    span<ByteRangeReadRequest> requests, int64_t max_gap_bytes,
+    absl::FunctionRef<void(OptionalByteRangeRequest merged,
+                           span<ByteRangeReadRequest> group)>
+        callback) {
+  if (requests.empty()) return;
+  std::sort(requests.begin(), requests.end(),
+            [](const ByteRangeReadRequest& a, const ByteRangeReadRequest& b) {
+              assert(!a.byte_range.IsSuffixLength());
+              assert(!b.byte_range.IsSuffixLength());
+              return a.byte_range.inclusive_min < b.byte_range.inclusive_min;
+            });
+  ptrdiff_t group_begin = 0;
+  OptionalByteRangeRequest merged = requests[0].byte_range;
+  for (ptrdiff_t i = 1; i < requests.size(); ++i) {
+    const auto& byte_range = requests[i].byte_range;
+    // Overlapping ranges have a negative gap.
+    if (merged.exclusive_max != -1 &&
+        byte_range.inclusive_min - merged.exclusive_max > max_gap_bytes) {
+      callback(merged, requests.subspan(group_begin, i - group_begin));
+      group_begin = i;
+      merged = byte_range;
+      continue;
+    }
+    if (merged.exclusive_max != -1) {
+      merged.exclusive_max = (byte_range.exclusive_max == -1)
+                                 ? -1
+                                 : std::max(merged.exclusive_max,
+                                            byte_range.exclusive_max);
+    }
+  }
+  callback(merged, requests.subspan(group_begin));
+}
+
+void ResolveCoalescedRequests(OptionalByteRangeRequest merged,
+                              span<ByteRangeReadRequest> requests,
+                              const Result<kvstore::ReadResult>& result) {
+  if (!result.ok() || !result->has_value()) {
+    for (auto& request : requests) {
+      request.promise.SetResult(result);
+    }
+    return;
+  }
+  const absl::Cord& value = result->value;
+  // Offset within the stored value of the end of `value`.
+  const int64_t value_end = merged.inclusive_min + value.size();
+  for (auto& request : requests) {
+    const auto& byte_range = request.byte_range;
+    int64_t exclusive_max = byte_range.exclusive_max;
+    if (exclusive_max == -1) {
+      if (merged.exclusive_max != -1) {
+        // The value may extend past the end of `merged`; the merged read
+        // cannot satisfy this request.  This does not occur for groups
+        // computed by `CoalesceByteRangeRequests`.
+        request.promise.SetResult(absl::InternalError(
+            "Merged byte range does not contain requested byte range"));
+        continue;
+      }
+      exclusive_max = value_end;
+    }
+    if (byte_range.inclusive_min > value_end || exclusive_max > value_end) {
+      request.promise.SetResult(absl::OutOfRangeError(tensorstore::StrCat(
+          "Requested byte range ", byte_range,
+          " is not valid for value of size ", value_end)));
+      continue;
+    }
+    kvstore::ReadResult sub_result;
+    sub_result.state = result->state;
+    sub_result.stamp = result->stamp;
+    sub_result.value =
+        value.Subcord(byte_range.inclusive_min - merged.inclusive_min,
+                      exclusive_max - byte_range.inclusive_min);
+    request.promise.SetResult(std::move(sub_result));
+  }
+}
+
+Future<kvstore::ReadResult> BatchRead(kvstore::Driver& driver,
+                                      kvstore::Key key,
+                                      kvstore::ReadOptions options,
+                                      int64_t max_gap_bytes) {
+  assert(options.batch);
+  const Batch batch = std::move(options.batch);
+  options.batch = no_batch;
+  auto& entry = batch.GetEntry<BatchReadEntry>(&driver, [&] {
+    return new BatchReadEntry(kvstore::DriverPtr(&driver), max_gap_bytes);
+  });
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  entry.Add({std::move(key), std::move(options), std::move(promise)});
+  return std::move(future);
+}
+
+}  // namespace internal_kvstore_batch
+}  // namespace tensorstore
@@ -0,0 +1,94 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_BATCH_UTIL_H_
+#define TENSORSTORE_KVSTORE_BATCH_UTIL_H_
+
+/// \file
+///
+/// Utilities for implementing batched reads in kvstore drivers.
+
+#include <stdint.h>
+
+#include "absl/functional/function_ref.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/span.h"
+
+namespace tensorstore {
+namespace internal_kvstore_batch {
+
+/// Default maximum number of unrequested bytes between two byte ranges of the
+/// same value for them to be read by a single request.
+constexpr int64_t kDefaultMaxGapBytes = 1024 * 1024;
+
+/// Request for a byte range of a value.
+struct ByteRangeReadRequest {
+  OptionalByteRangeRequest byte_range;
+  Promise<kvstore::ReadResult> promise;
+};
+
+/// Sorts `requests` by byte range and partitions them into groups of
+/// overlapping or nearby byte ranges.
+///
+/// Two consecutive byte ranges are placed in the same group if the number of
+/// bytes between them does not exceed `max_gap_bytes`.  `callback` is invoked
+/// for each group with the smallest byte range containing all byte ranges in
+/// the group.
+///
+/// \dchecks No byte range specifies a suffix length.
+void CoalesceByteRangeRequests(
+    span<ByteRangeReadRequest> requests, int64_t max_gap_bytes,
+    absl::FunctionRef<void(OptionalByteRangeRequest merged,
+                           span<ByteRangeReadRequest> group)>
+        callback);
+
+/// Resolves each of `requests` from `result`, the result of a read of the
+/// `merged` byte range computed by `CoalesceByteRangeRequests`.
+void ResolveCoalescedRequests(OptionalByteRangeRequest merged,
+                              span<ByteRangeReadRequest> requests,
+                              const Result<kvstore::ReadResult>& result);
+
+/// Adds a read of `key` to `options.batch`.
+///
+/// When the batch is submitted, the reads added for `driver` are grouped by key
+/// and generation conditions, and reads of nearby byte ranges of the same key
+/// are combined into a single call to `driver.Read` with `options.batch`
+/// cleared.  If a combined read fails with `absl::StatusCode::kOutOfRange`, the
+/// individual reads are retried separately.
+///
+/// This is intended to be called by `kvstore::Driver::Read` implementations
+/// for which each request has a significant fixed cost, e.g.:
+///
+///     Future<ReadResult> Read(Key key, ReadOptions options) override {
+///       if (options.batch) {
+///         return internal_kvstore_batch::BatchRead(*this, std::move(key),
+///                                                  std::move(options));
+///       }
+///       ...
+///     }
+///
+/// \dchecks `options.batch`
+Future<kvstore::ReadResult> BatchRead(
+    kvstore::Driver& driver, kvstore::Key key, kvstore::ReadOptions options,
+    int64_t max_gap_bytes = kDefaultMaxGapBytes);
+
+}  // namespace internal_kvstore_batch
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_BATCH_UTIL_H_
@@ -0,0 +1,153 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/batch_util.h"
+
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/test_matchers.h"
+#include "tensorstore/util/span.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::Batch;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::OptionalByteRangeRequest;
+using ::tensorstore::span;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MockKeyValueStore;
+using ::tensorstore::internal_kvstore_batch::BatchRead;
+using ::tensorstore::internal_kvstore_batch::ByteRangeReadRequest;
+using ::tensorstore::internal_kvstore_batch::CoalesceByteRangeRequests;
+
+kvstore::ReadOptions MakeOptions(const Batch& batch,
+                                 OptionalByteRangeRequest byte_range) {
+  kvstore::ReadOptions options;
+  options.batch = batch;
+  options.byte_range = byte_range;
+  return options;
+}
+
+TEST(CoalesceByteRangeRequestsTest, Basic) {
+  std::vector<ByteRangeReadRequest> requests(5);
+  requests[0].byte_range = OptionalByteRangeRequest(20, 30);
+  requests[1].byte_range = OptionalByteRangeRequest(0, 5);
+  requests[2].byte_range = OptionalByteRangeRequest(8, 10);
+  requests[3].byte_range = OptionalByteRangeRequest(2, 4);
+  requests[4].byte_range = OptionalByteRangeRequest(100);
+  std::vector<std::pair<OptionalByteRangeRequest, size_t>> groups;
+  CoalesceByteRangeRequests(
+      requests, /*max_gap_bytes=*/5,
+      [&](OptionalByteRangeRequest merged, span<ByteRangeReadRequest> group) {
+        groups.emplace_back(merged, group.size());
+      });
+  EXPECT_THAT(groups, ::testing::ElementsAre(
+                          std::pair(OptionalByteRangeRequest(0, 10), 3),
+                          std::pair(OptionalByteRangeRequest(20, 30), 1),
+                          std::pair(OptionalByteRangeRequest(100), 1)));
+}
+
+TEST(BatchReadTest, CombinesByteRanges) {
+  auto mock = MockKeyValueStore::Make();
+  auto memory = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory, "a", absl::Cord("0123456789")).result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory, "b", absl::Cord("abcdef")).result());
+
+  auto batch = Batch::New();
+  auto future1 =
+      BatchRead(*mock, "a", MakeOptions(batch, OptionalByteRangeRequest(0, 2)));
+  auto future2 =
+      BatchRead(*mock, "a", MakeOptions(batch, OptionalByteRangeRequest(4, 6)));
+  auto future3 =
+      BatchRead(*mock, "a", MakeOptions(batch, OptionalByteRangeRequest(8)));
+  auto future4 =
+      BatchRead(*mock, "b", MakeOptions(batch, OptionalByteRangeRequest(1, 3)));
+  auto future5 = BatchRead(
+      *mock, "a",
+      MakeOptions(batch, OptionalByteRangeRequest::SuffixLength(1)));
+
+  // No reads are issued until the batch is submitted.
+  EXPECT_TRUE(mock->read_requests.empty());
+  batch.Release();
+
+  {
+    auto req = mock->read_requests.pop();
+    EXPECT_EQ("a", req.key);
+    EXPECT_EQ(OptionalByteRangeRequest::SuffixLength(1),
+              req.options.byte_range);
+    EXPECT_FALSE(req.options.batch);
+    req(memory.driver);
+  }
+  {
+    auto req = mock->read_requests.pop();
+    EXPECT_EQ("a", req.key);
+    EXPECT_EQ(OptionalByteRangeRequest(0), req.options.byte_range);
+    req(memory.driver);
+  }
+  {
+    auto req = mock->read_requests.pop();
+    EXPECT_EQ("b", req.key);
+    EXPECT_EQ(OptionalByteRangeRequest(1, 3), req.options.byte_range);
+    req(memory.driver);
+  }
+  EXPECT_TRUE(mock->read_requests.empty());
+
+  EXPECT_THAT(future1.result(), MatchesKvsReadResult(absl::Cord("01")));
+  EXPECT_THAT(future2.result(), MatchesKvsReadResult(absl::Cord("45")));
+  EXPECT_THAT(future3.result(), MatchesKvsReadResult(absl::Cord("89")));
+  EXPECT_THAT(future4.result(), MatchesKvsReadResult(absl::Cord("bc")));
+  EXPECT_THAT(future5.result(), MatchesKvsReadResult(absl::Cord("9")));
+}
+
+TEST(BatchReadTest, RetriesOutOfRangeIndividually) {
+  auto mock = MockKeyValueStore::Make();
+  auto memory = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory, "a", absl::Cord("0123456789")).result());
+
+  auto batch = Batch::New();
+  auto future1 =
+      BatchRead(*mock, "a", MakeOptions(batch, OptionalByteRangeRequest(0, 2)));
+  auto future2 = BatchRead(
+      *mock, "a", MakeOptions(batch, OptionalByteRangeRequest(8, 12)));
+  batch.Release();
+
+  {
+    auto req = mock->read_requests.pop();
+    EXPECT_EQ(OptionalByteRangeRequest(0, 12), req.options.byte_range);
+    req(memory.driver);
+  }
+  for (int i = 0; i < 2; ++i) {
+    mock->read_requests.pop()(memory.driver);
+  }
+  EXPECT_THAT(future1.result(), MatchesKvsReadResult(absl::Cord("01")));
+  EXPECT_THAT(future2.result(), MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
+}  // namespace
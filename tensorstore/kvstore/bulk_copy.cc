@@ -0,0 +1,297 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/bulk_copy.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/metrics/gauge.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/supported_features.h"
+#include "tensorstore/util/execution/any_receiver.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_kvstore {
+namespace {
+
+auto& bulk_copy_keys_listed = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/bulk_copy/keys_listed",
+    "Number of keys listed by BulkCopy");
+
+auto& bulk_copy_keys_copied = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/bulk_copy/keys_copied",
+    "Number of keys copied by BulkCopy");
+
+auto& bulk_copy_keys_skipped = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/bulk_copy/keys_skipped",
+    "Number of keys not copied by BulkCopy because they matched the target "
+    "or were deleted");
+
+auto& bulk_copy_bytes_copied = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/bulk_copy/bytes_copied",
+    "Number of bytes copied by BulkCopy");
+
+auto& bulk_copy_in_flight_bytes = internal_metrics::Gauge<int64_t>::New(
+    "/tensorstore/kvstore/bulk_copy/in_flight_bytes",
+    "Number of bytes reserved by keys being copied by BulkCopy");
+
+/// State of a `BulkCopy` operation.
+///
+/// Listed keys are queued in `pending` and started as the limits permit.  The
+/// promise becomes ready with the first error, or once listing has finished
+/// and all operations have released their references to the state.
+///
+/// The future of each operation is linked to the promise, such that it is
+/// released, and no further operation is started for its key, once the result
+/// is no longer needed.
+struct BulkCopyState : public internal::AtomicReferenceCount<BulkCopyState> {
+  KvStore source;
+  KvStore target;
+  BulkCopyOptions options;
+  Promise<void> promise;
+
+  absl::Mutex mutex;
+  // Keys which have been listed but not yet started.  Since `kvstore::List`
+  // does not support back pressure, keys are buffered here rather than values.
+  std::deque<kvstore::ListEntry> pending ABSL_GUARDED_BY(mutex);
+  size_t in_flight_operations ABSL_GUARDED_BY(mutex) = 0;
+  int64_t in_flight_bytes ABSL_GUARDED_BY(mutex) = 0;
+  // Set while a thread is starting operations, to avoid unbounded recursion
+  // when operations complete immediately.
+  bool starting ABSL_GUARDED_BY(mutex) = false;
+
+  void AddEntry(kvstore::ListEntry entry) {
+    {
+      absl::MutexLock lock(&mutex);
+      pending.push_back(std::move(entry));
+    }
+    StartOperations();
+  }
+
+  // Starts copying pending keys while the limits permit.
+  void StartOperations() {
+    {
+      absl::MutexLock lock(&mutex);
+      if (starting) return;
+      starting = true;
+    }
+    while (true) {
+      kvstore::Key key;
+      int64_t reserved;
+      {
+        absl::MutexLock lock(&mutex);
+        if (!promise.result_needed()) pending.clear();
+        if (pending.empty() ||
+            in_flight_operations >=
+                std::max<size_t>(options.max_in_flight_operations, 1)) {
+          starting = false;
+          return;
+        }
+        reserved = std::max<int64_t>(pending.front().size, 0);
+        if (in_flight_bytes > 0 &&
+            in_flight_bytes + reserved > options.max_in_flight_bytes) {
+          starting = false;
+          return;
+        }
+        key = std::move(pending.front().key);
+        pending.pop_front();
+        ++in_flight_operations;
+        in_flight_bytes += reserved;
+      }
+      bulk_copy_in_flight_bytes.IncrementBy(reserved);
+      Copy(std::move(key), reserved);
+    }
+  }
+
+  void Copy(kvstore::Key key, int64_t reserved) {
+    if (!options.skip_matching_generations) {
+      ReadSource(std::move(key), reserved, StorageGeneration::Unknown());
+      return;
+    }
+    kvstore::ReadOptions stat_options;
+    stat_options.byte_range = OptionalByteRangeRequest::Range(0, 0);
+    auto future = kvstore::Read(target, key, std::move(stat_options));
+    Link(
+        [self = internal::IntrusivePtr<BulkCopyState>(this),
+         key = std::move(key),
+         reserved](Promise<void>,
+                   ReadyFuture<kvstore::ReadResult> future) mutable {
+          auto& r = future.result();
+          if (!r.ok()) {
+            self->Finish(key, reserved, r.status());
+            return;
+          }
+          self->ReadSource(std::move(key), reserved,
+                           r->has_value() ? r->stamp.generation
+                                          : StorageGeneration::Unknown());
+        },
+        promise, std::move(future));
+  }
+
+  void ReadSource(kvstore::Key key, int64_t reserved,
+                  StorageGeneration target_generation) {
+    if (!promise.result_needed()) return;
+    kvstore::ReadOptions read_options;
+    read_options.if_not_equal = std::move(target_generation);
+    read_options.staleness_bound = options.source_staleness_bound;
+    auto future = kvstore::Read(source, key, std::move(read_options));
+    Link(
+        [self = internal::IntrusivePtr<BulkCopyState>(this),
+         key = std::move(key),
+         reserved](Promise<void>,
+                   ReadyFuture<kvstore::ReadResult> future) mutable {
+          auto& r = future.result();
+          if (!r.ok()) {
+            self->Finish(key, reserved, r.status());
+            return;
+          }
+          if (!r->has_value()) {
+            // The generation matches the target, or the key was deleted.
+            bulk_copy_keys_skipped.Increment();
+            self->Finish(key, reserved, absl::OkStatus());
+            return;
+          }
+          self->Write(std::move(key), reserved, r->value);
+        },
+        promise, std::move(future));
+  }
+
+  void Write(kvstore::Key key, int64_t reserved, absl::Cord value) {
+    // The copy may have failed, or its result may no longer be needed, while
+    // the source was read.
+    if (!promise.result_needed()) return;
+    const int64_t size = value.size();
+    {
+      absl::MutexLock lock(&mutex);
+      in_flight_bytes += size - reserved;
+    }
+    bulk_copy_in_flight_bytes.IncrementBy(size - reserved);
+    auto future = kvstore::Write(target, key, std::move(value));
+    Link(
+        [self = internal::IntrusivePtr<BulkCopyState>(this),
+         key = std::move(key),
+         size](Promise<void>,
+               ReadyFuture<TimestampedStorageGeneration> future) {
+          auto& r = future.result();
+          if (r.ok()) {
+            bulk_copy_keys_copied.Increment();
+            bulk_copy_bytes_copied.IncrementBy(size);
+          }
+          self->Finish(key, size, r.status());
+        },
+        promise, std::move(future));
+  }
+
+  void Finish(const kvstore::Key& key, int64_t reserved, absl::Status status) {
+    if (!status.ok()) {
+      promise.SetResult(MaybeAnnotateStatus(
+          std::move(status),
+          tensorstore::StrCat("Error copying ", QuoteString(key))));
+    }
+    {
+      absl::MutexLock lock(&mutex);
+      --in_flight_operations;
+      in_flight_bytes -= reserved;
+    }
+    bulk_copy_in_flight_bytes.DecrementBy(reserved);
+    StartOperations();
+  }
+};
+
+// Receiver used by `BulkCopy` for processing the results from `List` on the
+// source.
+struct BulkCopyListReceiver {
+  internal::IntrusivePtr<BulkCopyState> state_;
+  FutureCallbackRegistration cancel_registration_;
+
+  void set_starting(AnyCancelReceiver cancel) {
+    cancel_registration_ =
+        state_->promise.ExecuteWhenNotNeeded(std::move(cancel));
+  }
+
+  void set_value(kvstore::ListEntry entry) {
+    bulk_copy_keys_listed.Increment();
+    state_->AddEntry(std::move(entry));
+  }
+
+  void set_error(absl::Status error) {
+    state_->promise.SetResult(std::move(error));
+  }
+
+  void set_done() {}
+
+  void set_stopping() { cancel_registration_.Unregister(); }
+};
+
+}  // namespace
+
+Future<const void> BulkCopy(KvStore source, KvStore target,
+                            BulkCopyOptions options) {
+  if (source.transaction != no_transaction) {
+    return absl::UnimplementedError("transactional list not supported");
+  }
+  if (options.skip_matching_generations) {
+    // Generations are only comparable between stores if they are derived
+    // from the value.
+    const auto supports_skip = [&](const KvStore& store) {
+      return (store.driver->GetSupportedFeatures(
+                  KeyRange::AddPrefix(store.path, options.source_range)) &
+              kvstore::SupportedFeatures::kContentDerivedGenerations) !=
+             kvstore::SupportedFeatures{};
+    };
+    if (!supports_skip(source) || !supports_skip(target)) {
+      return absl::InvalidArgumentError(
+          "skip_matching_generations requires stores with generations derived "
+          "from the value");
+    }
+  }
+  auto [promise, future] = PromiseFuturePair<void>::Make(MakeResult());
+  auto state = internal::MakeIntrusivePtr<BulkCopyState>();
+  state->source = std::move(source);
+  state->target = std::move(target);
+  state->options = std::move(options);
+  state->promise = std::move(promise);
+
+  kvstore::ListOptions list_options;
+  list_options.range = state->options.source_range;
+  list_options.staleness_bound = state->options.source_staleness_bound;
+  kvstore::List(state->source, std::move(list_options),
+                BulkCopyListReceiver{state});
+  return std::move(future);
+}
+
+}  // namespace internal_kvstore
+}  // namespace tensorstore
@@ -0,0 +1,87 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_BULK_COPY_H_
+#define TENSORSTORE_KVSTORE_BULK_COPY_H_
+
+/// \file
+///
+/// Copies all keys in a range from one kvstore to another with bounded
+/// resource usage.
+///
+/// Keys are copied as they are received from `kvstore::List`, such that
+/// copying may start before listing completes.  The number of keys and the
+/// total size of the values being copied concurrently are limited.  Progress
+/// is reported by the `/tensorstore/kvstore/bulk_copy/` metrics.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "absl/time/time.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+namespace internal_kvstore {
+
+/// Options for `BulkCopy`.
+struct BulkCopyOptions {
+  /// Range of keys, relative to the source path, to copy.
+  KeyRange source_range;
+
+  /// Staleness bound for listing and reading the source.
+  absl::Time source_staleness_bound = absl::InfiniteFuture();
+
+  /// Maximum number of keys copied concurrently.
+  size_t max_in_flight_operations = 64;
+
+  /// Maximum total size of the values copied concurrently.
+  ///
+  /// The size of a value is reserved when it is listed, if `kvstore::List`
+  /// reports its size, and otherwise once it has been read, in which case the
+  /// limit may be exceeded.  A value larger than the limit is copied while no
+  /// other value is in flight.
+  int64_t max_in_flight_bytes = 256 * 1024 * 1024;
+
+  /// If `true`, a key is not copied if its generation in the target is equal
+  /// to its generation in the source.
+  ///
+  /// The generation in the target is determined by an additional request per
+  /// key, and the source is then read conditioned on not having that
+  /// generation.  This is useful when resuming a copy, but is only supported
+  /// if both stores derive generations from the value, as indicated by
+  /// `kvstore::SupportedFeatures::kContentDerivedGenerations`, since otherwise
+  /// equal generations do not imply equal values.
+  bool skip_matching_generations = false;
+};
+
+/// Copies the keys in `options.source_range` of `source` to the
+/// corresponding keys of `target`.
+///
+/// Keys which are deleted from `source` after being listed are skipped.  The
+/// copy stops with the first error.  Dropping all references to the returned
+/// future cancels any remaining operations.
+///
+/// \error `absl::StatusCode::kUnimplemented` if `source` is transactional.
+/// \error `absl::StatusCode::kInvalidArgument` if
+///     `options.skip_matching_generations` is specified but `source` or
+///     `target` does not derive generations from the value.
+Future<const void> BulkCopy(KvStore source, KvStore target,
+                            BulkCopyOptions options = {});
+
+}  // namespace internal_kvstore
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_BULK_COPY_H_
@@ -0,0 +1,252 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/bulk_copy.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/supported_features.h"
+#include "tensorstore/kvstore/test_matchers.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::KeyRange;
+using ::tensorstore::KvStore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal::MockKeyValueStore;
+using ::tensorstore::internal_kvstore::BulkCopy;
+using ::tensorstore::internal_kvstore::BulkCopyOptions;
+
+TEST(BulkCopyTest, Basic) {
+  auto store = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "x/a", absl::Cord("1")).result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(store, "x/b/c", absl::Cord("22")).result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(store, "x/d", absl::Cord("333")).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "z", absl::Cord("4")).result());
+
+  BulkCopyOptions options;
+  options.source_range = KeyRange::Prefix("b");
+  TENSORSTORE_ASSERT_OK(BulkCopy(store.WithPathSuffix("x/"),
+                                 store.WithPathSuffix("y/"), options)
+                            .result());
+  EXPECT_THAT(kvstore::Read(store, "y/b/c").result(),
+              MatchesKvsReadResult(absl::Cord("22")));
+  EXPECT_THAT(kvstore::Read(store, "y/a").result(),
+              MatchesKvsReadResultNotFound());
+
+  TENSORSTORE_ASSERT_OK(BulkCopy(store.WithPathSuffix("x/"),
+                                 store.WithPathSuffix("y/"))
+                            .result());
+  EXPECT_THAT(kvstore::Read(store, "y/a").result(),
+              MatchesKvsReadResult(absl::Cord("1")));
+  EXPECT_THAT(kvstore::Read(store, "y/d").result(),
+              MatchesKvsReadResult(absl::Cord("333")));
+  EXPECT_THAT(kvstore::Read(store, "y/z").result(),
+              MatchesKvsReadResultNotFound());
+}
+
+TEST(BulkCopyTest, InFlightLimits) {
+  auto source = kvstore::Open("memory://").value();
+  for (char c = 'a'; c <= 'f'; ++c) {
+    TENSORSTORE_ASSERT_OK(
+        kvstore::Write(source, std::string(1, c), absl::Cord("0123456789"))
+            .result());
+  }
+  auto mock_driver = MockKeyValueStore::Make();
+
+  BulkCopyOptions options;
+  options.max_in_flight_operations = 3;
+  options.max_in_flight_bytes = 25;
+  auto future = BulkCopy(source, KvStore(mock_driver), options);
+
+  // The memory kvstore reports the size of each value, so only two values of
+  // 10 bytes are copied concurrently.
+  for (int i = 0; i < 6; ++i) {
+    auto req = mock_driver->write_requests.pop();
+    absl::SleepFor(absl::Milliseconds(10));
+    EXPECT_LE(mock_driver->write_requests.size(), 1);
+    req.promise.SetResult(TimestampedStorageGeneration{
+        StorageGeneration::FromString("g"), absl::Now()});
+  }
+  TENSORSTORE_ASSERT_OK(future.result());
+
+  options.max_in_flight_bytes = 1000;
+  future = BulkCopy(source, KvStore(mock_driver), options);
+  for (int i = 0; i < 6; ++i) {
+    auto req = mock_driver->write_requests.pop();
+    absl::SleepFor(absl::Milliseconds(10));
+    EXPECT_LE(mock_driver->write_requests.size(), 2);
+    req.promise.SetResult(TimestampedStorageGeneration{
+        StorageGeneration::FromString("g"), absl::Now()});
+  }
+  TENSORSTORE_ASSERT_OK(future.result());
+}
+
+TEST(BulkCopyTest, SkipMatchingGenerations) {
+  auto memory_store = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp_a,
+      kvstore::Write(memory_store, "a", absl::Cord("1")).result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory_store, "b", absl::Cord("2")).result());
+  auto source_driver = MockKeyValueStore::Make();
+  source_driver->forward_to = memory_store.driver;
+  source_driver->supported_features =
+      kvstore::SupportedFeatures::kContentDerivedGenerations;
+  auto mock_driver = MockKeyValueStore::Make();
+  mock_driver->supported_features =
+      kvstore::SupportedFeatures::kContentDerivedGenerations;
+
+  BulkCopyOptions options;
+  options.skip_matching_generations = true;
+  options.max_in_flight_operations = 1;
+  auto future = BulkCopy(KvStore(source_driver), KvStore(mock_driver), options);
+
+  // The target generation of "a" matches the source.
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ("a", req.key);
+    EXPECT_EQ(tensorstore::OptionalByteRangeRequest(0, 0),
+              req.options.byte_range);
+    req.promise.SetResult(kvstore::ReadResult::Value(absl::Cord(), stamp_a));
+  }
+  // "b" is missing in the target.
+  {
+    auto req = mock_driver->read_requests.pop();
+    EXPECT_EQ("b", req.key);
+    req.promise.SetResult(kvstore::ReadResult::Missing(absl::Now()));
+  }
+  {
+    auto req = mock_driver->write_requests.pop();
+    EXPECT_EQ("b", req.key);
+    EXPECT_EQ(absl::Cord("2"), req.value);
+    req.promise.SetResult(TimestampedStorageGeneration{
+        StorageGeneration::FromString("g"), absl::Now()});
+  }
+  TENSORSTORE_ASSERT_OK(future.result());
+  EXPECT_TRUE(mock_driver->write_requests.empty());
+}
+
+TEST(BulkCopyTest, SkipMatchingGenerationsUnsupported) {
+  // The memory kvstore assigns generations from a per-store counter, such that
+  // equal generations in different stores do not imply equal values.
+  auto source = kvstore::Open("memory://").value();
+  auto target = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(kvstore::Write(source, "a", absl::Cord("1")).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(target, "a", absl::Cord("2")).result());
+
+  BulkCopyOptions options;
+  options.skip_matching_generations = true;
+  EXPECT_THAT(BulkCopy(source, target, options).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument,
+                            "skip_matching_generations requires .*"));
+  EXPECT_THAT(kvstore::Read(target, "a").result(),
+              MatchesKvsReadResult(absl::Cord("2")));
+}
+
+TEST(BulkCopyTest, Error) {
+  auto source = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(kvstore::Write(source, "a", absl::Cord("1")).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(source, "b", absl::Cord("2")).result());
+  auto mock_driver = MockKeyValueStore::Make();
+
+  BulkCopyOptions options;
+  options.max_in_flight_operations = 1;
+  auto future = BulkCopy(source, KvStore(mock_driver), options);
+  {
+    auto req = mock_driver->write_requests.pop();
+    EXPECT_EQ("a", req.key);
+    req.promise.SetResult(absl::UnknownError("write failed"));
+  }
+  EXPECT_THAT(future.result(),
+              MatchesStatus(absl::StatusCode::kUnknown,
+                            "Error copying \"a\": write failed"));
+
+  // No further keys are copied.
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_TRUE(mock_driver->write_requests.empty());
+}
+
+TEST(BulkCopyTest, ErrorWhileReading) {
+  auto memory_store = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory_store, "a", absl::Cord("1")).result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory_store, "b", absl::Cord("2")).result());
+  auto source_driver = MockKeyValueStore::Make();
+  auto mock_driver = MockKeyValueStore::Make();
+
+  BulkCopyOptions options;
+  options.max_in_flight_operations = 2;
+  auto future = BulkCopy(KvStore(source_driver), KvStore(mock_driver), options);
+  source_driver->list_requests.pop()(memory_store.driver);
+  auto req_a = source_driver->read_requests.pop();
+  auto req_b = source_driver->read_requests.pop();
+  EXPECT_EQ("a", req_a.key);
+  EXPECT_EQ("b", req_b.key);
+  req_a.promise.SetResult(absl::UnknownError("read failed"));
+  EXPECT_THAT(future.result(),
+              MatchesStatus(absl::StatusCode::kUnknown,
+                            "Error copying \"a\": read failed"));
+
+  // The read of "b" is no longer needed, and is not written even if it
+  // completes.
+  EXPECT_FALSE(req_b.promise.result_needed());
+  req_b(memory_store.driver);
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_TRUE(mock_driver->write_requests.empty());
+}
+
+TEST(BulkCopyTest, NotNeeded) {
+  auto memory_store = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory_store, "a", absl::Cord("1")).result());
+  auto source_driver = MockKeyValueStore::Make();
+  auto mock_driver = MockKeyValueStore::Make();
+
+  auto future = BulkCopy(KvStore(source_driver), KvStore(mock_driver));
+  source_driver->list_requests.pop()(memory_store.driver);
+  auto req = source_driver->read_requests.pop();
+  EXPECT_TRUE(req.promise.result_needed());
+
+  // Dropping the returned future cancels the read.
+  future = {};
+  EXPECT_FALSE(req.promise.result_needed());
+  req(memory_store.driver);
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_TRUE(mock_driver->write_requests.empty());
+}
+
+}  // namespace
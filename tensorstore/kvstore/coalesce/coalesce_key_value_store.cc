@@ -0,0 +1,214 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Key-value store adapter that coalesces concurrent byte range reads of the
+/// same key, as performed by sharded formats, into fewer reads of the base
+/// kvstore.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorstore/context.h"
+#include "tensorstore/internal/data_copy_concurrency_resource.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_binding/absl_time.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/kvstore/coalesce/coalesce_kvstore.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/registry.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/supported_features.h"
+#include "tensorstore/transaction.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/garbage_collection/fwd.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/str_cat.h"
+
+// specializations
+#include "tensorstore/internal/cache_key/absl_time.h"  // IWYU pragma: keep
+#include "tensorstore/serialization/absl_time.h"  // IWYU pragma: keep
+
+namespace tensorstore {
+namespace {
+
+namespace jb = tensorstore::internal_json_binding;
+
+using ::tensorstore::internal_coalesce_kvstore::MakeCoalesceKvStoreDriver;
+using ::tensorstore::kvstore::ListReceiver;
+using ::tensorstore::kvstore::ReadResult;
+
+constexpr size_t kDefaultThresholdBytes = 1024 * 1024;
+
+struct CoalesceKvStoreSpecData {
+  kvstore::Spec base;
+  size_t threshold_bytes;
+  size_t merged_bytes;
+  absl::Duration interval;
+  Context::Resource<internal::DataCopyConcurrencyResource>
+      data_copy_concurrency;
+
+  constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+    return f(x.base, x.threshold_bytes, x.merged_bytes, x.interval,
+             x.data_copy_concurrency);
+  };
+
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member("base", jb::Projection<&CoalesceKvStoreSpecData::base>()),
+      jb::Member("threshold_bytes",
+                 jb::Projection<&CoalesceKvStoreSpecData::threshold_bytes>(
+                     jb::DefaultValue([](auto* v) {
+                       *v = kDefaultThresholdBytes;
+                     }))),
+      jb::Member("merged_bytes",
+                 jb::Projection<&CoalesceKvStoreSpecData::merged_bytes>(
+                     jb::DefaultValue([](auto* v) { *v = 0; }))),
+      jb::Member("interval",
+                 jb::Projection<&CoalesceKvStoreSpecData::interval>(
+                     jb::DefaultValue(
+                         [](auto* v) { *v = absl::ZeroDuration(); }))),
+      jb::Member(internal::DataCopyConcurrencyResource::id,
+                 jb::Projection<
+                     &CoalesceKvStoreSpecData::data_copy_concurrency>()) /**/
+  );
+};
+
+class CoalesceKvStoreSpec
+    : public internal_kvstore::RegisteredDriverSpec<CoalesceKvStoreSpec,
+                                                    CoalesceKvStoreSpecData> {
+ public:
+  static constexpr char id[] = "coalesce";
+
+  Future<kvstore::DriverPtr> DoOpen() const override;
+
+  absl::Status ApplyOptions(kvstore::DriverSpecOptions&& options) override {
+    return data_.base.driver.Set(std::move(options));
+  }
+
+  Result<kvstore::Spec> GetBase(std::string_view path) const override {
+    auto base = data_.base;
+    base.AppendSuffix(path);
+    return base;
+  }
+};
+
+/// Defines the "coalesce" key value store.
+///
+/// Reads are performed by a coalescing driver that wraps the base driver;
+/// all other operations are forwarded to the base kvstore.
+class CoalesceKvStore
+    : public internal_kvstore::RegisteredDriver<CoalesceKvStore,
+                                                CoalesceKvStoreSpec> {
+ public:
+  Future<ReadResult> Read(Key key, ReadOptions options) override {
+    return coalesce_driver_->Read(tensorstore::StrCat(base_.path, key),
+                                  std::move(options));
+  }
+
+  Future<TimestampedStorageGeneration> Write(Key key,
+                                            std::optional<Value> value,
+                                            WriteOptions options) override {
+    return kvstore::Write(base_, key, std::move(value), std::move(options));
+  }
+
+  Future<const void> DeleteRange(KeyRange range) override {
+    return kvstore::DeleteRange(base_, std::move(range));
+  }
+
+  void ListImpl(ListOptions options, ListReceiver receiver) override {
+    kvstore::List(base_, std::move(options), std::move(receiver));
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    return base_.driver->DescribeKey(tensorstore::StrCat(base_.path, key));
+  }
+
+  absl::Status GetBoundSpecData(CoalesceKvStoreSpecData& spec) const {
+    TENSORSTORE_ASSIGN_OR_RETURN(spec.base.driver,
+                                 base_.driver->GetBoundSpec());
+    spec.base.path = base_.path;
+    spec.threshold_bytes = threshold_bytes_;
+    spec.merged_bytes = merged_bytes_;
+    spec.interval = interval_;
+    spec.data_copy_concurrency = data_copy_concurrency_;
+    return absl::OkStatus();
+  }
+
+  kvstore::SupportedFeatures GetSupportedFeatures(
+      const KeyRange& key_range) const final {
+    return base_.driver->GetSupportedFeatures(
+        KeyRange::AddPrefix(base_.path, key_range));
+  }
+
+  Result<KvStore> GetBase(std::string_view path,
+                          const Transaction& transaction) const override {
+    return KvStore(base_.driver, tensorstore::StrCat(base_.path, path),
+                   transaction);
+  }
+
+  size_t threshold_bytes_;
+  size_t merged_bytes_;
+  absl::Duration interval_;
+  Context::Resource<internal::DataCopyConcurrencyResource>
+      data_copy_concurrency_;
+  kvstore::KvStore base_;
+  kvstore::DriverPtr coalesce_driver_;
+};
+
+Future<kvstore::DriverPtr> CoalesceKvStoreSpec::DoOpen() const {
+  return MapFutureValue(
+      InlineExecutor{},
+      [spec = internal::IntrusivePtr<const CoalesceKvStoreSpec>(this)](
+          kvstore::KvStore& base_kvstore) -> Result<kvstore::DriverPtr> {
+        auto driver = internal::MakeIntrusivePtr<CoalesceKvStore>();
+        driver->threshold_bytes_ = spec->data_.threshold_bytes;
+        driver->merged_bytes_ = spec->data_.merged_bytes;
+        driver->interval_ = spec->data_.interval;
+        driver->data_copy_concurrency_ = spec->data_.data_copy_concurrency;
+        driver->coalesce_driver_ = MakeCoalesceKvStoreDriver(
+            base_kvstore.driver, spec->data_.threshold_bytes,
+            spec->data_.merged_bytes, spec->data_.interval,
+            spec->data_.data_copy_concurrency->executor);
+        driver->base_ = std::move(base_kvstore);
+        return driver;
+      },
+      kvstore::Open(data_.base));
+}
+
+}  // namespace
+}  // namespace tensorstore
+
+TENSORSTORE_DECLARE_GARBAGE_COLLECTION_NOT_REQUIRED(
+    tensorstore::CoalesceKvStore)
+
+// Registers the driver.
+namespace {
+const tensorstore::internal_kvstore::DriverRegistration<
+    tensorstore::CoalesceKvStoreSpec>
+    registration;
+
+}  // namespace
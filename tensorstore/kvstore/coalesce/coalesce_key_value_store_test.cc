@@ -0,0 +1,144 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/context.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/test_matchers.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::Context;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::OptionalByteRangeRequest;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MockKeyValueStoreResource;
+
+TEST(CoalesceKeyValueStoreTest, Basic) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "coalesce"}, {"base", "memory://base/"}},
+                    context)
+          .result());
+  tensorstore::internal::TestKeyValueReadWriteOps(store);
+}
+
+TEST(CoalesceKeyValueStoreTest, DeleteRange) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "coalesce"}, {"base", "memory://base/"}},
+                    context)
+          .result());
+  tensorstore::internal::TestKeyValueStoreDeleteRange(store);
+}
+
+TEST(CoalesceKeyValueStoreTest, List) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "coalesce"}, {"base", "memory://base/"}},
+                    context)
+          .result());
+  tensorstore::internal::TestKeyValueStoreList(store);
+}
+
+TEST(CoalesceKeyValueStoreTest, CoalescesReads) {
+  auto context = Context::Default();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto mock_key_value_store_resource,
+      context.GetResource<MockKeyValueStoreResource>());
+  auto mock_key_value_store = *mock_key_value_store_resource;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto base_store, kvstore::Open("memory://", context).result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(base_store, "prefix/a", absl::Cord("0123456789"))
+          .result());
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "coalesce"},
+                                 {"base",
+                                  {{"driver", "mock_key_value_store"},
+                                   {"path", "prefix/"}}},
+                                 {"threshold_bytes", 2}},
+                                context)
+                      .result());
+
+  kvstore::ReadOptions ro1, ro2, ro3;
+  ro1.byte_range = OptionalByteRangeRequest(0, 1);  // not coalesced
+  ro2.byte_range = OptionalByteRangeRequest(2, 3);  // coalesced
+  ro3.byte_range = OptionalByteRangeRequest(5, 6);  // coalesced
+  auto read_future1 = kvstore::Read(store, "a", ro1);
+  auto read_future2 = kvstore::Read(store, "a", ro2);
+  auto read_future3 = kvstore::Read(store, "a", ro3);
+
+  {
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/a", req.key);
+    EXPECT_EQ(ro1.byte_range, req.options.byte_range);
+    req(base_store.driver);
+  }
+  EXPECT_THAT(read_future1.result(), MatchesKvsReadResult(absl::Cord("0")));
+  {
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ("prefix/a", req.key);
+    EXPECT_EQ(OptionalByteRangeRequest(2, 6), req.options.byte_range);
+    req(base_store.driver);
+  }
+  EXPECT_THAT(read_future2.result(), MatchesKvsReadResult(absl::Cord("2")));
+  EXPECT_THAT(read_future3.result(), MatchesKvsReadResult(absl::Cord("5")));
+}
+
+TEST(CoalesceKeyValueStoreTest, SpecRoundtrip) {
+  tensorstore::internal::KeyValueStoreSpecRoundtripOptions options;
+  options.full_spec = {
+      {"driver", "coalesce"},
+      {"base", {{"driver", "memory"}, {"path", "base/"}}},
+      {"threshold_bytes", 1024},
+      {"merged_bytes", 4096},
+      {"interval", "10ms"},
+  };
+  options.full_base_spec = {{"driver", "memory"}, {"path", "base/"}};
+  // Not possible with "memory" driver.
+  options.check_data_persists = false;
+  options.check_data_after_serialization = false;
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(options);
+}
+
+TEST(CoalesceKeyValueStoreTest, InvalidSpec) {
+  auto context = Context::Default();
+  EXPECT_THAT(kvstore::Open({{"driver", "coalesce"}}, context).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(kvstore::Open({{"driver", "coalesce"},
+                             {"base", "memory://"},
+                             {"threshold_bytes", -1}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
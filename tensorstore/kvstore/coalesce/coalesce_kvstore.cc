@@ -12,7 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "tensorstore/kvstore/ocdbt/io/coalesce_kvstore.h"
+#include "tensorstore/kvstore/coalesce/coalesce_kvstore.h"
 
 #include <stddef.h>
 
@@ -37,9 +37,11 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/internal/flat_cord_builder.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/log/verbose_flag.h"
+#include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/thread/schedule_at.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/driver.h"
@@ -56,10 +58,23 @@
 #include "tensorstore/util/result.h"
 
 namespace tensorstore {
-namespace internal_ocdbt {
+namespace internal_coalesce_kvstore {
 namespace {
 
-ABSL_CONST_INIT internal_log::VerboseFlag ocdbt_logging("ocdbt");
+ABSL_CONST_INIT internal_log::VerboseFlag coalesce_logging("coalesce");
+
+auto& coalesce_merged_read = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/coalesce/merged_read",
+    "Reads of the base kvstore that served multiple coalesced reads");
+
+auto& coalesce_merged_request = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/coalesce/merged_request",
+    "Reads served by a read of the base kvstore shared with other reads");
+
+auto& coalesce_gap_bytes = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/coalesce/gap_bytes",
+    "Bytes read from the base kvstore by merged reads that were not "
+    "requested");
 
 absl::Cord DeepCopyCord(const absl::Cord& cord) {
   // If the Cord is flat, skipping the CordBuilder improves performance.
@@ -220,6 +235,9 @@ Future<kvstore::ReadResult> CoalesceKvStoreDriver::Read(Key key,
       /// the read for later.
       auto& state = *it;
       auto op = PromiseFuturePair<ReadResult>::Make();
+      // The queued read is issued only once the in-flight read completes,
+      // which may itself require the batch to be submitted.
+      options.batch = no_batch;
       state->pending_ops.emplace_back(
           PendingRead::Op{std::move(options), std::move(op.promise)});
       return std::move(op.future);
@@ -245,6 +263,7 @@ Future<kvstore::ReadResult> CoalesceKvStoreDriver::Read(Key key,
 
         auto& state = *it;
         auto op = PromiseFuturePair<ReadResult>::Make();
+        options.batch = no_batch;
         state->pending_ops.emplace_back(
             PendingRead::Op{std::move(options), std::move(op.promise)});
         return std::move(op.future);
@@ -276,8 +295,41 @@ struct MergeValue {
   std::vector<Entry> subreads;
 };
 
+// Returns the number of bytes of `value`, the result of a merged read, that
+// are not covered by any of the `subreads`.
+//
+// The `subreads` are ordered by `byte_range.inclusive_min`.
+int64_t GetGapBytes(const MergeValue& merge_values, const absl::Cord& value) {
+  const int64_t size = value.size();
+  int64_t covered = 0;
+  int64_t covered_end = 0;
+  for (const auto& e : merge_values.subreads) {
+    int64_t start, end;
+    if (e.byte_range.inclusive_min < 0) {
+      start = size + e.byte_range.inclusive_min;
+    } else {
+      start = e.byte_range.inclusive_min -
+              merge_values.options.byte_range.inclusive_min;
+    }
+    if (e.byte_range.exclusive_max == -1) {
+      end = size;
+    } else {
+      end = std::min(size, start + e.byte_range.size());
+    }
+    start = std::max(start, covered_end);
+    if (end <= start) continue;
+    covered += end - start;
+    covered_end = end;
+  }
+  return size - covered;
+}
+
 void OnReadComplete(MergeValue merge_values,
                     ReadyFuture<kvstore::ReadResult> ready) {
+  if (merge_values.subreads.size() > 1) {
+    coalesce_merged_read.Increment();
+    coalesce_merged_request.IncrementBy(merge_values.subreads.size());
+  }
   // If there is no value, or there is a single subread, then forward the
   // ReadResult to all subreads.
   if (!ready.result().ok() || !ready.value().has_value() ||
@@ -289,6 +341,7 @@ void OnReadComplete(MergeValue merge_values,
     /// Otherwise extract the desired range and return that.
     kvstore::ReadResult result = ready.value();
     absl::Cord value = std::move(result.value);
+    coalesce_gap_bytes.IncrementBy(GetGapBytes(merge_values, value));
 
     for (const auto& e : merge_values.subreads) {
       size_t request_start, request_size;
@@ -377,9 +430,10 @@ void CoalesceKvStoreDriver::StartNextRead(
       merged = MergeValue{};
       merged.options = e.options;
     } else if (merged.options.byte_range.exclusive_max != -1 &&
+               // Overlapping ranges have a negative gap.
                ((e.options.byte_range.inclusive_min -
                      merged.options.byte_range.exclusive_max >
-                 threshold_) ||
+                 static_cast<int64_t>(threshold_)) ||
                 (merged_threshold_ > 0 &&
                  merged.options.byte_range.size() > merged_threshold_))) {
       // The distance from the end of the prior read to the beginning of the
@@ -444,7 +498,7 @@ kvstore::DriverPtr MakeCoalesceKvStoreDriver(kvstore::DriverPtr base,
                                              size_t merged_threshold,
                                              absl::Duration interval,
                                              Executor executor) {
-  ABSL_LOG_IF(INFO, ocdbt_logging)
+  ABSL_LOG_IF(INFO, coalesce_logging)
       << "Coalescing reads with threshold: " << threshold
       << ", merged_threshold: " << merged_threshold
       << ", interval: " << interval;
@@ -453,5 +507,5 @@ kvstore::DriverPtr MakeCoalesceKvStoreDriver(kvstore::DriverPtr base,
       std::move(executor));
 }
 
-}  // namespace internal_ocdbt
+}  // namespace internal_coalesce_kvstore
 }  // namespace tensorstore
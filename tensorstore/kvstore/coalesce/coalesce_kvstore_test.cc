@@ -12,26 +12,35 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "tensorstore/kvstore/ocdbt/io/coalesce_kvstore.h"
+#include "tensorstore/kvstore/coalesce/coalesce_kvstore.h"
+
+#include <stdint.h>
+
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/strings/cord.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
+#include "tensorstore/internal/metrics/metrics_testutil.h"
 #include "tensorstore/internal/thread/thread_pool.h"
 #include "tensorstore/kvstore/kvstore.h"
 #include "tensorstore/kvstore/mock_kvstore.h"
 #include "tensorstore/kvstore/operations.h"
 #include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/test_matchers.h"
 #include "tensorstore/util/status_testutil.h"
 
 namespace {
 
 namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::Batch;
 using ::tensorstore::Context;
 using ::tensorstore::OptionalByteRangeRequest;
+using ::tensorstore::internal::MatchesKvsReadResult;
 using ::tensorstore::internal::MockKeyValueStore;
-using ::tensorstore::internal_ocdbt::MakeCoalesceKvStoreDriver;
+using ::tensorstore::internal_coalesce_kvstore::MakeCoalesceKvStoreDriver;
+using ::tensorstore::internal_metrics::GetCounterValue;
 using ::tensorstore::kvstore::ReadOptions;
 
 TEST(CoalesceKvstoreTest, SimpleRead) {
@@ -264,4 +273,91 @@ TEST(CoalesceKvstoreTest, ReadWithInterval) {
   EXPECT_EQ(read_future4.result().value().value, absl::Cord("7"));
 }
 
+TEST(CoalesceKvstoreTest, BatchedReadsOverBatchingDriver) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto base_store,
+                                   kvstore::Open("memory://").result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(base_store, "a", absl::Cord("0123456789")).result());
+
+  auto mock_key_value_store = MockKeyValueStore::Make();
+  mock_key_value_store->batch_reads = true;
+  mock_key_value_store->forward_to = base_store.driver;
+
+  auto coalesce_driver = MakeCoalesceKvStoreDriver(
+      mock_key_value_store, /*threshold=*/100, /*merged_threshold=*/0,
+      /*interval=*/absl::ZeroDuration(),
+      tensorstore::internal::DetachedThreadPool(1));
+
+  auto batch = Batch::New();
+  auto read = [&](OptionalByteRangeRequest byte_range) {
+    ReadOptions options;
+    options.batch = batch;
+    options.byte_range = byte_range;
+    return kvstore::Read(coalesce_driver, "a", std::move(options));
+  };
+  auto read_future1 = read(OptionalByteRangeRequest(0, 2));
+  // Queued behind the first read, which is deferred until the batch is
+  // submitted.  The queued read must not prevent the batch from being
+  // submitted.
+  auto read_future2 = read(OptionalByteRangeRequest(4, 6));
+  batch.Release();
+
+  ASSERT_TRUE(read_future1.WaitFor(absl::Seconds(10)));
+  ASSERT_TRUE(read_future2.WaitFor(absl::Seconds(10)));
+  EXPECT_THAT(read_future1.result(), MatchesKvsReadResult(absl::Cord("01")));
+  EXPECT_THAT(read_future2.result(), MatchesKvsReadResult(absl::Cord("45")));
+}
+
+TEST(CoalesceKvstoreTest, Metrics) {
+#ifdef TENSORSTORE_METRICS_DISABLED
+  GTEST_SKIP() << "metrics disabled";
+#endif
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto base_store,
+                                   kvstore::Open("memory://").result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(base_store, "a", absl::Cord("0123456789")).result());
+
+  auto mock_key_value_store = MockKeyValueStore::Make();
+  auto coalesce_driver = MakeCoalesceKvStoreDriver(
+      mock_key_value_store, /*threshold=*/2, /*merged_threshold=*/0,
+      /*interval=*/absl::ZeroDuration(),
+      tensorstore::internal::DetachedThreadPool(1));
+
+  const int64_t merged_read =
+      GetCounterValue("/tensorstore/kvstore/coalesce/merged_read");
+  const int64_t merged_request =
+      GetCounterValue("/tensorstore/kvstore/coalesce/merged_request");
+  const int64_t gap_bytes =
+      GetCounterValue("/tensorstore/kvstore/coalesce/gap_bytes");
+
+  ReadOptions ro1, ro2, ro3, ro4;
+  ro1.byte_range = OptionalByteRangeRequest(0, 1);  // not coalesced
+  ro2.byte_range = OptionalByteRangeRequest(2, 4);  // coalesced
+  ro3.byte_range = OptionalByteRangeRequest(3, 5);  // coalesced, overlapping
+  ro4.byte_range = OptionalByteRangeRequest(7, 8);  // coalesced, 2 byte gap
+
+  auto read_future1 = kvstore::Read(coalesce_driver, "a", ro1);
+  auto read_future2 = kvstore::Read(coalesce_driver, "a", ro2);
+  auto read_future3 = kvstore::Read(coalesce_driver, "a", ro3);
+  auto read_future4 = kvstore::Read(coalesce_driver, "a", ro4);
+
+  mock_key_value_store->read_requests.pop()(base_store.driver);
+  TENSORSTORE_EXPECT_OK(read_future1.result());
+  {
+    auto req = mock_key_value_store->read_requests.pop();
+    EXPECT_EQ(req.options.byte_range, OptionalByteRangeRequest(2, 8));
+    req(base_store.driver);
+  }
+  TENSORSTORE_EXPECT_OK(read_future2.result());
+  TENSORSTORE_EXPECT_OK(read_future3.result());
+  EXPECT_EQ(read_future4.result().value().value, absl::Cord("7"));
+
+  EXPECT_EQ(merged_read + 1,
+            GetCounterValue("/tensorstore/kvstore/coalesce/merged_read"));
+  EXPECT_EQ(merged_request + 3,
+            GetCounterValue("/tensorstore/kvstore/coalesce/merged_request"));
+  EXPECT_EQ(gap_bytes + 2,
+            GetCounterValue("/tensorstore/kvstore/coalesce/gap_bytes"));
+}
+
 }  // namespace
@@ -12,40 +12,59 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <iostream>
 #include <optional>
 #include <string>
-#include <vector>
+#include <utility>
 
 #include "absl/flags/flag.h"
-#include "absl/status/status.h"
-#include "absl/synchronization/mutex.h"
 #include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "tensorstore/internal/json_binding/std_optional.h"
-#include "tensorstore/internal/path.h"
-#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/internal/metrics/collect.h"
+#include "tensorstore/internal/metrics/registry.h"
+#include "tensorstore/kvstore/bulk_copy.h"
 #include "tensorstore/kvstore/kvstore.h"
-#include "tensorstore/kvstore/operations.h"
-#include "tensorstore/kvstore/read_result.h"
 #include "tensorstore/kvstore/spec.h"
-#include "tensorstore/util/executor.h"
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/json_absl_flag.h"
-#include "tensorstore/util/quote_string.h"
 #include "tensorstore/util/result.h"
 
 ABSL_FLAG(tensorstore::JsonAbslFlag<std::optional<tensorstore::kvstore::Spec>>,
           source, std::nullopt, "Source kvstore");
 ABSL_FLAG(tensorstore::JsonAbslFlag<std::optional<tensorstore::kvstore::Spec>>,
           target, std::nullopt, "Target kvstore");
+ABSL_FLAG(size_t, max_in_flight_operations, 64,
+          "Maximum number of keys copied concurrently");
+ABSL_FLAG(int64_t, max_in_flight_bytes, 256 * 1024 * 1024,
+          "Maximum total size of the values copied concurrently");
+ABSL_FLAG(bool, skip_matching_generations, false,
+          "Skip keys whose generation in the target matches the source; only "
+          "supported if both stores derive generations from the value, such "
+          "as s3");
+ABSL_FLAG(absl::Duration, progress_interval, absl::Seconds(10),
+          "Interval at which progress is reported");
 
 namespace tensorstore {
 
 namespace {
 
-Result<int> RunCopy() {
-  static absl::Mutex log_mutex;
+void PrintProgress() {
+  for (const auto& metric :
+       internal_metrics::GetMetricRegistry().CollectWithPrefix(
+           "/tensorstore/kvstore/bulk_copy/")) {
+    internal_metrics::FormatCollectedMetric(
+        metric, [](bool has_value, std::string line) {
+          if (has_value) std::cout << line << std::endl;
+        });
+  }
+}
 
+Result<int> RunCopy() {
   auto source_spec = absl::GetFlag(FLAGS_source).value;
   if (!source_spec) {
     return absl::InvalidArgumentError("Must specify --source");
@@ -60,58 +79,27 @@ Result<int> RunCopy() {
   TENSORSTORE_ASSIGN_OR_RETURN(auto target,
                                kvstore::Open(*target_spec).result());
 
-  TENSORSTORE_ASSIGN_OR_RETURN(auto list_entries,
-                               kvstore::ListFuture(source).result());
-
-  std::vector<Future<const void>> write_futures;
+  internal_kvstore::BulkCopyOptions options;
+  options.max_in_flight_operations =
+      absl::GetFlag(FLAGS_max_in_flight_operations);
+  options.max_in_flight_bytes = absl::GetFlag(FLAGS_max_in_flight_bytes);
+  options.skip_matching_generations =
+      absl::GetFlag(FLAGS_skip_matching_generations);
+  auto future = internal_kvstore::BulkCopy(std::move(source), std::move(target),
+                                           std::move(options));
 
-  for (const auto& entry : list_entries) {
-    std::string key = entry.key;
-    write_futures.push_back(MapFutureValue(
-        InlineExecutor{},
-        [&](const Result<kvstore::ReadResult>& read_result) -> Future<void> {
-          if (!read_result.ok()) {
-            absl::MutexLock lock(&log_mutex);
-            std::cout << "Error reading: " << tensorstore::QuoteString(key)
-                      << ": " << read_result.status() << std::endl;
-          }
-          if (!read_result->has_value()) {
-            return absl::OkStatus();
-          }
-          {
-            absl::MutexLock lock(&log_mutex);
-            std::cout << "Read: " << tensorstore::QuoteString(key) << std::endl;
-          }
-          return MapFuture(
-              InlineExecutor{},
-              [&](const Result<TimestampedStorageGeneration>& stamp)
-                  -> Result<void> {
-                if (!stamp.ok()) {
-                  absl::MutexLock lock(&log_mutex);
-                  std::cout
-                      << "Error writing: " << tensorstore::QuoteString(key)
-                      << ": " << stamp.status() << std::endl;
-                  return stamp.status();
-                }
-                {
-                  absl::MutexLock lock(&log_mutex);
-                  std::cout << "Wrote: " << tensorstore::QuoteString(key)
-                            << std::endl;
-                }
-                return absl::OkStatus();
-              },
-              kvstore::Write(target, key, read_result->value));
-        },
-        kvstore::Read(source, key)));
+  const absl::Duration progress_interval =
+      absl::GetFlag(FLAGS_progress_interval);
+  while (!future.WaitFor(progress_interval)) {
+    PrintProgress();
   }
+  PrintProgress();
 
-  bool all_ok = true;
-  for (const auto& future : write_futures) {
-    const auto& result = future.result();
-    if (!result.ok()) all_ok = false;
+  if (!future.status().ok()) {
+    std::cout << future.status() << std::endl;
+    return 1;
   }
-
-  return all_ok ? 0 : 1;
+  return 0;
 }
 }  // namespace
 }  // namespace tensorstore
@@ -0,0 +1,229 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/disk_cache/disk_cache_index.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "riegeli/bytes/cord_reader.h"
+#include "riegeli/bytes/cord_writer.h"
+#include "riegeli/varint/varint_reading.h"
+#include "riegeli/varint/varint_writing.h"
+#include "tensorstore/internal/digest/sha256.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_disk_cache {
+namespace {
+
+constexpr std::string_view kMagic = "tsdc";
+constexpr uint64_t kFormatVersion = 1;
+
+// Length of the hex-encoded SHA-256 hash.
+constexpr size_t kHashLength = 64;
+
+// Length of the hex-encoded identifier of a stored entry.
+constexpr size_t kIdLength = 16;
+
+}  // namespace
+
+std::string GetKeyHash(std::string_view base_identifier, std::string_view key) {
+  internal::SHA256Digester digester;
+  // Length-prefix the identifier so that distinct (identifier, key) pairs
+  // never hash the same input.
+  digester.Write(absl::StrCat(base_identifier.size(), ":"));
+  digester.Write(base_identifier);
+  digester.Write(key);
+  auto digest = digester.Digest();
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest.data()), digest.size()));
+}
+
+std::string GetLocalKey(std::string_view hash, uint64_t size, uint64_t id) {
+  return absl::StrCat(hash.substr(0, 2), "/", hash.substr(2), ".", size, ".",
+                      absl::Hex(id, absl::kZeroPad16));
+}
+
+bool ParseLocalKey(std::string_view local_key, std::string& hash,
+                   uint64_t& size) {
+  // "xx/" + 62 hex digits + "." + at least one decimal digit + "." + 16 hex
+  // digits.
+  if (local_key.size() < kHashLength + kIdLength + 4 || local_key[2] != '/' ||
+      local_key[kHashLength + 1] != '.' ||
+      local_key[local_key.size() - kIdLength - 1] != '.') {
+    return false;
+  }
+  hash = absl::StrCat(local_key.substr(0, 2),
+                      local_key.substr(3, kHashLength - 2));
+  for (char c : hash) {
+    if (!absl::ascii_isxdigit(c) || absl::ascii_isupper(c)) return false;
+  }
+  for (char c : local_key.substr(local_key.size() - kIdLength)) {
+    if (!absl::ascii_isxdigit(c) || absl::ascii_isupper(c)) return false;
+  }
+  std::string_view size_str = local_key.substr(
+      kHashLength + 2, local_key.size() - kHashLength - kIdLength - 3);
+  for (char c : size_str) {
+    if (!absl::ascii_isdigit(c)) return false;
+  }
+  return absl::SimpleAtoi(size_str, &size);
+}
+
+absl::Cord EncodeEntry(std::string_view key,
+                       const StorageGeneration& generation,
+                       const absl::Cord& value) {
+  absl::Cord encoded;
+  riegeli::CordWriter<absl::Cord*> writer(&encoded);
+  writer.Write(kMagic);
+  riegeli::WriteVarint64(kFormatVersion, writer);
+  riegeli::WriteVarint64(key.size(), writer);
+  writer.Write(key);
+  riegeli::WriteVarint64(generation.value.size(), writer);
+  writer.Write(generation.value);
+  writer.Write(value);
+  writer.Close();
+  return encoded;
+}
+
+Result<DecodedEntry> DecodeEntry(const absl::Cord& encoded) {
+  riegeli::CordReader<const absl::Cord*> reader(&encoded);
+  const auto corrupt = [] {
+    return absl::DataLossError("Invalid disk cache entry");
+  };
+  std::string magic;
+  uint64_t version, key_size, generation_size;
+  DecodedEntry entry;
+  if (!reader.Read(kMagic.size(), magic) || magic != kMagic ||
+      !riegeli::ReadVarint64(reader, version) || version != kFormatVersion ||
+      !riegeli::ReadVarint64(reader, key_size) ||
+      !reader.Read(key_size, entry.key) ||
+      !riegeli::ReadVarint64(reader, generation_size) ||
+      !reader.Read(generation_size, entry.generation.value)) {
+    return corrupt();
+  }
+  if (!reader.Read(encoded.size() - reader.pos(), entry.value) ||
+      !reader.Close()) {
+    return corrupt();
+  }
+  return entry;
+}
+
+uint64_t DiskCacheIndex::total_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return total_bytes_;
+}
+
+std::optional<IndexEntry> DiskCacheIndex::Find(std::string_view hash) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(hash);
+  if (it == entries_.end()) return std::nullopt;
+  lru_.splice(lru_.end(), lru_, it->second.lru_position);
+  return it->second.info;
+}
+
+std::vector<std::string> DiskCacheIndex::Insert(std::string hash,
+                                                IndexEntry entry) {
+  std::vector<std::string> unreferenced;
+  absl::MutexLock lock(&mutex_);
+  if (auto it = entries_.find(hash); it != entries_.end()) {
+    if (it->second.info.local_key != entry.local_key) {
+      unreferenced.push_back(std::move(it->second.info.local_key));
+    }
+    EraseLocked(it);
+  }
+  total_bytes_ += entry.size;
+  lru_.push_back(hash);
+  auto lru_position = std::prev(lru_.end());
+  entries_.emplace(std::move(hash), Entry{std::move(entry), lru_position});
+
+  // Evict least recently used entries, but never the newly-added entry.
+  while (total_bytes_ > total_bytes_limit_ && lru_.begin() != lru_position) {
+    auto it = entries_.find(lru_.front());
+    unreferenced.push_back(std::move(it->second.info.local_key));
+    EraseLocked(it);
+  }
+  return unreferenced;
+}
+
+bool DiskCacheIndex::Erase(std::string_view hash, std::string_view local_key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(hash);
+  if (it == entries_.end() || it->second.info.local_key != local_key) {
+    return false;
+  }
+  EraseLocked(it);
+  return true;
+}
+
+void DiskCacheIndex::UpdateValidation(std::string_view hash,
+                                      std::string_view local_key,
+                                      std::string_view key,
+                                      const StorageGeneration& generation,
+                                      absl::Time time) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(hash);
+  if (it == entries_.end()) return;
+  auto& info = it->second.info;
+  if (info.local_key != local_key) return;
+  info.key = std::string(key);
+  if (info.generation == generation) {
+    info.time = std::max(info.time, time);
+  } else {
+    info.generation = generation;
+    info.time = time;
+  }
+}
+
+std::vector<std::string> DiskCacheIndex::EraseRange(const KeyRange& range) {
+  std::vector<std::string> erased;
+  absl::MutexLock lock(&mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto cur = it++;
+    const auto& info = cur->second.info;
+    if (info.key && Contains(range, *info.key)) {
+      erased.push_back(info.local_key);
+      EraseLocked(cur);
+    }
+  }
+  return erased;
+}
+
+void DiskCacheIndex::EraseLocked(
+    absl::flat_hash_map<std::string, Entry>::iterator it) {
+  total_bytes_ -= it->second.info.size;
+  lru_.erase(it->second.lru_position);
+  entries_.erase(it);
+}
+
+}  // namespace internal_disk_cache
+}  // namespace tensorstore
@@ -0,0 +1,171 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_DISK_CACHE_DISK_CACHE_INDEX_H_
+#define TENSORSTORE_KVSTORE_DISK_CACHE_DISK_CACHE_INDEX_H_
+
+/// \file
+/// In-memory index and on-disk entry format of the "disk_cache" driver.
+///
+/// Each cached value is stored in the cache kvstore under a "local key" of
+/// the form `<h[0:2]>/<h[2:]>.<size>.<id>`, where `h` is the hex-encoded
+/// SHA-256 hash of the base kvstore identifier and the key, `size` is the size
+/// of the stored entry, and `id` is a random 64-bit hex-encoded identifier.
+/// Including the size in the local key allows the index to be rebuilt by
+/// listing the cache kvstore, without reading every entry.  Since each stored
+/// entry has a distinct local key, deleting a replaced or evicted entry never
+/// removes a more recently stored entry for the same hash.
+///
+/// The stored entry consists of a header, specifying the key and the
+/// `StorageGeneration` of the cached value, followed by the value itself.
+
+#include <stdint.h>
+
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_disk_cache {
+
+/// Returns the hex-encoded SHA-256 hash identifying `key` of the base kvstore
+/// identified by `base_identifier`.
+std::string GetKeyHash(std::string_view base_identifier, std::string_view key);
+
+/// Returns the local key under which an entry of `size` bytes for `hash` is
+/// stored.  The `id` must be chosen randomly for each stored entry.
+std::string GetLocalKey(std::string_view hash, uint64_t size, uint64_t id);
+
+/// Parses a local key returned by `GetLocalKey`.  Returns `false` if
+/// `local_key` is not in the expected format.
+bool ParseLocalKey(std::string_view local_key, std::string& hash,
+                   uint64_t& size);
+
+/// Decoded representation of a stored entry.
+struct DecodedEntry {
+  std::string key;
+  StorageGeneration generation;
+  absl::Cord value;
+};
+
+/// Encodes an entry to be stored in the cache kvstore.
+absl::Cord EncodeEntry(std::string_view key,
+                       const StorageGeneration& generation,
+                       const absl::Cord& value);
+
+/// Decodes an entry encoded by `EncodeEntry`.
+Result<DecodedEntry> DecodeEntry(const absl::Cord& encoded);
+
+/// Index entry for a cached value.
+struct IndexEntry {
+  /// Key in the cache kvstore.
+  std::string local_key;
+
+  /// Size of the stored entry.
+  uint64_t size = 0;
+
+  /// Key in the base kvstore, if known.  Entries found by listing the cache
+  /// kvstore when the driver is opened have an unknown key until they are
+  /// read.
+  std::optional<std::string> key;
+
+  /// Generation of the cached value, or `StorageGeneration::Unknown()` if it
+  /// has not been read since the driver was opened.
+  StorageGeneration generation;
+
+  /// Time as of which `generation` is known to be current in the base
+  /// kvstore.
+  absl::Time time = absl::InfinitePast();
+};
+
+/// Tracks the entries of the cache kvstore, and selects the least recently
+/// used entries for eviction once their total size exceeds a limit.
+///
+/// Entries are identified by the hash returned by `GetKeyHash`.
+///
+/// This class is thread-safe.
+class DiskCacheIndex {
+ public:
+  explicit DiskCacheIndex(uint64_t total_bytes_limit)
+      : total_bytes_limit_(total_bytes_limit) {}
+
+  uint64_t total_bytes_limit() const { return total_bytes_limit_; }
+
+  /// Returns the total size of the indexed entries.
+  uint64_t total_bytes() const;
+
+  /// Returns the entry for `hash`, if any, and marks it most recently used.
+  std::optional<IndexEntry> Find(std::string_view hash);
+
+  /// Adds or replaces the entry for `hash`.
+  ///
+  /// Returns the local keys of the entries that are no longer indexed, and
+  /// should be deleted from the cache kvstore: the replaced entry, if stored
+  /// under a different local key, and any entries evicted to satisfy the
+  /// limit.
+  std::vector<std::string> Insert(std::string hash, IndexEntry entry);
+
+  /// Removes the entry for `hash` if it is stored under `local_key`.
+  ///
+  /// Returns `true` if the entry was removed.
+  bool Erase(std::string_view hash, std::string_view local_key);
+
+  /// Records that the entry for `hash`, if stored under `local_key`, holds
+  /// `key` with `generation`, which is current as of `time`.
+  void UpdateValidation(std::string_view hash, std::string_view local_key,
+                        std::string_view key,
+                        const StorageGeneration& generation, absl::Time time);
+
+  /// Removes the entries with a known key in `range`.  Entries with an
+  /// unknown key have not been validated, and are always revalidated before
+  /// use.
+  ///
+  /// Returns the local keys of the removed entries.
+  std::vector<std::string> EraseRange(const KeyRange& range);
+
+ private:
+  struct Entry {
+    IndexEntry info;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  void EraseLocked(absl::flat_hash_map<std::string, Entry>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const uint64_t total_bytes_limit_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+
+  /// Hashes of `entries_`, least recently used first.
+  std::list<std::string> lru_ ABSL_GUARDED_BY(mutex_);
+
+  uint64_t total_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace internal_disk_cache
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_DISK_CACHE_DISK_CACHE_INDEX_H_
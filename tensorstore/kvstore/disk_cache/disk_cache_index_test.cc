@@ -0,0 +1,226 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/disk_cache/disk_cache_index.h"
+
+#include <stdint.h>
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+using ::tensorstore::KeyRange;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::internal_disk_cache::DecodeEntry;
+using ::tensorstore::internal_disk_cache::DiskCacheIndex;
+using ::tensorstore::internal_disk_cache::EncodeEntry;
+using ::tensorstore::internal_disk_cache::GetKeyHash;
+using ::tensorstore::internal_disk_cache::GetLocalKey;
+using ::tensorstore::internal_disk_cache::IndexEntry;
+using ::tensorstore::internal_disk_cache::ParseLocalKey;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+using ::testing::UnorderedElementsAre;
+
+IndexEntry MakeEntry(const std::string& hash, uint64_t size,
+                     std::string key = "") {
+  IndexEntry entry;
+  entry.local_key = GetLocalKey(hash, size, 1);
+  entry.size = size;
+  if (!key.empty()) entry.key = std::move(key);
+  return entry;
+}
+
+TEST(DiskCacheIndexTest, KeyHash) {
+  auto hash = GetKeyHash("base", "key");
+  EXPECT_EQ(64, hash.size());
+  EXPECT_EQ(hash, GetKeyHash("base", "key"));
+  EXPECT_NE(hash, GetKeyHash("base", "key2"));
+  EXPECT_NE(hash, GetKeyHash("other", "key"));
+  // The identifier is length-prefixed.
+  EXPECT_NE(GetKeyHash("ab", "c"), GetKeyHash("a", "bc"));
+}
+
+TEST(DiskCacheIndexTest, LocalKeyRoundtrip) {
+  auto hash = GetKeyHash("base", "key");
+  auto local_key = GetLocalKey(hash, 12345, 0xabcdef);
+  EXPECT_EQ(hash.substr(0, 2), local_key.substr(0, 2));
+  EXPECT_EQ('/', local_key[2]);
+  std::string parsed_hash;
+  uint64_t parsed_size;
+  ASSERT_TRUE(ParseLocalKey(local_key, parsed_hash, parsed_size));
+  EXPECT_EQ(hash, parsed_hash);
+  EXPECT_EQ(12345, parsed_size);
+}
+
+TEST(DiskCacheIndexTest, ParseLocalKeyInvalid) {
+  auto local_key = GetLocalKey(GetKeyHash("base", "key"), 10, 1);
+  std::string hash;
+  uint64_t size;
+  EXPECT_FALSE(ParseLocalKey("", hash, size));
+  EXPECT_FALSE(ParseLocalKey(local_key.substr(0, 64), hash, size));
+  EXPECT_FALSE(ParseLocalKey(local_key + "x", hash, size));
+  EXPECT_FALSE(ParseLocalKey(local_key.substr(0, local_key.size() - 17),
+                             hash, size));
+  EXPECT_FALSE(ParseLocalKey("zz" + local_key.substr(2), hash, size));
+  EXPECT_FALSE(ParseLocalKey(local_key.substr(0, 2) + "_" +
+                                 local_key.substr(3),
+                             hash, size));
+}
+
+TEST(DiskCacheIndexTest, EncodeDecodeRoundtrip) {
+  auto generation = StorageGeneration::FromString("abc");
+  auto encoded = EncodeEntry("key", generation, absl::Cord("value"));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto decoded, DecodeEntry(encoded));
+  EXPECT_EQ("key", decoded.key);
+  EXPECT_EQ(generation, decoded.generation);
+  EXPECT_EQ("value", decoded.value);
+}
+
+TEST(DiskCacheIndexTest, DecodeEmptyValue) {
+  auto encoded =
+      EncodeEntry("", StorageGeneration::FromString("g"), absl::Cord());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto decoded, DecodeEntry(encoded));
+  EXPECT_EQ("", decoded.key);
+  EXPECT_EQ("", decoded.value);
+}
+
+TEST(DiskCacheIndexTest, DecodeInvalid) {
+  EXPECT_THAT(DecodeEntry(absl::Cord()),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+  EXPECT_THAT(DecodeEntry(absl::Cord("tsdx\x01")),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+  auto encoded = EncodeEntry("key", StorageGeneration::FromString("abc"),
+                             absl::Cord("value"));
+  // Truncated within the generation.
+  EXPECT_THAT(DecodeEntry(encoded.Subcord(0, 10)),
+              MatchesStatus(absl::StatusCode::kDataLoss));
+}
+
+TEST(DiskCacheIndexTest, FindInsertErase) {
+  DiskCacheIndex index(1000);
+  auto hash = GetKeyHash("base", "a");
+  EXPECT_EQ(std::nullopt, index.Find(hash));
+  EXPECT_THAT(index.Insert(hash, MakeEntry(hash, 10, "a")), IsEmpty());
+  EXPECT_EQ(10, index.total_bytes());
+  auto entry = index.Find(hash);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(GetLocalKey(hash, 10, 1), entry->local_key);
+  EXPECT_THAT(entry->key, Optional(std::string("a")));
+
+  // Erasing with a different local key has no effect.
+  EXPECT_FALSE(index.Erase(hash, GetLocalKey(hash, 11, 1)));
+  EXPECT_TRUE(index.Erase(hash, GetLocalKey(hash, 10, 1)));
+  EXPECT_EQ(std::nullopt, index.Find(hash));
+  EXPECT_EQ(0, index.total_bytes());
+}
+
+TEST(DiskCacheIndexTest, Replace) {
+  DiskCacheIndex index(1000);
+  auto hash = GetKeyHash("base", "a");
+  EXPECT_THAT(index.Insert(hash, MakeEntry(hash, 10)), IsEmpty());
+  // Same local key: nothing to delete.
+  EXPECT_THAT(index.Insert(hash, MakeEntry(hash, 10)), IsEmpty());
+  EXPECT_THAT(index.Insert(hash, MakeEntry(hash, 20)),
+              ElementsAre(GetLocalKey(hash, 10, 1)));
+  EXPECT_EQ(20, index.total_bytes());
+}
+
+TEST(DiskCacheIndexTest, EvictsLeastRecentlyUsed) {
+  DiskCacheIndex index(30);
+  auto a = GetKeyHash("base", "a");
+  auto b = GetKeyHash("base", "b");
+  auto c = GetKeyHash("base", "c");
+  auto d = GetKeyHash("base", "d");
+  EXPECT_THAT(index.Insert(a, MakeEntry(a, 10)), IsEmpty());
+  EXPECT_THAT(index.Insert(b, MakeEntry(b, 10)), IsEmpty());
+  EXPECT_THAT(index.Insert(c, MakeEntry(c, 10)), IsEmpty());
+  // Marks `a` as most recently used.
+  EXPECT_TRUE(index.Find(a));
+  EXPECT_THAT(index.Insert(d, MakeEntry(d, 15)),
+              UnorderedElementsAre(GetLocalKey(b, 10, 1),
+                                   GetLocalKey(c, 10, 1)));
+  EXPECT_EQ(25, index.total_bytes());
+  EXPECT_TRUE(index.Find(a));
+  EXPECT_FALSE(index.Find(b));
+  EXPECT_FALSE(index.Find(c));
+  EXPECT_TRUE(index.Find(d));
+}
+
+TEST(DiskCacheIndexTest, NeverEvictsInsertedEntry) {
+  DiskCacheIndex index(10);
+  auto a = GetKeyHash("base", "a");
+  auto b = GetKeyHash("base", "b");
+  EXPECT_THAT(index.Insert(a, MakeEntry(a, 5)), IsEmpty());
+  EXPECT_THAT(index.Insert(b, MakeEntry(b, 20)),
+              ElementsAre(GetLocalKey(a, 5, 1)));
+  EXPECT_TRUE(index.Find(b));
+  EXPECT_EQ(20, index.total_bytes());
+}
+
+TEST(DiskCacheIndexTest, UpdateValidation) {
+  DiskCacheIndex index(1000);
+  auto hash = GetKeyHash("base", "a");
+  index.Insert(hash, MakeEntry(hash, 10));
+  auto generation = StorageGeneration::FromString("g");
+  auto t1 = absl::FromUnixSeconds(100);
+  auto t2 = absl::FromUnixSeconds(200);
+
+  // Ignored if the local key does not match.
+  index.UpdateValidation(hash, GetLocalKey(hash, 11, 1), "a", generation, t1);
+  EXPECT_EQ(std::nullopt, index.Find(hash)->key);
+
+  index.UpdateValidation(hash, GetLocalKey(hash, 10, 1), "a", generation, t2);
+  auto entry = index.Find(hash);
+  EXPECT_THAT(entry->key, Optional(std::string("a")));
+  EXPECT_EQ(generation, entry->generation);
+  EXPECT_EQ(t2, entry->time);
+
+  // An older validation of the same generation does not decrease the time.
+  index.UpdateValidation(hash, GetLocalKey(hash, 10, 1), "a", generation, t1);
+  EXPECT_EQ(t2, index.Find(hash)->time);
+}
+
+TEST(DiskCacheIndexTest, EraseRange) {
+  DiskCacheIndex index(1000);
+  auto a = GetKeyHash("base", "a");
+  auto b = GetKeyHash("base", "b");
+  auto c = GetKeyHash("base", "c");
+  auto unknown = GetKeyHash("base", "bb");
+  index.Insert(a, MakeEntry(a, 10, "a"));
+  index.Insert(b, MakeEntry(b, 10, "b"));
+  index.Insert(c, MakeEntry(c, 10, "c"));
+  index.Insert(unknown, MakeEntry(unknown, 10));
+  EXPECT_THAT(index.EraseRange(KeyRange("b", "c")),
+              ElementsAre(GetLocalKey(b, 10, 1)));
+  EXPECT_TRUE(index.Find(a));
+  EXPECT_FALSE(index.Find(b));
+  EXPECT_TRUE(index.Find(c));
+  // Entries with an unknown key are retained.
+  EXPECT_TRUE(index.Find(unknown));
+  EXPECT_EQ(30, index.total_bytes());
+}
+
+}  // namespace
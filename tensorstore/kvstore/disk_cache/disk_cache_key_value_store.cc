@@ -0,0 +1,526 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// Key-value store adapter that caches the values read from a base kvstore,
+/// typically a remote store, in a second kvstore, typically on local disk.
+///
+/// Reads are served from the cache kvstore if the cached value is known to be
+/// current as of the requested `staleness_bound`.  Otherwise, the cached value
+/// is revalidated by a read of the base kvstore conditioned on
+/// `if_not_equal` the cached generation, which avoids transferring the value
+/// again if it is unchanged.  Writes and deletes are applied to the base
+/// kvstore and then to the cache.
+///
+/// Only reads of entire values are added to the cache; byte range reads of
+/// cached values are served from the cache.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/absl_log.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/batch.h"
+#include "tensorstore/context.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/json_binding.h"
+#include "tensorstore/internal/log/verbose_flag.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/disk_cache/disk_cache_index.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/registry.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/supported_features.h"
+#include "tensorstore/transaction.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/garbage_collection/fwd.h"
+#include "tensorstore/util/quote_string.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/status.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace {
+
+namespace jb = tensorstore::internal_json_binding;
+
+using ::tensorstore::internal_disk_cache::DecodeEntry;
+using ::tensorstore::internal_disk_cache::DiskCacheIndex;
+using ::tensorstore::internal_disk_cache::EncodeEntry;
+using ::tensorstore::internal_disk_cache::GetKeyHash;
+using ::tensorstore::internal_disk_cache::GetLocalKey;
+using ::tensorstore::internal_disk_cache::IndexEntry;
+using ::tensorstore::internal_disk_cache::ParseLocalKey;
+using ::tensorstore::kvstore::ListReceiver;
+using ::tensorstore::kvstore::ReadResult;
+
+ABSL_CONST_INIT internal_log::VerboseFlag disk_cache_logging("disk_cache");
+
+auto& disk_cache_hit = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/hit",
+    "disk_cache reads served from the cache without contacting the base");
+auto& disk_cache_revalidated = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/revalidated",
+    "disk_cache reads served from the cache after revalidation");
+auto& disk_cache_miss = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/miss",
+    "disk_cache reads that fetched the value from the base");
+auto& disk_cache_evict = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/disk_cache/evict",
+    "disk_cache entries removed from the cache");
+
+// -----------------------------------------------------------------------------
+
+struct DiskCacheKvStoreSpecData {
+  kvstore::Spec base;
+  kvstore::Spec cache;
+  uint64_t total_bytes_limit;
+
+  constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+    return f(x.base, x.cache, x.total_bytes_limit);
+  };
+
+  constexpr static auto default_json_binder = jb::Object(
+      jb::Member("base", jb::Projection<&DiskCacheKvStoreSpecData::base>()),
+      jb::Member("cache", jb::Projection<&DiskCacheKvStoreSpecData::cache>()),
+      jb::Member(
+          "total_bytes_limit",
+          jb::Projection<&DiskCacheKvStoreSpecData::total_bytes_limit>()) /**/
+  );
+};
+
+class DiskCacheKvStoreSpec
+    : public internal_kvstore::RegisteredDriverSpec<DiskCacheKvStoreSpec,
+                                                    DiskCacheKvStoreSpecData> {
+ public:
+  static constexpr char id[] = "disk_cache";
+
+  Future<kvstore::DriverPtr> DoOpen() const override;
+
+  absl::Status ApplyOptions(kvstore::DriverSpecOptions&& options) override {
+    return data_.base.driver.Set(std::move(options));
+  }
+
+  Result<kvstore::Spec> GetBase(std::string_view path) const override {
+    auto base = data_.base;
+    base.AppendSuffix(path);
+    return base;
+  }
+};
+
+/// Defines the "disk_cache" key value store.
+class DiskCacheKvStore
+    : public internal_kvstore::RegisteredDriver<DiskCacheKvStore,
+                                                DiskCacheKvStoreSpec> {
+ public:
+  explicit DiskCacheKvStore(uint64_t total_bytes_limit)
+      : total_bytes_limit_(total_bytes_limit), index_(total_bytes_limit) {}
+
+  Future<ReadResult> Read(Key key, ReadOptions options) override;
+
+  Future<TimestampedStorageGeneration> Write(Key key,
+                                            std::optional<Value> value,
+                                            WriteOptions options) override;
+
+  Future<const void> DeleteRange(KeyRange range) override;
+
+  void ListImpl(ListOptions options, ListReceiver receiver) override {
+    kvstore::List(base_, std::move(options), std::move(receiver));
+  }
+
+  std::string DescribeKey(std::string_view key) override {
+    return base_.driver->DescribeKey(tensorstore::StrCat(base_.path, key));
+  }
+
+  absl::Status GetBoundSpecData(DiskCacheKvStoreSpecData& spec) const {
+    TENSORSTORE_ASSIGN_OR_RETURN(spec.base.driver,
+                                 base_.driver->GetBoundSpec());
+    spec.base.path = base_.path;
+    TENSORSTORE_ASSIGN_OR_RETURN(spec.cache.driver,
+                                 cache_.driver->GetBoundSpec());
+    spec.cache.path = cache_.path;
+    spec.total_bytes_limit = total_bytes_limit_;
+    return absl::OkStatus();
+  }
+
+  kvstore::SupportedFeatures GetSupportedFeatures(
+      const KeyRange& key_range) const final {
+    return base_.driver->GetSupportedFeatures(
+        KeyRange::AddPrefix(base_.path, key_range));
+  }
+
+  Result<KvStore> GetBase(std::string_view path,
+                          const Transaction& transaction) const override {
+    return KvStore(base_.driver, tensorstore::StrCat(base_.path, path),
+                   transaction);
+  }
+
+  /// Adds the entries listed from the cache kvstore to the index.
+  void RebuildIndex(const std::vector<kvstore::ListEntry>& entries);
+
+  /// Adds `value` of `key`, which has the specified `stamp`, to the cache.
+  void Store(std::string key, std::string hash, const absl::Cord& value,
+             TimestampedStorageGeneration stamp);
+
+  /// Removes the entry for `hash` stored under `local_key` from the cache.
+  void Evict(std::string_view hash, const std::string& local_key);
+
+  /// Deletes entries that are no longer indexed from the cache kvstore.
+  void DeleteUnreferenced(std::vector<std::string> local_keys);
+
+  /// Returns a random identifier for a newly stored entry.
+  uint64_t NewEntryId() {
+    absl::MutexLock lock(&id_mutex_);
+    return absl::Uniform<uint64_t>(id_gen_);
+  }
+
+  uint64_t total_bytes_limit_;
+  kvstore::KvStore base_;
+  kvstore::KvStore cache_;
+
+  /// Identifies `base_` in the hashes of cached keys.
+  std::string base_identifier_;
+
+  DiskCacheIndex index_;
+
+  absl::Mutex id_mutex_;
+  absl::BitGen id_gen_ ABSL_GUARDED_BY(id_mutex_);
+};
+
+Future<kvstore::DriverPtr> DiskCacheKvStoreSpec::DoOpen() const {
+  auto driver =
+      internal::MakeIntrusivePtr<DiskCacheKvStore>(data_.total_bytes_limit);
+  return PromiseFuturePair<kvstore::DriverPtr>::LinkValue(
+             [driver](Promise<kvstore::DriverPtr> promise,
+                      ReadyFuture<KvStore> base_future,
+                      ReadyFuture<KvStore> cache_future) {
+               auto& base = base_future.value();
+               auto base_spec = base.spec(tensorstore::strip_context);
+               if (!base_spec.ok()) {
+                 promise.SetResult(base_spec.status());
+                 return;
+               }
+               auto base_json = base_spec->ToJson();
+               if (!base_json.ok()) {
+                 promise.SetResult(base_json.status());
+                 return;
+               }
+               driver->base_identifier_ = base_json->dump();
+               driver->base_ = std::move(base);
+               driver->cache_ = std::move(cache_future.value());
+               // Rebuild the index from the entries already present in the
+               // cache kvstore.
+               LinkValue(
+                   [driver](Promise<kvstore::DriverPtr> promise,
+                            ReadyFuture<std::vector<kvstore::ListEntry>>
+                                future) {
+                     driver->RebuildIndex(future.value());
+                     promise.SetResult(driver);
+                   },
+                   std::move(promise), kvstore::ListFuture(driver->cache_));
+             },
+             kvstore::Open(data_.base), kvstore::Open(data_.cache))
+      .future;
+}
+
+void DiskCacheKvStore::RebuildIndex(
+    const std::vector<kvstore::ListEntry>& entries) {
+  std::vector<std::string> unreferenced;
+  for (const auto& entry : entries) {
+    std::string hash;
+    uint64_t size;
+    if (!ParseLocalKey(entry.key, hash, size)) continue;
+    IndexEntry index_entry;
+    index_entry.local_key = entry.key;
+    index_entry.size = size;
+    auto evicted = index_.Insert(std::move(hash), std::move(index_entry));
+    unreferenced.insert(unreferenced.end(),
+                        std::make_move_iterator(evicted.begin()),
+                        std::make_move_iterator(evicted.end()));
+  }
+  DeleteUnreferenced(std::move(unreferenced));
+}
+
+void DiskCacheKvStore::Store(std::string key, std::string hash,
+                             const absl::Cord& value,
+                             TimestampedStorageGeneration stamp) {
+  absl::Cord encoded = EncodeEntry(key, stamp.generation, value);
+  if (encoded.size() > index_.total_bytes_limit()) return;
+  IndexEntry entry;
+  entry.local_key = GetLocalKey(hash, encoded.size(), NewEntryId());
+  entry.size = encoded.size();
+  entry.key = std::move(key);
+  entry.generation = std::move(stamp.generation);
+  entry.time = stamp.time;
+  auto local_key = entry.local_key;
+  kvstore::Write(cache_, local_key, std::move(encoded))
+      .ExecuteWhenReady(
+          [self = internal::IntrusivePtr<DiskCacheKvStore>(this),
+           hash = std::move(hash), entry = std::move(entry)](
+              ReadyFuture<TimestampedStorageGeneration> future) mutable {
+            if (!future.status().ok()) {
+              ABSL_LOG_IF(INFO, disk_cache_logging)
+                  << "Failed to write " << QuoteString(entry.local_key)
+                  << " to cache: " << future.status();
+              return;
+            }
+            self->DeleteUnreferenced(
+                self->index_.Insert(std::move(hash), std::move(entry)));
+          });
+}
+
+void DiskCacheKvStore::Evict(std::string_view hash,
+                             const std::string& local_key) {
+  if (!index_.Erase(hash, local_key)) return;
+  DeleteUnreferenced({local_key});
+}
+
+void DiskCacheKvStore::DeleteUnreferenced(std::vector<std::string> local_keys) {
+  for (auto& local_key : local_keys) {
+    disk_cache_evict.Increment();
+    // Failure to delete only wastes space until the index is rebuilt.  Since
+    // local keys are never reused, this cannot delete a newer entry.
+    kvstore::Delete(cache_, local_key).IgnoreFuture();
+  }
+}
+
+/// Implements `DiskCacheKvStore::Read`.
+struct ReadState : public internal::AtomicReferenceCount<ReadState> {
+  internal::IntrusivePtr<DiskCacheKvStore> owner;
+  kvstore::Key key;
+  kvstore::ReadOptions options;
+  std::string hash;
+
+  // Set once the cached entry has been read.
+  std::optional<IndexEntry> entry;
+  StorageGeneration cached_generation;
+  absl::Cord cached_value;
+
+  /// Starts the read.  The `batch`, which is not retained in `options`, only
+  /// applies to the reads issued immediately: holding it until a later read
+  /// of the base kvstore is issued would prevent the batch from being
+  /// submitted.
+  void Start(Promise<ReadResult> promise, Batch batch) {
+    entry = owner->index_.Find(hash);
+    if (!entry) {
+      kvstore::ReadOptions base_options = options;
+      base_options.batch = std::move(batch);
+      ReadBase(std::move(promise), std::move(base_options),
+               /*revalidate=*/false);
+      return;
+    }
+    kvstore::ReadOptions cache_options;
+    cache_options.batch = std::move(batch);
+    Link(
+        [self = internal::IntrusivePtr<ReadState>(this)](
+            Promise<ReadResult> promise, ReadyFuture<ReadResult> future) {
+          self->OnCacheRead(std::move(promise), future.result());
+        },
+        std::move(promise),
+        kvstore::Read(owner->cache_, entry->local_key,
+                      std::move(cache_options)));
+  }
+
+  void OnCacheRead(Promise<ReadResult> promise, Result<ReadResult>& result) {
+    if (!promise.result_needed()) return;
+    absl::Status status;
+    if (!result.ok()) {
+      status = result.status();
+    } else if (!result->has_value()) {
+      status = absl::NotFoundError("Entry missing from cache");
+    } else if (auto decoded = DecodeEntry(result->value); !decoded.ok()) {
+      status = decoded.status();
+    } else if (decoded->key != key) {
+      status = absl::DataLossError("Key mismatch in cache entry");
+    } else {
+      cached_generation = std::move(decoded->generation);
+      cached_value = std::move(decoded->value);
+    }
+    if (!status.ok()) {
+      ABSL_LOG_IF(INFO, disk_cache_logging)
+          << "Failed to read " << QuoteString(entry->local_key)
+          << " from cache: " << status;
+      owner->Evict(hash, entry->local_key);
+      entry.reset();
+      ReadBase(std::move(promise), options, /*revalidate=*/false);
+      return;
+    }
+
+    if (entry->generation == cached_generation &&
+        entry->time >= options.staleness_bound) {
+      disk_cache_hit.Increment();
+      ServeCached(std::move(promise), {cached_generation, entry->time});
+      return;
+    }
+
+    // Only transfer the value from the base kvstore if it has changed.
+    kvstore::ReadOptions base_options = options;
+    base_options.if_not_equal = cached_generation;
+    ReadBase(std::move(promise), std::move(base_options), /*revalidate=*/true);
+  }
+
+  void ReadBase(Promise<ReadResult> promise, kvstore::ReadOptions base_options,
+                bool revalidate) {
+    Link(
+        [self = internal::IntrusivePtr<ReadState>(this), revalidate](
+            Promise<ReadResult> promise, ReadyFuture<ReadResult> future) {
+          self->OnBaseRead(std::move(promise), future.result(), revalidate);
+        },
+        std::move(promise),
+        kvstore::Read(owner->base_, key, std::move(base_options)));
+  }
+
+  void OnBaseRead(Promise<ReadResult> promise, Result<ReadResult>& result,
+                  bool revalidate) {
+    if (!result.ok()) {
+      promise.SetResult(result.status());
+      return;
+    }
+    ReadResult& read_result = *result;
+    if (revalidate) {
+      if (read_result.aborted() &&
+          read_result.stamp.generation == cached_generation) {
+        // Cached value is unchanged.
+        disk_cache_revalidated.Increment();
+        owner->index_.UpdateValidation(hash, entry->local_key, key,
+                                       cached_generation,
+                                       read_result.stamp.time);
+        ServeCached(std::move(promise), std::move(read_result.stamp));
+        return;
+      }
+      owner->Evict(hash, entry->local_key);
+    }
+    disk_cache_miss.Increment();
+    if (read_result.has_value() && options.byte_range.IsFull()) {
+      owner->Store(key, hash, read_result.value, read_result.stamp);
+      if (options.if_not_equal == read_result.stamp.generation) {
+        // `options.if_not_equal` was replaced by the cached generation.
+        read_result = ReadResult::Unspecified(std::move(read_result.stamp));
+      }
+    }
+    promise.SetResult(std::move(read_result));
+  }
+
+  // Completes the read from `cached_value`, which is current as of `stamp`.
+  void ServeCached(Promise<ReadResult> promise,
+                   TimestampedStorageGeneration stamp) {
+    if (options.if_not_equal == stamp.generation ||
+        (!StorageGeneration::IsUnknown(options.if_equal) &&
+         options.if_equal != stamp.generation)) {
+      promise.SetResult(ReadResult::Unspecified(std::move(stamp)));
+      return;
+    }
+    auto byte_range = options.byte_range.Validate(cached_value.size());
+    if (!byte_range.ok()) {
+      promise.SetResult(byte_range.status());
+      return;
+    }
+    promise.SetResult(ReadResult::Value(
+        internal::GetSubCord(cached_value, *byte_range), std::move(stamp)));
+  }
+};
+
+Future<ReadResult> DiskCacheKvStore::Read(Key key, ReadOptions options) {
+  auto state = internal::MakeIntrusivePtr<ReadState>();
+  state->owner = internal::IntrusivePtr<DiskCacheKvStore>(this);
+  state->hash = GetKeyHash(base_identifier_, key);
+  state->key = std::move(key);
+  Batch batch = std::move(options.batch);
+  options.batch = no_batch;
+  state->options = std::move(options);
+  auto [promise, future] = PromiseFuturePair<ReadResult>::Make();
+  state->Start(std::move(promise), std::move(batch));
+  return std::move(future);
+}
+
+// `Write` and `DeleteRange` update the cache from a callback passed to
+// `MapFuture`, such that dropping the returned future cancels the base
+// operation.  If the callback is skipped for that reason, the cache may retain
+// entries for the old values; these are only served to reads whose staleness
+// bound permits it, and are otherwise revalidated against the base kvstore.
+
+Future<TimestampedStorageGeneration> DiskCacheKvStore::Write(
+    Key key, std::optional<Value> value, WriteOptions options) {
+  auto future = kvstore::Write(base_, key, value, std::move(options));
+  return MapFuture(
+      InlineExecutor{},
+      [self = internal::IntrusivePtr<DiskCacheKvStore>(this),
+       key = std::move(key), value = std::move(value)](
+          const Result<TimestampedStorageGeneration>& result) mutable
+      -> Result<TimestampedStorageGeneration> {
+        if (result.ok() && StorageGeneration::IsUnknown(result->generation)) {
+          // Condition not satisfied; the base kvstore is unchanged.
+          return result;
+        }
+        auto hash = GetKeyHash(self->base_identifier_, key);
+        if (auto entry = self->index_.Find(hash)) {
+          self->Evict(hash, entry->local_key);
+        }
+        if (result.ok() && value) {
+          self->Store(std::move(key), std::move(hash), *value, *result);
+        }
+        return result;
+      },
+      std::move(future));
+}
+
+Future<const void> DiskCacheKvStore::DeleteRange(KeyRange range) {
+  auto future = kvstore::DeleteRange(base_, range);
+  // Remove cached entries once the range has been deleted, so that they are
+  // not re-added by concurrent reads that observed the old values.
+  return MapFuture(
+      InlineExecutor{},
+      [self = internal::IntrusivePtr<DiskCacheKvStore>(this),
+       range = std::move(range)](const Result<void>& result) {
+        self->DeleteUnreferenced(self->index_.EraseRange(range));
+        return result;
+      },
+      std::move(future));
+}
+
+}  // namespace
+}  // namespace tensorstore
+
+TENSORSTORE_DECLARE_GARBAGE_COLLECTION_NOT_REQUIRED(
+    tensorstore::DiskCacheKvStore)
+
+// Registers the driver.
+namespace {
+const tensorstore::internal_kvstore::DriverRegistration<
+    tensorstore::DiskCacheKvStoreSpec>
+    registration;
+
+}  // namespace
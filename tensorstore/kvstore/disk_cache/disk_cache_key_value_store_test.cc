@@ -0,0 +1,346 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/batch.h"
+#include "tensorstore/context.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/test_matchers.h"
+#include "tensorstore/kvstore/test_util.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::Batch;
+using ::tensorstore::Context;
+using ::tensorstore::KvStore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesKvsReadResultNotFound;
+using ::tensorstore::internal::MockKeyValueStoreResource;
+using ::testing::SizeIs;
+
+class DiskCacheKeyValueStoreTest : public ::testing::Test {
+ public:
+  ::nlohmann::json GetSpec(size_t total_bytes_limit = 1000000) {
+    return {{"driver", "disk_cache"},
+            {"base", "memory://base/"},
+            {"cache", "memory://cache/"},
+            {"total_bytes_limit", total_bytes_limit}};
+  }
+
+  KvStore Open(size_t total_bytes_limit = 1000000) {
+    auto store = kvstore::Open(GetSpec(total_bytes_limit), context).result();
+    EXPECT_TRUE(store.ok()) << store.status();
+    return *store;
+  }
+
+  KvStore OpenMemory(std::string path) {
+    auto store = kvstore::Open({{"driver", "memory"}, {"path", path}}, context)
+                     .result();
+    EXPECT_TRUE(store.ok()) << store.status();
+    return *store;
+  }
+
+  // Returns the number of entries in the cache kvstore, once the asynchronous
+  // updates have completed.
+  size_t GetCacheEntryCount(size_t expected) {
+    auto cache = OpenMemory("cache/");
+    size_t count = 0;
+    for (int i = 0; i < 1000; ++i) {
+      auto entries = kvstore::ListFuture(cache).result();
+      EXPECT_TRUE(entries.ok());
+      count = entries->size();
+      if (count == expected) break;
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+    return count;
+  }
+
+  Context context = Context::Default();
+};
+
+TEST_F(DiskCacheKeyValueStoreTest, Basic) {
+  auto store = Open();
+  tensorstore::internal::TestKeyValueReadWriteOps(store);
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeleteRange) {
+  auto store = Open();
+  tensorstore::internal::TestKeyValueStoreDeleteRange(store);
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, DeletePrefix) {
+  auto store = Open();
+  tensorstore::internal::TestKeyValueStoreDeletePrefix(store);
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, List) {
+  auto store = Open();
+  tensorstore::internal::TestKeyValueStoreList(store);
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, ReadPopulatesCache) {
+  auto base = OpenMemory("base/");
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  auto store = Open();
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  EXPECT_EQ(1, GetCacheEntryCount(1));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, ServesCachedValueWithinStalenessBound) {
+  auto base = OpenMemory("base/");
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(base, "a", absl::Cord("abc")).result());
+  auto store = Open();
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc"), stamp.generation));
+  ASSERT_EQ(1, GetCacheEntryCount(1));
+
+  // Modify the base kvstore directly, bypassing the cache.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("xyz")));
+
+  kvstore::ReadOptions options;
+  options.staleness_bound = absl::InfinitePast();
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("abc"), stamp.generation));
+
+  options.byte_range = tensorstore::OptionalByteRangeRequest::Range(1, 2);
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("b"), stamp.generation));
+
+  // A read with the default staleness bound revalidates the cached value.
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, ReplacedEntryUsesNewLocalKey) {
+  auto base = OpenMemory("base/");
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  auto store = Open();
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  ASSERT_EQ(1, GetCacheEntryCount(1));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto old_entries, kvstore::ListFuture(OpenMemory("cache/")).result());
+
+  // The replacement entry has the same size as the evicted entry, but is
+  // stored under a distinct local key, such that the asynchronous deletion of
+  // the evicted entry cannot remove it.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("xyz")));
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+  ASSERT_EQ(1, GetCacheEntryCount(1));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto new_entries, kvstore::ListFuture(OpenMemory("cache/")).result());
+  ASSERT_THAT(old_entries, SizeIs(1));
+  ASSERT_THAT(new_entries, SizeIs(1));
+  EXPECT_NE(old_entries[0].key, new_entries[0].key);
+
+  // Served from the cache without revalidation.
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(base, "a"));
+  kvstore::ReadOptions options;
+  options.staleness_bound = absl::InfinitePast();
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("xyz")));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, RevalidatesDeletedValue) {
+  auto base = OpenMemory("base/");
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  auto store = Open();
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  ASSERT_EQ(1, GetCacheEntryCount(1));
+
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(base, "a"));
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResultNotFound());
+  EXPECT_EQ(0, GetCacheEntryCount(0));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, BatchedReadOverBatchingDriver) {
+  auto base = OpenMemory("");
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto mock_key_value_store,
+      context.GetResource<MockKeyValueStoreResource>());
+  (*mock_key_value_store)->batch_reads = true;
+  (*mock_key_value_store)->forward_to = base.driver;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "disk_cache"},
+                     {"base", {{"driver", "mock_key_value_store"}}},
+                     {"cache", "memory://cache/"},
+                     {"total_bytes_limit", 1000000}},
+                    context)
+          .result());
+
+  // The first read populates the cache; the second revalidates the cached
+  // value with a read of the base kvstore that is issued only after the
+  // cache kvstore has been read.  Neither may prevent the batch from being
+  // submitted.
+  for (int i = 0; i < 2; ++i) {
+    auto batch = Batch::New();
+    kvstore::ReadOptions options;
+    options.batch = batch;
+    auto future = kvstore::Read(store, "a", std::move(options));
+    batch.Release();
+    ASSERT_TRUE(future.WaitFor(absl::Seconds(10))) << i;
+    EXPECT_THAT(future.result(), MatchesKvsReadResult(absl::Cord("abc"))) << i;
+    ASSERT_EQ(1, GetCacheEntryCount(1));
+  }
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, WriteThrough) {
+  auto store = Open();
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "a", absl::Cord("abc")));
+  EXPECT_EQ(1, GetCacheEntryCount(1));
+  EXPECT_THAT(kvstore::Read(OpenMemory("base/"), "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(store, "a"));
+  EXPECT_EQ(0, GetCacheEntryCount(0));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, WriteNotNeeded) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto mock_key_value_store,
+      context.GetResource<MockKeyValueStoreResource>());
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "disk_cache"},
+                     {"base", {{"driver", "mock_key_value_store"}}},
+                     {"cache", "memory://cache/"},
+                     {"total_bytes_limit", 1000000}},
+                    context)
+          .result());
+
+  // Dropping the returned futures cancels the base operations.
+  auto write_future = kvstore::Write(store, "a", absl::Cord("abc"));
+  auto write_req = (*mock_key_value_store)->write_requests.pop();
+  EXPECT_TRUE(write_req.promise.result_needed());
+  write_future = {};
+  EXPECT_FALSE(write_req.promise.result_needed());
+
+  auto delete_future = kvstore::DeleteRange(store, {});
+  auto delete_req = (*mock_key_value_store)->delete_range_requests.pop();
+  EXPECT_TRUE(delete_req.promise.result_needed());
+  delete_future = {};
+  EXPECT_FALSE(delete_req.promise.result_needed());
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, EvictsLeastRecentlyUsed) {
+  // Each entry, including its header, is less than 100 bytes.
+  auto store = Open(/*total_bytes_limit=*/250);
+  std::string value(50, 'x');
+  for (int i = 0; i < 5; ++i) {
+    TENSORSTORE_ASSERT_OK(
+        kvstore::Write(store, std::to_string(i), absl::Cord(value)));
+    size_t expected = std::min(i + 1, 3);
+    EXPECT_EQ(expected, GetCacheEntryCount(expected));
+  }
+  // Evicted values are still read from the base kvstore.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_THAT(kvstore::Read(store, std::to_string(i)).result(),
+                MatchesKvsReadResult(absl::Cord(value)));
+  }
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, ReopenUsesExistingEntries) {
+  auto base = OpenMemory("base/");
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  {
+    auto store = Open();
+    EXPECT_THAT(kvstore::Read(store, "a").result(),
+                MatchesKvsReadResult(absl::Cord("abc")));
+    ASSERT_EQ(1, GetCacheEntryCount(1));
+  }
+  // Entries found when re-opening are revalidated before use.
+  auto store = Open();
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  EXPECT_EQ(1, GetCacheEntryCount(1));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, CorruptEntry) {
+  auto base = OpenMemory("base/");
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base, "a", absl::Cord("abc")));
+  auto store = Open();
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+  ASSERT_EQ(1, GetCacheEntryCount(1));
+
+  auto cache = OpenMemory("cache/");
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto entries,
+                                   kvstore::ListFuture(cache).result());
+  ASSERT_THAT(entries, SizeIs(1));
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(cache, entries[0].key, absl::Cord("corrupt")));
+
+  kvstore::ReadOptions options;
+  options.staleness_bound = absl::InfinitePast();
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesKvsReadResult(absl::Cord("abc")));
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, SpecRoundtrip) {
+  tensorstore::internal::KeyValueStoreSpecRoundtripOptions options;
+  options.full_spec = {
+      {"driver", "disk_cache"},
+      {"base", {{"driver", "memory"}, {"path", "base/"}}},
+      {"cache", {{"driver", "memory"}, {"path", "cache/"}}},
+      {"total_bytes_limit", 1000},
+  };
+  options.full_base_spec = {{"driver", "memory"}, {"path", "base/"}};
+  // Not possible with "memory" driver.
+  options.check_data_persists = false;
+  options.check_data_after_serialization = false;
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(options);
+}
+
+TEST_F(DiskCacheKeyValueStoreTest, InvalidSpec) {
+  EXPECT_THAT(kvstore::Open({{"driver", "disk_cache"},
+                             {"base", "memory://"},
+                             {"cache", "memory://cache/"}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(kvstore::Open({{"driver", "disk_cache"},
+                             {"base", "memory://"},
+                             {"total_bytes_limit", 1000}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
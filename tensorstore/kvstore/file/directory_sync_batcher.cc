@@ -0,0 +1,122 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/directory_sync_batcher.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/no_destructor.h"
+#include "tensorstore/internal/os/error_code.h"
+#include "tensorstore/util/executor.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace internal_file_kvstore {
+namespace {
+
+auto& group_commit_directory_syncs = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/group_commit/directory_syncs",
+    "file driver directory fsync calls issued by group commit");
+
+auto& group_commit_requests = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/group_commit/requests",
+    "file driver operations made durable by group commit");
+
+}  // namespace
+
+DirectorySyncBatcher& DirectorySyncBatcher::Global() {
+  static internal::NoDestructor<DirectorySyncBatcher> batcher;
+  return *batcher;
+}
+
+void DirectorySyncBatcher::Sync(Executor executor, std::string dir_path,
+                                internal_file_util::UniqueFileDescriptor dir_fd,
+                                Callback callback) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto [it, inserted] = directories_.try_emplace(dir_path);
+    it->second.pending.push_back(
+        Request{std::move(dir_fd), std::move(callback)});
+    // If an `fsync` is already in progress, the thread performing it issues
+    // another one, covering this request, once it completes.
+    if (!inserted) return;
+  }
+  RunBatch(std::move(executor), dir_path);
+}
+
+void DirectorySyncBatcher::RunBatch(Executor executor,
+                                    const std::string& dir_path) {
+  std::vector<Request> batch;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = directories_.find(dir_path);
+    assert(it != directories_.end());
+    batch = std::exchange(it->second.pending, {});
+  }
+  assert(!batch.empty());
+
+  // Any descriptor referring to the directory will do.
+  absl::Status status;
+  if (!internal_file_util::FsyncDirectory(batch.front().dir_fd.get())) {
+    status = internal::StatusFromOsError(
+        internal::GetLastErrorCode(),
+        "Error calling fsync on directory: ", dir_path);
+  }
+  group_commit_directory_syncs.Increment();
+  group_commit_requests.IncrementBy(batch.size());
+
+  for (auto& request : batch) {
+    request.dir_fd = internal_file_util::UniqueFileDescriptor();
+    std::move(request.callback)(status);
+  }
+  batch.clear();
+
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = directories_.find(dir_path);
+    assert(it != directories_.end());
+    if (it->second.pending.empty()) {
+      directories_.erase(it);
+      return;
+    }
+  }
+  // Requests arrived while the `fsync` was in progress.  Sync them from the
+  // executor rather than looping here, so that a steady stream of writes to
+  // one directory does not monopolize the calling thread.
+  executor([this, executor, dir_path] { RunBatch(executor, dir_path); });
+}
+
+std::string ParentDirectoryPath(const std::string& path) {
+  size_t end_pos = path.size();
+  while (end_pos != 0 &&
+         !internal_file_util::IsDirSeparator(path[end_pos - 1])) {
+    --end_pos;
+  }
+  return path.substr(0, end_pos);
+}
+
+}  // namespace internal_file_kvstore
+}  // namespace tensorstore
@@ -0,0 +1,101 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_DIRECTORY_SYNC_BATCHER_H_
+#define TENSORSTORE_KVSTORE_FILE_DIRECTORY_SYNC_BATCHER_H_
+
+/// \file
+/// Group commit of directory `fsync` calls for the "file" driver.
+///
+/// A write or delete made durable by the "file" driver requires an `fsync` of
+/// the parent directory after the `rename` or `unlink`.  When many operations
+/// on the same directory complete concurrently, a single `fsync` issued after
+/// all of them suffices.  `DirectorySyncBatcher` collects such requests per
+/// directory: at most one `fsync` per directory is in progress at a time, and
+/// every request that arrives while it is in progress is satisfied by the next
+/// `fsync`, which is issued as soon as the current one completes.
+///
+/// Since a request is only ever satisfied by an `fsync` that started after the
+/// request was made, the durability guarantee is the same as calling
+/// `FsyncDirectory` directly.
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorstore/kvstore/file/unique_handle.h"
+#include "tensorstore/util/executor.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace tensorstore {
+namespace internal_file_kvstore {
+
+class DirectorySyncBatcher {
+ public:
+  /// Callback invoked once the directory has been synced.
+  ///
+  /// All callbacks of a batch receive the same status.
+  using Callback = absl::AnyInvocable<void(const absl::Status&) &&>;
+
+  /// Returns the process-wide batcher used by the "file" driver.
+  static DirectorySyncBatcher& Global();
+
+  /// Requests an `fsync` of the directory `dir_path`, which has been opened as
+  /// `dir_fd`, and invokes `callback` once it completes.
+  ///
+  /// If no `fsync` of `dir_path` is in progress, the `fsync` is performed on
+  /// the calling thread.  Otherwise, the request is queued and the next batch
+  /// is performed on `executor` once the current `fsync` completes.
+  void Sync(Executor executor, std::string dir_path,
+            internal_file_util::UniqueFileDescriptor dir_fd,
+            Callback callback);
+
+ private:
+  struct Request {
+    internal_file_util::UniqueFileDescriptor dir_fd;
+    Callback callback;
+  };
+
+  struct Directory {
+    /// Requests not yet covered by an `fsync` in progress.
+    std::vector<Request> pending;
+  };
+
+  /// Syncs all pending requests for `dir_path`.  Must only be called by the
+  /// thread that inserted the `directories_` entry, or by a continuation that
+  /// it scheduled.
+  void RunBatch(Executor executor, const std::string& dir_path);
+
+  absl::Mutex mutex_;
+
+  /// Directories with an `fsync` in progress.
+  absl::flat_hash_map<std::string, Directory> directories_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+/// Returns the directory component of `path`, which is used as the key for
+/// `DirectorySyncBatcher::Sync`.
+std::string ParentDirectoryPath(const std::string& path);
+
+}  // namespace internal_file_kvstore
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_DIRECTORY_SYNC_BATCHER_H_
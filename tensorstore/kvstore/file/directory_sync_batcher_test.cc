@@ -0,0 +1,72 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/directory_sync_batcher.h"
+
+#include <stddef.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "tensorstore/internal/testing/scoped_directory.h"
+#include "tensorstore/internal/thread/thread_pool.h"
+#include "tensorstore/util/executor.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+#include "tensorstore/kvstore/file/windows_file_util.h"
+
+namespace {
+
+using ::tensorstore::Executor;
+using ::tensorstore::internal_file_kvstore::DirectorySyncBatcher;
+using ::tensorstore::internal_file_kvstore::ParentDirectoryPath;
+using ::tensorstore::internal_file_util::OpenDirectoryDescriptor;
+using ::tensorstore::internal_file_util::UniqueFileDescriptor;
+using ::tensorstore::internal_testing::ScopedTemporaryDirectory;
+
+TEST(ParentDirectoryPathTest, Basic) {
+  EXPECT_EQ("/a/b/", ParentDirectoryPath("/a/b/c"));
+  EXPECT_EQ("/", ParentDirectoryPath("/c"));
+  EXPECT_EQ("", ParentDirectoryPath("c"));
+}
+
+TEST(DirectorySyncBatcherTest, ConcurrentRequests) {
+  ScopedTemporaryDirectory tempdir;
+  Executor executor = tensorstore::internal::DetachedThreadPool(4);
+  auto& batcher = DirectorySyncBatcher::Global();
+
+  constexpr size_t kNumRequests = 100;
+  absl::BlockingCounter counter(kNumRequests);
+  std::atomic<size_t> num_ok{0};
+  for (size_t i = 0; i < kNumRequests; ++i) {
+    executor([&] {
+      UniqueFileDescriptor fd(OpenDirectoryDescriptor(tempdir.path().c_str()));
+      batcher.Sync(executor, tempdir.path(), std::move(fd),
+                   [&](const absl::Status& status) {
+                     if (status.ok()) ++num_ok;
+                     counter.DecrementCount();
+                   });
+    });
+  }
+  counter.Wait();
+  EXPECT_EQ(kNumRequests, num_ok.load());
+}
+
+}  // namespace
@@ -80,6 +80,26 @@
 /// 8. `fsync` the parent directory of the file (to ensure the `unlink` or
 ///    `rename` operations are durable).  This step is skipped on MS Windows,
 ///    where `fsync` is not supported for directories.
+///
+/// If `Context.file_io_group_commit` is `true`, step 8 is instead performed
+/// after the lock is released, by `DirectorySyncBatcher`, which issues a single
+/// `fsync` for all concurrent operations on the same directory.  The future is
+/// not marked ready until an `fsync` that started after the `rename` or
+/// `unlink` completes, so the durability guarantee is unchanged.
+///
+/// Reads are normally performed using blocking `pread` calls on the
+/// `file_io_concurrency` executor.  If `Context.file_io_engine` specifies
+/// `"io_uring"` and io_uring is available, the value file is still opened on
+/// the executor, but the data is read asynchronously by `IoUringEngine`, which
+/// batches submissions and completes the futures directly from the completion
+/// queue.
+///
+/// If `Context.file_io_mmap` is `true`, large reads instead return an
+/// `absl::Cord` that references a read-only memory mapping of the requested
+/// byte range, avoiding a copy.  This is safe because value files are never
+/// modified in place by this driver.  If the mapping cannot be created, the
+/// data is read normally.  Mapped reads are not used on Windows, where a mapped
+/// view prevents the file from being replaced or deleted.
 
 #include <stddef.h>
 #include <stdint.h>
@@ -92,9 +112,11 @@
 #include <string_view>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/functional/function_ref.h"
+#include "absl/log/absl_log.h"
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/match.h"
@@ -108,15 +130,20 @@
 #include "tensorstore/internal/flat_cord_builder.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/bindable.h"
+#include "tensorstore/internal/json_binding/enum.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/os/error_code.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/internal/uri_utils.h"
 #include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/file/directory_sync_batcher.h"
+#include "tensorstore/kvstore/file/io_uring_engine.h"
 #include "tensorstore/kvstore/file/unique_handle.h"
 #include "tensorstore/kvstore/file/util.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/operation_metrics.h"
 #include "tensorstore/kvstore/operations.h"
 #include "tensorstore/kvstore/read_result.h"
 #include "tensorstore/kvstore/registry.h"
@@ -198,6 +225,14 @@ auto& file_delete_range = internal_metrics::Counter<int64_t>::New(
 auto& file_list = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/file/list", "file driver kvstore::List calls");
 
+auto& file_bytes_mapped = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/bytes_mapped",
+    "Bytes returned from memory mappings by the file kvstore driver");
+
+auto& file_mmap_fallback = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/mmap_fallback",
+    "Reads copied because a memory mapping could not be created");
+
 auto& file_lock_contention = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/file/lock_contention",
     "file driver write lock contention");
@@ -219,12 +254,117 @@ struct FileIoSyncResource
   }
 };
 
+struct FileIoMmapResource
+    : public internal::ContextResourceTraits<FileIoMmapResource> {
+  constexpr static bool config_only = true;
+  static constexpr char id[] = "file_io_mmap";
+  using Spec = bool;
+  using Resource = Spec;
+  static Spec Default() { return false; }
+  static constexpr auto JsonBinder() { return jb::DefaultBinder<>; }
+  static Result<Resource> Create(
+      Spec v, internal::ContextResourceCreationContext context) {
+    return v;
+  }
+  static Spec GetSpec(Resource v, const internal::ContextSpecBuilder& builder) {
+    return v;
+  }
+};
+
+struct FileIoGroupCommitResource
+    : public internal::ContextResourceTraits<FileIoGroupCommitResource> {
+  constexpr static bool config_only = true;
+  static constexpr char id[] = "file_io_group_commit";
+  using Spec = bool;
+  using Resource = Spec;
+  static Spec Default() { return false; }
+  static constexpr auto JsonBinder() { return jb::DefaultBinder<>; }
+  static Result<Resource> Create(
+      Spec v, internal::ContextResourceCreationContext context) {
+    return v;
+  }
+  static Spec GetSpec(Resource v, const internal::ContextSpecBuilder& builder) {
+    return v;
+  }
+};
+
+/// Specifies the mechanism used to read file data.
+struct FileIoEngineResource
+    : public internal::ContextResourceTraits<FileIoEngineResource> {
+  static constexpr char id[] = "file_io_engine";
+
+  enum class Mode {
+    /// Blocking reads on the `file_io_concurrency` executor.
+    kThreadPool,
+    /// Asynchronous reads using `IoUringEngine`, if available.
+    kIoUring,
+  };
+
+  struct Spec {
+    Mode mode = Mode::kThreadPool;
+    size_t queue_depth = 256;
+
+    constexpr static auto ApplyMembers = [](auto&& x, auto f) {
+      return f(x.mode, x.queue_depth);
+    };
+  };
+
+  struct Resource {
+    Spec spec;
+    // Null if `spec.mode == Mode::kThreadPool` or io_uring is unavailable.
+    IoUringEnginePtr io_uring;
+  };
+
+  static Spec Default() { return {}; }
+
+  static constexpr auto JsonBinder() {
+    return jb::Object(
+        jb::Member("mode",
+                   jb::Projection<&Spec::mode>(jb::DefaultValue(
+                       [](auto* v) { *v = Mode::kThreadPool; },
+                       jb::Enum<Mode, std::string_view>({
+                           {Mode::kThreadPool, "thread_pool"},
+                           {Mode::kIoUring, "io_uring"},
+                       })))),
+        jb::Member("queue_depth",
+                   jb::Projection<&Spec::queue_depth>(jb::DefaultValue(
+                       [](auto* v) { *v = 256; },
+                       jb::Integer<size_t>(1, 32768)))));
+  }
+
+  static Result<Resource> Create(
+      const Spec& spec, internal::ContextResourceCreationContext context) {
+    Resource resource;
+    resource.spec = spec;
+    if (spec.mode == Mode::kIoUring) {
+      auto engine = IoUringEngine::Create(spec.queue_depth);
+      if (engine.ok()) {
+        resource.io_uring = *std::move(engine);
+      } else {
+        ABSL_LOG_FIRST_N(INFO, 1)
+            << "io_uring unavailable, using thread pool for file reads: "
+            << engine.status();
+      }
+    }
+    return resource;
+  }
+
+  static Spec GetSpec(const Resource& resource,
+                      const internal::ContextSpecBuilder& builder) {
+    return resource.spec;
+  }
+};
+
 struct FileKeyValueStoreSpecData {
   Context::Resource<internal::FileIoConcurrencyResource> file_io_concurrency;
   Context::Resource<FileIoSyncResource> file_io_sync;
+  Context::Resource<FileIoEngineResource> file_io_engine;
+  Context::Resource<FileIoMmapResource> file_io_mmap;
+  Context::Resource<FileIoGroupCommitResource> file_io_group_commit;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(x.file_io_concurrency, x.file_io_sync);
+    return f(x.file_io_concurrency, x.file_io_sync, x.file_io_engine,
+             x.file_io_mmap, x.file_io_group_commit);
   };
 
   // TODO(jbms): Storing a UNIX path as a JSON string presents a challenge
@@ -247,7 +387,14 @@ struct FileKeyValueStoreSpecData {
           internal::FileIoConcurrencyResource::id,
           jb::Projection<&FileKeyValueStoreSpecData::file_io_concurrency>()),
       jb::Member(FileIoSyncResource::id,
-                 jb::Projection<&FileKeyValueStoreSpecData::file_io_sync>())
+                 jb::Projection<&FileKeyValueStoreSpecData::file_io_sync>()),
+      jb::Member(FileIoEngineResource::id,
+                 jb::Projection<&FileKeyValueStoreSpecData::file_io_engine>()),
+      jb::Member(FileIoMmapResource::id,
+                 jb::Projection<&FileKeyValueStoreSpecData::file_io_mmap>()),
+      jb::Member(
+          FileIoGroupCommitResource::id,
+          jb::Projection<&FileKeyValueStoreSpecData::file_io_group_commit>())
       //
   );
 };
@@ -298,6 +445,14 @@ class FileKeyValueStore
 
   bool sync() const { return *spec_.file_io_sync; }
 
+  bool mmap() const { return *spec_.file_io_mmap; }
+
+  bool group_commit() const { return *spec_.file_io_group_commit; }
+
+  IoUringEngine* io_uring_engine() const {
+    return spec_.file_io_engine->io_uring.get();
+  }
+
   SpecData spec_;
 };
 
@@ -613,33 +768,72 @@ struct PathRangeVisitor {
   }
 };
 
+/// Value file opened by `ReadTask::Open`.
+struct OpenedValueFile {
+  UniqueFileDescriptor fd;
+  ByteRange byte_range;
+  TimestampedStorageGeneration stamp;
+};
+
+/// Minimum size of a read for which a memory mapping is returned when
+/// `Context.file_io_mmap` is enabled.  For smaller reads, the cost of creating
+/// and destroying the mapping exceeds the cost of copying the data.
+constexpr size_t kMinMmapReadSize = 64 * 1024;
+
 /// Implements `FileKeyValueStore::Read`.
 struct ReadTask {
   std::string full_path;
   kvstore::ReadOptions options;
+  bool mmap;
 
-  Result<ReadResult> operator()() const {
-    TimestampedStorageGeneration stamp;
-    stamp.time = absl::Now();
+  /// Opens the value file and checks the conditions specified by `options`.
+  ///
+  /// \returns The opened file along with the byte range to read, or the
+  ///     final `ReadResult` if no data needs to be read.
+  Result<std::variant<OpenedValueFile, ReadResult>> Open() const {
+    OpenedValueFile file;
+    file.stamp.time = absl::Now();
     int64_t size;
     TENSORSTORE_ASSIGN_OR_RETURN(
-        auto fd, OpenValueFile(full_path.c_str(), &stamp.generation, &size));
-    if (!fd.valid()) {
-      return kvstore::ReadResult::Missing(stamp.time);
+        file.fd,
+        OpenValueFile(full_path.c_str(), &file.stamp.generation, &size));
+    if (!file.fd.valid()) {
+      return kvstore::ReadResult::Missing(file.stamp.time);
     }
-    if (stamp.generation == options.if_not_equal ||
+    if (file.stamp.generation == options.if_not_equal ||
         (!StorageGeneration::IsUnknown(options.if_equal) &&
-         stamp.generation != options.if_equal)) {
-      return kvstore::ReadResult::Unspecified(std::move(stamp));
+         file.stamp.generation != options.if_equal)) {
+      return kvstore::ReadResult::Unspecified(std::move(file.stamp));
     }
-    TENSORSTORE_ASSIGN_OR_RETURN(auto byte_range,
+    TENSORSTORE_ASSIGN_OR_RETURN(file.byte_range,
                                  options.byte_range.Validate(size));
-    internal::FlatCordBuilder buffer(byte_range.size());
+    return file;
+  }
+
+  Result<ReadResult> operator()() const {
+    internal_tracing::Span span("FileKeyValueStore::Read");
+    if (span.is_recording()) span.SetAttribute("path", full_path);
+    TENSORSTORE_ASSIGN_OR_RETURN(auto opened, Open());
+    if (auto* read_result = std::get_if<ReadResult>(&opened)) {
+      return std::move(*read_result);
+    }
+    auto& file = std::get<OpenedValueFile>(opened);
+    if (ShouldMap(file)) {
+      if (auto read_result = TryReadMapped(file)) {
+        return *std::move(read_result);
+      }
+    }
+    return ReadCopied(file);
+  }
+
+  /// Reads the requested byte range of `file` into a newly allocated buffer.
+  Result<ReadResult> ReadCopied(OpenedValueFile& file) const {
+    internal::FlatCordBuilder buffer(file.byte_range.size());
     size_t offset = 0;
     while (offset < buffer.size()) {
       ptrdiff_t n = internal_file_util::ReadFromFile(
-          fd.get(), buffer.data() + offset, buffer.size() - offset,
-          byte_range.inclusive_min + offset);
+          file.fd.get(), buffer.data() + offset, buffer.size() - offset,
+          file.byte_range.inclusive_min + offset);
       if (n > 0) {
         file_bytes_read.IncrementBy(n);
         offset += n;
@@ -652,14 +846,156 @@ struct ReadTask {
       return StatusFromErrno("Error reading file: ", full_path);
     }
     return kvstore::ReadResult::Value(std::move(buffer).Build(),
-                                      std::move(stamp));
+                                      std::move(file.stamp));
+  }
+
+  bool ShouldMap(const OpenedValueFile& file) const {
+#ifdef _WIN32
+    // On Windows, a file with a live mapped view cannot be replaced by
+    // `MoveFileEx` or deleted, which would cause subsequent writes and deletes
+    // of the key to fail for as long as the returned `absl::Cord` is
+    // referenced.
+    return false;
+#else
+    return mmap && file.byte_range.size() >= kMinMmapReadSize;
+#endif
+  }
+
+  /// Returns the requested byte range of `file` as an `absl::Cord` that
+  /// references a read-only memory mapping.  The mapping is released when the
+  /// last reference to the `absl::Cord` is destroyed.
+  ///
+  /// \returns `std::nullopt` if the mapping could not be created, e.g. due to
+  ///     address space or mapping count limits, in which case the caller falls
+  ///     back to reading a copy.
+  std::optional<ReadResult> TryReadMapped(OpenedValueFile& file) const {
+    const size_t alignment = internal_file_util::GetMapAlignment();
+    const int64_t map_offset =
+        file.byte_range.inclusive_min -
+        file.byte_range.inclusive_min % static_cast<int64_t>(alignment);
+    const size_t skip =
+        static_cast<size_t>(file.byte_range.inclusive_min - map_offset);
+    const size_t size = static_cast<size_t>(file.byte_range.size());
+    const size_t map_size = skip + size;
+    const char* data =
+        internal_file_util::MapFileRegion(file.fd.get(), map_offset, map_size);
+    if (!data) {
+      file_mmap_fallback.Increment();
+      return std::nullopt;
+    }
+    file_bytes_mapped.IncrementBy(size);
+    absl::Cord value = absl::MakeCordFromExternal(
+        std::string_view(data + skip, size), [data, map_size] {
+          internal_file_util::UnmapFileRegion(data, map_size);
+        });
+    return kvstore::ReadResult::Value(std::move(value), std::move(file.stamp));
+  }
+};
+
+/// Implements `FileKeyValueStore::Read` using `IoUringEngine`.
+///
+/// The value file is opened on the `file_io_concurrency` executor, but the
+/// data is read by the engine, so that no executor thread is occupied while
+/// waiting for the device.
+struct IoUringReadState {
+  ReadTask task;
+  // Keeps the engine alive for continuation reads, which are queued from the
+  // callback of the previous read.
+  IoUringEnginePtr engine;
+  Promise<ReadResult> promise;
+  OpenedValueFile file;
+  internal::FlatCordBuilder buffer;
+  size_t offset = 0;
+
+  static void Start(std::unique_ptr<IoUringReadState> self) {
+    if (!self->promise.result_needed()) return;
+    auto opened = self->task.Open();
+    if (!opened.ok()) {
+      self->promise.SetResult(std::move(opened).status());
+      return;
+    }
+    if (auto* read_result = std::get_if<ReadResult>(&*opened)) {
+      self->promise.SetResult(std::move(*read_result));
+      return;
+    }
+    self->file = std::get<OpenedValueFile>(*std::move(opened));
+    if (self->task.ShouldMap(self->file)) {
+      if (auto read_result = self->task.TryReadMapped(self->file)) {
+        self->promise.SetResult(*std::move(read_result));
+        return;
+      }
+    }
+    self->buffer = internal::FlatCordBuilder(self->file.byte_range.size());
+    if (self->buffer.size() == 0) {
+      Finish(std::move(self));
+      return;
+    }
+    Submit(std::move(self));
+  }
+
+  static void Submit(std::unique_ptr<IoUringReadState> self) {
+    auto* state = self.get();
+    state->engine->Read(
+        state->file.fd.get(), state->buffer.data() + state->offset,
+        state->buffer.size() - state->offset,
+        state->file.byte_range.inclusive_min + state->offset,
+        [self = std::move(self)](ptrdiff_t n) mutable {
+          OnRead(std::move(self), n);
+        });
+  }
+
+  static void OnRead(std::unique_ptr<IoUringReadState> self, ptrdiff_t n) {
+    if (n > 0) {
+      file_bytes_read.IncrementBy(n);
+      self->offset += n;
+      if (self->offset < self->buffer.size()) {
+        Submit(std::move(self));
+      } else {
+        Finish(std::move(self));
+      }
+      return;
+    }
+    if (n == 0) {
+      self->promise.SetResult(absl::UnavailableError(tensorstore::StrCat(
+          "Length changed while reading: ", self->task.full_path)));
+      return;
+    }
+    if (n == -EINTR || n == -EAGAIN) {
+      Submit(std::move(self));
+      return;
+    }
+    self->promise.SetResult(StatusFromOsError(
+        static_cast<OsErrorCode>(-n), "Error reading file: ",
+        self->task.full_path));
+  }
+
+  static void Finish(std::unique_ptr<IoUringReadState> self) {
+    // Close the file before marking the promise ready.
+    self->file.fd = UniqueFileDescriptor();
+    self->promise.SetResult(kvstore::ReadResult::Value(
+        std::move(self->buffer).Build(), std::move(self->file.stamp)));
   }
 };
 
 Future<ReadResult> FileKeyValueStore::Read(Key key, ReadOptions options) {
   file_read.Increment();
   TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
-  return MapFuture(executor(), ReadTask{std::move(key), std::move(options)});
+  if (auto* engine = io_uring_engine()) {
+    auto [promise, future] = PromiseFuturePair<ReadResult>::Make();
+    auto state = std::make_unique<IoUringReadState>();
+    state->task = ReadTask{std::move(key), std::move(options), mmap()};
+    state->engine = IoUringEnginePtr(engine);
+    state->promise = std::move(promise);
+    executor()([state = std::move(state)]() mutable {
+      IoUringReadState::Start(std::move(state));
+    });
+    return internal_kvstore::RecordReadMetrics(FileKeyValueStoreSpec::id,
+                                               std::move(future));
+  }
+  return internal_kvstore::RecordReadMetrics(
+      FileKeyValueStoreSpec::id,
+      MapFuture(executor(),
+                ReadTask{std::move(key), std::move(options), mmap()}));
 }
 
 /// Implements `FileKeyValueStore::Write`.
@@ -670,6 +1006,19 @@ struct WriteTask {
   bool sync;
 
   Result<TimestampedStorageGeneration> operator()() const {
+    return Run(/*deferred_dir_fd=*/nullptr);
+  }
+
+  /// Performs the write.  If `deferred_dir_fd` is not `nullptr` and the parent
+  /// directory must be synced, it is set to the open parent directory instead
+  /// of syncing it, and the caller is responsible for syncing it.
+  Result<TimestampedStorageGeneration> Run(
+      UniqueFileDescriptor* deferred_dir_fd) const {
+    internal_tracing::Span span("FileKeyValueStore::Write");
+    if (span.is_recording()) {
+      span.SetAttribute("path", full_path);
+      span.SetAttribute("bytes", static_cast<int64_t>(value.size()));
+    }
     TimestampedStorageGeneration r;
     r.time = absl::Now();
 
@@ -719,7 +1068,9 @@ struct WriteTask {
                                full_path);
       }
       delete_lock_file = false;
-      if (this->sync) {
+      if (this->sync && deferred_dir_fd) {
+        *deferred_dir_fd = std::move(dir_fd);
+      } else if (this->sync) {
         // fsync the parent directory to ensure the `rename` is durable.
         if (!internal_file_util::FsyncDirectory(dir_fd.get())) {
           return StatusFromErrno("Error calling fsync on parent directory of: ",
@@ -755,6 +1106,15 @@ struct DeleteTask {
   bool sync;
 
   Result<TimestampedStorageGeneration> operator()() const {
+    return Run(/*deferred_dir_fd=*/nullptr);
+  }
+
+  /// Performs the delete.  `deferred_dir_fd` has the same meaning as for
+  /// `WriteTask::Run`.
+  Result<TimestampedStorageGeneration> Run(
+      UniqueFileDescriptor* deferred_dir_fd) const {
+    internal_tracing::Span span("FileKeyValueStore::Delete");
+    if (span.is_recording()) span.SetAttribute("path", full_path);
     TimestampedStorageGeneration r;
     r.time = absl::Now();
 
@@ -786,8 +1146,11 @@ struct DeleteTask {
     // Delete the lock file.
     TENSORSTORE_RETURN_IF_ERROR(lock_helper.Delete());
 
-    // fsync the parent directory to ensure the `rename` is durable.
-    if (fsync_directory && !internal_file_util::FsyncDirectory(dir_fd.get())) {
+    if (fsync_directory && deferred_dir_fd) {
+      *deferred_dir_fd = std::move(dir_fd);
+    } else if (fsync_directory &&
+               !internal_file_util::FsyncDirectory(dir_fd.get())) {
+      // fsync the parent directory to ensure the `unlink` is durable.
       return StatusFromErrno("Error calling fsync on parent directory of: ",
                              full_path);
     }
@@ -799,17 +1162,66 @@ struct DeleteTask {
   }
 };
 
+/// Runs a `WriteTask` or `DeleteTask` on `executor`, deferring the `fsync` of
+/// the parent directory to `DirectorySyncBatcher`.
+template <typename Task>
+Future<TimestampedStorageGeneration> RunWithGroupCommit(Executor executor,
+                                                        Task task) {
+  auto [promise, future] =
+      PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  executor([executor, task = std::move(task),
+            promise = std::move(promise)]() mutable {
+    if (!promise.result_needed()) return;
+    UniqueFileDescriptor dir_fd;
+    auto result = task.Run(&dir_fd);
+    if (!result.ok() || !dir_fd.valid()) {
+      promise.SetResult(std::move(result));
+      return;
+    }
+    std::string dir_path = ParentDirectoryPath(task.full_path);
+    DirectorySyncBatcher::Global().Sync(
+        executor, std::move(dir_path), std::move(dir_fd),
+        [promise = std::move(promise), result = std::move(result),
+         full_path = std::move(task.full_path)](
+            const absl::Status& status) mutable {
+          if (!status.ok()) {
+            promise.SetResult(tensorstore::MaybeAnnotateStatus(
+                status, tensorstore::StrCat(
+                            "Error calling fsync on parent directory of: ",
+                            full_path)));
+            return;
+          }
+          promise.SetResult(std::move(result));
+        });
+  });
+  return std::move(future);
+}
+
 Future<TimestampedStorageGeneration> FileKeyValueStore::Write(
     Key key, std::optional<Value> value, WriteOptions options) {
   file_write.Increment();
   TENSORSTORE_RETURN_IF_ERROR(ValidateKey(key));
+  std::optional<int64_t> bytes;
+  Future<TimestampedStorageGeneration> future;
   if (value) {
-    return MapFuture(executor(), WriteTask{std::move(key), std::move(*value),
-                                           std::move(options), this->sync()});
+    bytes = value->size();
+    WriteTask task{std::move(key), std::move(*value), std::move(options),
+                   this->sync()};
+    if (this->sync() && group_commit()) {
+      future = RunWithGroupCommit(executor(), std::move(task));
+    } else {
+      future = MapFuture(executor(), std::move(task));
+    }
   } else {
-    return MapFuture(executor(), DeleteTask{std::move(key), std::move(options),
-                                            this->sync()});
+    DeleteTask task{std::move(key), std::move(options), this->sync()};
+    if (this->sync() && group_commit()) {
+      future = RunWithGroupCommit(executor(), std::move(task));
+    } else {
+      future = MapFuture(executor(), std::move(task));
+    }
   }
+  return internal_kvstore::RecordWriteMetrics(FileKeyValueStoreSpec::id, bytes,
+                                              std::move(future));
 }
 
 /// Implements `FileKeyValueStore::DeleteRange`.
@@ -856,9 +1268,11 @@ Future<const void> FileKeyValueStore::DeleteRange(KeyRange range) {
   file_delete_range.Increment();
   if (range.empty()) return absl::OkStatus();  // Converted to a ReadyFuture.
   TENSORSTORE_RETURN_IF_ERROR(ValidateKeyRange(range));
-  return PromiseFuturePair<void>::Link(
-             WithExecutor(executor(), DeleteRangeTask{std::move(range)}))
-      .future;
+  return internal_kvstore::RecordDeleteRangeMetrics(
+      FileKeyValueStoreSpec::id,
+      PromiseFuturePair<void>::Link(
+          WithExecutor(executor(), DeleteRangeTask{std::move(range)}))
+          .future);
 }
 
 /// Implements `FileKeyValueStore:::List`.
@@ -912,7 +1326,10 @@ void FileKeyValueStore::ListImpl(ListOptions options, ListReceiver receiver) {
     execution::set_stopping(receiver);
     return;
   }
-  executor()(ListTask{std::move(options), std::move(receiver)});
+  executor()(ListTask{
+      std::move(options),
+      internal_kvstore::RecordListMetrics(FileKeyValueStoreSpec::id,
+                                          std::move(receiver))});
 }
 
 Future<kvstore::DriverPtr> FileKeyValueStoreSpec::DoOpen() const {
@@ -927,6 +1344,12 @@ Result<kvstore::Spec> ParseFileUrl(std::string_view url) {
       Context::Resource<internal::FileIoConcurrencyResource>::DefaultSpec();
   driver_spec->data_.file_io_sync =
       Context::Resource<FileIoSyncResource>::DefaultSpec();
+  driver_spec->data_.file_io_engine =
+      Context::Resource<FileIoEngineResource>::DefaultSpec();
+  driver_spec->data_.file_io_mmap =
+      Context::Resource<FileIoMmapResource>::DefaultSpec();
+  driver_spec->data_.file_io_group_commit =
+      Context::Resource<FileIoGroupCommitResource>::DefaultSpec();
   auto parsed = internal::ParseGenericUri(url);
   assert(parsed.scheme == internal_file_kvstore::FileKeyValueStoreSpec::id);
   if (!parsed.query.empty()) {
@@ -961,4 +1384,16 @@ const tensorstore::internal::ContextResourceRegistration<
     tensorstore::internal_file_kvstore::FileIoSyncResource>
     file_io_sync_registration;
 
+const tensorstore::internal::ContextResourceRegistration<
+    tensorstore::internal_file_kvstore::FileIoEngineResource>
+    file_io_engine_registration;
+
+const tensorstore::internal::ContextResourceRegistration<
+    tensorstore::internal_file_kvstore::FileIoMmapResource>
+    file_io_mmap_registration;
+
+const tensorstore::internal::ContextResourceRegistration<
+    tensorstore::internal_file_kvstore::FileIoGroupCommitResource>
+    file_io_group_commit_registration;
+
 }  // namespace
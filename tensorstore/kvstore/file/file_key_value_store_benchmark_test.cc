@@ -0,0 +1,93 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// Benchmarks durable concurrent writes to a single directory, with and
+/// without `Context.file_io_group_commit`.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include "absl/log/absl_check.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/metrics/metrics_testutil.h"
+#include "tensorstore/internal/testing/scoped_directory.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/util/future.h"
+
+namespace {
+
+namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::internal_metrics::GetCounterValue;
+using ::tensorstore::internal_testing::ScopedTemporaryDirectory;
+
+// Each iteration issues `state.range(0)` concurrent writes of small values to
+// distinct keys in the same directory and waits for all of them.  With
+// `file_io_group_commit` (`state.range(1) == 1`), the directory `fsync` is
+// shared among the writes rather than performed by each of them.
+void BM_ConcurrentWrites(benchmark::State& state) {
+  const size_t num_writes = state.range(0);
+  const bool group_commit = state.range(1) != 0;
+  ScopedTemporaryDirectory tempdir;
+  auto store_result =
+      kvstore::Open({{"driver", "file"},
+                     {"path", tempdir.path() + "/"},
+                     {"file_io_sync", true},
+                     {"file_io_group_commit", group_commit},
+                     {"context", {{"file_io_concurrency", {{"limit", 64}}}}}})
+          .result();
+  ABSL_CHECK_OK(store_result.status());
+  auto store = *std::move(store_result);
+
+  std::vector<std::string> keys(num_writes);
+  for (size_t i = 0; i < num_writes; ++i) keys[i] = absl::StrCat("key", i);
+  const absl::Cord value(std::string(1024, 'x'));
+
+  const int64_t syncs_before =
+      GetCounterValue("/tensorstore/kvstore/file/group_commit/directory_syncs");
+  std::vector<tensorstore::Future<tensorstore::TimestampedStorageGeneration>>
+      futures(num_writes);
+  for (auto s : state) {
+    for (size_t i = 0; i < num_writes; ++i) {
+      futures[i] = kvstore::Write(store, keys[i], value);
+    }
+    for (auto& future : futures) {
+      ABSL_CHECK_OK(future.status());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_writes);
+  if (group_commit) {
+    const int64_t syncs =
+        GetCounterValue(
+            "/tensorstore/kvstore/file/group_commit/directory_syncs") -
+        syncs_before;
+    state.counters["writes_per_sync"] = benchmark::Counter(
+        syncs ? static_cast<double>(state.iterations() * num_writes) / syncs
+              : 0);
+  }
+}
+
+BENCHMARK(BM_ConcurrentWrites)
+    ->ArgNames({"writes", "group_commit"})
+    ->ArgsProduct({{1, 16, 64}, {0, 1}})
+    ->UseRealTime();
+
+}  // namespace
@@ -14,6 +14,7 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include <cstring>
 #include <fstream>
@@ -25,12 +26,15 @@
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/notification.h"
 #include <nlohmann/json.hpp>
 #include "tensorstore/context.h"
+#include "tensorstore/internal/metrics/metrics_testutil.h"
 #include "tensorstore/internal/os/filesystem.h"
 #include "tensorstore/internal/testing/scoped_directory.h"
 #include "tensorstore/internal/thread/thread.h"
+#include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
 #include "tensorstore/kvstore/kvstore.h"
@@ -61,10 +65,15 @@ using ::tensorstore::StorageGeneration;
 using ::tensorstore::internal::MatchesKvsReadResultNotFound;
 using ::tensorstore::internal::MatchesListEntry;
 using ::tensorstore::internal::MatchesTimestampedStorageGeneration;
+using ::tensorstore::internal_metrics::GetCounterValue;
 using ::tensorstore::internal_testing::ScopedCurrentWorkingDirectory;
 using ::tensorstore::internal_testing::ScopedTemporaryDirectory;
 using ::testing::HasSubstr;
 
+constexpr char kBytesMappedMetric[] = "/tensorstore/kvstore/file/bytes_mapped";
+constexpr char kMmapFallbackMetric[] =
+    "/tensorstore/kvstore/file/mmap_fallback";
+
 KvStore GetStore(std::string root) {
   return kvstore::Open({{"driver", "file"}, {"path", root + "/"}}).value();
 }
@@ -76,6 +85,177 @@ TEST(FileKeyValueStoreTest, Basic) {
   tensorstore::internal::TestKeyValueReadWriteOps(store);
 }
 
+TEST(FileKeyValueStoreTest, BasicIoUring) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  // Falls back to the thread pool if io_uring is unavailable.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "file"},
+                     {"path", root + "/"},
+                     {"file_io_engine", {{"mode", "io_uring"}}}})
+          .result());
+  tensorstore::internal::TestKeyValueReadWriteOps(store);
+}
+
+TEST(FileKeyValueStoreTest, ConcurrentReadsIoUring) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "file"},
+                     {"path", root + "/"},
+                     {"file_io_engine", {{"mode", "io_uring"},
+                                         {"queue_depth", 2}}}})
+          .result());
+  constexpr size_t kNumKeys = 32;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK(kvstore::Write(store, absl::StrCat("key", i),
+                                         absl::Cord(absl::StrCat("value", i)))
+                              .result());
+  }
+  std::vector<tensorstore::Future<kvstore::ReadResult>> futures;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    kvstore::ReadOptions options;
+    options.byte_range = tensorstore::OptionalByteRangeRequest::Range(1, 4);
+    futures.push_back(
+        kvstore::Read(store, absl::StrCat("key", i), std::move(options)));
+  }
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto read_result, futures[i].result());
+    EXPECT_EQ("alu", read_result.value) << i;
+  }
+}
+
+TEST(FileKeyValueStoreTest, BasicMmap) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "file"},
+                                 {"path", root + "/"},
+                                 {"file_io_mmap", true}})
+                      .result());
+  tensorstore::internal::TestKeyValueReadWriteOps(store);
+}
+
+TEST(FileKeyValueStoreTest, LargeValueMmap) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "file"},
+                                 {"path", root + "/"},
+                                 {"file_io_mmap", true}})
+                      .result());
+  std::string value;
+  for (size_t i = 0; i < 1024 * 1024; ++i) {
+    value += static_cast<char>(i % 251);
+  }
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "key", absl::Cord(value)));
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto full_read,
+                                   kvstore::Read(store, "key").result());
+  EXPECT_EQ(value, full_read.value);
+
+  // Unaligned byte range.
+  kvstore::ReadOptions options;
+  options.byte_range =
+      tensorstore::OptionalByteRangeRequest::Range(12345, 12345 + 100000);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto partial_read, kvstore::Read(store, "key", options).result());
+  EXPECT_EQ(value.substr(12345, 100000), partial_read.value);
+
+  // Replacing the value does not affect data that has already been read,
+  // since value files are replaced rather than modified.
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(store, "key", absl::Cord(std::string(200000, 'x'))));
+  EXPECT_EQ(value, full_read.value);
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(store, "key"));
+  EXPECT_EQ(value.substr(12345, 100000), partial_read.value);
+}
+
+TEST(FileKeyValueStoreTest, MmapOnlyWherePermitted) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "file"},
+                                 {"path", root + "/"},
+                                 {"file_io_mmap", true}})
+                      .result());
+  const std::string value(256 * 1024, 'a');
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "key", absl::Cord(value)));
+
+  const int64_t mapped_before = GetCounterValue(kBytesMappedMetric);
+  const int64_t fallback_before = GetCounterValue(kMmapFallbackMetric);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto read_result,
+                                   kvstore::Read(store, "key").result());
+  EXPECT_EQ(value, read_result.value);
+  const int64_t mapped = GetCounterValue(kBytesMappedMetric) - mapped_before;
+  const int64_t fallback =
+      GetCounterValue(kMmapFallbackMetric) - fallback_before;
+#ifdef _WIN32
+  // A mapped view would prevent the write and delete below.
+  EXPECT_EQ(0, mapped);
+  EXPECT_EQ(0, fallback);
+#else
+  // Either the data is mapped, or mapping failed and it was copied instead.
+  EXPECT_EQ(value.size(), mapped + fallback * value.size());
+#endif
+
+  // Overwriting and deleting the key succeeds while the value is referenced.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "key", absl::Cord("x")));
+  TENSORSTORE_ASSERT_OK(kvstore::Delete(store, "key"));
+  EXPECT_EQ(value, read_result.value);
+}
+
+TEST(FileKeyValueStoreTest, BasicGroupCommit) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "file"},
+                                 {"path", root + "/"},
+                                 {"file_io_group_commit", true}})
+                      .result());
+  tensorstore::internal::TestKeyValueReadWriteOps(store);
+}
+
+TEST(FileKeyValueStoreTest, ConcurrentWritesGroupCommit) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "file"},
+                                 {"path", root + "/"},
+                                 {"file_io_group_commit", true}})
+                      .result());
+  constexpr size_t kNumKeys = 64;
+  std::vector<tensorstore::Future<tensorstore::TimestampedStorageGeneration>>
+      futures;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    futures.push_back(kvstore::Write(store, absl::StrCat("dir/key", i),
+                                     absl::Cord(absl::StrCat("value", i))));
+  }
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto stamp, futures[i].result());
+    EXPECT_TRUE(StorageGeneration::IsClean(stamp.generation)) << i;
+  }
+  futures.clear();
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        auto read_result,
+        kvstore::Read(store, absl::StrCat("dir/key", i)).result());
+    EXPECT_EQ(absl::StrCat("value", i), read_result.value) << i;
+  }
+  for (size_t i = 0; i < kNumKeys; i += 2) {
+    futures.push_back(kvstore::Delete(store, absl::StrCat("dir/key", i)));
+  }
+  for (auto& future : futures) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto stamp, future.result());
+    EXPECT_TRUE(StorageGeneration::IsNoValue(stamp.generation));
+  }
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto entries,
+                                   kvstore::ListFuture(store).result());
+  EXPECT_EQ(kNumKeys / 2, entries.size());
+}
+
 TEST(FileKeyValueStoreTest, InvalidKey) {
   ScopedTemporaryDirectory tempdir;
   std::string root = tempdir.path() + "/root";
@@ -407,6 +587,61 @@ TEST(FileKeyValueStoreTest, SpecRoundtripSync) {
       {"context",
        {
            {"file_io_concurrency", ::nlohmann::json::object_t()},
+           {"file_io_engine", ::nlohmann::json::object_t()},
+           {"file_io_group_commit", false},
+           {"file_io_mmap", false},
+       }},
+  };
+  options.spec_request_options.Set(tensorstore::retain_context);
+  tensorstore::internal::TestKeyValueStoreSpecRoundtrip(options);
+}
+
+TEST(FileKeyValueStoreTest, ReleaseStoreFromReadCallbackIoUring) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "file"},
+                     {"path", root + "/"},
+                     {"file_io_engine", {{"mode", "io_uring"}}}})
+          .result());
+  constexpr size_t kNumKeys = 16;
+  const absl::Cord value(std::string(1 << 20, 'x'));
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK(
+        kvstore::Write(store, absl::StrCat("key", i), value).result());
+  }
+  std::vector<tensorstore::Future<kvstore::ReadResult>> futures;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    futures.push_back(kvstore::Read(store, absl::StrCat("key", i)));
+  }
+  // Releasing the store, and with it the engine, from a read callback must
+  // not affect the remaining reads.
+  futures[0].ExecuteWhenReady(
+      [store = std::move(store)](
+          tensorstore::ReadyFuture<kvstore::ReadResult>) mutable {
+        store = {};
+      });
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto read_result, futures[i].result());
+    EXPECT_EQ(value, read_result.value) << i;
+  }
+}
+
+TEST(FileKeyValueStoreTest, SpecRoundtripIoEngine) {
+  ScopedTemporaryDirectory tempdir;
+  std::string root = tempdir.path() + "/root";
+  tensorstore::internal::KeyValueStoreSpecRoundtripOptions options;
+  options.full_spec = {
+      {"driver", "file"},
+      {"path", root},
+      {"file_io_sync", false},
+      {"context",
+       {
+           {"file_io_concurrency", ::nlohmann::json::object_t()},
+           {"file_io_engine", {{"mode", "io_uring"}, {"queue_depth", 64}}},
+           {"file_io_group_commit", false},
+           {"file_io_mmap", false},
        }},
   };
   options.spec_request_options.Set(tensorstore::retain_context);
@@ -429,6 +664,14 @@ TEST(FileKeyValueStoreTest, InvalidSpec) {
   EXPECT_THAT(
       kvstore::Open({{"driver", "file"}, {"path", 5}}, context).result(),
       MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with invalid `"file_io_engine"` mode.
+  EXPECT_THAT(kvstore::Open({{"driver", "file"},
+                             {"path", root},
+                             {"file_io_engine", {{"mode", "invalid"}}}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
 }
 
 TEST(FileKeyValueStoreTest, UrlRoundtrip) {
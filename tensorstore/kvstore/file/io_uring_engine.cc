@@ -0,0 +1,511 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/internal/os/error_code.h"
+#include "tensorstore/internal/thread/thread.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/str_cat.h"
+
+// Include system headers last to reduce impact of macros.
+#ifdef __linux__
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// `IORING_SETUP_CLAMP` was added in the same kernel release (5.6) as
+// `IORING_OP_READ` and `IORING_REGISTER_PROBE`, which are required here.
+#if defined(__linux__) && defined(__NR_io_uring_setup) && \
+    defined(IORING_SETUP_CLAMP)
+#define TENSORSTORE_INTERNAL_HAVE_IO_URING 1
+#endif
+
+namespace tensorstore {
+namespace internal_file_kvstore {
+namespace {
+
+#ifdef TENSORSTORE_INTERNAL_HAVE_IO_URING
+
+auto& io_uring_submit_batches = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/io_uring/submit_batches",
+    "file driver io_uring_enter calls that submitted at least one read");
+
+auto& io_uring_reads = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/file/io_uring/reads",
+    "file driver reads submitted to io_uring");
+
+/// `user_data` value used for the eventfd poll request, which is never a valid
+/// `Op` pointer.
+constexpr uint64_t kWakeupUserData = 0;
+
+int IoUringSetup(unsigned entries, ::io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                    min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int ring_fd, unsigned opcode, void* arg,
+                    unsigned nr_args) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+unsigned LoadAcquire(const unsigned* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(unsigned* p, unsigned v) {
+  __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+/// Memory mapping of one of the io_uring regions.
+struct RingMapping {
+  void* ptr = MAP_FAILED;
+  size_t size = 0;
+
+  bool Map(int ring_fd, size_t map_size, off_t offset) {
+    size = map_size;
+    ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+    return ptr != MAP_FAILED;
+  }
+
+  char* data() const { return static_cast<char*>(ptr); }
+
+  ~RingMapping() {
+    if (ptr != MAP_FAILED) ::munmap(ptr, size);
+  }
+};
+
+bool IsOpSupported(const ::io_uring_probe* probe, int op) {
+  return op <= probe->last_op &&
+         (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+/// State of an io_uring instance, shared by an `IoUringEngineImpl` and its
+/// event loop thread.
+///
+/// Read callbacks are invoked on the event loop thread, and may release the
+/// last reference to the engine.  The event loop thread therefore holds its
+/// own reference to the ring, which is destroyed once the loop has stopped.
+class IoUringRing {
+ public:
+  using ReadCallback = IoUringEngine::ReadCallback;
+
+  struct Op {
+    int fd;
+    void* buf;
+    size_t count;
+    int64_t offset;
+    ReadCallback callback;
+  };
+
+  /// Starts the event loop thread, after a successful `Init`.
+  static void Start(std::shared_ptr<IoUringRing> ring) {
+    internal::Thread::StartDetached({"tensorstore_io_uring"},
+                                    [ring = std::move(ring)] { ring->Run(); });
+  }
+
+  /// Stops the event loop once all queued reads have completed.  Unless called
+  /// from a read callback, waits for the event loop to stop.
+  void Stop() {
+    absl::MutexLock lock(&mutex_);
+    stop_ = true;
+    Wakeup();
+    if (run_thread_id_ == internal::Thread::this_thread_id()) return;
+    mutex_.Await(absl::Condition(&stopped_));
+  }
+
+  ~IoUringRing() {
+    if (event_fd_ != -1) ::close(event_fd_);
+    // The mappings must be released before the ring file descriptor is
+    // closed.
+    sqes_mapping_.reset();
+    cq_mapping_.reset();
+    sq_mapping_.reset();
+    if (ring_fd_ != -1) ::close(ring_fd_);
+  }
+
+  absl::Status Init(size_t queue_depth) {
+    ::io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CLAMP;
+    ring_fd_ = IoUringSetup(
+        static_cast<unsigned>(std::clamp<size_t>(queue_depth, 2, 32768)),
+        &params);
+    if (ring_fd_ < 0) {
+      ring_fd_ = -1;
+      return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                         "io_uring_setup failed");
+    }
+
+    // Verify that the required operations are supported by the kernel.
+    constexpr unsigned kMaxProbeOps = 256;
+    std::vector<char> probe_buffer(sizeof(::io_uring_probe) +
+                                   kMaxProbeOps * sizeof(::io_uring_probe_op));
+    auto* probe = reinterpret_cast<::io_uring_probe*>(probe_buffer.data());
+    if (IoUringRegister(ring_fd_, IORING_REGISTER_PROBE, probe, kMaxProbeOps) <
+            0 ||
+        !IsOpSupported(probe, IORING_OP_READ) ||
+        !IsOpSupported(probe, IORING_OP_POLL_ADD)) {
+      return absl::UnimplementedError(
+          "io_uring does not support IORING_OP_READ");
+    }
+
+    sq_entries_ = params.sq_entries;
+    size_t sq_size =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(::io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) sq_size = cq_size = std::max(sq_size, cq_size);
+    sq_mapping_ = std::make_unique<RingMapping>();
+    if (!sq_mapping_->Map(ring_fd_, sq_size, IORING_OFF_SQ_RING)) {
+      return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                         "Failed to map io_uring SQ ring");
+    }
+    char* cq_ptr;
+    if (single_mmap) {
+      cq_ptr = sq_mapping_->data();
+    } else {
+      cq_mapping_ = std::make_unique<RingMapping>();
+      if (!cq_mapping_->Map(ring_fd_, cq_size, IORING_OFF_CQ_RING)) {
+        return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                           "Failed to map io_uring CQ ring");
+      }
+      cq_ptr = cq_mapping_->data();
+    }
+    sqes_mapping_ = std::make_unique<RingMapping>();
+    if (!sqes_mapping_->Map(ring_fd_,
+                            params.sq_entries * sizeof(::io_uring_sqe),
+                            IORING_OFF_SQES)) {
+      return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                         "Failed to map io_uring SQEs");
+    }
+
+    char* sq_ptr = sq_mapping_->data();
+    sq_tail_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq_ptr + params.sq_off.array);
+    sqes_ = reinterpret_cast<::io_uring_sqe*>(sqes_mapping_->data());
+    cq_head_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq_ptr + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<::io_uring_cqe*>(cq_ptr + params.cq_off.cqes);
+
+    event_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd_ < 0) {
+      event_fd_ = -1;
+      return internal::StatusFromOsError(internal::GetLastErrorCode(),
+                                         "Failed to create eventfd");
+    }
+
+    return absl::OkStatus();
+  }
+
+  void Read(int fd, void* buf, size_t count, int64_t offset,
+            ReadCallback callback) {
+    auto op = std::make_unique<Op>(
+        Op{fd, buf, count, offset, std::move(callback)});
+    bool wakeup = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!failed_) {
+        pending_.push_back(std::move(op));
+        if (!wakeup_requested_) {
+          wakeup_requested_ = true;
+          wakeup = true;
+        }
+      }
+    }
+    if (op) {
+      ReadSync(std::move(op));
+      return;
+    }
+    if (wakeup) Wakeup();
+  }
+
+ private:
+  /// Performs `op` with a blocking `pread`, once the ring has failed.
+  static void ReadSync(std::unique_ptr<Op> op) {
+    ssize_t n;
+    do {
+      n = ::pread(op->fd, op->buf, op->count, op->offset);
+    } while (n < 0 && errno == EINTR);
+    std::move(op->callback)(n < 0 ? -static_cast<ptrdiff_t>(errno)
+                                  : static_cast<ptrdiff_t>(n));
+  }
+
+  /// Handles an unexpected `io_uring_enter` error, such as `ENOMEM`.
+  ///
+  /// Reads not yet consumed by the kernel, and all later reads, are performed
+  /// with `pread` instead.  Reads already consumed by the kernel still own
+  /// their buffers, and are completed through the ring as usual.  Returns the
+  /// number of reads removed from the submission ring.
+  size_t FailOver(int error) {
+    ABSL_LOG(WARNING) << "io_uring_enter failed, falling back to pread: "
+                      << internal::GetOsErrorMessage(error);
+    std::vector<std::unique_ptr<Op>> ops;
+    for (unsigned i = sq_submitted_; i != sq_local_tail_; ++i) {
+      const uint64_t user_data = sqes_[i & sq_mask_].user_data;
+      if (user_data == kWakeupUserData) continue;
+      ops.emplace_back(reinterpret_cast<Op*>(user_data));
+    }
+    const size_t num_unsubmitted = ops.size();
+    // The kernel only consumes SQEs when they are submitted, so the tail may
+    // be moved back.
+    sq_local_tail_ = sq_submitted_;
+    StoreRelease(sq_tail_, sq_local_tail_);
+    {
+      absl::MutexLock lock(&mutex_);
+      failed_ = true;
+      for (auto& op : pending_) ops.push_back(std::move(op));
+      pending_.clear();
+      wakeup_requested_ = false;
+    }
+    for (auto& op : ops) ReadSync(std::move(op));
+    return num_unsubmitted;
+  }
+
+  void Wakeup() {
+    if (event_fd_ == -1) return;
+    uint64_t value = 1;
+    [[maybe_unused]] auto n = ::write(event_fd_, &value, sizeof(value));
+  }
+
+  /// Appends an SQE to the submission ring; the new tail is published by
+  /// `PublishSqes`.
+  ::io_uring_sqe* NextSqe() {
+    unsigned index = sq_local_tail_ & sq_mask_;
+    ++sq_local_tail_;
+    ::io_uring_sqe* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  void PrepareRead(std::unique_ptr<Op> op) {
+    ::io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = op->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(op->buf);
+    // Larger reads complete as short reads and are continued by the caller.
+    sqe->len = static_cast<uint32_t>(std::min<size_t>(op->count, 1u << 30));
+    sqe->off = static_cast<uint64_t>(op->offset);
+    sqe->user_data = reinterpret_cast<uint64_t>(op.release());
+  }
+
+  void PrepareWakeupPoll() {
+    ::io_uring_sqe* sqe = NextSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = event_fd_;
+    sqe->poll_events = POLLIN;
+    sqe->user_data = kWakeupUserData;
+  }
+
+  void Run() {
+    {
+      absl::MutexLock lock(&mutex_);
+      run_thread_id_ = internal::Thread::this_thread_id();
+    }
+    // Number of reads submitted to the kernel that have not completed.
+    size_t in_flight = 0;
+    bool poll_armed = false;
+    // Set once `io_uring_enter` has failed; see `FailOver`.
+    bool failed = false;
+    std::vector<std::pair<std::unique_ptr<Op>, ptrdiff_t>> completed;
+    while (true) {
+      size_t num_reads = 0;
+      {
+        absl::MutexLock lock(&mutex_);
+        if (failed && in_flight == 0) {
+          // No further completions are expected; wait for `Stop`.
+          mutex_.Await(absl::Condition(&stop_));
+          stopped_ = true;
+          break;
+        }
+        // One slot is reserved for the wakeup poll.  Limiting the number of
+        // outstanding requests to the SQ size also ensures that the CQ (which
+        // is twice as large) never overflows.
+        while (!pending_.empty() &&
+               in_flight + num_reads + 1 < sq_entries_) {
+          PrepareRead(std::move(pending_.front()));
+          pending_.pop_front();
+          ++num_reads;
+        }
+        if (pending_.empty()) wakeup_requested_ = false;
+        if (stop_ && pending_.empty() && in_flight + num_reads == 0) {
+          stopped_ = true;
+          break;
+        }
+      }
+      if (!poll_armed && !failed) {
+        PrepareWakeupPoll();
+        poll_armed = true;
+      }
+      StoreRelease(sq_tail_, sq_local_tail_);
+      in_flight += num_reads;
+      // Number of SQEs added to the ring but not yet consumed by the kernel.
+      const unsigned unsubmitted = sq_local_tail_ - sq_submitted_;
+      if (num_reads) {
+        io_uring_reads.IncrementBy(num_reads);
+        io_uring_submit_batches.Increment();
+      }
+
+      // Submit the batch and wait for at least one completion.
+      int r = IoUringEnter(ring_fd_, unsubmitted, 1, IORING_ENTER_GETEVENTS);
+      if (r < 0) {
+        int error = errno;
+        if (error != EINTR && error != EAGAIN && error != EBUSY) {
+          if (!failed) {
+            failed = true;
+            in_flight -= FailOver(error);
+          } else {
+            // Poll for the completion of the remaining reads.
+            absl::SleepFor(absl::Milliseconds(1));
+          }
+        }
+      } else {
+        sq_submitted_ += static_cast<unsigned>(r);
+      }
+
+      unsigned head = *cq_head_;
+      unsigned tail = LoadAcquire(cq_tail_);
+      for (; head != tail; ++head) {
+        const ::io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        if (cqe.user_data == kWakeupUserData) {
+          poll_armed = false;
+          uint64_t value;
+          [[maybe_unused]] auto n = ::read(event_fd_, &value, sizeof(value));
+          continue;
+        }
+        completed.emplace_back(
+            std::unique_ptr<Op>(reinterpret_cast<Op*>(cqe.user_data)),
+            static_cast<ptrdiff_t>(cqe.res));
+      }
+      StoreRelease(cq_head_, head);
+      in_flight -= completed.size();
+      for (auto& [op, result] : completed) {
+        std::move(op->callback)(result);
+      }
+      completed.clear();
+    }
+  }
+
+  int ring_fd_ = -1;
+  int event_fd_ = -1;
+  unsigned sq_entries_ = 0;
+  std::unique_ptr<RingMapping> sq_mapping_;
+  std::unique_ptr<RingMapping> cq_mapping_;
+  std::unique_ptr<RingMapping> sqes_mapping_;
+
+  // Ring pointers; only accessed by the event loop thread.
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  ::io_uring_sqe* sqes_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  ::io_uring_cqe* cqes_ = nullptr;
+  unsigned sq_local_tail_ = 0;
+  unsigned sq_submitted_ = 0;
+
+  absl::Mutex mutex_;
+  std::deque<std::unique_ptr<Op>> pending_ ABSL_GUARDED_BY(mutex_);
+  // Set when the event loop has been (or will be) woken to process
+  // `pending_`, to avoid redundant eventfd writes.
+  bool wakeup_requested_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stop_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  // Set by `FailOver`, after which reads are performed with `pread`.
+  bool failed_ ABSL_GUARDED_BY(mutex_) = false;
+  internal::Thread::Id run_thread_id_ ABSL_GUARDED_BY(mutex_);
+};
+
+class IoUringEngineImpl : public IoUringEngine {
+ public:
+  ~IoUringEngineImpl() override {
+    if (started_) ring_->Stop();
+  }
+
+  absl::Status Init(size_t queue_depth) {
+    ring_ = std::make_shared<IoUringRing>();
+    if (auto status = ring_->Init(queue_depth); !status.ok()) {
+      // Setup fails with a variety of errors, e.g. `EPERM` if io_uring is
+      // disabled by a seccomp policy; all of them mean it is unavailable.
+      return absl::UnimplementedError(
+          tensorstore::StrCat("io_uring is not available: ", status.message()));
+    }
+    IoUringRing::Start(ring_);
+    started_ = true;
+    return absl::OkStatus();
+  }
+
+  void Read(int fd, void* buf, size_t count, int64_t offset,
+            ReadCallback callback) override {
+    ring_->Read(fd, buf, count, offset, std::move(callback));
+  }
+
+ private:
+  std::shared_ptr<IoUringRing> ring_;
+  bool started_ = false;
+};
+
+#endif  // TENSORSTORE_INTERNAL_HAVE_IO_URING
+
+}  // namespace
+
+IoUringEngine::~IoUringEngine() = default;
+
+Result<IoUringEnginePtr> IoUringEngine::Create(size_t queue_depth) {
+#ifdef TENSORSTORE_INTERNAL_HAVE_IO_URING
+  auto engine = internal::MakeIntrusivePtr<IoUringEngineImpl>();
+  TENSORSTORE_RETURN_IF_ERROR(engine->Init(queue_depth));
+  return IoUringEnginePtr(std::move(engine));
+#else
+  return absl::UnimplementedError("io_uring is not supported on this platform");
+#endif
+}
+
+}  // namespace internal_file_kvstore
+}  // namespace tensorstore
@@ -0,0 +1,84 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_FILE_IO_URING_ENGINE_H_
+#define TENSORSTORE_KVSTORE_FILE_IO_URING_ENGINE_H_
+
+/// \file
+/// Asynchronous read engine for the "file" driver based on Linux io_uring.
+///
+/// Reads may be queued from any thread.  A single event loop thread per engine
+/// submits all reads queued since its last wakeup to the kernel with a single
+/// `io_uring_enter` call, reaps completions from the completion queue, and
+/// invokes the per-read callbacks.  Consequently, a read in progress does not
+/// occupy a `file_io_concurrency` thread.
+///
+/// On platforms other than Linux, or if the running kernel does not support
+/// io_uring (or it is disabled, e.g. by a seccomp policy), `Create` returns an
+/// error and the caller is expected to fall back to blocking reads.  If the
+/// ring fails after it has been set up, e.g. because `io_uring_enter` fails
+/// with `ENOMEM`, the engine itself falls back to blocking reads.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "absl/functional/any_invocable.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_file_kvstore {
+
+class IoUringEngine : public internal::AtomicReferenceCount<IoUringEngine> {
+ public:
+  /// Callback invoked from the engine thread when a read completes, or from
+  /// the thread that queued the read if the engine has fallen back to blocking
+  /// reads.
+  ///
+  /// The argument is the number of bytes read (`0` indicates end of file), or
+  /// the negated `errno` value in the case of an error.  The callback must not
+  /// block; it may queue additional reads on the same engine.
+  using ReadCallback = absl::AnyInvocable<void(ptrdiff_t) &&>;
+
+  /// Creates a new engine with its own submission/completion queues.
+  ///
+  /// \param queue_depth Minimum number of reads that may be in flight
+  ///     concurrently; additional reads are queued until a slot is available.
+  /// \error `absl::StatusCode::kUnimplemented` if io_uring is not available,
+  ///     including if setting up a ring fails for any reason.
+  static Result<internal::IntrusivePtr<IoUringEngine>> Create(
+      size_t queue_depth);
+
+  /// Waits for all queued reads to complete and then stops the event loop.
+  ///
+  /// If the last reference is released by a read callback, the event loop
+  /// instead stops asynchronously once the remaining reads have completed.
+  virtual ~IoUringEngine();
+
+  /// Queues a read of up to `count` bytes starting at `offset` in `fd`.
+  ///
+  /// `fd` and `buf` must remain valid until `callback` is invoked.  Queued
+  /// reads complete even if the last reference to the engine is released, but
+  /// `callback` may only queue a continuation read, e.g. after a short read, if
+  /// it holds a reference to the engine.
+  virtual void Read(int fd, void* buf, size_t count, int64_t offset,
+                    ReadCallback callback) = 0;
+};
+
+using IoUringEnginePtr = internal::IntrusivePtr<IoUringEngine>;
+
+}  // namespace internal_file_kvstore
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_FILE_IO_URING_ENGINE_H_
@@ -0,0 +1,153 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/file/io_uring_engine.h"
+
+#include <stddef.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "tensorstore/internal/testing/scoped_directory.h"
+
+// Include these last to reduce impact of macros.
+#include "tensorstore/kvstore/file/posix_file_util.h"
+
+// `IoUringEngine` operates on POSIX file descriptors.
+#ifndef _WIN32
+
+namespace {
+
+using ::tensorstore::internal_file_kvstore::IoUringEngine;
+using ::tensorstore::internal_file_util::OpenExistingFileForReading;
+using ::tensorstore::internal_testing::ScopedTemporaryDirectory;
+
+TEST(IoUringEngineTest, Read) {
+  auto engine = IoUringEngine::Create(/*queue_depth=*/4);
+  if (!engine.ok()) {
+    EXPECT_EQ(absl::StatusCode::kUnimplemented, engine.status().code())
+        << engine.status();
+    GTEST_SKIP() << engine.status();
+  }
+
+  ScopedTemporaryDirectory tempdir;
+  std::string path = tempdir.path() + "/data";
+  std::string contents;
+  for (int i = 0; i < 4096; ++i) contents += static_cast<char>(i * 7);
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << contents;
+  }
+  auto fd = OpenExistingFileForReading(path.c_str());
+  ASSERT_TRUE(fd.valid());
+
+  // Queue more reads than the queue depth to exercise pending reads.
+  constexpr size_t kNumReads = 64;
+  constexpr size_t kReadSize = 100;
+  std::vector<std::string> buffers(kNumReads, std::string(kReadSize, '\0'));
+  std::vector<ptrdiff_t> results(kNumReads, -1);
+  absl::BlockingCounter counter(kNumReads);
+  for (size_t i = 0; i < kNumReads; ++i) {
+    (*engine)->Read(fd.get(), buffers[i].data(), kReadSize, i * 50,
+                    [&, i](ptrdiff_t n) {
+                      results[i] = n;
+                      counter.DecrementCount();
+                    });
+  }
+  counter.Wait();
+  for (size_t i = 0; i < kNumReads; ++i) {
+    EXPECT_EQ(kReadSize, results[i]) << i;
+    EXPECT_EQ(contents.substr(i * 50, kReadSize), buffers[i]) << i;
+  }
+
+  // Read past the end of file.
+  ptrdiff_t eof_result = -1;
+  {
+    absl::BlockingCounter eof_counter(1);
+    char buf[10];
+    (*engine)->Read(fd.get(), buf, sizeof(buf), contents.size(),
+                    [&](ptrdiff_t n) {
+                      eof_result = n;
+                      eof_counter.DecrementCount();
+                    });
+    eof_counter.Wait();
+  }
+  EXPECT_EQ(0, eof_result);
+}
+
+TEST(IoUringEngineTest, DestroyWaitsForPendingReads) {
+  auto engine = IoUringEngine::Create(/*queue_depth=*/2);
+  if (!engine.ok()) GTEST_SKIP() << engine.status();
+
+  ScopedTemporaryDirectory tempdir;
+  std::string path = tempdir.path() + "/data";
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << std::string(1000, 'x');
+  }
+  auto fd = OpenExistingFileForReading(path.c_str());
+  ASSERT_TRUE(fd.valid());
+
+  constexpr size_t kNumReads = 16;
+  std::vector<std::string> buffers(kNumReads, std::string(10, '\0'));
+  size_t num_completed = 0;
+  for (size_t i = 0; i < kNumReads; ++i) {
+    (*engine)->Read(fd.get(), buffers[i].data(), buffers[i].size(), i * 10,
+                    [&](ptrdiff_t n) {
+                      EXPECT_EQ(10, n);
+                      ++num_completed;
+                    });
+  }
+  // Callbacks are invoked sequentially from the engine thread, and the
+  // destructor waits for it to stop.
+  *engine = {};
+  EXPECT_EQ(kNumReads, num_completed);
+}
+
+TEST(IoUringEngineTest, ReleaseLastReferenceFromCallback) {
+  auto engine = IoUringEngine::Create(/*queue_depth=*/2);
+  if (!engine.ok()) GTEST_SKIP() << engine.status();
+
+  ScopedTemporaryDirectory tempdir;
+  std::string path = tempdir.path() + "/data";
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << std::string(10, 'x');
+  }
+  auto fd = OpenExistingFileForReading(path.c_str());
+  ASSERT_TRUE(fd.valid());
+
+  std::string buffer(10, '\0');
+  absl::Notification done;
+  auto* engine_ptr = engine->get();
+  engine_ptr->Read(fd.get(), buffer.data(), buffer.size(), 0,
+                   [&, engine = *std::move(engine)](ptrdiff_t n) mutable {
+                     EXPECT_EQ(10, n);
+                     // Destroys the engine on its own event loop thread.
+                     engine = {};
+                     done.Notify();
+                   });
+  done.WaitForNotification();
+  EXPECT_EQ(std::string(10, 'x'), buffer);
+}
+
+}  // namespace
+
+#endif  // !defined(_WIN32)
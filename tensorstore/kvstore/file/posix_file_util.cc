@@ -17,6 +17,7 @@
 #include "tensorstore/kvstore/file/posix_file_util.h"
 
 // More system headers
+#include <sys/mman.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
@@ -73,6 +74,23 @@ UniqueFileDescriptor OpenFileForWriting(const std::string& path) {
   return fd;
 }
 
+size_t GetMapAlignment() {
+  static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+const char* MapFileRegion(FileDescriptor fd, int64_t offset, size_t size) {
+  PotentiallyBlockingRegion region;
+  void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd,
+                     static_cast<off_t>(offset));
+  if (ptr == MAP_FAILED) return nullptr;
+  return static_cast<const char*>(ptr);
+}
+
+void UnmapFileRegion(const char* data, size_t size) {
+  ::munmap(const_cast<char*>(data), size);
+}
+
 std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value) {
   absl::InlinedVector<iovec, 16> iovs;
 
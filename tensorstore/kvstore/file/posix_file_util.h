@@ -164,6 +164,30 @@ inline ptrdiff_t ReadFromFile(FileDescriptor fd, void* buf, size_t count,
   return ::pread(fd, buf, count, static_cast<off_t>(offset));
 }
 
+/// Returns the alignment required for the `offset` passed to `MapFileRegion`.
+size_t GetMapAlignment();
+
+/// Maps a region of an open file into memory for reading.
+///
+/// The mapping remains valid after `fd` is closed, until it is released by
+/// `UnmapFileRegion`.  Accessing the mapping after the file has been truncated
+/// results in undefined behavior (`SIGBUS` on POSIX).
+///
+/// \param fd Open file descriptor.
+/// \param offset Byte offset within file at which the mapping starts.  Must be
+///     a multiple of `GetMapAlignment()`.
+/// \param size Number of bytes to map, must be non-zero.
+/// \returns Pointer to the mapped memory on success.  Returns `nullptr` to
+///     indicate an error (in which case `GetLastErrorCode()` retrieves the
+///     error).
+const char* MapFileRegion(FileDescriptor fd, int64_t offset, size_t size);
+
+/// Releases a mapping created by `MapFileRegion`.
+///
+/// \param data Pointer returned by `MapFileRegion`.
+/// \param size The size passed to `MapFileRegion`.
+void UnmapFileRegion(const char* data, size_t size);
+
 /// Writes to an open file.
 ///
 /// \param fd Open file descriptor.
@@ -100,6 +100,38 @@ std::ptrdiff_t WriteToFile(FileDescriptor fd, const void* buf,
   return static_cast<std::size_t>(num_written);
 }
 
+std::size_t GetMapAlignment() {
+  static const std::size_t granularity = [] {
+    ::SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    return static_cast<std::size_t>(info.dwAllocationGranularity);
+  }();
+  return granularity;
+}
+
+const char* MapFileRegion(FileDescriptor fd, std::int64_t offset,
+                          std::size_t size) {
+  HANDLE mapping =
+      ::CreateFileMappingW(fd, /*lpFileMappingAttributes=*/nullptr,
+                           PAGE_READONLY, /*dwMaximumSizeHigh=*/0,
+                           /*dwMaximumSizeLow=*/0, /*lpName=*/nullptr);
+  if (mapping == nullptr) return nullptr;
+  const auto uoffset = static_cast<std::uint64_t>(offset);
+  void* ptr = ::MapViewOfFile(mapping, FILE_MAP_READ,
+                              static_cast<DWORD>(uoffset >> 32),
+                              static_cast<DWORD>(uoffset & 0xffffffff), size);
+  // The file mapping object is kept alive by the view.  Preserve the error
+  // code from `MapViewOfFile`, if any.
+  DWORD error = ::GetLastError();
+  ::CloseHandle(mapping);
+  ::SetLastError(error);
+  return static_cast<const char*>(ptr);
+}
+
+void UnmapFileRegion(const char* data, std::size_t size) {
+  ::UnmapViewOfFile(data);
+}
+
 std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value) {
   // If we switched to OVERLAPPED io on Windows, then using WriteFileGather
   // would be similar to the unix ::writev call.
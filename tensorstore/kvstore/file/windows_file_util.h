@@ -94,6 +94,11 @@ std::ptrdiff_t ReadFromFile(FileDescriptor fd, void* buf, std::size_t count,
 std::ptrdiff_t WriteToFile(FileDescriptor fd, const void* buf,
                            std::size_t count);
 
+std::size_t GetMapAlignment();
+const char* MapFileRegion(FileDescriptor fd, std::int64_t offset,
+                          std::size_t size);
+void UnmapFileRegion(const char* data, std::size_t size);
+
 std::ptrdiff_t WriteCordToFile(FileDescriptor fd, absl::Cord value);
 
 inline bool TruncateFile(FileDescriptor fd) {
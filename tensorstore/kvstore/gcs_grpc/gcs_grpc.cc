@@ -56,6 +56,7 @@
 #include "tensorstore/internal/source_location.h"
 #include "tensorstore/internal/thread/schedule_at.h"
 #include "tensorstore/internal/uri_utils.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/gcs/gcs_resource.h"
@@ -1042,6 +1043,10 @@ struct DeleteRangeListReceiver {
 /// Key value store operations.
 Future<kvstore::ReadResult> GcsGrpcKeyValueStore::Read(Key key,
                                                        ReadOptions options) {
+  if (options.batch) {
+    return internal_kvstore_batch::BatchRead(*this, std::move(key),
+                                             std::move(options));
+  }
   gcs_grpc_read.Increment();
   if (!IsValidObjectName(key)) {
     return absl::InvalidArgumentError("Invalid blob object name");
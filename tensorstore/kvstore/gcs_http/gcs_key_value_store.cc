@@ -15,12 +15,14 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
@@ -30,8 +32,10 @@
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -44,6 +48,7 @@
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/http/request_hedging.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json/json.h"
 #include "tensorstore/internal/json_binding/bindable.h"
@@ -59,6 +64,7 @@
 #include "tensorstore/internal/source_location.h"
 #include "tensorstore/internal/thread/schedule_at.h"
 #include "tensorstore/internal/uri_utils.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/gcs/gcs_resource.h"
@@ -67,12 +73,17 @@
 #include "tensorstore/kvstore/gcs_http/object_metadata.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operation_metrics.h"
 #include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/parallel_read.h"
 #include "tensorstore/kvstore/read_result.h"
 #include "tensorstore/kvstore/registry.h"
 #include "tensorstore/kvstore/spec.h"
 #include "tensorstore/kvstore/supported_features.h"
 #include "tensorstore/kvstore/url_registry.h"
+#include "tensorstore/transaction.h"
+#include "tensorstore/util/division.h"
 #include "tensorstore/util/execution/any_receiver.h"
 #include "tensorstore/util/execution/execution.h"
 #include "tensorstore/util/executor.h"
@@ -159,6 +170,10 @@ auto& gcs_write_latency_ms =
         "/tensorstore/kvstore/gcs/write_latency_ms",
         "GCS driver kvstore::Write latency (ms)");
 
+auto& gcs_copy = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/gcs/copy",
+    "Objects copied within GCS by kvstore::ExperimentalCopyRange");
+
 auto& gcs_delete_range = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/gcs/delete_range",
     "GCS driver kvstore::DeleteRange calls");
@@ -229,18 +244,38 @@ std::string BucketUploadRoot(std::string_view bucket) {
                              "/b/", bucket);
 }
 
+/// Default size above which values are written using a resumable upload.
+constexpr size_t kDefaultResumableUploadThreshold = 64 * 1024 * 1024;
+
+/// Default size of each chunk of a resumable upload.
+constexpr size_t kDefaultResumableChunkSize = 16 * 1024 * 1024;
+
+/// GCS requires each chunk of a resumable upload, other than the last, to be a
+/// multiple of 256 KiB.
+constexpr size_t kResumableChunkSizeMultiple = 256 * 1024;
+
+/// Maximum number of source objects of a single compose request.
+constexpr size_t kMaxComposeComponents = 32;
+
 struct GcsKeyValueStoreSpecData {
   std::string bucket;
+  size_t resumable_upload_threshold;
+  size_t resumable_chunk_size;
+  size_t composite_upload_threshold;
+  size_t parallel_read_part_size;
 
   Context::Resource<GcsConcurrencyResource> request_concurrency;
   std::optional<Context::Resource<GcsRateLimiterResource>> rate_limiter;
   Context::Resource<GcsUserProjectResource> user_project;
   Context::Resource<GcsRequestRetries> retries;
   Context::Resource<DataCopyConcurrencyResource> data_copy_concurrency;
+  std::optional<internal_http::RequestHedgingOptions> read_hedging;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(x.bucket, x.request_concurrency, x.rate_limiter, x.user_project,
-             x.retries, x.data_copy_concurrency);
+    return f(x.bucket, x.resumable_upload_threshold, x.resumable_chunk_size,
+             x.composite_upload_threshold, x.parallel_read_part_size,
+             x.request_concurrency, x.rate_limiter, x.user_project, x.retries,
+             x.data_copy_concurrency, x.read_hedging);
   };
 
   constexpr static auto default_json_binder = jb::Object(
@@ -255,6 +290,33 @@ struct GcsKeyValueStoreSpecData {
                        }
                        return absl::OkStatus();
                      }))),
+      jb::Member(
+          "resumable_upload_threshold",
+          jb::Projection<&GcsKeyValueStoreSpecData::resumable_upload_threshold>(
+              jb::DefaultValue(
+                  [](auto* v) { *v = kDefaultResumableUploadThreshold; }))),
+      jb::Member(
+          "resumable_chunk_size",
+          jb::Projection<&GcsKeyValueStoreSpecData::resumable_chunk_size>(
+              jb::DefaultValue(
+                  [](auto* v) { *v = kDefaultResumableChunkSize; },
+                  jb::Validate([](const auto& options, const size_t* x) {
+                    if (*x == 0 || *x % kResumableChunkSizeMultiple != 0) {
+                      return absl::InvalidArgumentError(tensorstore::StrCat(
+                          "resumable_chunk_size must be a positive multiple "
+                          "of ",
+                          kResumableChunkSizeMultiple));
+                    }
+                    return absl::OkStatus();
+                  })))),
+      jb::Member(
+          "composite_upload_threshold",
+          jb::Projection<&GcsKeyValueStoreSpecData::composite_upload_threshold>(
+              jb::DefaultValue([](auto* v) { *v = 0; }))),
+      jb::Member(
+          "parallel_read_part_size",
+          jb::Projection<&GcsKeyValueStoreSpecData::parallel_read_part_size>(
+              jb::DefaultValue([](auto* v) { *v = 0; }))),
 
       jb::Member(
           GcsConcurrencyResource::id,
@@ -271,7 +333,12 @@ struct GcsKeyValueStoreSpecData {
                  jb::Projection<&GcsKeyValueStoreSpecData::retries>()),
       jb::Member(DataCopyConcurrencyResource::id,
                  jb::Projection<
-                     &GcsKeyValueStoreSpecData::data_copy_concurrency>()) /**/
+                     &GcsKeyValueStoreSpecData::data_copy_concurrency>()),
+      jb::Member("experimental_read_hedging",
+                 jb::Projection<&GcsKeyValueStoreSpecData::read_hedging>(
+                     jb::Optional(
+                         internal_http::RequestHedgingOptions::JsonBinder())))
+      /**/
   );
 };
 
@@ -316,12 +383,39 @@ class GcsKeyValueStore
                                              std::optional<Value> value,
                                              WriteOptions options) override;
 
+  /// Writes a value of at least `composite_upload_threshold` bytes using a
+  /// parallel composite upload.
+  Future<TimestampedStorageGeneration> WriteComposite(Key key, Value value,
+                                                      WriteOptions options);
+
+  /// Writes `value` to a single object, without a composite upload.
+  Future<TimestampedStorageGeneration> WriteObject(
+      std::string encoded_object_name, Value value, WriteOptions options);
+
   void ListImpl(ListOptions options, ListReceiver receiver) override;
 
   Future<const void> DeleteRange(KeyRange range) override;
 
-  /// Returns the Auth header for a GCS request.
-  Result<std::optional<std::string>> GetAuthHeader() {
+  Future<const void> ExperimentalCopyRangeFrom(
+      const internal::OpenTransactionPtr& transaction, const KvStore& source,
+      Key target_prefix, kvstore::CopyRangeOptions options) override;
+
+  /// Returns `true` if objects of `source` may be copied by GCS on behalf of
+  /// this store, i.e. if both stores send requests through the same transport
+  /// with the same credentials and user project.  The endpoint is determined
+  /// per process and is therefore always the same.
+  bool CanCopyObjectsFrom(GcsKeyValueStore& source);
+
+  /// Copies the object `source_key` of the bucket with resource root
+  /// `source_resource_root` to `target_key` without transferring its contents
+  /// through the client.
+  Future<TimestampedStorageGeneration> CopyObject(
+      std::string_view source_resource_root, std::string_view source_key,
+      Key target_key);
+
+  /// Returns the provider of credentials for GCS requests, or `nullptr` for
+  /// anonymous access.
+  Result<std::shared_ptr<internal_oauth2::AuthProvider>> GetAuthProvider() {
     absl::MutexLock lock(&auth_provider_mutex_);
     if (!auth_provider_) {
       auto result = tensorstore::internal_oauth2::GetSharedGoogleAuthProvider();
@@ -332,8 +426,14 @@ class GcsKeyValueStore
         auth_provider_ = std::move(*result);
       }
     }
-    if (!*auth_provider_) return std::nullopt;
-    auto auth_header_result = (*auth_provider_)->GetAuthHeader();
+    return *auth_provider_;
+  }
+
+  /// Returns the Auth header for a GCS request.
+  Result<std::optional<std::string>> GetAuthHeader() {
+    TENSORSTORE_ASSIGN_OR_RETURN(auto auth_provider, GetAuthProvider());
+    if (!auth_provider) return std::nullopt;
+    auto auth_header_result = auth_provider->GetAuthHeader();
     if (!auth_header_result.ok() &&
         absl::IsNotFound(auth_header_result.status())) {
       return std::nullopt;
@@ -409,6 +509,9 @@ class GcsKeyValueStore
 
   std::shared_ptr<HttpTransport> transport_;
 
+  // Set if reads are hedged.
+  std::shared_ptr<internal_http::RequestHedger> read_hedger_;
+
   absl::Mutex auth_provider_mutex_;
   // Optional state indicates whether the provider has been obtained.  A
   // nullptr provider is valid and indicates to use anonymous access.
@@ -421,6 +524,10 @@ Future<kvstore::DriverPtr> GcsKeyValueStoreSpec::DoOpen() const {
   driver->resource_root_ = BucketResourceRoot(data_.bucket);
   driver->upload_root_ = BucketUploadRoot(data_.bucket);
   driver->transport_ = internal_http::GetDefaultHttpTransport();
+  if (data_.read_hedging) {
+    driver->read_hedger_ =
+        std::make_shared<internal_http::RequestHedger>(*data_.read_hedging);
+  }
 
   // NOTE: Remove temporary logging use of experimental feature.
   if (data_.rate_limiter.has_value()) {
@@ -433,6 +540,22 @@ Future<kvstore::DriverPtr> GcsKeyValueStoreSpec::DoOpen() const {
   return driver;
 }
 
+/// Returns a random 128-bit identifier as 32 hex digits.
+std::string GetRandomId() {
+  struct RandomState {
+    absl::Mutex mutex;
+    absl::BitGen gen ABSL_GUARDED_BY(mutex);
+  };
+  static RandomState random_state;
+  uint64_t uuid[2];
+  absl::MutexLock lock(&random_state.mutex);
+  for (auto& x : uuid) {
+    x = absl::Uniform<uint64_t>(random_state.gen);
+  }
+  return tensorstore::StrCat(absl::Hex(uuid[0], absl::kZeroPad16),
+                             absl::Hex(uuid[1], absl::kZeroPad16));
+}
+
 // GCS does not follow HTTP spec as far as respecting `cache-control` request
 // headers.
 //
@@ -445,25 +568,17 @@ Future<kvstore::DriverPtr> GcsKeyValueStoreSpec::DoOpen() const {
 // As a workaround, specify a unique query parameter in every request.  That
 // ensures the cache is bypassed.
 void AddUniqueQueryParameterToDisableCaching(std::string& url) {
-  struct RandomState {
-    absl::Mutex mutex;
-    absl::BitGen gen ABSL_GUARDED_BY(mutex);
-  };
-  static RandomState random_state;
-  uint64_t uuid[2];
-  absl::MutexLock lock(&random_state.mutex);
-  for (auto& x : uuid) {
-    x = absl::Uniform<uint64_t>(random_state.gen);
-  }
-  tensorstore::StrAppend(&url,
-                         "&tensorstore=", absl::Hex(uuid[0], absl::kZeroPad16),
-                         absl::Hex(uuid[1], absl::kZeroPad16));
+  tensorstore::StrAppend(&url, "&tensorstore=", GetRandomId());
 }
 
 ////////////////////////////////////////////////////
 
 /// A ReadTask is a function object used to satisfy a
 /// GcsKeyValueStore::Read request.
+///
+/// When `part_size_` is non-zero, only the first `part_size_` bytes of the
+/// requested byte range are read by this task, and the remaining bytes are
+/// read concurrently by `internal_kvstore::ReadRemainingParts`.
 struct ReadTask : public RateLimiterNode,
                   public internal::AtomicReferenceCount<ReadTask> {
   IntrusivePtr<GcsKeyValueStore> owner;
@@ -471,6 +586,11 @@ struct ReadTask : public RateLimiterNode,
   kvstore::ReadOptions options;
   Promise<kvstore::ReadResult> promise;
 
+  std::string key_;
+  int64_t part_size_ = 0;
+  ByteRange remaining_{0, 0};
+  int restarts_ = 0;
+
   int attempt_ = 0;
   absl::Time start_time_;
 
@@ -483,6 +603,12 @@ struct ReadTask : public RateLimiterNode,
 
   ~ReadTask() { owner->admission_queue().Finish(this); }
 
+  /// Submits `task` to the read rate limiter.
+  static void Schedule(IntrusivePtr<ReadTask> task) {
+    intrusive_ptr_increment(task.get());  // adopted by ReadTask::Start.
+    task->owner->read_rate_limiter().Admit(task.get(), &ReadTask::Start);
+  }
+
   static void Start(void* task) {
     auto* self = reinterpret_cast<ReadTask*>(task);
     self->owner->read_rate_limiter().Finish(self);
@@ -527,7 +653,11 @@ struct ReadTask : public RateLimiterNode,
     if (maybe_auth_header.value().has_value()) {
       request_builder.AddHeader(*maybe_auth_header.value());
     }
-    if (options.byte_range.size() != 0) {
+    if (part_size_ != 0) {
+      request_builder.MaybeAddRangeHeader(
+          internal_kvstore::GetFirstPartByteRange(options.byte_range,
+                                                  part_size_));
+    } else if (options.byte_range.size() != 0) {
       request_builder.MaybeAddRangeHeader(options.byte_range);
     }
 
@@ -535,7 +665,12 @@ struct ReadTask : public RateLimiterNode,
     start_time_ = absl::Now();
 
     ABSL_LOG_IF(INFO, gcs_http_logging) << "ReadTask: " << request;
-    auto future = owner->transport_->IssueRequest(request, {});
+    auto future =
+        owner->read_hedger_
+            ? internal_http::IssueHedgedRequest(
+                  owner->read_hedger_, owner->transport_, std::move(request),
+                  owner->spec_.request_concurrency->queue)
+            : owner->transport_->IssueRequest(request, {});
     future.ExecuteWhenReady([self = IntrusivePtr<ReadTask>(this)](
                                 ReadyFuture<HttpResponse> response) {
       self->OnResponse(response.result());
@@ -549,6 +684,15 @@ struct ReadTask : public RateLimiterNode,
     ABSL_LOG_IF(INFO, gcs_http_logging.Level(1) && response.ok())
         << "ReadTask " << *response;
 
+    if (part_size_ != 0 && response.ok() &&
+        response.value().status_code == 416) {
+      // The value ends before the first part begins (e.g. it is empty), so the
+      // range is not satisfiable; read the value without splitting instead.
+      part_size_ = 0;
+      Retry();
+      return;
+    }
+
     absl::Status status = [&]() -> absl::Status {
       if (!response.ok()) return response.status();
       switch (response.value().status_code) {
@@ -570,9 +714,31 @@ struct ReadTask : public RateLimiterNode,
     }
     if (!status.ok()) {
       promise.SetResult(status);
-    } else {
-      promise.SetResult(FinishResponse(response.value()));
+      return;
+    }
+    auto result = FinishResponse(response.value());
+    if (result.ok() && remaining_.size() != 0) {
+      // A restart is a new task, such that this task does not hold its
+      // admission queue slot while the remaining parts are read.
+      auto restart = [owner = owner, resource = resource, options = options,
+                      key = key_, part_size = part_size_,
+                      restarts = restarts_ + 1](
+                         Promise<kvstore::ReadResult> promise) mutable {
+        auto task = internal::MakeIntrusivePtr<ReadTask>(
+            std::move(owner), std::move(resource), std::move(options),
+            std::move(promise));
+        task->key_ = std::move(key);
+        task->part_size_ = part_size;
+        task->restarts_ = restarts;
+        Schedule(std::move(task));
+      };
+      internal_kvstore::ReadRemainingParts(
+          std::move(promise), owner, std::move(key_), options,
+          *std::move(result), remaining_, part_size_, restarts_,
+          std::move(restart));
+      return;
     }
+    promise.SetResult(std::move(result));
   }
 
   Result<kvstore::ReadResult> FinishResponse(const HttpResponse& httpresponse) {
@@ -617,11 +783,17 @@ struct ReadTask : public RateLimiterNode,
         TENSORSTORE_ASSIGN_OR_RETURN(auto content_range_tuple,
                                      ParseContentRangeHeader(httpresponse));
 
-        if (auto request_size = options.byte_range.size();
-            (options.byte_range.inclusive_min != -1 &&
-             options.byte_range.inclusive_min !=
-                 std::get<0>(content_range_tuple)) ||
-            (request_size >= 0 && request_size != value.size())) {
+        if (part_size_ != 0) {
+          TENSORSTORE_ASSIGN_OR_RETURN(
+              remaining_, internal_kvstore::GetRemainingByteRange(
+                              options.byte_range, part_size_,
+                              std::get<0>(content_range_tuple), value.size(),
+                              std::get<2>(content_range_tuple)));
+        } else if (auto request_size = options.byte_range.size();
+                   (options.byte_range.inclusive_min != -1 &&
+                    options.byte_range.inclusive_min !=
+                        std::get<0>(content_range_tuple)) ||
+                   (request_size >= 0 && request_size != value.size())) {
           // Return an error when the response does not start at the requested
           // offset of when the response is smaller than the desired size.
           return absl::OutOfRangeError(
@@ -650,6 +822,10 @@ struct ReadTask : public RateLimiterNode,
 
 Future<kvstore::ReadResult> GcsKeyValueStore::Read(Key key,
                                                    ReadOptions options) {
+  if (options.batch) {
+    return internal_kvstore_batch::BatchRead(*this, std::move(key),
+                                             std::move(options));
+  }
   gcs_read.Increment();
   if (!IsValidObjectName(key)) {
     return absl::InvalidArgumentError("Invalid GCS object name");
@@ -663,18 +839,56 @@ Future<kvstore::ReadResult> GcsKeyValueStore::Read(Key key,
   std::string resource = tensorstore::internal::JoinPath(resource_root_, "/o/",
                                                          encoded_object_name);
 
+  const int64_t part_size = spec_.parallel_read_part_size;
+  const bool split = internal_kvstore::ShouldSplitRead(options, part_size);
+
   auto op = PromiseFuturePair<ReadResult>::Make();
   auto state = internal::MakeIntrusivePtr<ReadTask>(
       internal::IntrusivePtr<GcsKeyValueStore>(this), std::move(resource),
       std::move(options), std::move(op.promise));
+  if (split) {
+    state->key_ = std::move(key);
+    state->part_size_ = part_size;
+  }
+  ReadTask::Schedule(std::move(state));
+  return internal_kvstore::RecordReadMetrics(GcsKeyValueStoreSpec::id,
+                                             std::move(op.future));
+}
 
-  intrusive_ptr_increment(state.get());  // adopted by ReadTask::Start.
-  read_rate_limiter().Admit(state.get(), &ReadTask::Start);
-  return std::move(op.future);
+/// Deletes the temporary component objects of a parallel composite upload.
+void DeleteComposeComponents(GcsKeyValueStore& owner,
+                             const std::vector<std::string>& components) {
+  for (const auto& name : components) {
+    owner.Write(name, std::nullopt, {}).IgnoreFuture();
+  }
+}
+
+/// Returns the number of bytes persisted by GCS, as indicated by the `range`
+/// header of a "308 Resume Incomplete" response to a resumable upload request.
+Result<size_t> GetResumableUploadCommittedSize(const HttpResponse& response) {
+  auto it = response.headers.find("range");
+  if (it == response.headers.end()) {
+    // No bytes have been persisted.
+    return 0;
+  }
+  std::string_view range = it->second;
+  size_t last_byte;
+  if (!absl::ConsumePrefix(&range, "bytes=0-") ||
+      !absl::SimpleAtoi(range, &last_byte)) {
+    return absl::InvalidArgumentError(
+        tensorstore::StrCat("Invalid range header in resumable upload "
+                            "response: ",
+                            QuoteString(it->second)));
+  }
+  return last_byte + 1;
 }
 
 /// A WriteTask is a function object used to satisfy a
 /// GcsKeyValueStore::Write request.
+///
+/// Values of at least `resumable_upload_threshold` bytes are written using a
+/// resumable upload, and values written using a parallel composite upload are
+/// completed by composing the `compose_components_` objects.
 struct WriteTask : public RateLimiterNode,
                    public internal::AtomicReferenceCount<WriteTask> {
   IntrusivePtr<GcsKeyValueStore> owner;
@@ -686,6 +900,18 @@ struct WriteTask : public RateLimiterNode,
   int attempt_ = 0;
   absl::Time start_time_;
 
+  // State of a resumable upload.  The session url is obtained by the first
+  // request; each subsequent request uploads the next chunk, starting at the
+  // number of bytes persisted by GCS.  After an interrupted request, the
+  // persisted size is queried before resuming so that bytes which GCS has
+  // already received are not sent again.
+  std::string session_url_;
+  size_t committed_size_ = 0;
+  bool query_committed_size_ = false;
+
+  // Names of the component objects to compose into the object.
+  std::vector<std::string> compose_components_;
+
   WriteTask(IntrusivePtr<GcsKeyValueStore> owner,
             std::string encoded_object_name, absl::Cord value,
             kvstore::WriteOptions options,
@@ -696,7 +922,11 @@ struct WriteTask : public RateLimiterNode,
         options(std::move(options)),
         promise(std::move(promise)) {}
 
-  ~WriteTask() { owner->admission_queue().Finish(this); }
+  ~WriteTask() {
+    owner->admission_queue().Finish(this);
+    // The components are no longer needed once the compose request completes.
+    DeleteComposeComponents(*owner, compose_components_);
+  }
 
   static void Start(void* task) {
     auto* self = reinterpret_cast<WriteTask*>(task);
@@ -711,11 +941,25 @@ struct WriteTask : public RateLimiterNode,
         });
   }
 
+  bool IsResumable() const {
+    const auto& spec = owner->spec_;
+    return spec.resumable_upload_threshold != 0 &&
+           value.size() >= spec.resumable_upload_threshold;
+  }
+
   /// Writes an object to GCS.
   void Retry() {
     if (!promise.result_needed()) {
       return;
     }
+    if (!compose_components_.empty()) {
+      RetryCompose();
+      return;
+    }
+    if (IsResumable()) {
+      RetryResumable();
+      return;
+    }
     // We use the SimpleUpload technique.
 
     std::string upload_url =
@@ -755,6 +999,184 @@ struct WriteTask : public RateLimiterNode,
     });
   }
 
+  /// Issues the next request of a resumable upload.
+  void RetryResumable() {
+    auto maybe_auth_header = owner->GetAuthHeader();
+    if (!maybe_auth_header.ok()) {
+      promise.SetResult(maybe_auth_header.status());
+      return;
+    }
+
+    absl::Cord payload;
+    std::optional<HttpRequestBuilder> request_builder;
+    if (session_url_.empty()) {
+      std::string upload_url = tensorstore::StrCat(
+          owner->upload_root(), "/o", "?uploadType=resumable",
+          "&name=", encoded_object_name);
+      AddGenerationParam(&upload_url, true, "ifGenerationMatch",
+                         options.if_equal);
+      AddUserProjectParam(&upload_url, true, owner->encoded_user_project());
+      request_builder.emplace("POST", upload_url);
+      request_builder->AddHeader("Content-Length: 0")
+          .AddHeader("X-Upload-Content-Type: application/octet-stream")
+          .AddHeader(tensorstore::StrCat("X-Upload-Content-Length: ",
+                                         value.size()));
+      start_time_ = absl::Now();
+    } else if (query_committed_size_) {
+      request_builder.emplace("PUT", session_url_);
+      request_builder->AddHeader("Content-Length: 0")
+          .AddHeader(
+              tensorstore::StrCat("Content-Range: bytes */", value.size()));
+    } else {
+      payload =
+          value.Subcord(committed_size_, owner->spec_.resumable_chunk_size);
+      request_builder.emplace("PUT", session_url_);
+      request_builder
+          ->AddHeader(tensorstore::StrCat("Content-Length: ", payload.size()))
+          .AddHeader(tensorstore::StrCat(
+              "Content-Range: bytes ", committed_size_, "-",
+              committed_size_ + payload.size() - 1, "/", value.size()));
+    }
+    if (maybe_auth_header.value().has_value()) {
+      request_builder->AddHeader(*maybe_auth_header.value());
+    }
+    auto request = request_builder->BuildRequest();
+
+    ABSL_LOG_IF(INFO, gcs_http_logging)
+        << "WriteTask (resumable): " << request << " size=" << payload.size();
+
+    auto future = owner->transport_->IssueRequest(request, std::move(payload));
+    future.ExecuteWhenReady([self = IntrusivePtr<WriteTask>(this)](
+                                ReadyFuture<HttpResponse> response) {
+      self->OnResumableResponse(response.result());
+    });
+  }
+
+  void OnResumableResponse(const Result<HttpResponse>& response) {
+    if (!promise.result_needed()) {
+      return;
+    }
+    ABSL_LOG_IF(INFO, gcs_http_logging.Level(1) && response.ok())
+        << "WriteTask (resumable) " << *response;
+
+    absl::Status status = [&]() -> absl::Status {
+      if (!response.ok()) return response.status();
+      switch (response.value().status_code) {
+        case 308:
+          // Resume incomplete: the upload continues.
+          [[fallthrough]];
+        case 304:
+          [[fallthrough]];
+        case 412:
+          return absl::OkStatus();
+        case 404:
+          [[fallthrough]];
+        case 410:
+          if (!session_url_.empty()) {
+            // The upload session has expired, so the upload is restarted.
+            session_url_.clear();
+            committed_size_ = 0;
+            query_committed_size_ = false;
+            return absl::UnavailableError("Resumable upload session expired");
+          }
+          if (!StorageGeneration::IsUnknown(options.if_equal) &&
+              !StorageGeneration::IsNoValue(options.if_equal)) {
+            return absl::OkStatus();
+          }
+          break;
+        default:
+          break;
+      }
+      return HttpResponseCodeToStatus(response.value());
+    }();
+
+    if (!status.ok() && IsRetriable(status)) {
+      // The number of bytes received by GCS is unknown.
+      query_committed_size_ = !session_url_.empty();
+      status =
+          owner->BackoffForAttemptAsync(std::move(status), attempt_++, this);
+      if (status.ok()) {
+        return;
+      }
+    }
+    if (!status.ok()) {
+      promise.SetResult(status);
+      return;
+    }
+
+    const auto& httpresponse = response.value();
+    if (session_url_.empty() && httpresponse.status_code < 300) {
+      auto it = httpresponse.headers.find("location");
+      if (it == httpresponse.headers.end()) {
+        promise.SetResult(absl::InvalidArgumentError(
+            "Missing location header in resumable upload response"));
+        return;
+      }
+      session_url_ = it->second;
+    } else if (httpresponse.status_code == 308) {
+      auto committed_size = GetResumableUploadCommittedSize(httpresponse);
+      if (!committed_size.ok()) {
+        promise.SetResult(committed_size.status());
+        return;
+      }
+      // If the entire value was persisted without completing the upload, the
+      // status is queried to obtain the final response.
+      committed_size_ = *committed_size;
+      query_committed_size_ = committed_size_ >= value.size();
+      attempt_ = 0;
+    } else {
+      promise.SetResult(FinishResponse(httpresponse));
+      return;
+    }
+
+    // The next request is issued from the executor, since the response may
+    // be ready immediately.
+    owner->executor()(
+        [self = IntrusivePtr<WriteTask>(this)] { self->Retry(); });
+  }
+
+  /// Composes `compose_components_` into the object.
+  void RetryCompose() {
+    std::string compose_url = tensorstore::StrCat(
+        owner->resource_root(), "/o/", encoded_object_name, "/compose");
+    bool has_query = AddGenerationParam(&compose_url, false,
+                                        "ifGenerationMatch", options.if_equal);
+    AddUserProjectParam(&compose_url, has_query, owner->encoded_user_project());
+
+    auto maybe_auth_header = owner->GetAuthHeader();
+    if (!maybe_auth_header.ok()) {
+      promise.SetResult(maybe_auth_header.status());
+      return;
+    }
+
+    ::nlohmann::json::array_t source_objects;
+    for (const auto& name : compose_components_) {
+      source_objects.push_back({{"name", name}});
+    }
+    absl::Cord payload(::nlohmann::json{
+        {"sourceObjects", std::move(source_objects)},
+        {"destination", {{"contentType", "application/octet-stream"}}},
+    }.dump());
+
+    HttpRequestBuilder request_builder("POST", compose_url);
+    if (maybe_auth_header.value().has_value()) {
+      request_builder.AddHeader(*maybe_auth_header.value());
+    }
+    auto request =
+        request_builder.AddHeader("Content-Type: application/json")
+            .AddHeader(tensorstore::StrCat("Content-Length: ", payload.size()))
+            .BuildRequest();
+    start_time_ = absl::Now();
+
+    ABSL_LOG_IF(INFO, gcs_http_logging) << "WriteTask (compose): " << request;
+
+    auto future = owner->transport_->IssueRequest(request, std::move(payload));
+    future.ExecuteWhenReady([self = IntrusivePtr<WriteTask>(this)](
+                                ReadyFuture<HttpResponse> response) {
+      self->OnResponse(response.result());
+    });
+  }
+
   void OnResponse(const Result<HttpResponse>& response) {
     if (!promise.result_needed()) {
       return;
@@ -961,6 +1383,155 @@ struct DeleteTask : public RateLimiterNode,
   }
 };
 
+// Rewrite responds with a Json payload that includes these fields.
+struct GcsRewriteResponsePayload {
+  bool done = false;
+  std::string rewrite_token;  // used to continue an incomplete rewrite.
+  std::optional<ObjectMetadata> resource;  // metadata of the new object.
+};
+
+constexpr static auto GcsRewriteResponsePayloadBinder = jb::Object(
+    jb::Member("done", jb::Projection(&GcsRewriteResponsePayload::done,
+                                      jb::DefaultInitializedValue())),
+    jb::Member("rewriteToken",
+               jb::Projection(&GcsRewriteResponsePayload::rewrite_token,
+                              jb::DefaultInitializedValue())),
+    jb::Member("resource", jb::Projection(&GcsRewriteResponsePayload::resource,
+                                          jb::DefaultInitializedValue())),
+    jb::DiscardExtraMembers);
+
+/// A CopyTask is a function object used to satisfy a
+/// GcsKeyValueStore::CopyObject request.
+///
+/// The object is copied by GCS using rewrite requests.  GCS may complete
+/// the rewrite of a large object over several requests, each of which
+/// continues from the `rewriteToken` returned by the previous one.
+struct CopyTask : public RateLimiterNode,
+                  public internal::AtomicReferenceCount<CopyTask> {
+  IntrusivePtr<GcsKeyValueStore> owner;
+  std::string rewrite_url;
+  Promise<TimestampedStorageGeneration> promise;
+
+  std::string rewrite_token_;
+  int attempt_ = 0;
+  absl::Time start_time_;
+
+  CopyTask(IntrusivePtr<GcsKeyValueStore> owner, std::string rewrite_url,
+           Promise<TimestampedStorageGeneration> promise)
+      : owner(std::move(owner)),
+        rewrite_url(std::move(rewrite_url)),
+        promise(std::move(promise)) {}
+
+  ~CopyTask() { owner->admission_queue().Finish(this); }
+
+  static void Start(void* task) {
+    auto* self = reinterpret_cast<CopyTask*>(task);
+    self->owner->write_rate_limiter().Finish(self);
+    self->owner->admission_queue().Admit(self, &CopyTask::Admit);
+  }
+
+  static void Admit(void* task) {
+    auto* self = reinterpret_cast<CopyTask*>(task);
+    self->owner->executor()(
+        [state = IntrusivePtr<CopyTask>(self, internal::adopt_object_ref)] {
+          state->start_time_ = absl::Now();
+          state->Retry();
+        });
+  }
+
+  void Retry() {
+    if (!promise.result_needed()) {
+      return;
+    }
+    std::string url = rewrite_url;
+    bool has_query = false;
+    if (!rewrite_token_.empty()) {
+      absl::StrAppend(&url, "?rewriteToken=",
+                      internal::PercentEncodeUriComponent(rewrite_token_));
+      has_query = true;
+    }
+    AddUserProjectParam(&url, has_query, owner->encoded_user_project());
+
+    auto maybe_auth_header = owner->GetAuthHeader();
+    if (!maybe_auth_header.ok()) {
+      promise.SetResult(maybe_auth_header.status());
+      return;
+    }
+    HttpRequestBuilder request_builder("POST", url);
+    if (maybe_auth_header.value().has_value()) {
+      request_builder.AddHeader(*maybe_auth_header.value());
+    }
+    auto request =
+        request_builder.AddHeader("Content-Length: 0").BuildRequest();
+
+    ABSL_LOG_IF(INFO, gcs_http_logging) << "CopyTask: " << request;
+
+    auto future = owner->transport_->IssueRequest(request, {});
+    future.ExecuteWhenReady([self = IntrusivePtr<CopyTask>(this)](
+                                ReadyFuture<HttpResponse> response) {
+      self->OnResponse(response.result());
+    });
+  }
+
+  void OnResponse(const Result<HttpResponse>& response) {
+    if (!promise.result_needed()) {
+      return;
+    }
+    ABSL_LOG_IF(INFO, gcs_http_logging.Level(1) && response.ok())
+        << "CopyTask " << *response;
+
+    absl::Status status =
+        response.ok() ? HttpResponseCodeToStatus(*response) : response.status();
+    if (!status.ok() && IsRetriable(status)) {
+      status =
+          owner->BackoffForAttemptAsync(std::move(status), attempt_++, this);
+      if (status.ok()) {
+        return;
+      }
+    }
+    if (!status.ok()) {
+      promise.SetResult(status);
+      return;
+    }
+
+    auto payload = response->payload;
+    auto j = internal::ParseJson(payload.Flatten());
+    if (j.is_discarded()) {
+      promise.SetResult(absl::InternalError(tensorstore::StrCat(
+          "Failed to parse rewrite response: ", payload.Flatten())));
+      return;
+    }
+    auto parsed_payload = jb::FromJson<GcsRewriteResponsePayload>(
+        j, GcsRewriteResponsePayloadBinder);
+    if (!parsed_payload.ok()) {
+      promise.SetResult(parsed_payload.status());
+      return;
+    }
+    if (!parsed_payload->done) {
+      if (parsed_payload->rewrite_token.empty()) {
+        promise.SetResult(absl::InternalError(
+            "Incomplete rewrite response is missing rewriteToken"));
+        return;
+      }
+      // The next request is issued from the executor, since the response may
+      // be ready immediately.
+      rewrite_token_ = std::move(parsed_payload->rewrite_token);
+      attempt_ = 0;
+      owner->executor()(
+          [self = IntrusivePtr<CopyTask>(this)] { self->Retry(); });
+      return;
+    }
+    if (!parsed_payload->resource) {
+      promise.SetResult(absl::InternalError(
+          "Completed rewrite response is missing resource"));
+      return;
+    }
+    promise.SetResult(TimestampedStorageGeneration{
+        StorageGeneration::FromUint64(parsed_payload->resource->generation),
+        start_time_});
+  }
+};
+
 Future<TimestampedStorageGeneration> GcsKeyValueStore::Write(
     Key key, std::optional<Value> value, WriteOptions options) {
   gcs_write.Increment();
@@ -971,27 +1542,122 @@ Future<TimestampedStorageGeneration> GcsKeyValueStore::Write(
     return absl::InvalidArgumentError("Malformed StorageGeneration");
   }
 
+  if (value && spec_.composite_upload_threshold != 0 &&
+      value->size() >= spec_.composite_upload_threshold) {
+    // Metrics are recorded for the writes of the individual components.
+    return WriteComposite(std::move(key), std::move(*value),
+                          std::move(options));
+  }
+
   std::string encoded_object_name = internal::PercentEncodeUriComponent(key);
+  if (value) {
+    return WriteObject(std::move(encoded_object_name), std::move(*value),
+                       std::move(options));
+  }
+
   auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  std::string resource = tensorstore::internal::JoinPath(
+      resource_root_, "/o/", encoded_object_name);
 
-  if (value) {
-    auto state = internal::MakeIntrusivePtr<WriteTask>(
-        IntrusivePtr<GcsKeyValueStore>(this), std::move(encoded_object_name),
-        std::move(*value), std::move(options), std::move(op.promise));
+  auto state = internal::MakeIntrusivePtr<DeleteTask>(
+      IntrusivePtr<GcsKeyValueStore>(this), std::move(resource),
+      std::move(options), std::move(op.promise));
 
-    intrusive_ptr_increment(state.get());  // adopted by WriteTask::Start.
-    write_rate_limiter().Admit(state.get(), &WriteTask::Start);
-  } else {
-    std::string resource = tensorstore::internal::JoinPath(
-        resource_root_, "/o/", encoded_object_name);
+  intrusive_ptr_increment(state.get());  // adopted by DeleteTask::Start.
+  write_rate_limiter().Admit(state.get(), &DeleteTask::Start);
+  return internal_kvstore::RecordWriteMetrics(
+      GcsKeyValueStoreSpec::id, std::nullopt, std::move(op.future));
+}
 
-    auto state = internal::MakeIntrusivePtr<DeleteTask>(
-        IntrusivePtr<GcsKeyValueStore>(this), std::move(resource),
-        std::move(options), std::move(op.promise));
+Future<TimestampedStorageGeneration> GcsKeyValueStore::WriteObject(
+    std::string encoded_object_name, Value value, WriteOptions options) {
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  const int64_t bytes = value.size();
+  auto state = internal::MakeIntrusivePtr<WriteTask>(
+      IntrusivePtr<GcsKeyValueStore>(this), std::move(encoded_object_name),
+      std::move(value), std::move(options), std::move(op.promise));
+
+  intrusive_ptr_increment(state.get());  // adopted by WriteTask::Start.
+  write_rate_limiter().Admit(state.get(), &WriteTask::Start);
+  return internal_kvstore::RecordWriteMetrics(GcsKeyValueStoreSpec::id, bytes,
+                                              std::move(op.future));
+}
+
+/// Link callback which composes the components of a parallel composite upload
+/// into the object once they are written.
+///
+/// If the upload fails or is cancelled before the compose request is issued,
+/// the components are deleted when the callback is destroyed; otherwise, they
+/// are deleted by the compose `WriteTask`.
+struct ComposeCallback {
+  IntrusivePtr<GcsKeyValueStore> owner;
+  std::string encoded_object_name;
+  std::vector<std::string> components;
+  kvstore::WriteOptions options;
+
+  ComposeCallback(IntrusivePtr<GcsKeyValueStore> owner,
+                  std::string encoded_object_name,
+                  std::vector<std::string> components,
+                  kvstore::WriteOptions options)
+      : owner(std::move(owner)),
+        encoded_object_name(std::move(encoded_object_name)),
+        components(std::move(components)),
+        options(std::move(options)) {}
+  ComposeCallback(ComposeCallback&&) = default;
+
+  ~ComposeCallback() {
+    if (owner) DeleteComposeComponents(*owner, components);
+  }
+
+  void operator()(Promise<TimestampedStorageGeneration> promise,
+                  ReadyFuture<void> all_written) {
+    if (!all_written.status().ok()) {
+      promise.SetResult(all_written.status());
+      return;
+    }
+    auto state = internal::MakeIntrusivePtr<WriteTask>(
+        owner, std::move(encoded_object_name), absl::Cord(),
+        std::move(options), std::move(promise));
+    state->compose_components_ = std::exchange(components, {});
+    intrusive_ptr_increment(state.get());  // adopted by WriteTask::Start.
+    owner->write_rate_limiter().Admit(state.get(), &WriteTask::Start);
+  }
+};
 
-    intrusive_ptr_increment(state.get());  // adopted by DeleteTask::Start.
-    write_rate_limiter().Admit(state.get(), &DeleteTask::Start);
+Future<TimestampedStorageGeneration> GcsKeyValueStore::WriteComposite(
+    Key key, Value value, WriteOptions options) {
+  // Slices of the value are written concurrently to temporary component
+  // objects, each as a separate write subject to the rate limiter and the
+  // request concurrency limit.  The components are then composed into the
+  // object by a single compose request, to which `options.if_equal` applies,
+  // and deleted.  Each component is at least `composite_upload_threshold`
+  // bytes, and is written using a resumable upload if it is large enough.
+  const size_t num_components =
+      std::min(kMaxComposeComponents,
+               value.size() / spec_.composite_upload_threshold);
+  const size_t component_size = CeilOfRatio(value.size(), num_components);
+  const std::string component_prefix =
+      tensorstore::StrCat(key, ".tensorstore_compose_", GetRandomId(), "_");
+
+  std::vector<std::string> components;
+  std::vector<AnyFuture> futures;
+  for (size_t offset = 0; offset < value.size(); offset += component_size) {
+    components.push_back(
+        tensorstore::StrCat(component_prefix, components.size()));
+    // Components are written directly, since they are themselves large
+    // enough to be written using a composite upload.
+    futures.push_back(
+        WriteObject(internal::PercentEncodeUriComponent(components.back()),
+                    value.Subcord(offset, component_size), {}));
   }
+
+  // The component writes are linked to the promise, such that they are
+  // cancelled if the result is no longer needed.
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  Link(ComposeCallback(IntrusivePtr<GcsKeyValueStore>(this),
+                       internal::PercentEncodeUriComponent(key),
+                       std::move(components), std::move(options)),
+       std::move(op.promise), WaitAllFuture(futures));
   return std::move(op.future);
 }
 
@@ -1187,7 +1853,8 @@ void GcsKeyValueStore::ListImpl(ListOptions options, ListReceiver receiver) {
 
   auto state = internal::MakeIntrusivePtr<ListTask>(
       IntrusivePtr<GcsKeyValueStore>(this), std::move(options),
-      std::move(receiver),
+      internal_kvstore::RecordListMetrics(GcsKeyValueStoreSpec::id,
+                                          std::move(receiver)),
       /*resource=*/tensorstore::internal::JoinPath(resource_root_, "/o"));
 
   intrusive_ptr_increment(state.get());  // adopted by ListTask::Start.
@@ -1234,9 +1901,100 @@ Future<const void> GcsKeyValueStore::DeleteRange(KeyRange range) {
   ListImpl(list_options, DeleteRangeListReceiver{
                              internal::IntrusivePtr<GcsKeyValueStore>(this),
                              std::move(op.promise)});
+  return internal_kvstore::RecordDeleteRangeMetrics(GcsKeyValueStoreSpec::id,
+                                                    std::move(op.future));
+}
+
+Future<TimestampedStorageGeneration> GcsKeyValueStore::CopyObject(
+    std::string_view source_resource_root, std::string_view source_key,
+    Key target_key) {
+  gcs_copy.Increment();
+  if (!IsValidObjectName(target_key)) {
+    return absl::InvalidArgumentError("Invalid GCS object name");
+  }
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  auto state = internal::MakeIntrusivePtr<CopyTask>(
+      IntrusivePtr<GcsKeyValueStore>(this),
+      tensorstore::StrCat(source_resource_root, "/o/",
+                          internal::PercentEncodeUriComponent(source_key),
+                          "/rewriteTo/b/", spec_.bucket, "/o/",
+                          internal::PercentEncodeUriComponent(target_key)),
+      std::move(op.promise));
+  intrusive_ptr_increment(state.get());  // adopted by CopyTask::Start.
+  write_rate_limiter().Admit(state.get(), &CopyTask::Start);
   return std::move(op.future);
 }
 
+// Receiver used by `ExperimentalCopyRangeFrom` for processing the results from
+// `List` on the source.
+struct CopyRangeListReceiver {
+  IntrusivePtr<GcsKeyValueStore> owner_;
+  std::string source_resource_root_;
+  size_t source_prefix_length_;
+  std::string target_prefix_;
+  Promise<void> promise_;
+  FutureCallbackRegistration cancel_registration_;
+
+  void set_starting(AnyCancelReceiver cancel) {
+    cancel_registration_ = promise_.ExecuteWhenNotNeeded(std::move(cancel));
+  }
+
+  void set_value(ListEntry entry) {
+    std::string target_key = tensorstore::StrCat(
+        target_prefix_,
+        std::string_view(entry.key).substr(
+            std::min(source_prefix_length_, entry.key.size())));
+    LinkError(promise_, owner_->CopyObject(source_resource_root_, entry.key,
+                                           std::move(target_key)));
+  }
+
+  void set_error(absl::Status error) {
+    SetDeferredResult(promise_, std::move(error));
+    promise_ = Promise<void>();
+  }
+
+  void set_done() { promise_ = Promise<void>(); }
+
+  void set_stopping() { cancel_registration_.Unregister(); }
+};
+
+bool GcsKeyValueStore::CanCopyObjectsFrom(GcsKeyValueStore& source) {
+  if (source.transport_ != transport_ ||
+      source.encoded_user_project_ != encoded_user_project_) {
+    return false;
+  }
+  auto source_auth_provider = source.GetAuthProvider();
+  auto auth_provider = GetAuthProvider();
+  return source_auth_provider.ok() && auth_provider.ok() &&
+         *source_auth_provider == *auth_provider;
+}
+
+Future<const void> GcsKeyValueStore::ExperimentalCopyRangeFrom(
+    const internal::OpenTransactionPtr& transaction, const KvStore& source,
+    Key target_prefix, kvstore::CopyRangeOptions options) {
+  // Objects within GCS are copied by GCS if both stores access GCS in the
+  // same way; otherwise the generic implementation is used.
+  if (typeid(*source.driver) == typeid(GcsKeyValueStore) && !transaction &&
+      source.transaction == no_transaction &&
+      CanCopyObjectsFrom(static_cast<GcsKeyValueStore&>(*source.driver))) {
+    auto& source_driver = static_cast<GcsKeyValueStore&>(*source.driver);
+    auto op = PromiseFuturePair<void>::Make(tensorstore::MakeResult());
+    ListOptions list_options;
+    list_options.range =
+        KeyRange::AddPrefix(source.path, std::move(options.source_range));
+    list_options.staleness_bound = options.source_staleness_bound;
+    source_driver.ListImpl(
+        std::move(list_options),
+        CopyRangeListReceiver{IntrusivePtr<GcsKeyValueStore>(this),
+                              source_driver.resource_root(),
+                              source.path.size(), std::move(target_prefix),
+                              std::move(op.promise)});
+    return std::move(op.future);
+  }
+  return kvstore::Driver::ExperimentalCopyRangeFrom(
+      transaction, source, std::move(target_prefix), std::move(options));
+}
+
 Result<kvstore::Spec> ParseGcsUrl(std::string_view url) {
   auto parsed = internal::ParseGenericUri(url);
   assert(parsed.scheme == kUriScheme);
@@ -1258,6 +2016,11 @@ Result<kvstore::Spec> ParseGcsUrl(std::string_view url) {
           : parsed.authority_and_path.substr(end_of_bucket + 1);
   auto driver_spec = internal::MakeIntrusivePtr<GcsKeyValueStoreSpec>();
   driver_spec->data_.bucket = bucket;
+  driver_spec->data_.resumable_upload_threshold =
+      kDefaultResumableUploadThreshold;
+  driver_spec->data_.resumable_chunk_size = kDefaultResumableChunkSize;
+  driver_spec->data_.composite_upload_threshold = 0;
+  driver_spec->data_.parallel_read_part_size = 0;
   driver_spec->data_.request_concurrency =
       Context::Resource<GcsConcurrencyResource>::DefaultSpec();
   driver_spec->data_.user_project =
@@ -134,6 +134,7 @@ class MyMockTransport : public HttpTransport {
                                     absl::Cord payload,
                                     absl::Duration request_timeout,
                                     absl::Duration connect_timeout) override {
+    if (absl::StrContains(request.url, "/compose")) ++compose_requests_;
     auto future = metadata_mock_.IssueRequest(request, payload, request_timeout,
                                               connect_timeout);
     if (future.result().ok()) return future;
@@ -150,6 +151,7 @@ class MyMockTransport : public HttpTransport {
 
   MetadataMockTransport metadata_mock_;
   std::vector<GCSMockStorageBucket*> buckets_;
+  std::atomic<int> compose_requests_{0};
 };
 
 struct DefaultHttpTransportSetter {
@@ -285,6 +287,139 @@ TEST(GcsKeyValueStoreTest, Retry) {
   }
 }
 
+TEST(GcsKeyValueStoreTest, ResumableUpload) {
+  auto mock_transport = std::make_shared<MyMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", kDriver},
+                                 {"bucket", "my-bucket"},
+                                 {"resumable_upload_threshold", 300 * 1024},
+                                 {"resumable_chunk_size", 256 * 1024}},
+                                context)
+                      .result());
+
+  // Uploaded in 4 chunks; the default mock error rate causes some of the
+  // chunks to be resumed.
+  absl::Cord value(std::string(1000 * 1024, 'x'));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto stamp,
+                                   kvstore::Write(store, "a", value).result());
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              tensorstore::internal::MatchesKvsReadResult(value,
+                                                          stamp.generation));
+
+  // Conditional writes are resolved when the upload is finalized.
+  kvstore::WriteOptions options;
+  options.if_equal = StorageGeneration::NoValue();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto conflict, kvstore::Write(store, "a", value, options).result());
+  EXPECT_TRUE(StorageGeneration::IsUnknown(conflict.generation));
+
+  options.if_equal = stamp.generation;
+  TENSORSTORE_EXPECT_OK(kvstore::Write(store, "a", value, options).result());
+}
+
+TEST(GcsKeyValueStoreTest, CompositeUpload) {
+  auto mock_transport = std::make_shared<MyMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", kDriver},
+                                 {"bucket", "my-bucket"},
+                                 {"composite_upload_threshold", 100 * 1024}},
+                                context)
+                      .result());
+
+  std::string data;
+  for (int i = 0; i < 1000 * 1024; ++i) data += static_cast<char>('a' + i % 26);
+  absl::Cord value(data);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto stamp,
+                                   kvstore::Write(store, "a", value).result());
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              tensorstore::internal::MatchesKvsReadResult(value,
+                                                          stamp.generation));
+  EXPECT_LE(1, mock_transport->compose_requests_.load());
+
+  // A value of exactly the threshold is composed from a single component,
+  // which is itself written directly.
+  absl::Cord threshold_value(data.substr(0, 100 * 1024));
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto threshold_stamp,
+      kvstore::Write(store, "b", threshold_value).result());
+  EXPECT_THAT(kvstore::Read(store, "b").result(),
+              tensorstore::internal::MatchesKvsReadResult(
+                  threshold_value, threshold_stamp.generation));
+
+  // The temporary component objects are deleted asynchronously.
+  std::vector<kvstore::ListEntry> entries;
+  for (int i = 0; i < 1000; ++i) {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(entries,
+                                     kvstore::ListFuture(store).result());
+    if (entries.size() == 2) break;
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_THAT(entries, ::testing::UnorderedElementsAre(MatchesListEntry("a"),
+                                                       MatchesListEntry("b")));
+
+  // A failed precondition is reported by the compose request.
+  kvstore::WriteOptions options;
+  options.if_equal = StorageGeneration::NoValue();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto conflict, kvstore::Write(store, "a", value, options).result());
+  EXPECT_TRUE(StorageGeneration::IsUnknown(conflict.generation));
+}
+
+TEST(GcsKeyValueStoreTest, ParallelRead) {
+  auto mock_transport = std::make_shared<MyMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", kDriver},
+                                 {"bucket", "my-bucket"},
+                                 {"parallel_read_part_size", 100}},
+                                context)
+                      .result());
+  tensorstore::internal::TestKeyValueReadWriteOps(store);
+
+  std::string data;
+  for (int i = 0; i < 1050; ++i) data += static_cast<char>('a' + i % 26);
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(store, "a", absl::Cord(data)).result());
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              tensorstore::internal::MatchesKvsReadResult(absl::Cord(data),
+                                                          stamp.generation));
+
+  kvstore::ReadOptions options;
+  options.byte_range = tensorstore::OptionalByteRangeRequest::Range(150, 999);
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              tensorstore::internal::MatchesKvsReadResult(
+                  absl::Cord(data.substr(150, 849)), stamp.generation));
+
+  options.byte_range = tensorstore::OptionalByteRangeRequest::Range(0, 2000);
+  EXPECT_THAT(kvstore::Read(store, "a", options).result(),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+
+  // The range requested for the first part of an empty value is not
+  // satisfiable; the value is then read without splitting.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto empty_stamp, kvstore::Write(store, "empty", absl::Cord()).result());
+  EXPECT_THAT(kvstore::Read(store, "empty").result(),
+              tensorstore::internal::MatchesKvsReadResult(
+                  absl::Cord(), empty_stamp.generation));
+}
+
 TEST(GcsKeyValueStoreTest, List) {
   // Setup mocks for:
   // https://www.googleapis.com/kvstore/v1/b/my-bucket/o/test
@@ -438,6 +573,14 @@ TEST(GcsKeyValueStoreTest, InvalidSpec) {
   EXPECT_THAT(
       kvstore::Open({{"driver", kDriver}, {"bucket", 5}}, context).result(),
       MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with `"resumable_chunk_size"` not a multiple of 256 KiB.
+  EXPECT_THAT(kvstore::Open({{"driver", kDriver},
+                             {"bucket", "my-bucket"},
+                             {"resumable_chunk_size", 1000}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
 }
 
 TEST(GcsKeyValueStoreTest, RequestorPays) {
@@ -552,6 +695,94 @@ TEST(GcsKeyValueStoreTest, DeleteRangeFromBeginning) {
   tensorstore::internal::TestKeyValueStoreDeleteRangeFromBeginning(store);
 }
 
+TEST(GcsKeyValueStoreTest, CopyRange) {
+  auto mock_transport = std::make_shared<MyMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  mock_transport->buckets_.push_back(&bucket);
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", kDriver}, {"bucket", "my-bucket"}}, context)
+          .result());
+  tensorstore::internal::TestKeyValueStoreCopyRange(store);
+}
+
+class MyCopyRangeMockTransport : public MyMockTransport {
+ public:
+  Future<HttpResponse> IssueRequest(const HttpRequest& request,
+                                    absl::Cord payload,
+                                    absl::Duration request_timeout,
+                                    absl::Duration connect_timeout) override {
+    if (absl::StrContains(request.url, "/rewriteTo/")) {
+      ++total_rewrite_requests_;
+    } else if (absl::StrContains(request.url, "alt=media")) {
+      ++total_media_requests_;
+    }
+    return MyMockTransport::IssueRequest(request, payload, request_timeout,
+                                         connect_timeout);
+  }
+
+  std::atomic<size_t> total_rewrite_requests_{0};
+  std::atomic<size_t> total_media_requests_{0};
+};
+
+TEST(GcsKeyValueStoreTest, CopyRangeRewrite) {
+  auto mock_transport = std::make_shared<MyCopyRangeMockTransport>();
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  GCSMockStorageBucket bucket("my-bucket");
+  bucket.SetErrorRate(0);
+  mock_transport->buckets_.push_back(&bucket);
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", kDriver}, {"bucket", "my-bucket"}}, context)
+          .result());
+
+  // The mock rewrites at most 1MiB per request, so copying the object
+  // requires 3 requests.
+  std::string data;
+  for (int i = 0; i < 2560 * 1024; ++i) data += static_cast<char>('a' + i % 26);
+  absl::Cord value(data);
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "x/a", value).result());
+  TENSORSTORE_ASSERT_OK(kvstore::Write(store, "x/b", absl::Cord()).result());
+
+  TENSORSTORE_ASSERT_OK(
+      kvstore::ExperimentalCopyRange(store.WithPathSuffix("x/"),
+                                     store.WithPathSuffix("y/"))
+          .result());
+  EXPECT_EQ(4, mock_transport->total_rewrite_requests_);
+  EXPECT_EQ(0, mock_transport->total_media_requests_);
+
+  EXPECT_THAT(kvstore::Read(store, "y/a").result(),
+              tensorstore::internal::MatchesKvsReadResult(value));
+  EXPECT_THAT(kvstore::Read(store, "y/b").result(),
+              tensorstore::internal::MatchesKvsReadResult(absl::Cord()));
+
+  // Objects are not copied by GCS on behalf of a store that bills requests to
+  // a different user project; they are read and written instead.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto other_store,
+      kvstore::Open(
+          {{"driver", kDriver},
+           {"bucket", "my-bucket"},
+           {"context", {{"gcs_user_project", {{"project_id", "other"}}}}}},
+          context)
+          .result());
+  TENSORSTORE_ASSERT_OK(
+      kvstore::ExperimentalCopyRange(other_store.WithPathSuffix("x/"),
+                                     store.WithPathSuffix("z/"))
+          .result());
+  EXPECT_EQ(4, mock_transport->total_rewrite_requests_);
+  EXPECT_LT(0, mock_transport->total_media_requests_);
+  EXPECT_THAT(kvstore::Read(store, "z/a").result(),
+              tensorstore::internal::MatchesKvsReadResult(value));
+}
+
 class MyDeleteRangeCancellationMockTransport : public MyMockTransport {
  public:
   Future<HttpResponse> IssueRequest(const HttpRequest& request,
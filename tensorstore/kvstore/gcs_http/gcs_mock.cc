@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <optional>
@@ -32,9 +33,11 @@
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include <nlohmann/json.hpp>
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/internal/uri_utils.h"
@@ -162,6 +165,12 @@ GCSMockStorageBucket::Match(const HttpRequest& request, absl::Cord payload) {
     }
   }
 
+  if (is_upload && path == "/o" && request.method == "PUT" &&
+      params.count("upload_id")) {
+    // The session url of a resumable upload does not require a userProject.
+    return HandleResumableUploadRequest(request, params, payload);
+  }
+
   std::optional<std::string> user_project;
   if (auto it = params.find("userProject"); it != params.end()) {
     user_project = it->second;
@@ -185,9 +194,18 @@ GCSMockStorageBucket::Match(const HttpRequest& request, absl::Cord payload) {
               R"({ "error": { "code": 400, "message": "Uploads must be sent to the upload URL." } })")};
     }
     return HandleInsertRequest(path, params, payload);
+  } else if (absl::StartsWith(path, "/o/") &&
+             absl::EndsWith(path, "/compose") && request.method == "POST") {
+    // POST request to compose objects.
+    return HandleComposeRequest(path, params, payload);
+  } else if (absl::StartsWith(path, "/o/") &&
+             absl::StrContains(path, "/rewriteTo/b/") &&
+             request.method == "POST") {
+    // POST request to rewrite an object.
+    return HandleRewriteRequest(path, params);
   } else if (absl::StartsWith(path, "/o/") && request.method == "GET") {
     // GET request on an object.
-    return HandleGetRequest(path, params);
+    return HandleGetRequest(request, path, params);
   } else if (absl::StartsWith(path, "/o/") && request.method == "DELETE") {
     // DELETE request on an object.
     return HandleDeleteRequest(path, params);
@@ -195,9 +213,7 @@ GCSMockStorageBucket::Match(const HttpRequest& request, absl::Cord payload) {
 
   // NOT HANDLED
   // update (PUT request)
-  // .../compose
   // .../watch
-  // .../rewrite/...
   // patch (PATCH request)
   // .../copyTo/...
 
@@ -272,52 +288,230 @@ GCSMockStorageBucket::HandleInsertRequest(std::string_view path,
   do {
     /// TODO: What does GCS return if these values are bad?
     auto uploadType = params.find("uploadType");
-    if (uploadType == params.end() || uploadType->second != "media") break;
+    if (uploadType == params.end()) break;
 
     auto name_it = params.find("name");
     if (name_it == params.end() || name_it->second.empty()) break;
     std::string name(name_it->second.data(), name_it->second.length());
 
-    auto it = data_.find(name);
-    if (parsed_parameters.ifGenerationMatch.has_value()) {
-      const int64_t v = parsed_parameters.ifGenerationMatch.value();
-      if (v == 0) {
-        if (it != data_.end()) {
-          // Live version => failure
-          return HttpResponse{412, absl::Cord()};
-        }
-        // No live versions => success;
-      } else if (it == data_.end() || v != it->second.generation) {
-        // generation does not match.
-        return HttpResponse{412, absl::Cord()};
-      }
+    if (uploadType->second == "resumable") {
+      // https://cloud.google.com/storage/docs/performing-resumable-uploads
+      // Preconditions are checked when the upload completes.
+      std::string upload_id = tensorstore::StrCat(next_upload_id_++);
+      auto& upload = uploads_[upload_id];
+      upload.name = std::move(name);
+      upload.if_generation_match = parsed_parameters.ifGenerationMatch;
+      HttpResponse response{200, absl::Cord()};
+      response.headers.insert(
+          {"location",
+           tensorstore::StrCat("https://", upload_prefix_,
+                               "/o?uploadType=resumable&upload_id=",
+                               upload_id)});
+      return response;
     }
+    if (uploadType->second != "media") break;
 
-    if (parsed_parameters.ifGenerationNotMatch.has_value()) {
-      const int64_t v = parsed_parameters.ifGenerationNotMatch.value();
-      if (it != data_.end() && v == it->second.generation) {
-        // generation matches.
+    return InsertObject(std::move(name), parsed_parameters.ifGenerationMatch,
+                        parsed_parameters.ifGenerationNotMatch, payload);
+  } while (false);
+
+  return HttpResponse{404, absl::Cord()};
+}
+
+std::variant<std::monostate, HttpResponse, absl::Status>
+GCSMockStorageBucket::HandleResumableUploadRequest(const HttpRequest& request,
+                                                   const ParamMap& params,
+                                                   absl::Cord payload) {
+  // https://cloud.google.com/storage/docs/json_api/v1/objects/insert
+  auto upload_it = uploads_.find(params.find("upload_id")->second);
+  if (upload_it == uploads_.end()) {
+    return HttpResponse{404, absl::Cord()};
+  }
+  auto& upload = upload_it->second;
+
+  // Parse "Content-Range: bytes {first}-{last}/{total}" or, for a status
+  // query, "Content-Range: bytes */{total}".
+  std::string_view content_range;
+  for (std::string_view header : request.headers) {
+    if (absl::ConsumePrefix(&header, "Content-Range: bytes ")) {
+      content_range = header;
+    }
+  }
+  std::pair<std::string_view, std::string_view> range_and_total =
+      absl::StrSplit(content_range, absl::MaxSplits('/', 1));
+  int64_t total = 0;
+  if (!absl::SimpleAtoi(range_and_total.second, &total)) {
+    return HttpResponse{400, absl::Cord()};
+  }
+  if (range_and_total.first != "*") {
+    std::pair<std::string_view, std::string_view> first_and_last =
+        absl::StrSplit(range_and_total.first, absl::MaxSplits('-', 1));
+    int64_t first = 0, last = 0;
+    if (!absl::SimpleAtoi(first_and_last.first, &first) ||
+        !absl::SimpleAtoi(first_and_last.second, &last) ||
+        last - first + 1 != static_cast<int64_t>(payload.size()) ||
+        first > static_cast<int64_t>(upload.data.size())) {
+      return HttpResponse{400, absl::Cord()};
+    }
+    // Bytes which were already received are ignored.
+    upload.data.Append(payload.Subcord(upload.data.size() - first,
+                                       payload.size()));
+  }
+
+  if (static_cast<int64_t>(upload.data.size()) < total) {
+    HttpResponse response{308, absl::Cord()};
+    if (!upload.data.empty()) {
+      response.headers.insert(
+          {"range", tensorstore::StrCat("bytes=0-", upload.data.size() - 1)});
+    }
+    return response;
+  }
+
+  auto response =
+      InsertObject(std::move(upload.name), upload.if_generation_match,
+                   std::nullopt, std::move(upload.data));
+  uploads_.erase(upload_it);
+  return response;
+}
+
+std::variant<std::monostate, HttpResponse, absl::Status>
+GCSMockStorageBucket::HandleComposeRequest(std::string_view path,
+                                           const ParamMap& params,
+                                           absl::Cord payload) {
+  // https://cloud.google.com/storage/docs/json_api/v1/objects/compose
+  path.remove_prefix(3);  // remove /o/
+  path.remove_suffix(std::string_view("/compose").size());
+  std::string name = internal::PercentDecode(path);
+
+  QueryParameters parsed_parameters;
+  {
+    auto parse_result = ParseQueryParameters(params, &parsed_parameters);
+    if (parse_result.has_value()) {
+      return std::move(parse_result.value());
+    }
+  }
+
+  auto body = ::nlohmann::json::parse(std::string(payload), nullptr,
+                                      /*allow_exceptions=*/false);
+  if (!body.is_object() || !body["sourceObjects"].is_array()) {
+    return HttpResponse{400, absl::Cord()};
+  }
+  absl::Cord data;
+  for (const auto& source : body["sourceObjects"]) {
+    if (!source.is_object() || !source["name"].is_string()) {
+      return HttpResponse{400, absl::Cord()};
+    }
+    auto it = data_.find(source["name"].get<std::string>());
+    if (it == data_.end()) {
+      return HttpResponse{404, absl::Cord()};
+    }
+    data.Append(it->second.data);
+  }
+  return InsertObject(std::move(name), parsed_parameters.ifGenerationMatch,
+                      parsed_parameters.ifGenerationNotMatch, std::move(data));
+}
+
+std::variant<std::monostate, HttpResponse, absl::Status>
+GCSMockStorageBucket::HandleRewriteRequest(std::string_view path,
+                                           const ParamMap& params) {
+  // https://cloud.google.com/storage/docs/json_api/v1/objects/rewrite
+  path.remove_prefix(3);  // remove /o/
+  std::pair<std::string_view, std::string_view> split =
+      absl::StrSplit(path, absl::MaxSplits("/rewriteTo/b/", 1));
+  std::pair<std::string_view, std::string_view> destination =
+      absl::StrSplit(split.second, absl::MaxSplits("/o/", 1));
+  if (destination.first != bucket_) {
+    // Rewrites to other buckets are not supported.
+    return HttpResponse{400, absl::Cord()};
+  }
+  std::string source_name = internal::PercentDecode(split.first);
+  std::string name = internal::PercentDecode(destination.second);
+
+  QueryParameters parsed_parameters;
+  {
+    auto parse_result = ParseQueryParameters(params, &parsed_parameters);
+    if (parse_result.has_value()) {
+      return std::move(parse_result.value());
+    }
+  }
+
+  auto it = data_.find(source_name);
+  if (it == data_.end()) {
+    return HttpResponse{404, absl::Cord()};
+  }
+  absl::Cord data = it->second.data;
+
+  // Each request rewrites at most `kRewriteBytesPerCall` bytes; the number of
+  // bytes rewritten so far is used as the rewrite token.
+  constexpr int64_t kRewriteBytesPerCall = 1024 * 1024;
+  int64_t rewritten = 0;
+  if (auto token_it = params.find("rewriteToken"); token_it != params.end()) {
+    if (!absl::SimpleAtoi(token_it->second, &rewritten) || rewritten < 0) {
+      return HttpResponse{400, absl::Cord()};
+    }
+  }
+  rewritten = std::min<int64_t>(data.size(), rewritten + kRewriteBytesPerCall);
+  ::nlohmann::json result{
+      {"kind", "storage#rewriteResponse"},
+      {"totalBytesRewritten", tensorstore::StrCat(rewritten)},
+      {"objectSize", tensorstore::StrCat(data.size())},
+  };
+  if (rewritten < static_cast<int64_t>(data.size())) {
+    result["done"] = false;
+    result["rewriteToken"] = tensorstore::StrCat(rewritten);
+    return HttpResponse{200, absl::Cord(result.dump())};
+  }
+
+  auto response = InsertObject(name, parsed_parameters.ifGenerationMatch,
+                               parsed_parameters.ifGenerationNotMatch,
+                               std::move(data));
+  if (response.status_code != 200) return response;
+  result["done"] = true;
+  result["resource"] = ObjectMetadata(data_.find(name)->second);
+  return HttpResponse{200, absl::Cord(result.dump())};
+}
+
+HttpResponse GCSMockStorageBucket::InsertObject(
+    std::string name, std::optional<int64_t> if_generation_match,
+    std::optional<int64_t> if_generation_not_match, absl::Cord data) {
+  auto it = data_.find(name);
+  if (if_generation_match.has_value()) {
+    const int64_t v = if_generation_match.value();
+    if (v == 0) {
+      if (it != data_.end()) {
+        // Live version => failure
         return HttpResponse{412, absl::Cord()};
       }
+      // No live versions => success;
+    } else if (it == data_.end() || v != it->second.generation) {
+      // generation does not match.
+      return HttpResponse{412, absl::Cord()};
     }
+  }
 
-    auto& obj = data_[name];
-    if (obj.name.empty()) {
-      obj.name = std::move(name);
+  if (if_generation_not_match.has_value()) {
+    const int64_t v = if_generation_not_match.value();
+    if (it != data_.end() && v == it->second.generation) {
+      // generation matches.
+      return HttpResponse{412, absl::Cord()};
     }
-    obj.generation = ++next_generation_;
-    obj.data = payload;
+  }
 
-    ABSL_LOG(INFO) << "Uploaded: " << obj.name << " " << obj.generation;
+  auto& obj = data_[name];
+  if (obj.name.empty()) {
+    obj.name = std::move(name);
+  }
+  obj.generation = ++next_generation_;
+  obj.data = std::move(data);
 
-    return ObjectMetadataResponse(obj);
-  } while (false);
+  ABSL_LOG(INFO) << "Uploaded: " << obj.name << " " << obj.generation;
 
-  return HttpResponse{404, absl::Cord()};
+  return ObjectMetadataResponse(obj);
 }
 
 std::variant<std::monostate, HttpResponse, absl::Status>
-GCSMockStorageBucket::HandleGetRequest(std::string_view path,
+GCSMockStorageBucket::HandleGetRequest(const HttpRequest& request,
+                                       std::string_view path,
                                        const ParamMap& params) {
   // https://cloud.google.com/storage/docs/json_api/v1/objects/get
   path.remove_prefix(3);  // remove /o/
@@ -363,7 +557,7 @@ GCSMockStorageBucket::HandleGetRequest(std::string_view path,
     if (params.empty() || alt == params.end() || alt->second != "media") {
       return ObjectMetadataResponse(it->second);
     }
-    return ObjectMediaResponse(it->second);
+    return ObjectMediaResponse(it->second, request);
   } while (false);
 
   return HttpResponse{404};
@@ -445,8 +639,35 @@ HttpResponse GCSMockStorageBucket::ObjectMetadataResponse(
   };
 }
 
-HttpResponse GCSMockStorageBucket::ObjectMediaResponse(const Object& object) {
+HttpResponse GCSMockStorageBucket::ObjectMediaResponse(
+    const Object& object, const HttpRequest& request) {
   HttpResponse response{200, object.data};
+  const int64_t size = object.data.size();
+  for (std::string_view header : request.headers) {
+    // Only ranges with a starting offset are supported; the entire object is
+    // returned otherwise.
+    int64_t first = 0, last = size - 1;
+    if (!absl::ConsumePrefix(&header, "Range: bytes=")) continue;
+    std::pair<std::string_view, std::string_view> first_and_last =
+        absl::StrSplit(header, absl::MaxSplits('-', 1));
+    if (!absl::SimpleAtoi(first_and_last.first, &first) ||
+        (!first_and_last.second.empty() &&
+         !absl::SimpleAtoi(first_and_last.second, &last))) {
+      break;
+    }
+    if (first >= size) {
+      // As with GCS, a range starting at or past the end of the object (which
+      // includes any range of an empty object) is not satisfiable.
+      return HttpResponse{416, absl::Cord()};
+    }
+    last = std::min(last, size - 1);
+    response.status_code = 206;
+    response.payload = object.data.Subcord(first, last - first + 1);
+    response.headers.insert(
+        {"content-range",
+         tensorstore::StrCat("bytes ", first, "-", last, "/", size)});
+    break;
+  }
   response.headers.insert(
       {"content-length", tensorstore::StrCat(response.payload.size())});
   response.headers.insert({"content-type", "application/octet-stream"});
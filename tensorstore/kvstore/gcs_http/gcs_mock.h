@@ -78,14 +78,29 @@ class GCSMockStorageBucket {
   std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
   HandleListRequest(std::string_view path, const ParamMap& params);
 
-  // Insert an object into the bucket.
+  // Insert an object into the bucket, or start a resumable upload.
   std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
   HandleInsertRequest(std::string_view path, const ParamMap& params,
                       absl::Cord payload);
 
+  // Upload a chunk of, or query the status of, a resumable upload.
+  std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
+  HandleResumableUploadRequest(const internal_http::HttpRequest& request,
+                               const ParamMap& params, absl::Cord payload);
+
+  // Compose objects into a new object.
+  std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
+  HandleComposeRequest(std::string_view path, const ParamMap& params,
+                       absl::Cord payload);
+
+  // Rewrite an object to a new object in the same bucket.
+  std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
+  HandleRewriteRequest(std::string_view path, const ParamMap& params);
+
   // Get an object, which might be the data or the metadata.
   std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
-  HandleGetRequest(std::string_view path, const ParamMap& params);
+  HandleGetRequest(const internal_http::HttpRequest& request,
+                   std::string_view path, const ParamMap& params);
 
   // Delete an object.
   std::variant<std::monostate, internal_http::HttpResponse, absl::Status>
@@ -94,11 +109,19 @@ class GCSMockStorageBucket {
   // Construct an object metadata response.
   internal_http::HttpResponse ObjectMetadataResponse(const Object& object);
 
-  // Construct an object media response.
-  internal_http::HttpResponse ObjectMediaResponse(const Object& object);
+  // Construct an object media response, which is limited to the byte range
+  // of a `Range: bytes={first}-{last}` request header, if present.
+  internal_http::HttpResponse ObjectMediaResponse(
+      const Object& object, const internal_http::HttpRequest& request);
 
   ::nlohmann::json ObjectMetadata(const Object& object);
 
+  // Stores an object if the generation preconditions hold, and returns the
+  // object metadata response.
+  internal_http::HttpResponse InsertObject(
+      std::string name, std::optional<int64_t> if_generation_match,
+      std::optional<int64_t> if_generation_not_match, absl::Cord data);
+
   // Triggers a guaranteed error for the next `count` requests.
   void TriggerErrors(int64_t count) {
     assert(count >= 0);
@@ -128,6 +151,15 @@ class GCSMockStorageBucket {
 
   using Map = std::map<std::string, Object, std::less<>>;
   Map data_;
+
+  // An in-progress resumable upload.
+  struct ResumableUpload {
+    std::string name;
+    std::optional<int64_t> if_generation_match;
+    absl::Cord data;
+  };
+  int64_t next_upload_id_ = 1;
+  std::map<std::string, ResumableUpload> uploads_;
 };
 
 }  // namespace tensorstore
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -39,17 +40,22 @@
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/http/request_hedging.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/log/verbose_flag.h"
 #include "tensorstore/internal/metrics/counter.h"
 #include "tensorstore/internal/path.h"
+#include "tensorstore/internal/rate_limiter/admission_queue.h"
 #include "tensorstore/internal/retries_context_resource.h"
 #include "tensorstore/internal/retry.h"
 #include "tensorstore/internal/uri_utils.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operation_metrics.h"
 #include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/parallel_read.h"
 #include "tensorstore/kvstore/read_result.h"
 #include "tensorstore/kvstore/registry.h"
 #include "tensorstore/kvstore/spec.h"
@@ -63,9 +69,13 @@
 #include "tensorstore/util/str_cat.h"
 
 /// specializations
+#include "tensorstore/internal/cache_key/std_optional.h"  // IWYU pragma: keep
 #include "tensorstore/internal/cache_key/std_vector.h"  // IWYU pragma: keep
 #include "tensorstore/internal/json_binding/std_array.h"  // IWYU pragma: keep
+#include "tensorstore/internal/json_binding/std_optional.h"  // IWYU pragma: keep
+#include "tensorstore/serialization/std_optional.h"  // IWYU pragma: keep
 #include "tensorstore/serialization/std_vector.h"  // IWYU pragma: keep
+#include "tensorstore/util/garbage_collection/std_optional.h"  // IWYU pragma: keep
 
 using ::tensorstore::internal::IntrusivePtr;
 using ::tensorstore::internal_http::HttpRequestBuilder;
@@ -83,6 +93,9 @@ auto& http_bytes_read = internal_metrics::Counter<int64_t>::New(
 
 ABSL_CONST_INIT internal_log::VerboseFlag http_logging("http_kvstore");
 
+/// Default value of the `http_request_concurrency` resource.
+constexpr size_t kDefaultRequestConcurrency = 32;
+
 struct HttpRequestConcurrencyResource : public internal::ConcurrencyResource {
   static constexpr char id[] = "http_request_concurrency";
 };
@@ -96,7 +109,8 @@ struct HttpRequestRetries
 struct HttpRequestConcurrencyResourceTraits
     : public internal::ConcurrencyResourceTraits,
       public internal::ContextResourceTraits<HttpRequestConcurrencyResource> {
-  HttpRequestConcurrencyResourceTraits() : ConcurrencyResourceTraits(32) {}
+  HttpRequestConcurrencyResourceTraits()
+      : ConcurrencyResourceTraits(kDefaultRequestConcurrency) {}
 };
 const internal::ContextResourceRegistration<
     HttpRequestConcurrencyResourceTraits>
@@ -142,9 +156,12 @@ struct HttpKeyValueStoreSpecData {
   Context::Resource<HttpRequestConcurrencyResource> request_concurrency;
   Context::Resource<HttpRequestRetries> retries;
   std::vector<std::string> headers;
+  size_t parallel_read_part_size;
+  std::optional<internal_http::RequestHedgingOptions> read_hedging;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
-    return f(x.base_url, x.request_concurrency, x.retries, x.headers);
+    return f(x.base_url, x.request_concurrency, x.retries, x.headers,
+             x.parallel_read_part_size, x.read_hedging);
   };
 
   constexpr static auto default_json_binder = jb::Object(
@@ -160,11 +177,19 @@ struct HttpKeyValueStoreSpecData {
                          [](const auto& options, const std::string* x) {
                            return internal_http::ValidateHttpHeader(*x);
                          }))))),
+      jb::Member(
+          "parallel_read_part_size",
+          jb::Projection<&HttpKeyValueStoreSpecData::parallel_read_part_size>(
+              jb::DefaultValue([](auto* v) { *v = 0; }))),
       jb::Member(
           HttpRequestConcurrencyResource::id,
           jb::Projection<&HttpKeyValueStoreSpecData::request_concurrency>()),
       jb::Member(HttpRequestRetries::id,
-                 jb::Projection<&HttpKeyValueStoreSpecData::retries>()));
+                 jb::Projection<&HttpKeyValueStoreSpecData::retries>()),
+      jb::Member("experimental_read_hedging",
+                 jb::Projection<&HttpKeyValueStoreSpecData::read_hedging>(
+                     jb::Optional(
+                         internal_http::RequestHedgingOptions::JsonBinder()))));
 
   std::string GetUrl(std::string_view path) const {
     auto parsed = internal::ParseGenericUri(base_url);
@@ -229,23 +254,41 @@ class HttpKeyValueStore
   HttpKeyValueStoreSpecData spec_;
 
   std::shared_ptr<HttpTransport> transport_;
+
+  // Set if reads are hedged.  Hedged requests are issued outside of the
+  // `request_concurrency` executor, and are instead limited by
+  // `hedge_admission_queue_`.
+  std::shared_ptr<internal_http::RequestHedger> read_hedger_;
+  std::shared_ptr<internal::AdmissionQueue> hedge_admission_queue_;
 };
 
 Future<kvstore::DriverPtr> HttpKeyValueStoreSpec::DoOpen() const {
   auto driver = internal::MakeIntrusivePtr<HttpKeyValueStore>();
   driver->spec_ = data_;
   driver->transport_ = internal_http::GetDefaultHttpTransport();
+  if (data_.read_hedging) {
+    driver->read_hedger_ =
+        std::make_shared<internal_http::RequestHedger>(*data_.read_hedging);
+    driver->hedge_admission_queue_ = std::make_shared<internal::AdmissionQueue>(
+        data_.request_concurrency->spec.value_or(kDefaultRequestConcurrency));
+  }
   return driver;
 }
 
 /// A ReadTask is a function object used to satisfy a
 /// HttpKeyValueStore::Read request.
+///
+/// When `part_size` is non-zero, only the first `part_size` bytes of the
+/// requested byte range are read, and the byte range which remains to be read
+/// is stored in `remaining`.
 struct ReadTask {
   IntrusivePtr<HttpKeyValueStore> owner;
   std::string url;
   kvstore::ReadOptions options;
+  int64_t part_size = 0;
 
   HttpResponse httpresponse;
+  ByteRange remaining{0, 0};
 
   absl::Status DoRead() {
     HttpRequestBuilder request_builder(
@@ -253,7 +296,11 @@ struct ReadTask {
     for (const auto& header : owner->spec_.headers) {
       request_builder.AddHeader(header);
     }
-    if (options.byte_range.size() != 0) {
+    if (part_size != 0) {
+      request_builder.MaybeAddRangeHeader(
+          internal_kvstore::GetFirstPartByteRange(options.byte_range,
+                                                  part_size));
+    } else if (options.byte_range.size() != 0) {
       request_builder.MaybeAddRangeHeader(options.byte_range);
     }
 
@@ -276,13 +323,26 @@ struct ReadTask {
 
     ABSL_LOG_IF(INFO, http_logging) << "[http] Read: " << request;
 
-    auto response = owner->transport_->IssueRequest(request, {}).result();
+    auto future =
+        owner->read_hedger_
+            ? internal_http::IssueHedgedRequest(
+                  owner->read_hedger_, owner->transport_, std::move(request),
+                  owner->hedge_admission_queue_)
+            : owner->transport_->IssueRequest(request, {});
+    auto response = future.result();
     if (!response.ok()) return response.status();
     httpresponse = std::move(*response);
     http_bytes_read.IncrementBy(httpresponse.payload.size());
     ABSL_LOG_IF(INFO, http_logging.Level(1))
         << "[http] Read response: " << httpresponse;
 
+    if (part_size != 0 && httpresponse.status_code == 416) {
+      // The value ends before the first part begins (e.g. it is empty), so the
+      // range is not satisfiable; read the value without splitting instead.
+      part_size = 0;
+      return DoRead();
+    }
+
     switch (httpresponse.status_code) {
       // Special status codes handled outside the retry loop.
       case 412:
@@ -351,11 +411,17 @@ struct ReadTask {
         TENSORSTORE_ASSIGN_OR_RETURN(auto content_range_tuple,
                                      ParseContentRangeHeader(httpresponse));
 
-        if (auto request_size = options.byte_range.size();
-            (options.byte_range.inclusive_min != -1 &&
-             options.byte_range.inclusive_min !=
-                 std::get<0>(content_range_tuple)) ||
-            (request_size >= 0 && request_size != value.size())) {
+        if (part_size != 0) {
+          TENSORSTORE_ASSIGN_OR_RETURN(
+              remaining, internal_kvstore::GetRemainingByteRange(
+                             options.byte_range, part_size,
+                             std::get<0>(content_range_tuple), value.size(),
+                             std::get<2>(content_range_tuple)));
+        } else if (auto request_size = options.byte_range.size();
+                   (options.byte_range.inclusive_min != -1 &&
+                    options.byte_range.inclusive_min !=
+                        std::get<0>(content_range_tuple)) ||
+                   (request_size >= 0 && request_size != value.size())) {
           // Return an error when the response does not start at the requested
           // offset of when the response is smaller than the desired size.
           return absl::OutOfRangeError(tensorstore::StrCat(
@@ -425,11 +491,57 @@ struct ReadTask {
   }
 };
 
+/// Reads the first part of a split read using `task`, which determines the
+/// size of the value, and then reads the remaining parts concurrently.
+///
+/// \param restarts The number of times the split read has been restarted.
+void StartSplitRead(ReadTask task, kvstore::Key key,
+                    Promise<kvstore::ReadResult> promise, int restarts) {
+  auto executor = task.owner->executor();
+  executor([task = std::move(task), key = std::move(key),
+            promise = std::move(promise), restarts]() mutable {
+    if (!promise.result_needed()) return;
+    auto result = task();
+    if (result.ok() && task.remaining.size() != 0) {
+      auto owner = task.owner;
+      auto restart = [task = ReadTask{task.owner, task.url, task.options,
+                                      task.part_size},
+                      key, restarts](
+                         Promise<kvstore::ReadResult> promise) mutable {
+        StartSplitRead(std::move(task), std::move(key), std::move(promise),
+                       restarts + 1);
+      };
+      internal_kvstore::ReadRemainingParts(
+          std::move(promise), std::move(owner), std::move(key), task.options,
+          *std::move(result), task.remaining, task.part_size, restarts,
+          std::move(restart));
+      return;
+    }
+    promise.SetResult(std::move(result));
+  });
+}
+
 Future<kvstore::ReadResult> HttpKeyValueStore::Read(Key key,
                                                     ReadOptions options) {
+  if (options.batch) {
+    return internal_kvstore_batch::BatchRead(*this, std::move(key),
+                                             std::move(options));
+  }
   std::string url = spec_.GetUrl(key);
-  return MapFuture(executor(), ReadTask{IntrusivePtr<HttpKeyValueStore>(this),
-                                        std::move(url), std::move(options)});
+  const int64_t part_size = spec_.parallel_read_part_size;
+  if (!internal_kvstore::ShouldSplitRead(options, part_size)) {
+    return internal_kvstore::RecordReadMetrics(
+        HttpKeyValueStoreSpec::id,
+        MapFuture(executor(),
+                  ReadTask{IntrusivePtr<HttpKeyValueStore>(this),
+                           std::move(url), std::move(options)}));
+  }
+  auto op = PromiseFuturePair<ReadResult>::Make();
+  StartSplitRead(ReadTask{IntrusivePtr<HttpKeyValueStore>(this),
+                          std::move(url), std::move(options), part_size},
+                 std::move(key), std::move(op.promise), /*restarts=*/0);
+  return internal_kvstore::RecordReadMetrics(HttpKeyValueStoreSpec::id,
+                                             std::move(op.future));
 }
 
 Result<kvstore::Spec> ParseHttpUrl(std::string_view url) {
@@ -442,6 +554,7 @@ Result<kvstore::Spec> ParseHttpUrl(std::string_view url) {
       Context::Resource<HttpRequestConcurrencyResource>::DefaultSpec();
   driver_spec->data_.retries =
       Context::Resource<HttpRequestRetries>::DefaultSpec();
+  driver_spec->data_.parallel_read_part_size = 0;
   return {std::in_place, std::move(driver_spec), std::move(path)};
 }
 
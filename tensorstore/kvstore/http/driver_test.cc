@@ -14,6 +14,7 @@
 
 #include "tensorstore/kvstore/driver.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <gmock/gmock.h>
@@ -154,6 +155,50 @@ TEST_F(HttpKeyValueStoreTest, ReadByteRange) {
                                    StorageGeneration::Invalid()));
 }
 
+TEST_F(HttpKeyValueStoreTest, ParallelRead) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "http"},
+                                 {"base_url", "https://example.com/my/path/"},
+                                 {"parallel_read_part_size", 4}})
+                      .result());
+  auto read_future = kvstore::Read(store, "abc");
+  {
+    auto request = mock_transport->requests_.pop();
+    EXPECT_THAT(request.request.headers,
+                ::testing::UnorderedElementsAre("cache-control: no-cache",
+                                                "Range: bytes=0-3"));
+    request.promise.SetResult(
+        HttpResponse{206,
+                     absl::Cord("0123"),
+                     {{"content-range", "bytes 0-3/10"}, {"etag", "\"xyz\""}}});
+  }
+  // The remaining parts are requested concurrently, conditioned on the etag
+  // of the first part.
+  for (int i = 0; i < 2; ++i) {
+    auto request = mock_transport->requests_.pop();
+    EXPECT_THAT(request.request.headers,
+                ::testing::Contains("if-match: \"xyz\""));
+    if (std::find(request.request.headers.begin(),
+                  request.request.headers.end(),
+                  "Range: bytes=4-7") != request.request.headers.end()) {
+      request.promise.SetResult(HttpResponse{
+          206,
+          absl::Cord("4567"),
+          {{"content-range", "bytes 4-7/10"}, {"etag", "\"xyz\""}}});
+    } else {
+      EXPECT_THAT(request.request.headers,
+                  ::testing::Contains("Range: bytes=8-9"));
+      request.promise.SetResult(HttpResponse{
+          206,
+          absl::Cord("89"),
+          {{"content-range", "bytes 8-9/10"}, {"etag", "\"xyz\""}}});
+    }
+  }
+  EXPECT_THAT(read_future.result(),
+              MatchesKvsReadResult(absl::Cord("0123456789"),
+                                   StorageGeneration::FromString("xyz")));
+}
+
 TEST_F(HttpKeyValueStoreTest, ReadZeroByteRange) {
   TENSORSTORE_ASSERT_OK_AND_ASSIGN(
       auto store, kvstore::Open("https://example.com/my/path/").result());
@@ -31,6 +31,7 @@
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/queue_testutil.h"
 #include "tensorstore/internal/utf8.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
@@ -51,6 +52,10 @@ namespace jb = tensorstore::internal_json_binding;
 
 Future<kvstore::ReadResult> MockKeyValueStore::Read(Key key,
                                                     ReadOptions options) {
+  if (batch_reads && options.batch) {
+    return internal_kvstore_batch::BatchRead(*this, std::move(key),
+                                             std::move(options));
+  }
   if (log_requests) {
     ::nlohmann::json::object_t log_entry;
     log_entry.emplace("type", "read");
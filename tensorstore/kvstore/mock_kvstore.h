@@ -111,6 +111,11 @@ class MockKeyValueStore : public kvstore::Driver {
   // If set, all requests are forwarded immediately rather than added to the
   // various queues.
   kvstore::DriverPtr forward_to;
+
+  // If set to `true`, reads that specify a batch are deferred until the batch
+  // is submitted, and then handled with the batch cleared, as by drivers that
+  // support batching.
+  bool batch_reads = false;
 };
 
 /// Context resource for a `MockKeyValueStore`.
@@ -1175,8 +1175,11 @@ class ShardedKeyValueStore
 
   SupportedFeatures GetSupportedFeatures(
       const KeyRange& key_range) const final {
+    // Generations are derived from the generation of the entire shard.
     return base_kvstore_driver()->GetSupportedFeatures(
-        KeyRange::Prefix(key_prefix()));
+               KeyRange::Prefix(key_prefix())) &
+           (SupportedFeatures::kSingleKeyAtomicReadModifyWrite |
+            SupportedFeatures::kAtomicWriteWithoutOverwrite);
   }
 
   Result<KvStore> GetBase(std::string_view path,
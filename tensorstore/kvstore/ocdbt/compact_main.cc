@@ -0,0 +1,111 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <optional>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include <nlohmann/json.hpp>
+#include "tensorstore/internal/json_binding/std_optional.h"  // IWYU pragma: keep
+#include "tensorstore/internal/path.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/ocdbt/compact_util.h"
+#include "tensorstore/kvstore/spec.h"
+#include "tensorstore/util/json_absl_flag.h"
+#include "tensorstore/util/result.h"
+
+ABSL_FLAG(tensorstore::JsonAbslFlag<std::optional<tensorstore::kvstore::Spec>>,
+          kvstore, std::nullopt, "Underlying kvstore");
+ABSL_FLAG(absl::Duration, version_retention, absl::InfiniteDuration(),
+          "Drop versions committed longer ago than this duration");
+ABSL_FLAG(double, min_data_file_utilization, 0,
+          "Rewrite keys referencing data files with a lower fraction of "
+          "referenced bytes; requires a finite --version_retention");
+ABSL_FLAG(bool, delete_unreferenced_files, true,
+          "Delete data files referenced only by dropped versions");
+ABSL_FLAG(bool, dry_run, false,
+          "Report what would be done without modifying the database");
+
+namespace tensorstore {
+namespace internal_ocdbt {
+
+namespace {
+absl::Status RunCompactCommand() {
+  auto kvs_spec = absl::GetFlag(FLAGS_kvstore).value;
+  if (!kvs_spec) {
+    return absl::InvalidArgumentError("Must specify --kvstore");
+  }
+  internal::EnsureDirectoryPath(kvs_spec->path);
+  TENSORSTORE_ASSIGN_OR_RETURN(auto base_json, kvs_spec->ToJson());
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto kvs,
+      kvstore::Open({{"driver", "ocdbt"}, {"base", std::move(base_json)}})
+          .result());
+
+  CompactOptions options;
+  options.version_retention = absl::GetFlag(FLAGS_version_retention);
+  options.min_data_file_utilization =
+      absl::GetFlag(FLAGS_min_data_file_utilization);
+  options.delete_unreferenced_files =
+      absl::GetFlag(FLAGS_delete_unreferenced_files);
+  options.dry_run = absl::GetFlag(FLAGS_dry_run);
+  TENSORSTORE_ASSIGN_OR_RETURN(auto result,
+                               Compact(std::move(kvs), options).result());
+  std::cout << result << std::endl;
+  return absl::OkStatus();
+}
+}  // namespace
+}  // namespace internal_ocdbt
+}  // namespace tensorstore
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);  // InitTensorstore
+  auto status = tensorstore::internal_ocdbt::RunCompactCommand();
+  if (!status.ok()) {
+    std::cerr << status << std::endl;
+
+    if (absl::IsInvalidArgument(status)) {
+      std::cerr << "Usage: " << argv[0]
+                << " --kvstore <kvstore-json-spec> [--version_retention "
+                   "<duration>] [--min_data_file_utilization <fraction>] "
+                   "[--nodelete_unreferenced_files] [--dry_run]"
+                << "\n";
+      std::cerr << R"(
+The kvstore must refer to a prefix/directory containing an OCDBT database.
+
+Versions committed longer ago than `--version_retention` are dropped from the
+manifest; the latest version is always retained.  If
+`--min_data_file_utilization` is positive, keys of the latest version that
+reference data files in which a smaller fraction of bytes is still referenced
+are rewritten, unless `--version_retention` is infinite.  Data files that were
+referenced by a dropped version and are not referenced by any retained version
+are then deleted.
+
+The database may be written concurrently while it is compacted, but any
+readers of versions older than `--version_retention` must have finished.
+
+Example usage:
+
+bazel run //tensorstore/kvstore/ocdbt:compact -- --kvstore '"file:///tmp/ocdbt/"' --version_retention 1h --min_data_file_utilization 0.5 --dry_run
+
+)";
+      std::cerr << std::flush;
+    }
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,749 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/ocdbt/compact_util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/intrusive_ptr.h"
+#include "tensorstore/internal/log/verbose_flag.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/ocdbt/driver.h"
+#include "tensorstore/kvstore/ocdbt/format/btree.h"
+#include "tensorstore/kvstore/ocdbt/format/indirect_data_reference.h"
+#include "tensorstore/kvstore/ocdbt/format/manifest.h"
+#include "tensorstore/kvstore/ocdbt/format/version_tree.h"
+#include "tensorstore/kvstore/ocdbt/io_handle.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_ocdbt {
+namespace {
+
+ABSL_CONST_INIT internal_log::VerboseFlag ocdbt_logging("ocdbt");
+
+// Prefix of the data files written by `GenerateDataFileId`.
+constexpr std::string_view kDataFilePrefix = "d/";
+
+// Collects the set of data files, and the number of bytes within each data
+// file, referenced by a set of versions.
+//
+// References are deduplicated by location, such that nodes and values shared
+// by multiple versions are only read and counted once.  Consequently, the
+// same instance may be used to incrementally visit additional versions.
+struct ReferencedDataFiles
+    : public internal::AtomicReferenceCount<ReferencedDataFiles> {
+  using Ptr = internal::IntrusivePtr<ReferencedDataFiles>;
+
+  ReadonlyIoHandle::Ptr io_handle;
+
+  absl::Mutex mutex;
+
+  // Cache keys of all locations visited.
+  absl::flat_hash_set<std::string> visited ABSL_GUARDED_BY(mutex);
+
+  // Number of bytes referenced, keyed by data file path relative to the
+  // database root.
+  absl::flat_hash_map<std::string, uint64_t> bytes ABSL_GUARDED_BY(mutex);
+
+  // Records a reference to `ref`.
+  //
+  // Returns `true` if `ref` was not previously visited.
+  bool AddReference(const IndirectDataReference& ref) {
+    absl::MutexLock lock(&mutex);
+    if (!visited.insert(ref.EncodeCacheKey()).second) return false;
+    bytes[ref.file_id.FullPath()] += ref.length;
+    return true;
+  }
+
+  uint64_t GetReferencedBytes(const std::string& path) {
+    absl::MutexLock lock(&mutex);
+    auto it = bytes.find(path);
+    return it == bytes.end() ? 0 : it->second;
+  }
+
+  // Visits all versions referenced by `manifest`.
+  static Future<const void> VisitManifest(Ptr self, const Manifest& manifest) {
+    auto [promise, future] = PromiseFuturePair<void>::Make(absl::OkStatus());
+    for (const auto& version : manifest.versions) {
+      VisitVersion(self, promise, version);
+    }
+    for (const auto& node_ref : manifest.version_tree_nodes) {
+      VisitVersionTreeNode(self, promise, node_ref.location);
+    }
+    return std::move(future);
+  }
+
+  static void VisitVersion(const Ptr& self, const Promise<void>& promise,
+                           const BtreeGenerationReference& version) {
+    if (version.root.location.IsMissing()) return;
+    VisitBtreeNode(self, promise, version.root.location);
+  }
+
+  static void VisitVersionTreeNode(const Ptr& self,
+                                   const Promise<void>& promise,
+                                   const IndirectDataReference& location) {
+    if (!self->AddReference(location)) return;
+    auto* self_ptr = self.get();
+    Link(WithExecutor(
+             self_ptr->io_handle->executor,
+             [self = self](
+                 Promise<void> promise,
+                 ReadyFuture<const std::shared_ptr<const VersionTreeNode>>
+                     read_future) {
+               TENSORSTORE_ASSIGN_OR_RETURN(
+                   auto node, read_future.result(),
+                   static_cast<void>(SetDeferredResult(promise, _)));
+               if (auto* entries =
+                       std::get_if<VersionTreeNode::LeafNodeEntries>(
+                           &node->entries)) {
+                 for (const auto& version : *entries) {
+                   VisitVersion(self, promise, version);
+                 }
+               } else {
+                 auto& children =
+                     std::get<VersionTreeNode::InteriorNodeEntries>(
+                         node->entries);
+                 for (const auto& child : children) {
+                   VisitVersionTreeNode(self, promise, child.location);
+                 }
+               }
+             }),
+         promise, self_ptr->io_handle->GetVersionTreeNode(location));
+  }
+
+  static void VisitBtreeNode(const Ptr& self, const Promise<void>& promise,
+                             const IndirectDataReference& location) {
+    if (!self->AddReference(location)) return;
+    auto* self_ptr = self.get();
+    Link(WithExecutor(
+             self_ptr->io_handle->executor,
+             [self = self](
+                 Promise<void> promise,
+                 ReadyFuture<const std::shared_ptr<const BtreeNode>>
+                     read_future) {
+               TENSORSTORE_ASSIGN_OR_RETURN(
+                   auto node, read_future.result(),
+                   static_cast<void>(SetDeferredResult(promise, _)));
+               if (auto* entries = std::get_if<BtreeNode::LeafNodeEntries>(
+                       &node->entries)) {
+                 for (const auto& entry : *entries) {
+                   if (auto* ref = std::get_if<IndirectDataReference>(
+                           &entry.value_reference)) {
+                     self->AddReference(*ref);
+                   }
+                 }
+               } else {
+                 for (const auto& entry :
+                      std::get<BtreeNode::InteriorNodeEntries>(node->entries)) {
+                   VisitBtreeNode(self, promise, entry.node.location);
+                 }
+               }
+             }),
+         promise, self_ptr->io_handle->GetBtreeNode(location));
+  }
+};
+
+// Finds the keys of a b+tree version that must be rewritten in order for the
+// version to no longer reference any of the specified data files.
+//
+// Out-of-line values stored in one of the data files are rewritten directly.
+// B+tree nodes stored in one of the data files are rewritten by rewriting the
+// first key of the subtree, since writing a key rewrites every node on the
+// path from the root to the leaf containing it.
+struct FindKeysToRewriteOperation
+    : public internal::AtomicReferenceCount<FindKeysToRewriteOperation> {
+  using Ptr = internal::IntrusivePtr<FindKeysToRewriteOperation>;
+
+  ReadonlyIoHandle::Ptr io_handle;
+
+  // Paths of the data files to avoid, relative to the database root.
+  absl::flat_hash_set<std::string> data_files;
+
+  absl::Mutex mutex;
+  std::vector<std::string> keys ABSL_GUARDED_BY(mutex);
+
+  bool ReferencesDataFile(const IndirectDataReference& ref) const {
+    return data_files.contains(ref.file_id.FullPath());
+  }
+
+  // Visits the subtree rooted at `location`.
+  //
+  // Args:
+  //   inclusive_min_key: Full inclusive min key for the node.
+  //   subtree_common_prefix_length: Length of the prefix of
+  //     `inclusive_min_key` that is excluded from the encoded representation
+  //     of the node.
+  //   rewrite_first_key: Indicates that an ancestor of the node must be
+  //     rewritten, and the node is the first child along the path to the first
+  //     key of that ancestor.
+  static void VisitSubtree(Ptr op, const Promise<void>& promise,
+                           const IndirectDataReference& location,
+                           std::string inclusive_min_key,
+                           KeyLength subtree_common_prefix_length,
+                           bool rewrite_first_key) {
+    rewrite_first_key = rewrite_first_key || op->ReferencesDataFile(location);
+    auto* op_ptr = op.get();
+    Link(WithExecutor(
+             op_ptr->io_handle->executor,
+             [op = std::move(op),
+              inclusive_min_key = std::move(inclusive_min_key),
+              subtree_common_prefix_length, rewrite_first_key](
+                 Promise<void> promise,
+                 ReadyFuture<const std::shared_ptr<const BtreeNode>>
+                     read_future) mutable {
+               TENSORSTORE_ASSIGN_OR_RETURN(
+                   auto node, read_future.result(),
+                   static_cast<void>(SetDeferredResult(promise, _)));
+               auto& subtree_key_prefix = inclusive_min_key;
+               subtree_key_prefix.resize(subtree_common_prefix_length);
+               subtree_key_prefix += node->key_prefix;
+               if (node->height > 0) {
+                 VisitInteriorNode(op, promise, *node, subtree_key_prefix,
+                                   rewrite_first_key);
+               } else {
+                 VisitLeafNode(*op, *node, subtree_key_prefix,
+                               rewrite_first_key);
+               }
+             }),
+         promise, op_ptr->io_handle->GetBtreeNode(location));
+  }
+
+  static void VisitInteriorNode(const Ptr& op, const Promise<void>& promise,
+                                const BtreeNode& node,
+                                std::string_view subtree_key_prefix,
+                                bool rewrite_first_key) {
+    auto& entries = std::get<BtreeNode::InteriorNodeEntries>(node.entries);
+    for (size_t i = 0; i < entries.size(); ++i) {
+      const auto& entry = entries[i];
+      VisitSubtree(op, promise, entry.node.location,
+                   /*inclusive_min_key=*/
+                   tensorstore::StrCat(subtree_key_prefix, entry.key),
+                   /*subtree_common_prefix_length=*/subtree_key_prefix.size() +
+                       entry.subtree_common_prefix_length,
+                   /*rewrite_first_key=*/rewrite_first_key && i == 0);
+    }
+  }
+
+  static void VisitLeafNode(FindKeysToRewriteOperation& op,
+                            const BtreeNode& node,
+                            std::string_view subtree_key_prefix,
+                            bool rewrite_first_key) {
+    auto& entries = std::get<BtreeNode::LeafNodeEntries>(node.entries);
+    absl::MutexLock lock(&op.mutex);
+    for (size_t i = 0; i < entries.size(); ++i) {
+      const auto& entry = entries[i];
+      auto* ref = std::get_if<IndirectDataReference>(&entry.value_reference);
+      if ((rewrite_first_key && i == 0) ||
+          (ref && op.ReferencesDataFile(*ref))) {
+        op.keys.push_back(tensorstore::StrCat(subtree_key_prefix, entry.key));
+      }
+    }
+  }
+};
+
+Future<std::vector<std::string>> FindKeysToRewrite(
+    ReadonlyIoHandle::Ptr io_handle, const BtreeGenerationReference& version,
+    absl::flat_hash_set<std::string> data_files) {
+  if (version.root.location.IsMissing()) {
+    return std::vector<std::string>{};
+  }
+  auto op = internal::MakeIntrusivePtr<FindKeysToRewriteOperation>();
+  op->io_handle = std::move(io_handle);
+  op->data_files = std::move(data_files);
+  auto [promise, future] = PromiseFuturePair<void>::Make(absl::OkStatus());
+  FindKeysToRewriteOperation::VisitSubtree(op, promise, version.root.location,
+                                           /*inclusive_min_key=*/{},
+                                           /*subtree_common_prefix_length=*/0,
+                                           /*rewrite_first_key=*/false);
+  return PromiseFuturePair<std::vector<std::string>>::LinkValue(
+             [op = std::move(op)](Promise<std::vector<std::string>> promise,
+                                  ReadyFuture<const void> future) {
+               absl::MutexLock lock(&op->mutex);
+               auto& keys = op->keys;
+               std::sort(keys.begin(), keys.end());
+               keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+               promise.SetResult(std::move(keys));
+             },
+             std::move(future))
+      .future;
+}
+
+// Rewrites the current value of `key`, conditioned on it not being modified
+// concurrently.
+//
+// Returns `true` if the key was rewritten.  If the key was concurrently
+// modified, it need not be rewritten, since the modification itself writes the
+// key to a new location.
+Future<bool> RewriteKey(KvStore store, std::string key) {
+  auto read_future = kvstore::Read(store, key);
+  return PromiseFuturePair<bool>::LinkValue(
+             [store = std::move(store), key = std::move(key)](
+                 Promise<bool> promise,
+                 ReadyFuture<kvstore::ReadResult> read_future) {
+               auto& read_result = read_future.value();
+               if (!read_result.has_value()) {
+                 promise.SetResult(false);
+                 return;
+               }
+               kvstore::WriteOptions write_options;
+               write_options.if_equal = read_result.stamp.generation;
+               LinkValue(
+                   [](Promise<bool> promise,
+                      ReadyFuture<TimestampedStorageGeneration> write_future) {
+                     promise.SetResult(!StorageGeneration::IsUnknown(
+                         write_future.value().generation));
+                   },
+                   std::move(promise),
+                   kvstore::Write(store, key, std::move(read_result.value),
+                                  std::move(write_options)));
+             },
+             std::move(read_future))
+      .future;
+}
+
+Result<CommitTime> GetCutoff(absl::Duration version_retention) {
+  if (version_retention == absl::InfiniteDuration()) {
+    return CommitTime::min();
+  }
+  return CommitTime::FromAbslTime(
+      std::max(absl::Now() - version_retention, absl::UnixEpoch()));
+}
+
+// Asynchronous operation state used to implement `Compact`.
+//
+// The compaction is implemented as follows:
+//
+// 1. Read the manifest, and atomically replace it with a manifest from which
+//    versions older than the retention period have been dropped.  If the
+//    manifest was concurrently modified, start over.
+//
+// 2. List the data files and, in parallel, visit all nodes and out-of-line
+//    values referenced by the retained versions to determine the number of
+//    bytes referenced within each data file.
+//
+// 3. If any data files are sparsely referenced, rewrite the keys of the latest
+//    version that reference them, and repeat from step 1 (without rewriting
+//    again).  The data files only become unreferenced once the version
+//    superseded by the rewrite is dropped, which happens in the repeated pass
+//    only if the retention period has already elapsed for it (e.g. if
+//    `version_retention` is zero), and otherwise in a later compaction.  Keys
+//    are never rewritten with an infinite retention period.
+//
+// 4. Re-read the manifest to ensure that no version was committed that
+//    references a data file considered unreferenced, and delete the data files
+//    that are referenced by a version dropped in step 1 but not by any
+//    retained version.  Data files that are not referenced by any version at
+//    all, such as those of a commit still in progress, are never deleted.
+struct CompactOperation
+    : public internal::AtomicReferenceCount<CompactOperation> {
+  using Ptr = internal::IntrusivePtr<CompactOperation>;
+
+  // Driver of the database, owned by `store`.
+  OcdbtDriver* driver;
+  KvStore store;
+  CompactOptions options;
+  CompactResult result;
+
+  // Set once sparsely referenced data files have been compacted.
+  bool rewrite_done = false;
+
+  // Manifest with the retained versions.
+  std::shared_ptr<const Manifest> manifest;
+
+  // Data files present at the start of the current pass.
+  std::vector<kvstore::ListEntry> data_files;
+
+  // References of the retained versions.
+  ReferencedDataFiles::Ptr referenced;
+
+  // References of the versions dropped by any pass.
+  ReferencedDataFiles::Ptr dropped;
+
+  const IoHandle& io_handle() const { return *driver->io_handle_; }
+
+  static void Start(Ptr op, Promise<CompactResult> promise) {
+    auto* op_ptr = op.get();
+    LinkValue(WithExecutor(op_ptr->io_handle().executor,
+                           [op = std::move(op)](
+                               Promise<CompactResult> promise,
+                               ReadyFuture<const ManifestWithTime> future) {
+                             DropVersions(std::move(op), std::move(promise),
+                                          future.value().manifest);
+                           }),
+              std::move(promise),
+              op_ptr->io_handle().GetManifest(absl::Now()));
+  }
+
+  static void DropVersions(Ptr op, Promise<CompactResult> promise,
+                           std::shared_ptr<const Manifest> manifest) {
+    if (!manifest) {
+      // The database has not been created.
+      promise.SetResult(op->result);
+      return;
+    }
+    TENSORSTORE_ASSIGN_OR_RETURN(
+        auto cutoff, GetCutoff(op->options.version_retention),
+        static_cast<void>(promise.SetResult(_)));
+    uint64_t num_versions_dropped = 0;
+    auto new_manifest = std::make_shared<Manifest>(
+        internal_ocdbt::DropVersions(*manifest, cutoff, num_versions_dropped));
+    Manifest dropped = GetDroppedVersions(*manifest, *new_manifest);
+    if (num_versions_dropped == 0 || op->options.dry_run) {
+      op->result.num_versions_dropped += num_versions_dropped;
+      op->manifest = num_versions_dropped ? std::move(new_manifest)
+                                          : std::move(manifest);
+      VisitDroppedVersions(std::move(op), std::move(promise), dropped);
+      return;
+    }
+    ABSL_LOG_IF(INFO, ocdbt_logging)
+        << "Compact: dropping " << num_versions_dropped << " versions";
+    auto* op_ptr = op.get();
+    auto update_future = op_ptr->io_handle().TryUpdateManifest(
+        std::move(manifest), new_manifest, absl::Now());
+    LinkValue(WithExecutor(op_ptr->io_handle().executor,
+                           [op = std::move(op),
+                            new_manifest = std::move(new_manifest),
+                            dropped = std::move(dropped),
+                            num_versions_dropped](
+                               Promise<CompactResult> promise,
+                               ReadyFuture<TryUpdateManifestResult> future) {
+                             if (!future.value().success) {
+                               // Concurrently modified, retry.
+                               Start(std::move(op), std::move(promise));
+                               return;
+                             }
+                             op->result.num_versions_dropped +=
+                                 num_versions_dropped;
+                             op->manifest = std::move(new_manifest);
+                             VisitDroppedVersions(std::move(op),
+                                                  std::move(promise), dropped);
+                           }),
+              std::move(promise), std::move(update_future));
+  }
+
+  // Returns a manifest referencing the versions of `manifest` that were
+  // removed by `DropVersions` to obtain `new_manifest`.
+  static Manifest GetDroppedVersions(const Manifest& manifest,
+                                     const Manifest& new_manifest) {
+    Manifest dropped;
+    dropped.versions.assign(manifest.versions.begin(),
+                            manifest.versions.end() -
+                                new_manifest.versions.size());
+    dropped.version_tree_nodes.assign(
+        manifest.version_tree_nodes.begin(),
+        manifest.version_tree_nodes.end() -
+            new_manifest.version_tree_nodes.size());
+    return dropped;
+  }
+
+  static void VisitDroppedVersions(Ptr op, Promise<CompactResult> promise,
+                                   const Manifest& dropped) {
+    if (dropped.versions.empty() && dropped.version_tree_nodes.empty()) {
+      FindReferencedDataFiles(std::move(op), std::move(promise));
+      return;
+    }
+    auto* op_ptr = op.get();
+    LinkValue(WithExecutor(op_ptr->io_handle().executor,
+                           [op = std::move(op)](
+                               Promise<CompactResult> promise,
+                               ReadyFuture<const void> future) {
+                             FindReferencedDataFiles(std::move(op),
+                                                     std::move(promise));
+                           }),
+              std::move(promise),
+              ReferencedDataFiles::VisitManifest(op_ptr->dropped, dropped));
+  }
+
+  static void FindReferencedDataFiles(Ptr op, Promise<CompactResult> promise) {
+    op->referenced = internal::MakeIntrusivePtr<ReferencedDataFiles>();
+    op->referenced->io_handle = op->driver->io_handle_;
+    kvstore::ListOptions list_options;
+    list_options.range = KeyRange::Prefix(std::string(kDataFilePrefix));
+    auto list_future = kvstore::ListFuture(op->driver->base_, list_options);
+    auto visit_future =
+        ReferencedDataFiles::VisitManifest(op->referenced, *op->manifest);
+    auto* op_ptr = op.get();
+    LinkValue(WithExecutor(op_ptr->io_handle().executor,
+                           [op = std::move(op)](
+                               Promise<CompactResult> promise,
+                               ReadyFuture<std::vector<kvstore::ListEntry>>
+                                   list_future,
+                               ReadyFuture<const void> visit_future) {
+                             op->data_files = std::move(list_future.value());
+                             RewriteSparseDataFiles(std::move(op),
+                                                    std::move(promise));
+                           }),
+              std::move(promise), std::move(list_future),
+              std::move(visit_future));
+  }
+
+  static void RewriteSparseDataFiles(Ptr op, Promise<CompactResult> promise) {
+    const double min_utilization = op->options.min_data_file_utilization;
+    absl::flat_hash_set<std::string> sparse_files;
+    // With an infinite retention period, the version superseded by rewriting
+    // is never dropped, and the data files would remain referenced by it.
+    if (min_utilization > 0 && !op->rewrite_done &&
+        op->options.version_retention != absl::InfiniteDuration()) {
+      for (const auto& entry : op->data_files) {
+        if (!entry.has_size() || entry.size == 0) continue;
+        const uint64_t referenced_bytes =
+            op->referenced->GetReferencedBytes(entry.key);
+        // Unreferenced data files are deleted rather than rewritten.
+        if (referenced_bytes == 0) continue;
+        if (referenced_bytes < min_utilization * entry.size) {
+          sparse_files.insert(entry.key);
+        }
+      }
+    }
+    if (sparse_files.empty()) {
+      DeleteUnreferencedDataFiles(std::move(op), std::move(promise));
+      return;
+    }
+    ABSL_LOG_IF(INFO, ocdbt_logging)
+        << "Compact: rewriting keys referencing " << sparse_files.size()
+        << " sparse data files";
+    op->rewrite_done = true;
+    auto* op_ptr = op.get();
+    LinkValue(
+        WithExecutor(op_ptr->io_handle().executor,
+                     [op = std::move(op)](
+                         Promise<CompactResult> promise,
+                         ReadyFuture<std::vector<std::string>> future) {
+                       RewriteKeys(std::move(op), std::move(promise),
+                                   future.value());
+                     }),
+        std::move(promise),
+        FindKeysToRewrite(op_ptr->driver->io_handle_,
+                          op_ptr->manifest->latest_version(),
+                          std::move(sparse_files)));
+  }
+
+  static void RewriteKeys(Ptr op, Promise<CompactResult> promise,
+                          const std::vector<std::string>& keys) {
+    if (op->options.dry_run) {
+      op->result.num_keys_rewritten += keys.size();
+      DeleteUnreferencedDataFiles(std::move(op), std::move(promise));
+      return;
+    }
+    std::vector<Future<bool>> rewrite_futures;
+    std::vector<AnyFuture> futures;
+    rewrite_futures.reserve(keys.size());
+    futures.reserve(keys.size());
+    for (const auto& key : keys) {
+      rewrite_futures.push_back(RewriteKey(op->store, key));
+      futures.push_back(rewrite_futures.back());
+    }
+    auto* op_ptr = op.get();
+    LinkValue(WithExecutor(op_ptr->io_handle().executor,
+                           [op = std::move(op),
+                            rewrite_futures = std::move(rewrite_futures)](
+                               Promise<CompactResult> promise,
+                               ReadyFuture<void> future) {
+                             for (auto& rewrite_future : rewrite_futures) {
+                               if (rewrite_future.value()) {
+                                 ++op->result.num_keys_rewritten;
+                               }
+                             }
+                             // Start another pass to drop the versions
+                             // superseded by the rewrite, and to determine
+                             // the data files that are now unreferenced.
+                             Start(std::move(op), std::move(promise));
+                           }),
+              std::move(promise), WaitAllFuture(futures));
+  }
+
+  // Returns the data files referenced by a dropped version but not by any
+  // retained version.
+  std::vector<kvstore::ListEntry> GetUnreferencedDataFiles() {
+    std::vector<kvstore::ListEntry> unreferenced;
+    for (const auto& entry : data_files) {
+      if (referenced->GetReferencedBytes(entry.key) == 0 &&
+          dropped->GetReferencedBytes(entry.key) != 0) {
+        unreferenced.push_back(entry);
+      }
+    }
+    return unreferenced;
+  }
+
+  static void DeleteUnreferencedDataFiles(Ptr op,
+                                          Promise<CompactResult> promise) {
+    if (!op->options.delete_unreferenced_files ||
+        op->GetUnreferencedDataFiles().empty()) {
+      promise.SetResult(op->result);
+      return;
+    }
+    if (op->options.dry_run) {
+      DeleteDataFiles(std::move(op), std::move(promise));
+      return;
+    }
+    // A version committed since the manifest was read may reference a data
+    // file that is not referenced by any of the visited versions.
+    auto* op_ptr = op.get();
+    LinkValue(WithExecutor(op_ptr->io_handle().executor,
+                           [op = std::move(op)](
+                               Promise<CompactResult> promise,
+                               ReadyFuture<const ManifestWithTime> future) {
+                             auto& manifest = future.value().manifest;
+                             if (!manifest || *manifest == *op->manifest) {
+                               DeleteDataFiles(std::move(op),
+                                               std::move(promise));
+                               return;
+                             }
+                             op->manifest = manifest;
+                             auto* op_ptr = op.get();
+                             LinkValue(
+                                 [op = std::move(op)](
+                                     Promise<CompactResult> promise,
+                                     ReadyFuture<const void> future) {
+                                   DeleteDataFiles(std::move(op),
+                                                   std::move(promise));
+                                 },
+                                 std::move(promise),
+                                 ReferencedDataFiles::VisitManifest(
+                                     op_ptr->referenced, *op_ptr->manifest));
+                           }),
+              std::move(promise),
+              op_ptr->io_handle().GetManifest(absl::Now()));
+  }
+
+  static void DeleteDataFiles(Ptr op, Promise<CompactResult> promise) {
+    auto unreferenced = op->GetUnreferencedDataFiles();
+    for (const auto& entry : unreferenced) {
+      ++op->result.num_files_deleted;
+      if (entry.has_size()) op->result.num_bytes_deleted += entry.size;
+    }
+    if (op->options.dry_run) {
+      promise.SetResult(op->result);
+      return;
+    }
+    ABSL_LOG_IF(INFO, ocdbt_logging)
+        << "Compact: deleting " << unreferenced.size()
+        << " unreferenced data files";
+    std::vector<AnyFuture> futures;
+    futures.reserve(unreferenced.size());
+    for (const auto& entry : unreferenced) {
+      futures.push_back(kvstore::Delete(op->driver->base_, entry.key));
+    }
+    LinkValue(
+        [op = std::move(op)](Promise<CompactResult> promise,
+                             ReadyFuture<void> future) {
+          promise.SetResult(op->result);
+        },
+        std::move(promise), WaitAllFuture(futures));
+  }
+};
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, const CompactResult& x) {
+  return os << "{num_versions_dropped=" << x.num_versions_dropped
+            << ", num_keys_rewritten=" << x.num_keys_rewritten
+            << ", num_files_deleted=" << x.num_files_deleted
+            << ", num_bytes_deleted=" << x.num_bytes_deleted << "}";
+}
+
+Manifest DropVersions(const Manifest& manifest, CommitTime cutoff,
+                      uint64_t& num_versions_dropped) {
+  num_versions_dropped = 0;
+  Manifest new_manifest = manifest;
+  auto& versions = new_manifest.versions;
+  auto& version_tree_nodes = new_manifest.version_tree_nodes;
+  if (versions.empty()) return new_manifest;
+
+  // All versions referenced by `version_tree_nodes[i]` were committed before
+  // the first version referenced by `version_tree_nodes[i + 1]`, or, for the
+  // last node, the first inline version.
+  size_t num_nodes_dropped = 0;
+  while (num_nodes_dropped < version_tree_nodes.size()) {
+    const CommitTime next_commit_time =
+        num_nodes_dropped + 1 < version_tree_nodes.size()
+            ? version_tree_nodes[num_nodes_dropped + 1].commit_time
+            : versions.front().commit_time;
+    if (next_commit_time > cutoff) break;
+    num_versions_dropped +=
+        version_tree_nodes[num_nodes_dropped].num_generations;
+    ++num_nodes_dropped;
+  }
+  version_tree_nodes.erase(version_tree_nodes.begin(),
+                           version_tree_nodes.begin() + num_nodes_dropped);
+
+  // The latest version is always retained.
+  size_t num_inline_dropped = 0;
+  while (num_inline_dropped + 1 < versions.size() &&
+         versions[num_inline_dropped].commit_time < cutoff) {
+    ++num_inline_dropped;
+  }
+  versions.erase(versions.begin(), versions.begin() + num_inline_dropped);
+  num_versions_dropped += num_inline_dropped;
+  return new_manifest;
+}
+
+Future<CompactResult> Compact(KvStore store, CompactOptions options) {
+  auto* driver = dynamic_cast<OcdbtDriver*>(store.driver.get());
+  if (!driver) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "Compaction requires an ocdbt kvstore, but received: ",
+        store.driver->DescribeKey(store.path)));
+  }
+  if (driver->coordinator_->address) {
+    return absl::InvalidArgumentError(
+        "Compaction of an ocdbt kvstore with a coordinator is not supported");
+  }
+  if (!(options.min_data_file_utilization >= 0 &&
+        options.min_data_file_utilization <= 1)) {
+    return absl::InvalidArgumentError(tensorstore::StrCat(
+        "min_data_file_utilization must be in the range [0, 1], but received: ",
+        options.min_data_file_utilization));
+  }
+  auto op = internal::MakeIntrusivePtr<CompactOperation>();
+  op->driver = driver;
+  op->dropped = internal::MakeIntrusivePtr<ReferencedDataFiles>();
+  op->dropped->io_handle = driver->io_handle_;
+  op->store = KvStore(std::move(store.driver));
+  op->options = std::move(options);
+  auto [promise, future] = PromiseFuturePair<CompactResult>::Make();
+  CompactOperation::Start(std::move(op), std::move(promise));
+  return std::move(future);
+}
+
+}  // namespace internal_ocdbt
+}  // namespace tensorstore
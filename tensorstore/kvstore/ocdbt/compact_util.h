@@ -0,0 +1,127 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_OCDBT_COMPACT_UTIL_H_
+#define TENSORSTORE_KVSTORE_OCDBT_COMPACT_UTIL_H_
+
+/// \file
+///
+/// Offline compaction and garbage collection of an OCDBT database.
+///
+/// Every commit to an OCDBT database writes new data files, and data files are
+/// never modified or deleted by the driver.  Over time, storage is therefore
+/// consumed by:
+///
+/// - old versions, which remain reachable through the version tree;
+///
+/// - data files that are only sparsely referenced by the retained versions,
+///   because most of the values and b+tree nodes they contain have been
+///   superseded;
+///
+/// - data files that are referenced only by dropped versions.
+///
+/// `Compact` addresses all three: it drops versions older than a retention
+/// period from the manifest, rewrites the live keys that reference sparsely
+/// used data files, and deletes the data files that were referenced by the
+/// versions it dropped but are not referenced by any retained version.
+///
+/// Data files that are not referenced by any version, such as those written by
+/// a commit that is still in progress, are never deleted, so compaction is
+/// safe while other processes write to the database.  The data files of
+/// commits that failed are not reclaimed, nor are those of versions dropped
+/// by a previous compaction that did not complete.
+///
+/// .. warning::
+///
+///    Readers that opened an older version must finish before the data files
+///    of dropped versions are deleted; `version_retention` should exceed the
+///    duration of any such reader.
+
+#include <stdint.h>
+
+#include <iosfwd>
+
+#include "absl/time/time.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/ocdbt/format/manifest.h"
+#include "tensorstore/kvstore/ocdbt/format/version_tree.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+namespace internal_ocdbt {
+
+/// Options for `Compact`.
+struct CompactOptions {
+  /// Versions committed more than `version_retention` before the start of
+  /// compaction are removed from the manifest.  The latest version is always
+  /// retained.
+  absl::Duration version_retention = absl::InfiniteDuration();
+
+  /// Live keys referencing a data file for which the fraction of bytes
+  /// referenced by the retained versions is less than this threshold are
+  /// rewritten, so that the data file becomes unreferenced once the version
+  /// superseded by the rewrite is dropped, either by this compaction or, if
+  /// it is still within `version_retention`, by a later one.  A value of `0`
+  /// disables rewriting.  Ignored if `version_retention` is infinite.
+  double min_data_file_utilization = 0;
+
+  /// Delete data files referenced by a dropped version but not by any
+  /// retained version.
+  bool delete_unreferenced_files = true;
+
+  /// Compute the result without modifying the database.
+  bool dry_run = false;
+};
+
+/// Result of `Compact`.
+struct CompactResult {
+  /// Number of versions removed from the manifest.
+  uint64_t num_versions_dropped = 0;
+
+  /// Number of keys rewritten to compact sparsely used data files.
+  uint64_t num_keys_rewritten = 0;
+
+  /// Number of data files deleted.
+  uint64_t num_files_deleted = 0;
+
+  /// Total size of the data files deleted.
+  uint64_t num_bytes_deleted = 0;
+
+  friend std::ostream& operator<<(std::ostream& os, const CompactResult& x);
+};
+
+/// Returns a copy of `manifest` with the versions committed before `cutoff`
+/// removed, except for the latest version.
+///
+/// Inline versions are removed individually, while out-of-line version tree
+/// nodes are removed only if all of the versions they reference were
+/// committed before `cutoff`.
+///
+/// \param num_versions_dropped[out] Set to the number of versions removed.
+Manifest DropVersions(const Manifest& manifest, CommitTime cutoff,
+                      uint64_t& num_versions_dropped);
+
+/// Compacts the OCDBT database referenced by `store`.
+///
+/// \param store Must refer to an open "ocdbt" kvstore that is not configured
+///     with a coordinator.  The path is ignored; the entire database is
+///     compacted.
+/// \error `absl::StatusCode::kInvalidArgument` if `store` does not refer to a
+///     non-distributed "ocdbt" kvstore.
+Future<CompactResult> Compact(KvStore store, CompactOptions options = {});
+
+}  // namespace internal_ocdbt
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_OCDBT_COMPACT_UTIL_H_
@@ -0,0 +1,273 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/ocdbt/compact_util.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/time.h"
+#include "tensorstore/context.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/ocdbt/driver.h"
+#include "tensorstore/kvstore/ocdbt/format/indirect_data_reference.h"
+#include "tensorstore/kvstore/ocdbt/format/manifest.h"
+#include "tensorstore/kvstore/ocdbt/format/version_tree.h"
+#include "tensorstore/kvstore/ocdbt/test_util.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/test_matchers.h"
+#include "tensorstore/transaction.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::Context;
+using ::tensorstore::KeyRange;
+using ::tensorstore::KvStore;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal_ocdbt::BtreeGenerationReference;
+using ::tensorstore::internal_ocdbt::Compact;
+using ::tensorstore::internal_ocdbt::CompactOptions;
+using ::tensorstore::internal_ocdbt::CommitTime;
+using ::tensorstore::internal_ocdbt::DropVersions;
+using ::tensorstore::internal_ocdbt::IndirectDataReference;
+using ::tensorstore::internal_ocdbt::Manifest;
+using ::tensorstore::internal_ocdbt::OcdbtDriver;
+using ::tensorstore::internal_ocdbt::ReadManifest;
+using ::tensorstore::internal_ocdbt::VersionNodeReference;
+
+BtreeGenerationReference MakeVersion(uint64_t generation_number,
+                                     uint64_t commit_time) {
+  BtreeGenerationReference version{};
+  version.root.location = IndirectDataReference::Missing();
+  version.generation_number = generation_number;
+  version.root_height = 0;
+  version.commit_time = CommitTime{commit_time};
+  return version;
+}
+
+Manifest MakeManifest() {
+  Manifest manifest{};
+  VersionNodeReference node{};
+  node.generation_number = 4;
+  node.height = 1;
+  node.num_generations = 4;
+  node.commit_time = CommitTime{10};
+  manifest.version_tree_nodes.push_back(node);
+  manifest.versions.push_back(MakeVersion(5, 50));
+  manifest.versions.push_back(MakeVersion(6, 60));
+  return manifest;
+}
+
+TEST(DropVersionsTest, Basic) {
+  const auto manifest = MakeManifest();
+  uint64_t num_versions_dropped;
+
+  auto new_manifest =
+      DropVersions(manifest, CommitTime::min(), num_versions_dropped);
+  EXPECT_EQ(0, num_versions_dropped);
+  EXPECT_EQ(manifest, new_manifest);
+
+  // The version tree node references versions committed before 50.
+  new_manifest = DropVersions(manifest, CommitTime{49}, num_versions_dropped);
+  EXPECT_EQ(0, num_versions_dropped);
+  EXPECT_EQ(manifest, new_manifest);
+
+  new_manifest = DropVersions(manifest, CommitTime{50}, num_versions_dropped);
+  EXPECT_EQ(4, num_versions_dropped);
+  EXPECT_TRUE(new_manifest.version_tree_nodes.empty());
+  EXPECT_EQ(manifest.versions, new_manifest.versions);
+
+  new_manifest = DropVersions(manifest, CommitTime{55}, num_versions_dropped);
+  EXPECT_EQ(5, num_versions_dropped);
+  EXPECT_TRUE(new_manifest.version_tree_nodes.empty());
+  ASSERT_EQ(1, new_manifest.versions.size());
+  EXPECT_EQ(6, new_manifest.versions[0].generation_number);
+
+  // The latest version is always retained.
+  new_manifest =
+      DropVersions(manifest, CommitTime::max(), num_versions_dropped);
+  EXPECT_EQ(5, num_versions_dropped);
+  ASSERT_EQ(1, new_manifest.versions.size());
+  EXPECT_EQ(6, new_manifest.versions[0].generation_number);
+}
+
+// Returns the total size of the data files of the database in `base`.
+int64_t GetDataFileBytes(const KvStore& base) {
+  kvstore::ListOptions options;
+  options.range = KeyRange::Prefix("d/");
+  auto entries = kvstore::ListFuture(base, options).value();
+  int64_t total = 0;
+  for (const auto& entry : entries) total += entry.size;
+  return total;
+}
+
+class CompactTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        base_, kvstore::Open("memory://", context_).result());
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+        store_,
+        kvstore::Open({{"driver", "ocdbt"}, {"base", "memory://"}}, context_)
+            .result());
+  }
+
+  // Values larger than the default `max_inline_value_bytes` are stored in
+  // data files.
+  static absl::Cord MakeValue(char c) {
+    return absl::Cord(std::string(1000, c));
+  }
+
+  // Writes the keys in the range [`first`, `last`) in a single commit, such
+  // that the values share a data file.
+  void WriteKeys(char first, char last, char value_offset) {
+    auto transaction = tensorstore::Transaction(tensorstore::isolated);
+    TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto txn_store, store_ | transaction);
+    std::vector<tensorstore::Future<TimestampedStorageGeneration>> futures;
+    for (char c = first; c < last; ++c) {
+      futures.push_back(kvstore::Write(txn_store, std::string(1, c),
+                                       MakeValue(c + value_offset)));
+    }
+    TENSORSTORE_ASSERT_OK(transaction.CommitAsync());
+    for (auto& future : futures) {
+      TENSORSTORE_EXPECT_OK(future);
+    }
+  }
+
+  Context context_ = Context::Default();
+  KvStore base_;
+  KvStore store_;
+};
+
+TEST_F(CompactTest, DropsVersionsAndDeletesUnreferencedFiles) {
+  for (char c : {'a', 'b', 'c'}) {
+    TENSORSTORE_ASSERT_OK(kvstore::Write(store_, "x", MakeValue(c)));
+  }
+  const int64_t initial_bytes = GetDataFileBytes(base_);
+
+  // Without a retention period, all data files remain referenced.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, Compact(store_).result());
+  EXPECT_EQ(0, result.num_versions_dropped);
+  EXPECT_EQ(0, result.num_files_deleted);
+
+  CompactOptions options;
+  options.version_retention = absl::ZeroDuration();
+  options.dry_run = true;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(result, Compact(store_, options).result());
+  EXPECT_EQ(3, result.num_versions_dropped);
+  EXPECT_LT(0, result.num_files_deleted);
+  EXPECT_EQ(initial_bytes, GetDataFileBytes(base_));
+
+  options.dry_run = false;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(result, Compact(store_, options).result());
+  EXPECT_EQ(3, result.num_versions_dropped);
+  EXPECT_LT(0, result.num_files_deleted);
+  EXPECT_EQ(initial_bytes - static_cast<int64_t>(result.num_bytes_deleted),
+            GetDataFileBytes(base_));
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto manifest, ReadManifest(static_cast<OcdbtDriver&>(*store_.driver)));
+  ASSERT_TRUE(manifest);
+  EXPECT_EQ(1, manifest->versions.size());
+  EXPECT_TRUE(manifest->version_tree_nodes.empty());
+  EXPECT_THAT(kvstore::Read(store_, "x").result(),
+              MatchesKvsReadResult(MakeValue('c')));
+
+  // Compaction is idempotent.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(result, Compact(store_, options).result());
+  EXPECT_EQ(0, result.num_versions_dropped);
+  EXPECT_EQ(0, result.num_files_deleted);
+}
+
+TEST_F(CompactTest, RewritesSparseDataFiles) {
+  WriteKeys('a', 'k', /*value_offset=*/0);
+  // Overwrite all but one of the keys.
+  WriteKeys('b', 'k', /*value_offset=*/1);
+  const int64_t initial_bytes = GetDataFileBytes(base_);
+
+  // Keys are not rewritten if the superseded version is never dropped.
+  CompactOptions options;
+  options.min_data_file_utilization = 0.5;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result,
+                                   Compact(store_, options).result());
+  EXPECT_EQ(0, result.num_keys_rewritten);
+  EXPECT_EQ(0, result.num_files_deleted);
+
+  options.version_retention = absl::ZeroDuration();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(result, Compact(store_, options).result());
+  EXPECT_EQ(1, result.num_keys_rewritten);
+  EXPECT_LT(0, result.num_files_deleted);
+  // The data file written by the first commit is no longer referenced.
+  EXPECT_GE(initial_bytes - 8000, GetDataFileBytes(base_));
+
+  EXPECT_THAT(kvstore::Read(store_, "a").result(),
+              MatchesKvsReadResult(MakeValue('a')));
+  for (char c = 'b'; c < 'k'; ++c) {
+    EXPECT_THAT(kvstore::Read(store_, std::string(1, c)).result(),
+                MatchesKvsReadResult(MakeValue(c + 1)));
+  }
+}
+
+TEST_F(CompactTest, ConcurrentWrites) {
+  for (char c : {'a', 'b', 'c'}) {
+    TENSORSTORE_ASSERT_OK(kvstore::Write(store_, "x", MakeValue(c)));
+  }
+  // A data file written by a commit that has not yet completed is not
+  // referenced by any version.
+  TENSORSTORE_ASSERT_OK(kvstore::Write(base_, "d/in_progress", MakeValue('z')));
+
+  CompactOptions options;
+  options.version_retention = absl::ZeroDuration();
+  auto compact_future = Compact(store_, options);
+  std::vector<tensorstore::Future<TimestampedStorageGeneration>> futures;
+  for (char c = 'a'; c < 'k'; ++c) {
+    futures.push_back(kvstore::Write(store_, std::string(1, c), MakeValue(c)));
+  }
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto result, compact_future.result());
+  EXPECT_LT(0, result.num_files_deleted);
+  for (auto& future : futures) {
+    TENSORSTORE_EXPECT_OK(future);
+  }
+
+  EXPECT_THAT(kvstore::Read(base_, "d/in_progress").result(),
+              MatchesKvsReadResult(MakeValue('z')));
+  EXPECT_THAT(kvstore::Read(store_, "x").result(),
+              MatchesKvsReadResult(MakeValue('c')));
+  for (char c = 'a'; c < 'k'; ++c) {
+    EXPECT_THAT(kvstore::Read(store_, std::string(1, c)).result(),
+                MatchesKvsReadResult(MakeValue(c)));
+  }
+}
+
+TEST(CompactErrorTest, InvalidStore) {
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open("memory://").result());
+  EXPECT_THAT(Compact(store).result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
@@ -36,6 +36,7 @@
 #include "tensorstore/internal/data_copy_concurrency_resource.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/log/verbose_flag.h"
+#include "tensorstore/kvstore/coalesce/coalesce_kvstore.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/kvstore.h"
@@ -45,7 +46,6 @@
 #include "tensorstore/kvstore/ocdbt/format/indirect_data_reference.h"
 #include "tensorstore/kvstore/ocdbt/format/manifest.h"
 #include "tensorstore/kvstore/ocdbt/format/version_tree.h"
-#include "tensorstore/kvstore/ocdbt/io/coalesce_kvstore.h"
 #include "tensorstore/kvstore/ocdbt/io/indirect_data_kvstore_driver.h"
 #include "tensorstore/kvstore/ocdbt/io/indirect_data_writer.h"
 #include "tensorstore/kvstore/ocdbt/io/manifest_cache.h"
@@ -369,7 +369,7 @@ IoHandle::Ptr MakeIoHandle(
   // Maybe wrap the base driver in CoalesceKvStoreDriver.
   kvstore::DriverPtr driver_with_optional_coalescing =
       read_coalesce_options.has_value()
-          ? MakeCoalesceKvStoreDriver(
+          ? internal_coalesce_kvstore::MakeCoalesceKvStoreDriver(
                 base_kvstore.driver,
                 read_coalesce_options->max_overhead_bytes_per_request,
                 read_coalesce_options->max_merged_bytes_per_request,
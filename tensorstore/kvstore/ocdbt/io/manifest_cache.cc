@@ -214,12 +214,13 @@ absl::Status ManifestCache::TransactionNode::DoInitialize(
   return Base::TransactionNode::DoInitialize(transaction);
 }
 
-void ManifestCache::Entry::DoRead(absl::Time staleness_bound) {
-  DoReadImpl(this, staleness_bound);
+void ManifestCache::Entry::DoRead(internal::AsyncCacheReadRequest request) {
+  DoReadImpl(this, request.staleness_bound);
 }
 
-void ManifestCache::TransactionNode::DoRead(absl::Time staleness_bound) {
-  DoReadImpl(this, staleness_bound);
+void ManifestCache::TransactionNode::DoRead(
+    internal::AsyncCacheReadRequest request) {
+  DoReadImpl(this, request.staleness_bound);
 }
 
 void ManifestCache::TransactionNode::Commit() {
@@ -590,8 +591,9 @@ void DoNumberedReadImpl(EntryOrNode* entry_or_node,
 }
 }  // namespace
 
-void NumberedManifestCache::Entry::DoRead(absl::Time staleness_bound) {
-  return DoNumberedReadImpl(this, staleness_bound);
+void NumberedManifestCache::Entry::DoRead(
+    internal::AsyncCacheReadRequest request) {
+  return DoNumberedReadImpl(this, request.staleness_bound);
 }
 
 Future<TryUpdateManifestResult> NumberedManifestCache::Entry::TryUpdate(
@@ -624,8 +626,8 @@ Future<TryUpdateManifestResult> NumberedManifestCache::Entry::TryUpdate(
 }
 
 void NumberedManifestCache::TransactionNode::DoRead(
-    absl::Time staleness_bound) {
-  return DoNumberedReadImpl(this, staleness_bound);
+    internal::AsyncCacheReadRequest request) {
+  return DoNumberedReadImpl(this, request.staleness_bound);
 }
 
 namespace {
@@ -0,0 +1,147 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/operation_metrics.h"
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorstore/internal/metrics/histogram.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/execution/any_receiver.h"
+#include "tensorstore/util/execution/execution.h"
+#include "tensorstore/util/executor.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_kvstore {
+namespace {
+
+auto& kvstore_operation_latency_ms =
+    internal_metrics::Histogram<internal_metrics::DefaultBucketer, std::string,
+                                std::string, std::string>::
+        New("/tensorstore/kvstore/operation_latency_ms", "driver",
+            "operation", "outcome", "kvstore driver operation latency (ms)");
+
+auto& kvstore_operation_bytes =
+    internal_metrics::Histogram<internal_metrics::DefaultBucketer, std::string,
+                                std::string>::
+        New("/tensorstore/kvstore/operation_bytes", "driver", "operation",
+            "Bytes read or written by kvstore driver operations");
+
+void RecordLatency(std::string_view driver, std::string_view operation,
+                   absl::Time start, const absl::Status& status) {
+  kvstore_operation_latency_ms.Observe(
+      absl::ToDoubleMilliseconds(absl::Now() - start), driver, operation,
+      absl::StatusCodeToString(status.code()));
+}
+
+/// Receiver that forwards to a `ListReceiver` and records the latency of the
+/// list operation when it completes.
+struct ListMetricsReceiver {
+  std::string_view driver;
+  absl::Time start;
+  kvstore::ListReceiver receiver;
+
+  void set_starting(AnyCancelReceiver cancel) {
+    execution::set_starting(receiver, std::move(cancel));
+  }
+
+  void set_value(kvstore::ListEntry entry) {
+    execution::set_value(receiver, std::move(entry));
+  }
+
+  void set_done() {
+    RecordLatency(driver, "list", start, absl::OkStatus());
+    execution::set_done(receiver);
+  }
+
+  void set_error(absl::Status error) {
+    RecordLatency(driver, "list", start, error);
+    execution::set_error(receiver, std::move(error));
+  }
+
+  void set_stopping() { execution::set_stopping(receiver); }
+};
+
+}  // namespace
+
+// The metrics are recorded by a callback passed to `MapFuture`, rather than
+// one registered with `ExecuteWhenReady`, such that the returned future does
+// not hold a reference to `future`.  If the returned future is no longer
+// needed, the operation is cancelled as it would be without metrics, and is
+// not recorded.
+
+Future<kvstore::ReadResult> RecordReadMetrics(
+    std::string_view driver, Future<kvstore::ReadResult> future) {
+  return MapFuture(
+      InlineExecutor{},
+      [driver, start = absl::Now()](const Result<kvstore::ReadResult>& result)
+          -> Result<kvstore::ReadResult> {
+        RecordLatency(driver, "read", start, result.status());
+        if (result.ok() && result->has_value()) {
+          kvstore_operation_bytes.Observe(result->value.size(), driver,
+                                          "read");
+        }
+        return result;
+      },
+      std::move(future));
+}
+
+Future<TimestampedStorageGeneration> RecordWriteMetrics(
+    std::string_view driver, std::optional<int64_t> bytes,
+    Future<TimestampedStorageGeneration> future) {
+  return MapFuture(
+      InlineExecutor{},
+      [driver, bytes, start = absl::Now()](
+          const Result<TimestampedStorageGeneration>& result)
+          -> Result<TimestampedStorageGeneration> {
+        RecordLatency(driver, bytes ? "write" : "delete", start,
+                      result.status());
+        if (bytes && result.ok()) {
+          kvstore_operation_bytes.Observe(*bytes, driver, "write");
+        }
+        return result;
+      },
+      std::move(future));
+}
+
+Future<const void> RecordDeleteRangeMetrics(std::string_view driver,
+                                            Future<const void> future) {
+  return MapFuture(
+      InlineExecutor{},
+      [driver, start = absl::Now()](const Result<void>& result) {
+        RecordLatency(driver, "delete_range", start, result.status());
+        return result;
+      },
+      std::move(future));
+}
+
+kvstore::ListReceiver RecordListMetrics(std::string_view driver,
+                                        kvstore::ListReceiver receiver) {
+  return ListMetricsReceiver{driver, absl::Now(), std::move(receiver)};
+}
+
+}  // namespace internal_kvstore
+}  // namespace tensorstore
@@ -0,0 +1,83 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_OPERATION_METRICS_H_
+#define TENSORSTORE_KVSTORE_OPERATION_METRICS_H_
+
+/// \file
+///
+/// Latency and size distributions of kvstore driver operations, recorded in
+/// metrics shared by all drivers:
+///
+///   /tensorstore/kvstore/operation_latency_ms{driver, operation, outcome}
+///   /tensorstore/kvstore/operation_bytes{driver, operation}
+///
+/// The `operation` field is one of "read", "write", "delete",
+/// "delete_range" or "list", and the `outcome` field is the name of the
+/// `absl::StatusCode` of the result, e.g. "OK" or "UNAVAILABLE".  The size
+/// distribution records the number of bytes read or written by successful
+/// read and write operations.
+///
+/// Drivers wrap the futures and receivers of their operations with the
+/// functions below, which record the elapsed time from the call until the
+/// operation completes.  The `driver` argument must remain valid for the
+/// duration of the operation; it is normally the driver identifier literal.
+
+#include <stdint.h>
+
+#include <optional>
+#include <string_view>
+
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+
+namespace tensorstore {
+namespace internal_kvstore {
+
+/// Records the metrics of a `kvstore::Driver::Read` operation once `future`
+/// becomes ready.
+///
+/// \returns A future for the result of `future`.  If it is no longer needed
+///     before `future` becomes ready, `future` is no longer needed either, and
+///     no metrics are recorded.
+Future<kvstore::ReadResult> RecordReadMetrics(
+    std::string_view driver, Future<kvstore::ReadResult> future);
+
+/// Records the metrics of a `kvstore::Driver::Write` operation once `future`
+/// becomes ready.  If `bytes` is `std::nullopt`, the operation is recorded as
+/// a delete.
+///
+/// \returns A future for the result of `future`, as for `RecordReadMetrics`.
+Future<TimestampedStorageGeneration> RecordWriteMetrics(
+    std::string_view driver, std::optional<int64_t> bytes,
+    Future<TimestampedStorageGeneration> future);
+
+/// Records the metrics of a `kvstore::Driver::DeleteRange` operation once
+/// `future` becomes ready.
+///
+/// \returns A future for the result of `future`, as for `RecordReadMetrics`.
+Future<const void> RecordDeleteRangeMetrics(std::string_view driver,
+                                            Future<const void> future);
+
+/// Returns a receiver that forwards to `receiver` and records the metrics of
+/// a `kvstore::Driver::ListImpl` operation once the list completes.
+kvstore::ListReceiver RecordListMetrics(std::string_view driver,
+                                        kvstore::ListReceiver receiver);
+
+}  // namespace internal_kvstore
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_OPERATION_METRICS_H_
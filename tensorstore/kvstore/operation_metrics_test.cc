@@ -0,0 +1,153 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/operation_metrics.h"
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "absl/time/clock.h"
+#include "tensorstore/internal/metrics/collect.h"
+#include "tensorstore/internal/metrics/prometheus.h"
+#include "tensorstore/internal/metrics/registry.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/execution/execution.h"
+#include "tensorstore/util/execution/sender_testutil.h"
+#include "tensorstore/util/future.h"
+
+namespace {
+
+namespace kvstore = ::tensorstore::kvstore;
+using ::tensorstore::PromiseFuturePair;
+using ::tensorstore::TimestampedStorageGeneration;
+using ::tensorstore::internal_kvstore::RecordDeleteRangeMetrics;
+using ::tensorstore::internal_kvstore::RecordListMetrics;
+using ::tensorstore::internal_kvstore::RecordReadMetrics;
+using ::tensorstore::internal_kvstore::RecordWriteMetrics;
+using ::tensorstore::internal_metrics::CollectedMetric;
+using ::tensorstore::internal_metrics::GetMetricRegistry;
+using ::tensorstore::internal_metrics::PrometheusExpositionFormat;
+using ::testing::Contains;
+using ::testing::HasSubstr;
+
+// Returns the collected histogram cell of `metric_name` with `fields`.
+std::optional<CollectedMetric::Histogram> GetHistogram(
+    std::string_view metric_name, std::vector<std::string> fields) {
+  auto metric = GetMetricRegistry().Collect(metric_name);
+  if (!metric) return std::nullopt;
+  for (auto& h : metric->histograms) {
+    if (h.fields == fields) return h;
+  }
+  return std::nullopt;
+}
+
+int64_t GetLatencyCount(std::vector<std::string> fields) {
+  auto h = GetHistogram("/tensorstore/kvstore/operation_latency_ms",
+                        std::move(fields));
+  return h ? h->count : 0;
+}
+
+TEST(OperationMetricsTest, Read) {
+  auto pair = PromiseFuturePair<kvstore::ReadResult>::Make();
+  auto future = RecordReadMetrics("read_test", pair.future);
+  EXPECT_EQ(0, GetLatencyCount({"read_test", "read", "OK"}));
+  pair.promise.SetResult(kvstore::ReadResult::Value(
+      absl::Cord("abcd"), TimestampedStorageGeneration()));
+  EXPECT_TRUE(future.ready());
+  EXPECT_EQ(1, GetLatencyCount({"read_test", "read", "OK"}));
+
+  auto bytes = GetHistogram("/tensorstore/kvstore/operation_bytes",
+                            {"read_test", "read"});
+  ASSERT_TRUE(bytes);
+  EXPECT_EQ(1, bytes->count);
+  EXPECT_EQ(4, bytes->mean);
+
+  RecordReadMetrics("read_test", absl::UnavailableError(""));
+  EXPECT_EQ(1, GetLatencyCount({"read_test", "read", "UNAVAILABLE"}));
+}
+
+TEST(OperationMetricsTest, NotNeeded) {
+  auto pair = PromiseFuturePair<kvstore::ReadResult>::Make();
+  auto future = RecordReadMetrics("not_needed_test", std::move(pair.future));
+  EXPECT_TRUE(pair.promise.result_needed());
+
+  // Dropping the returned future cancels the operation.
+  future = {};
+  EXPECT_FALSE(pair.promise.result_needed());
+  pair.promise.SetResult(kvstore::ReadResult::Missing(absl::Now()));
+  EXPECT_EQ(0, GetLatencyCount({"not_needed_test", "read", "OK"}));
+}
+
+TEST(OperationMetricsTest, WriteAndDelete) {
+  RecordWriteMetrics("write_test", 10, TimestampedStorageGeneration());
+  RecordWriteMetrics("write_test", std::nullopt,
+                     TimestampedStorageGeneration());
+  EXPECT_EQ(1, GetLatencyCount({"write_test", "write", "OK"}));
+  EXPECT_EQ(1, GetLatencyCount({"write_test", "delete", "OK"}));
+  auto bytes = GetHistogram("/tensorstore/kvstore/operation_bytes",
+                            {"write_test", "write"});
+  ASSERT_TRUE(bytes);
+  EXPECT_EQ(1, bytes->count);
+  EXPECT_EQ(10, bytes->mean);
+}
+
+TEST(OperationMetricsTest, DeleteRange) {
+  auto pair = PromiseFuturePair<void>::Make();
+  auto future = RecordDeleteRangeMetrics("delete_range_test", pair.future);
+  pair.promise.SetResult(absl::NotFoundError(""));
+  EXPECT_TRUE(future.ready());
+  EXPECT_EQ(
+      1, GetLatencyCount({"delete_range_test", "delete_range", "NOT_FOUND"}));
+}
+
+TEST(OperationMetricsTest, List) {
+  std::vector<std::string> log;
+  auto receiver =
+      RecordListMetrics("list_test", tensorstore::LoggingReceiver{&log});
+  tensorstore::execution::set_starting(receiver, [] {});
+  EXPECT_EQ(0, GetLatencyCount({"list_test", "list", "UNKNOWN"}));
+  tensorstore::execution::set_error(receiver, absl::UnknownError("failed"));
+  EXPECT_EQ(1, GetLatencyCount({"list_test", "list", "UNKNOWN"}));
+  tensorstore::execution::set_stopping(receiver);
+  EXPECT_THAT(log, ::testing::ElementsAre("set_starting",
+                                          "set_error: UNKNOWN: failed",
+                                          "set_stopping"));
+}
+
+TEST(OperationMetricsTest, PrometheusExpositionFormat) {
+  RecordReadMetrics("prometheus_test",
+                    kvstore::ReadResult::Missing(absl::Now()));
+  auto metric =
+      GetMetricRegistry().Collect("/tensorstore/kvstore/operation_latency_ms");
+  ASSERT_TRUE(metric);
+  std::vector<std::string> lines;
+  PrometheusExpositionFormat(
+      *metric, [&](std::string line) { lines.push_back(std::move(line)); });
+  EXPECT_THAT(lines, Contains(HasSubstr(
+                         "_count {driver=\"prometheus_test\", "
+                         "operation=\"read\", outcome=\"OK\"} 1")));
+}
+
+}  // namespace
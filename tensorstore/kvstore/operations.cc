@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "tensorstore/internal/tracing/tracing.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
@@ -42,6 +43,21 @@
 
 namespace tensorstore {
 namespace kvstore {
+namespace {
+
+// Returns a future for the result of `future` that keeps `span` open until it
+// becomes ready, or until it is no longer needed.
+template <typename T>
+Future<T> ExtendSpanUntilReady(const internal_tracing::Span& span,
+                               Future<T> future) {
+  if (!span.is_recording() || future.ready()) return future;
+  auto [promise, linked_future] = PromiseFuturePair<T>::Make();
+  span.ExtendUntilReady(promise);
+  LinkResult(std::move(promise), std::move(future));
+  return std::move(linked_future);
+}
+
+}  // namespace
 
 Future<std::vector<ListEntry>> ListFuture(Driver* driver, ListOptions options) {
   return tensorstore::CollectFlowSenderIntoFuture<std::vector<ListEntry>>(
@@ -57,10 +73,13 @@ Future<std::vector<ListEntry>> ListFuture(const KvStore& store,
 
 Future<ReadResult> Read(const KvStore& store, std::string_view key,
                         ReadOptions options) {
+  internal_tracing::Span span("kvstore::Read");
   auto full_key = tensorstore::StrCat(store.path, key);
+  if (span.is_recording()) span.SetAttribute("key", full_key);
   if (store.transaction == no_transaction) {
     // Regular non-transactional read.
-    return store.driver->Read(std::move(full_key), std::move(options));
+    return ExtendSpanUntilReady(
+        span, store.driver->Read(std::move(full_key), std::move(options)));
   }
   if (!StorageGeneration::IsUnknown(options.if_equal)) {
     return absl::UnimplementedError(
@@ -86,11 +105,14 @@ Future<TimestampedStorageGeneration> Write(const KvStore& store,
                                            std::string_view key,
                                            std::optional<Value> value,
                                            WriteOptions options) {
+  internal_tracing::Span span("kvstore::Write");
   auto full_key = tensorstore::StrCat(store.path, key);
+  if (span.is_recording()) span.SetAttribute("key", full_key);
   if (store.transaction == no_transaction) {
     // Regular non-transactional write.
-    return store.driver->Write(std::move(full_key), std::move(value),
-                               std::move(options));
+    return ExtendSpanUntilReady(
+        span, store.driver->Write(std::move(full_key), std::move(value),
+                                  std::move(options)));
   }
   TENSORSTORE_ASSIGN_OR_RETURN(
       auto open_transaction,
@@ -117,11 +139,14 @@ Future<TimestampedStorageGeneration> WriteCommitted(const KvStore& store,
                                                     std::string_view key,
                                                     std::optional<Value> value,
                                                     WriteOptions options) {
+  internal_tracing::Span span("kvstore::Write");
   auto full_key = tensorstore::StrCat(store.path, key);
+  if (span.is_recording()) span.SetAttribute("key", full_key);
   if (store.transaction == no_transaction) {
     // Regular non-transactional write.
-    return store.driver->Write(std::move(full_key), std::move(value),
-                               std::move(options));
+    return ExtendSpanUntilReady(
+        span, store.driver->Write(std::move(full_key), std::move(value),
+                                  std::move(options)));
   }
   TENSORSTORE_ASSIGN_OR_RETURN(
       auto open_transaction,
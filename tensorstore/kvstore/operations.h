@@ -25,6 +25,7 @@
 
 #include "absl/status/status.h"
 #include "absl/time/time.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
@@ -74,6 +75,12 @@ struct ReadOptions {
 
   /// Specifies the byte range.
   OptionalByteRangeRequest byte_range;
+
+  /// Optional batch with which the read may be combined.  Drivers that do not
+  /// support batching perform the read immediately.
+  ///
+  /// The returned future may not become ready until the batch is submitted.
+  Batch batch{no_batch};
 };
 
 /// Read options for transactional reads.
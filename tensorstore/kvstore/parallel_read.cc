@@ -0,0 +1,154 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/parallel_read.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/internal/metrics/counter.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+#include "tensorstore/util/str_cat.h"
+
+namespace tensorstore {
+namespace internal_kvstore {
+namespace {
+
+auto& parallel_read = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/parallel_read/read",
+    "Reads split into concurrent byte range requests");
+
+auto& parallel_read_part = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/parallel_read/part",
+    "Byte range requests issued for split reads, excluding the first part");
+
+auto& parallel_read_restart = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/parallel_read/restart",
+    "Split reads restarted due to a concurrent modification");
+
+}  // namespace
+
+bool ShouldSplitRead(const kvstore::ReadOptions& options, int64_t part_size) {
+  if (part_size <= 0 || options.byte_range.inclusive_min < 0) return false;
+  const int64_t size = options.byte_range.size();
+  return size == -1 || size > part_size;
+}
+
+OptionalByteRangeRequest GetFirstPartByteRange(
+    const OptionalByteRangeRequest& byte_range, int64_t part_size) {
+  assert(byte_range.inclusive_min >= 0);
+  int64_t exclusive_max = byte_range.inclusive_min + part_size;
+  if (byte_range.exclusive_max != -1) {
+    exclusive_max = std::min(exclusive_max, byte_range.exclusive_max);
+  }
+  return OptionalByteRangeRequest::Range(byte_range.inclusive_min,
+                                         exclusive_max);
+}
+
+Result<ByteRange> GetRemainingByteRange(
+    const OptionalByteRangeRequest& byte_range, int64_t part_size,
+    int64_t start, int64_t size, int64_t total_size) {
+  TENSORSTORE_ASSIGN_OR_RETURN(auto full_range,
+                               byte_range.Validate(total_size));
+  const int64_t first_part_end = std::min(
+      full_range.exclusive_max, full_range.inclusive_min + part_size);
+  if (start != full_range.inclusive_min ||
+      size != first_part_end - full_range.inclusive_min) {
+    return absl::OutOfRangeError(tensorstore::StrCat(
+        "Requested byte range ", byte_range,
+        " was not satisfied by response of size ", size, " at offset ", start));
+  }
+  return ByteRange{first_part_end, full_range.exclusive_max};
+}
+
+void ReadRemainingParts(Promise<kvstore::ReadResult> promise,
+                        kvstore::DriverPtr driver, kvstore::Key key,
+                        const kvstore::ReadOptions& options,
+                        kvstore::ReadResult first_part, ByteRange remaining,
+                        int64_t part_size, int restarts,
+                        RestartSplitRead restart) {
+  assert(first_part.has_value());
+  assert(part_size > 0);
+  parallel_read.Increment();
+
+  // The parts are validated against the generation of the first part, when
+  // the driver returned one which may be used as a condition.
+  kvstore::ReadOptions part_options;
+  part_options.staleness_bound = options.staleness_bound;
+  if (StorageGeneration::IsCleanValidValue(first_part.stamp.generation)) {
+    part_options.if_equal = first_part.stamp.generation;
+  }
+
+  std::vector<Future<kvstore::ReadResult>> parts;
+  std::vector<AnyFuture> futures;
+  for (int64_t offset = remaining.inclusive_min;
+       offset < remaining.exclusive_max; offset += part_size) {
+    part_options.byte_range = OptionalByteRangeRequest::Range(
+        offset, std::min(offset + part_size, remaining.exclusive_max));
+    parts.push_back(driver->Read(key, part_options));
+    futures.push_back(parts.back());
+  }
+  parallel_read_part.IncrementBy(parts.size());
+
+  // If the result is no longer needed, the link is cancelled and the callback,
+  // which holds the parts, is destroyed, such that the part reads are
+  // cancelled as well.
+  Link(
+      [first_part = std::move(first_part), parts = std::move(parts), restarts,
+       restart = std::move(restart)](Promise<kvstore::ReadResult> promise,
+                                     ReadyFuture<void> all_ready) mutable {
+        // `all_ready` fails as soon as any part fails, while other parts may
+        // still be in progress.
+        if (!all_ready.status().ok()) {
+          promise.SetResult(all_ready.status());
+          return;
+        }
+        absl::Cord value = std::move(first_part.value);
+        for (auto& part : parts) {
+          auto& result = part.result();
+          if (!result->has_value() ||
+              result->stamp.generation != first_part.stamp.generation) {
+            // The value was modified after the first part was read.
+            if (restarts >= kMaxSplitReadRestarts) {
+              promise.SetResult(absl::AbortedError(tensorstore::StrCat(
+                  "Value was modified while it was read, after ",
+                  restarts, " restarts")));
+              return;
+            }
+            parallel_read_restart.Increment();
+            std::move(restart)(std::move(promise));
+            return;
+          }
+          value.Append(result->value);
+        }
+        first_part.value = std::move(value);
+        promise.SetResult(std::move(first_part));
+      },
+      std::move(promise), WaitAllFuture(futures));
+}
+
+}  // namespace internal_kvstore
+}  // namespace tensorstore
@@ -0,0 +1,112 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TENSORSTORE_KVSTORE_PARALLEL_READ_H_
+#define TENSORSTORE_KVSTORE_PARALLEL_READ_H_
+
+/// \file
+///
+/// Utilities for splitting large reads into concurrent byte range requests in
+/// kvstore drivers for which the throughput of a single request is limited.
+///
+/// A split read first issues a single request for the first `part_size` bytes
+/// of the requested byte range.  Once the response indicates the total size of
+/// the value, the remaining bytes are read concurrently in parts of at most
+/// `part_size` bytes, each conditioned on the generation returned by the first
+/// request, and the parts are concatenated without copying.  Values no larger
+/// than `part_size` therefore still require only a single request.
+
+#include <stdint.h>
+
+#include "absl/functional/any_invocable.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/driver.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/result.h"
+
+namespace tensorstore {
+namespace internal_kvstore {
+
+/// Returns `true` if a read with the specified `options` may be split into
+/// requests of at most `part_size` bytes.
+///
+/// Reads are split only if `part_size` is positive and `options.byte_range`
+/// specifies a starting offset and either no upper bound or more than
+/// `part_size` bytes.
+bool ShouldSplitRead(const kvstore::ReadOptions& options, int64_t part_size);
+
+/// Returns the byte range requested by the first request of a split read of
+/// `byte_range`.
+///
+/// If the value ends at or before `byte_range.inclusive_min` (e.g. it is
+/// empty), servers reject this range with `416 Range Not Satisfiable`; callers
+/// then reissue the read without splitting.
+///
+/// \dchecks `byte_range.inclusive_min >= 0`
+OptionalByteRangeRequest GetFirstPartByteRange(
+    const OptionalByteRangeRequest& byte_range, int64_t part_size);
+
+/// Validates the response to the first request of a split read of
+/// `byte_range`, and returns the byte range that remains to be read.
+///
+/// \param start Offset of the first byte of the response.
+/// \param size Size of the response.
+/// \param total_size Size of the entire value.
+/// \returns The remaining byte range, which is empty if the response includes
+///     the entire requested byte range.
+/// \error `absl::StatusCode::kOutOfRange` if `byte_range` is not satisfiable
+///     or the response does not match the requested byte range.
+Result<ByteRange> GetRemainingByteRange(
+    const OptionalByteRangeRequest& byte_range, int64_t part_size,
+    int64_t start, int64_t size, int64_t total_size);
+
+/// Maximum number of times a split read is restarted because the value was
+/// modified while its remaining parts were read.
+constexpr int kMaxSplitReadRestarts = 5;
+
+/// Restarts a split read from the first part, and sets the result of the
+/// specified promise.
+using RestartSplitRead =
+    absl::AnyInvocable<void(Promise<kvstore::ReadResult>) &&>;
+
+/// Reads the `remaining` byte range of `key` concurrently in parts of at most
+/// `part_size` bytes using `driver->Read`, and sets the result of `promise` to
+/// `first_part` with the parts appended to its value.
+///
+/// Each part is conditioned on the generation of `first_part`, provided that
+/// it is a clean, valid generation.  If the value is modified or deleted
+/// before all parts are read, the read is restarted by invoking `restart`,
+/// unless it has already been restarted `kMaxSplitReadRestarts` times.
+///
+/// The part reads are linked to `promise`, such that they are cancelled if
+/// its result is no longer needed.
+///
+/// \param options The options of the split read.
+/// \param restarts The number of times the split read has been restarted.
+/// \dchecks `first_part.has_value()`
+/// \error `absl::StatusCode::kAborted` if the value is modified while it is
+///     read, and `restarts == kMaxSplitReadRestarts`.
+void ReadRemainingParts(Promise<kvstore::ReadResult> promise,
+                        kvstore::DriverPtr driver, kvstore::Key key,
+                        const kvstore::ReadOptions& options,
+                        kvstore::ReadResult first_part, ByteRange remaining,
+                        int64_t part_size, int restarts,
+                        RestartSplitRead restart);
+
+}  // namespace internal_kvstore
+}  // namespace tensorstore
+
+#endif  // TENSORSTORE_KVSTORE_PARALLEL_READ_H_
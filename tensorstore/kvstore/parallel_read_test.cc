@@ -0,0 +1,232 @@
+// Copyright 2024 The TensorStore Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tensorstore/kvstore/parallel_read.h"
+
+#include <utility>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/cord.h"
+#include "tensorstore/kvstore/byte_range.h"
+#include "tensorstore/kvstore/generation.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/mock_kvstore.h"
+#include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/read_result.h"
+#include "tensorstore/kvstore/test_matchers.h"
+#include "tensorstore/util/future.h"
+#include "tensorstore/util/status_testutil.h"
+
+namespace {
+
+namespace kvstore = tensorstore::kvstore;
+using ::tensorstore::ByteRange;
+using ::tensorstore::MatchesStatus;
+using ::tensorstore::OptionalByteRangeRequest;
+using ::tensorstore::Promise;
+using ::tensorstore::PromiseFuturePair;
+using ::tensorstore::StorageGeneration;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MockKeyValueStore;
+using ::tensorstore::internal_kvstore::GetFirstPartByteRange;
+using ::tensorstore::internal_kvstore::GetRemainingByteRange;
+using ::tensorstore::internal_kvstore::kMaxSplitReadRestarts;
+using ::tensorstore::internal_kvstore::ReadRemainingParts;
+using ::tensorstore::internal_kvstore::ShouldSplitRead;
+
+kvstore::ReadOptions MakeOptions(OptionalByteRangeRequest byte_range) {
+  kvstore::ReadOptions options;
+  options.byte_range = byte_range;
+  return options;
+}
+
+TEST(ParallelReadTest, ShouldSplitRead) {
+  EXPECT_TRUE(ShouldSplitRead(MakeOptions(OptionalByteRangeRequest()), 10));
+  EXPECT_TRUE(ShouldSplitRead(MakeOptions(OptionalByteRangeRequest(5)), 10));
+  EXPECT_TRUE(
+      ShouldSplitRead(MakeOptions(OptionalByteRangeRequest(0, 11)), 10));
+  EXPECT_FALSE(
+      ShouldSplitRead(MakeOptions(OptionalByteRangeRequest(0, 10)), 10));
+  EXPECT_FALSE(ShouldSplitRead(
+      MakeOptions(OptionalByteRangeRequest::SuffixLength(100)), 10));
+  EXPECT_FALSE(ShouldSplitRead(MakeOptions(OptionalByteRangeRequest()), 0));
+}
+
+TEST(ParallelReadTest, GetFirstPartByteRange) {
+  EXPECT_EQ(OptionalByteRangeRequest(5, 15),
+            GetFirstPartByteRange(OptionalByteRangeRequest(5), 10));
+  EXPECT_EQ(OptionalByteRangeRequest(5, 15),
+            GetFirstPartByteRange(OptionalByteRangeRequest(5, 100), 10));
+  EXPECT_EQ(OptionalByteRangeRequest(5, 8),
+            GetFirstPartByteRange(OptionalByteRangeRequest(5, 8), 10));
+}
+
+TEST(ParallelReadTest, GetRemainingByteRange) {
+  EXPECT_THAT(GetRemainingByteRange(OptionalByteRangeRequest(5), 10,
+                                    /*start=*/5, /*size=*/10,
+                                    /*total_size=*/100),
+              ::testing::Optional(ByteRange{15, 100}));
+  EXPECT_THAT(GetRemainingByteRange(OptionalByteRangeRequest(5, 50), 10,
+                                    /*start=*/5, /*size=*/10,
+                                    /*total_size=*/100),
+              ::testing::Optional(ByteRange{15, 50}));
+  // The value is smaller than a single part.
+  EXPECT_THAT(GetRemainingByteRange(OptionalByteRangeRequest(0), 10,
+                                    /*start=*/0, /*size=*/4,
+                                    /*total_size=*/4),
+              ::testing::Optional(ByteRange{4, 4}));
+  // The requested byte range exceeds the value.
+  EXPECT_THAT(GetRemainingByteRange(OptionalByteRangeRequest(0, 50), 10,
+                                    /*start=*/0, /*size=*/10,
+                                    /*total_size=*/20),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+  // The response does not match the first part.
+  EXPECT_THAT(GetRemainingByteRange(OptionalByteRangeRequest(0), 10,
+                                    /*start=*/0, /*size=*/5,
+                                    /*total_size=*/20),
+              MatchesStatus(absl::StatusCode::kOutOfRange));
+}
+
+TEST(ParallelReadTest, ReadRemainingParts) {
+  auto mock = MockKeyValueStore::Make();
+  auto memory = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp,
+      kvstore::Write(memory, "a", absl::Cord("0123456789")).result());
+
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  ReadRemainingParts(
+      std::move(promise), mock, "a", MakeOptions(OptionalByteRangeRequest(1)),
+      kvstore::ReadResult::Value(absl::Cord("123"), stamp), ByteRange{4, 10},
+      /*part_size=*/3, /*restarts=*/0,
+      [](Promise<kvstore::ReadResult>) { ADD_FAILURE(); });
+
+  for (auto expected : {OptionalByteRangeRequest(4, 7),
+                        OptionalByteRangeRequest(7, 10)}) {
+    auto req = mock->read_requests.pop();
+    EXPECT_EQ("a", req.key);
+    EXPECT_EQ(expected, req.options.byte_range);
+    EXPECT_EQ(stamp.generation, req.options.if_equal);
+    req(memory.driver);
+  }
+  EXPECT_TRUE(mock->read_requests.empty());
+  EXPECT_THAT(future.result(), MatchesKvsReadResult(absl::Cord("123456789"),
+                                                    stamp.generation));
+}
+
+TEST(ParallelReadTest, RestartsWhenModified) {
+  auto mock = MockKeyValueStore::Make();
+  auto memory = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp,
+      kvstore::Write(memory, "a", absl::Cord("0123456789")).result());
+
+  bool restarted = false;
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  ReadRemainingParts(
+      std::move(promise), mock, "a", MakeOptions(OptionalByteRangeRequest(0)),
+      kvstore::ReadResult::Value(absl::Cord("012"), stamp), ByteRange{3, 10},
+      /*part_size=*/10, /*restarts=*/0,
+      [&](Promise<kvstore::ReadResult> restart_promise) {
+        restarted = true;
+        LinkResult(std::move(restart_promise), kvstore::Read(memory, "a"));
+      });
+
+  // Modify the value before the remaining part is read.
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto new_stamp,
+      kvstore::Write(memory, "a", absl::Cord("abcdef")).result());
+  {
+    auto req = mock->read_requests.pop();
+    EXPECT_EQ(stamp.generation, req.options.if_equal);
+    req(memory.driver);
+  }
+
+  // The read is restarted.
+  EXPECT_TRUE(restarted);
+  EXPECT_THAT(future.result(), MatchesKvsReadResult(absl::Cord("abcdef"),
+                                                    new_stamp.generation));
+}
+
+TEST(ParallelReadTest, FailsAfterMaxRestarts) {
+  auto mock = MockKeyValueStore::Make();
+  auto memory = kvstore::Open("memory://").value();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp,
+      kvstore::Write(memory, "a", absl::Cord("0123456789")).result());
+
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  ReadRemainingParts(
+      std::move(promise), mock, "a", MakeOptions(OptionalByteRangeRequest(0)),
+      kvstore::ReadResult::Value(absl::Cord("012"), stamp), ByteRange{3, 10},
+      /*part_size=*/10, /*restarts=*/kMaxSplitReadRestarts,
+      [](Promise<kvstore::ReadResult>) { ADD_FAILURE(); });
+
+  TENSORSTORE_ASSERT_OK(
+      kvstore::Write(memory, "a", absl::Cord("abcdef")).result());
+  mock->read_requests.pop()(memory.driver);
+  EXPECT_THAT(future.result(), MatchesStatus(absl::StatusCode::kAborted));
+}
+
+TEST(ParallelReadTest, PartError) {
+  auto mock = MockKeyValueStore::Make();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(kvstore::Open("memory://").value(), "a",
+                                 absl::Cord("0123456789"))
+                      .result());
+
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  ReadRemainingParts(
+      std::move(promise), mock, "a", MakeOptions(OptionalByteRangeRequest(0)),
+      kvstore::ReadResult::Value(absl::Cord("012"), stamp), ByteRange{3, 10},
+      /*part_size=*/3, /*restarts=*/0,
+      [](Promise<kvstore::ReadResult>) { ADD_FAILURE(); });
+
+  // The result fails as soon as one part fails.
+  auto first = mock->read_requests.pop();
+  auto second = mock->read_requests.pop();
+  second.promise.SetResult(absl::UnknownError("failed"));
+  EXPECT_THAT(future.result(),
+              MatchesStatus(absl::StatusCode::kUnknown, "failed"));
+}
+
+TEST(ParallelReadTest, NotNeeded) {
+  auto mock = MockKeyValueStore::Make();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(kvstore::Open("memory://").value(), "a",
+                                 absl::Cord("0123456789"))
+                      .result());
+
+  auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+  ReadRemainingParts(
+      std::move(promise), mock, "a", MakeOptions(OptionalByteRangeRequest(0)),
+      kvstore::ReadResult::Value(absl::Cord("012"), stamp), ByteRange{3, 10},
+      /*part_size=*/3, /*restarts=*/0,
+      [](Promise<kvstore::ReadResult>) { ADD_FAILURE(); });
+
+  auto first = mock->read_requests.pop();
+  auto second = mock->read_requests.pop();
+  auto third = mock->read_requests.pop();
+  EXPECT_TRUE(first.promise.result_needed());
+
+  // Dropping the result cancels the part reads.
+  future = {};
+  EXPECT_FALSE(first.promise.result_needed());
+  EXPECT_FALSE(second.promise.result_needed());
+  EXPECT_FALSE(third.promise.result_needed());
+}
+
+}  // namespace
@@ -37,10 +37,13 @@
 #include "tensorstore/internal/json_gtest.h"
 #include "tensorstore/internal/os/subprocess.h"
 #include "tensorstore/json_serialization_options_base.h"
+#include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operations.h"
 #include "tensorstore/kvstore/s3/credentials/aws_credentials.h"
 #include "tensorstore/kvstore/s3/s3_request_builder.h"
 #include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/test_matchers.h"
 #include "tensorstore/kvstore/test_util.h"
 #include "tensorstore/util/future.h"
 #include "tensorstore/util/result.h"
@@ -82,8 +85,11 @@ namespace kvstore = ::tensorstore::kvstore;
 
 using ::tensorstore::Context;
 using ::tensorstore::MatchesJson;
+using ::tensorstore::StorageGeneration;
 using ::tensorstore::internal::GetEnv;
 using ::tensorstore::internal::GetEnvironmentMap;
+using ::tensorstore::internal::MatchesKvsReadResult;
+using ::tensorstore::internal::MatchesTimestampedStorageGeneration;
 using ::tensorstore::internal::SetEnv;
 using ::tensorstore::internal::SpawnSubprocess;
 using ::tensorstore::internal::Subprocess;
@@ -325,4 +331,74 @@ TEST_F(LocalStackFixture, Basic) {
   tensorstore::internal::TestKeyValueReadWriteOps(store);
 }
 
+TEST_F(LocalStackFixture, MultipartUpload) {
+  auto context = DefaultTestContext();
+  constexpr size_t kPartSize = 5 * 1024 * 1024;
+  ::nlohmann::json json_spec{
+      {"driver", "s3"},                    //
+      {"bucket", Bucket()},                //
+      {"endpoint", endpoint_url()},        //
+      {"path", Path()},                    //
+      {"multipart_threshold", kPartSize},  //
+      {"multipart_part_size", kPartSize},  //
+  };
+
+  if (!Region().empty()) {
+    json_spec["aws_region"] = Region();
+  }
+  if (!absl::GetFlag(FLAGS_host_header).empty()) {
+    json_spec["host_header"] = absl::GetFlag(FLAGS_host_header);
+  }
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(json_spec, context).result());
+
+  std::string data(2 * kPartSize + 100, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(i % 251);
+  }
+  absl::Cord value(data);
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto stamp, kvstore::Write(store, "multipart", value).result());
+  EXPECT_THAT(kvstore::Read(store, "multipart").result(),
+              MatchesKvsReadResult(value, stamp.generation));
+
+  // Conditional writes are still checked against the current generation.
+  kvstore::WriteOptions options;
+  options.if_equal = StorageGeneration::NoValue();
+  EXPECT_THAT(
+      kvstore::Write(store, "multipart", value, options).result(),
+      MatchesTimestampedStorageGeneration(StorageGeneration::Unknown()));
+
+  options.if_equal = stamp.generation;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto new_stamp,
+      kvstore::Write(store, "multipart", value, options).result());
+  EXPECT_FALSE(StorageGeneration::IsUnknown(new_stamp.generation));
+}
+
+TEST_F(LocalStackFixture, CopyRange) {
+  auto context = DefaultTestContext();
+  ::nlohmann::json json_spec{
+      {"driver", "s3"},                                       //
+      {"bucket", Bucket()},                                   //
+      {"endpoint", endpoint_url()},                           //
+      {"path", tensorstore::StrCat(Path(), "copy_range/")},  //
+  };
+
+  if (!Region().empty()) {
+    json_spec["aws_region"] = Region();
+  }
+  if (!absl::GetFlag(FLAGS_host_header).empty()) {
+    json_spec["host_header"] = absl::GetFlag(FLAGS_host_header);
+  }
+
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(auto store,
+                                   kvstore::Open(json_spec, context).result());
+
+  // Objects are copied using CopyObject requests.
+  tensorstore::internal::TestKeyValueStoreCopyRange(store);
+}
+
 }  // namespace
@@ -15,14 +15,17 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <typeinfo>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/log/absl_log.h"
@@ -42,6 +45,7 @@
 #include "tensorstore/internal/http/http_request.h"
 #include "tensorstore/internal/http/http_response.h"
 #include "tensorstore/internal/http/http_transport.h"
+#include "tensorstore/internal/http/request_hedging.h"
 #include "tensorstore/internal/intrusive_ptr.h"
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/log/verbose_flag.h"
@@ -51,11 +55,15 @@
 #include "tensorstore/internal/source_location.h"
 #include "tensorstore/internal/thread/schedule_at.h"
 #include "tensorstore/internal/uri_utils.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/gcs/validate.h"
 #include "tensorstore/kvstore/generation.h"
 #include "tensorstore/kvstore/key_range.h"
+#include "tensorstore/kvstore/kvstore.h"
+#include "tensorstore/kvstore/operation_metrics.h"
 #include "tensorstore/kvstore/operations.h"
+#include "tensorstore/kvstore/parallel_read.h"
 #include "tensorstore/kvstore/read_result.h"
 #include "tensorstore/kvstore/registry.h"
 #include "tensorstore/kvstore/s3/credentials/aws_credentials.h"
@@ -67,7 +75,10 @@
 #include "tensorstore/kvstore/s3/s3_uri_utils.h"
 #include "tensorstore/kvstore/s3/validate.h"
 #include "tensorstore/kvstore/spec.h"
+#include "tensorstore/kvstore/supported_features.h"
 #include "tensorstore/kvstore/url_registry.h"
+#include "tensorstore/transaction.h"
+#include "tensorstore/util/division.h"
 #include "tensorstore/util/execution/any_receiver.h"
 #include "tensorstore/util/execution/execution.h"
 #include "tensorstore/util/executor.h"
@@ -117,6 +128,7 @@ using ::tensorstore::kvstore::Key;
 using ::tensorstore::kvstore::ListEntry;
 using ::tensorstore::kvstore::ListOptions;
 using ::tensorstore::kvstore::ListReceiver;
+using ::tensorstore::kvstore::SupportedFeatures;
 
 namespace tensorstore {
 namespace {
@@ -151,6 +163,14 @@ auto& s3_write_latency_ms =
         "/tensorstore/kvstore/s3/write_latency_ms",
         "S3 driver kvstore::Write latency (ms)");
 
+auto& s3_multipart_write = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/s3/multipart_write",
+    "S3 driver kvstore::Write calls performed as multipart uploads");
+
+auto& s3_copy = internal_metrics::Counter<int64_t>::New(
+    "/tensorstore/kvstore/s3/copy",
+    "Objects copied within S3 by kvstore::ExperimentalCopyRange");
+
 auto& s3_delete_range = internal_metrics::Counter<int64_t>::New(
     "/tensorstore/kvstore/s3/delete_range",
     "S3 driver kvstore::DeleteRange calls");
@@ -170,6 +190,26 @@ static constexpr char kEmptySha256[] =
 /// An empty etag which should not collide with an actual payload hash
 static constexpr char kEmptyEtag[] = "\"\"";
 
+/// Default size above which values are written using a multipart upload.
+static constexpr size_t kDefaultMultipartThreshold = 64 * 1024 * 1024;
+
+/// Default size of each part of a multipart upload.
+static constexpr size_t kDefaultMultipartPartSize = 16 * 1024 * 1024;
+
+/// S3 limits on the size of each part other than the last, and on the number
+/// of parts, of a multipart upload.
+/// https://docs.aws.amazon.com/AmazonS3/latest/userguide/qfacts.html
+static constexpr size_t kMinMultipartPartSize = 5 * 1024 * 1024;
+static constexpr size_t kMaxMultipartParts = 10000;
+
+/// Largest object which may be copied with a single CopyObject request.
+/// Larger objects are copied using UploadPartCopy requests.
+/// https://docs.aws.amazon.com/AmazonS3/latest/API/API_CopyObject.html
+static constexpr uint64_t kMaxCopyObjectSize = uint64_t{5} << 30;
+
+/// Size of each part of a multipart copy.
+static constexpr uint64_t kMultipartCopyPartSize = uint64_t{512} << 20;
+
 /// Adds the generation header to the provided builder.
 bool AddGenerationHeader(S3RequestBuilder* builder, std::string_view header,
                          const StorageGeneration& gen) {
@@ -270,17 +310,23 @@ struct S3KeyValueStoreSpecData {
   std::optional<std::string> endpoint;
   std::optional<std::string> host_header;
   std::string aws_region;
+  size_t multipart_threshold;
+  size_t multipart_part_size;
+  size_t parallel_read_part_size;
 
   Context::Resource<AwsCredentialsResource> aws_credentials;
   Context::Resource<S3ConcurrencyResource> request_concurrency;
   std::optional<Context::Resource<S3RateLimiterResource>> rate_limiter;
   Context::Resource<S3RequestRetries> retries;
   Context::Resource<DataCopyConcurrencyResource> data_copy_concurrency;
+  std::optional<internal_http::RequestHedgingOptions> read_hedging;
 
   constexpr static auto ApplyMembers = [](auto& x, auto f) {
     return f(x.bucket, x.requester_pays, x.endpoint, x.host_header,
-             x.aws_region, x.aws_credentials, x.request_concurrency,
-             x.rate_limiter, x.retries, x.data_copy_concurrency);
+             x.aws_region, x.multipart_threshold, x.multipart_part_size,
+             x.parallel_read_part_size, x.aws_credentials,
+             x.request_concurrency, x.rate_limiter, x.retries,
+             x.data_copy_concurrency, x.read_hedging);
   };
 
   constexpr static auto default_json_binder = jb::Object(
@@ -305,6 +351,28 @@ struct S3KeyValueStoreSpecData {
       jb::Member("aws_region",
                  jb::Projection<&S3KeyValueStoreSpecData::aws_region>(
                      jb::DefaultValue([](auto* v) { *v = ""; }))),
+      jb::Member("multipart_threshold",
+                 jb::Projection<&S3KeyValueStoreSpecData::multipart_threshold>(
+                     jb::DefaultValue([](auto* v) {
+                       *v = kDefaultMultipartThreshold;
+                     }))),
+      jb::Member(
+          "multipart_part_size",
+          jb::Projection<&S3KeyValueStoreSpecData::multipart_part_size>(
+              jb::DefaultValue(
+                  [](auto* v) { *v = kDefaultMultipartPartSize; },
+                  jb::Validate([](const auto& options, const size_t* x) {
+                    if (*x < kMinMultipartPartSize) {
+                      return absl::InvalidArgumentError(tensorstore::StrCat(
+                          "multipart_part_size must be at least ",
+                          kMinMultipartPartSize));
+                    }
+                    return absl::OkStatus();
+                  })))),
+      jb::Member(
+          "parallel_read_part_size",
+          jb::Projection<&S3KeyValueStoreSpecData::parallel_read_part_size>(
+              jb::DefaultValue([](auto* v) { *v = 0; }))),
       jb::Member(AwsCredentialsResource::id,
                  jb::Projection<&S3KeyValueStoreSpecData::aws_credentials>()),
       jb::Member(
@@ -316,7 +384,12 @@ struct S3KeyValueStoreSpecData {
                  jb::Projection<&S3KeyValueStoreSpecData::retries>()),
       jb::Member(DataCopyConcurrencyResource::id,
                  jb::Projection<
-                     &S3KeyValueStoreSpecData::data_copy_concurrency>()) /**/
+                     &S3KeyValueStoreSpecData::data_copy_concurrency>()),
+      jb::Member("experimental_read_hedging",
+                 jb::Projection<&S3KeyValueStoreSpecData::read_hedging>(
+                     jb::Optional(
+                         internal_http::RequestHedgingOptions::JsonBinder())))
+      /**/
   );
 };
 
@@ -357,11 +430,27 @@ class S3KeyValueStore
 
   Future<const void> DeleteRange(KeyRange range) override;
 
+  Future<const void> ExperimentalCopyRangeFrom(
+      const internal::OpenTransactionPtr& transaction, const KvStore& source,
+      Key target_prefix, kvstore::CopyRangeOptions options) override;
+
+  /// Copies the object `source_key` of `size` bytes in `source_bucket` to
+  /// `target_key` without transferring its contents through the client.
+  Future<TimestampedStorageGeneration> CopyObject(
+      std::string_view source_bucket, std::string_view source_key,
+      Key target_key, uint64_t size);
+
   absl::Status GetBoundSpecData(SpecData& spec) const {
     spec = spec_;
     return absl::OkStatus();
   }
 
+  // Generations are ETags, which S3 derives from the object content.
+  SupportedFeatures GetSupportedFeatures(
+      const KeyRange& key_range) const final {
+    return SupportedFeatures::kContentDerivedGenerations;
+  }
+
   const Executor& executor() const {
     return spec_.data_copy_concurrency->executor;
   }
@@ -418,12 +507,19 @@ class S3KeyValueStore
   S3KeyValueStoreSpecData spec_;
   std::string host_header_;
 
+  // Set if reads are hedged.
+  std::shared_ptr<internal_http::RequestHedger> read_hedger_;
+
   absl::Mutex mutex_;  // Guards resolve_ehr_ creation.
   Future<const S3EndpointRegion> resolve_ehr_;
 };
 
 /// A ReadTask is a function object used to satisfy a
 /// S3KeyValueStore::Read request.
+///
+/// When `part_size_` is non-zero, only the first `part_size_` bytes of the
+/// requested byte range are read by this task, and the remaining bytes are
+/// read concurrently by `internal_kvstore::ReadRemainingParts`.
 struct ReadTask : public RateLimiterNode,
                   public internal::AtomicReferenceCount<ReadTask> {
   IntrusivePtr<S3KeyValueStore> owner;
@@ -434,6 +530,10 @@ struct ReadTask : public RateLimiterNode,
   std::string read_url_;  // the url to read from
   ReadyFuture<const S3EndpointRegion> endpoint_region_;
 
+  int64_t part_size_ = 0;
+  ByteRange remaining_{0, 0};
+  int restarts_ = 0;
+
   int attempt_ = 0;
   absl::Time start_time_;
 
@@ -444,6 +544,13 @@ struct ReadTask : public RateLimiterNode,
         options(std::move(options)),
         promise(std::move(promise)) {}
 
+  /// Submits `task`, for which the endpoint is resolved, to the read rate
+  /// limiter.
+  static void Schedule(IntrusivePtr<ReadTask> task) {
+    intrusive_ptr_increment(task.get());  // adopted by ReadTask::Start.
+    task->owner->read_rate_limiter().Admit(task.get(), &ReadTask::Start);
+  }
+
   ~ReadTask() { owner->admission_queue().Finish(this); }
 
   static void Start(void* task) {
@@ -481,7 +588,11 @@ struct ReadTask : public RateLimiterNode,
                         options.if_not_equal);
     AddGenerationHeader(&request_builder, "if-match", options.if_equal);
 
-    if (options.byte_range.size() != 0) {
+    if (part_size_ != 0) {
+      request_builder.MaybeAddRangeHeader(
+          internal_kvstore::GetFirstPartByteRange(options.byte_range,
+                                                  part_size_));
+    } else if (options.byte_range.size() != 0) {
       request_builder.MaybeAddRangeHeader(options.byte_range);
     }
 
@@ -493,7 +604,12 @@ struct ReadTask : public RateLimiterNode,
                                      ehr.aws_region, kEmptySha256, start_time_);
 
     ABSL_LOG_IF(INFO, s3_logging) << "ReadTask: " << request;
-    auto future = owner->transport_->IssueRequest(request, {});
+    auto future =
+        owner->read_hedger_
+            ? internal_http::IssueHedgedRequest(
+                  owner->read_hedger_, owner->transport_, std::move(request),
+                  owner->spec_.request_concurrency->queue)
+            : owner->transport_->IssueRequest(request, {});
     future.ExecuteWhenReady([self = IntrusivePtr<ReadTask>(this)](
                                 ReadyFuture<HttpResponse> response) {
       self->OnResponse(response.result());
@@ -507,6 +623,15 @@ struct ReadTask : public RateLimiterNode,
     ABSL_LOG_IF(INFO, s3_logging.Level(1) && response.ok())
         << "ReadTask " << *response;
 
+    if (part_size_ != 0 && response.ok() &&
+        response.value().status_code == 416) {
+      // The value ends before the first part begins (e.g. it is empty), so the
+      // range is not satisfiable; read the value without splitting instead.
+      part_size_ = 0;
+      Retry();
+      return;
+    }
+
     absl::Status status = [&]() -> absl::Status {
       if (!response.ok()) return response.status();
       switch (response.value().status_code) {
@@ -528,9 +653,33 @@ struct ReadTask : public RateLimiterNode,
     }
     if (!status.ok()) {
       promise.SetResult(status);
-    } else {
-      promise.SetResult(FinishResponse(response.value()));
+      return;
     }
+    auto result = FinishResponse(response.value());
+    if (result.ok() && remaining_.size() != 0) {
+      // A restart is a new task, such that this task does not hold its
+      // admission queue slot while the remaining parts are read.
+      auto restart = [owner = owner, object_name = object_name,
+                      options = options, read_url = read_url_,
+                      endpoint_region = endpoint_region_,
+                      part_size = part_size_, restarts = restarts_ + 1](
+                         Promise<kvstore::ReadResult> promise) mutable {
+        auto task = internal::MakeIntrusivePtr<ReadTask>(
+            std::move(owner), std::move(object_name), std::move(options),
+            std::move(promise));
+        task->read_url_ = std::move(read_url);
+        task->endpoint_region_ = std::move(endpoint_region);
+        task->part_size_ = part_size;
+        task->restarts_ = restarts;
+        Schedule(std::move(task));
+      };
+      internal_kvstore::ReadRemainingParts(
+          std::move(promise), owner, std::move(object_name), options,
+          *std::move(result), remaining_, part_size_, restarts_,
+          std::move(restart));
+      return;
+    }
+    promise.SetResult(std::move(result));
   }
 
   Result<kvstore::ReadResult> FinishResponse(const HttpResponse& httpresponse) {
@@ -569,11 +718,17 @@ struct ReadTask : public RateLimiterNode,
         // Server should return a parseable content-range header.
         TENSORSTORE_ASSIGN_OR_RETURN(auto content_range_tuple,
                                      ParseContentRangeHeader(httpresponse));
-        if (auto request_size = options.byte_range.size();
-            (options.byte_range.inclusive_min != -1 &&
-             options.byte_range.inclusive_min !=
-                 std::get<0>(content_range_tuple)) ||
-            (request_size >= 0 && request_size != value.size())) {
+        if (part_size_ != 0) {
+          TENSORSTORE_ASSIGN_OR_RETURN(
+              remaining_, internal_kvstore::GetRemainingByteRange(
+                              options.byte_range, part_size_,
+                              std::get<0>(content_range_tuple), value.size(),
+                              std::get<2>(content_range_tuple)));
+        } else if (auto request_size = options.byte_range.size();
+                   (options.byte_range.inclusive_min != -1 &&
+                    options.byte_range.inclusive_min !=
+                        std::get<0>(content_range_tuple)) ||
+                   (request_size >= 0 && request_size != value.size())) {
           // Return an error when the response does not start at the requested
           // offset of when the response is smaller than the desired size.
           return absl::OutOfRangeError(
@@ -595,6 +750,10 @@ struct ReadTask : public RateLimiterNode,
 
 Future<kvstore::ReadResult> S3KeyValueStore::Read(Key key,
                                                   ReadOptions options) {
+  if (options.batch) {
+    return internal_kvstore_batch::BatchRead(*this, std::move(key),
+                                             std::move(options));
+  }
   s3_read.Increment();
   if (!IsValidObjectName(key)) {
     return absl::InvalidArgumentError("Invalid S3 object name");
@@ -604,10 +763,14 @@ Future<kvstore::ReadResult> S3KeyValueStore::Read(Key key,
     return absl::InvalidArgumentError("Malformed StorageGeneration");
   }
 
+  const int64_t part_size = spec_.parallel_read_part_size;
+  const bool split = internal_kvstore::ShouldSplitRead(options, part_size);
+
   auto op = PromiseFuturePair<ReadResult>::Make();
   auto state = internal::MakeIntrusivePtr<ReadTask>(
       internal::IntrusivePtr<S3KeyValueStore>(this), key, std::move(options),
       std::move(op.promise));
+  if (split) state->part_size_ = part_size;
   MaybeResolveRegion().ExecuteWhenReady(
       [state = std::move(state)](ReadyFuture<const S3EndpointRegion> ready) {
         if (!ready.status().ok()) {
@@ -617,12 +780,369 @@ Future<kvstore::ReadResult> S3KeyValueStore::Read(Key key,
         state->read_url_ = tensorstore::StrCat(ready.value().endpoint, "/",
                                                state->object_name);
         state->endpoint_region_ = std::move(ready);
-        intrusive_ptr_increment(state.get());  // adopted by ReadTask::Start.
-        state->owner->read_rate_limiter().Admit(state.get(), &ReadTask::Start);
+        ReadTask::Schedule(std::move(state));
       });
-  return std::move(op.future);
+  return internal_kvstore::RecordReadMetrics(S3KeyValueStoreSpec::id,
+                                             std::move(op.future));
 }
 
+/// Parses the text of the `element` child of the `root` element of an S3 XML
+/// response.
+///
+/// S3 may report errors of some requests, such as CompleteMultipartUpload,
+/// using an `<Error>` document in a 200 response, which is returned as a
+/// retriable error.
+Result<std::string> GetXmlResponseElement(absl::Cord cord, const char* root,
+                                          const char* element) {
+  auto payload = cord.Flatten();
+  tinyxml2::XMLDocument xmlDocument;
+  if (int xmlcode = xmlDocument.Parse(payload.data(), payload.size());
+      xmlcode != tinyxml2::XML_SUCCESS) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed ", root, " response: ", xmlcode));
+  }
+  auto* node = xmlDocument.FirstChildElement(root);
+  if (node == nullptr) {
+    if (auto* error = xmlDocument.FirstChildElement("Error")) {
+      return absl::UnavailableError(absl::StrCat(
+          root, " failed: ", GetNodeText(error->FirstChildElement("Code"))));
+    }
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed ", root, " response: missing <", root, ">"));
+  }
+  return GetNodeText(node->FirstChildElement(element));
+}
+
+/// State of a multipart upload used to satisfy a S3KeyValueStore::Write
+/// request with a value of at least `multipart_threshold` bytes, or to copy an
+/// object larger than `kMaxCopyObjectSize`.
+struct MultipartUploadState
+    : public internal::AtomicReferenceCount<MultipartUploadState> {
+  IntrusivePtr<S3KeyValueStore> owner;
+  absl::Cord value;
+  kvstore::WriteOptions options;
+
+  // If non-empty, the parts are copied from this `x-amz-copy-source`, of size
+  // `copy_size_`, rather than uploaded from `value`.
+  std::string copy_source_;
+  uint64_t copy_size_ = 0;
+  Promise<TimestampedStorageGeneration> promise;
+
+  std::string upload_url_;
+  ReadyFuture<const S3EndpointRegion> endpoint_region_;
+
+  size_t part_size_;
+  absl::Time start_time_;
+
+  // Assigned when the upload is initiated, before any part is uploaded.
+  std::string upload_id_;
+
+  // ETag of each part, indexed by part number - 1.  Each element is assigned
+  // only by the request which uploads that part.
+  std::vector<std::string> etags_;
+  std::atomic<size_t> remaining_parts_{0};
+  std::atomic<bool> aborted_{false};
+
+  uint64_t size() const {
+    return copy_source_.empty() ? value.size() : copy_size_;
+  }
+
+  absl::Cord GetPart(size_t part_index) const {
+    return value.Subcord(part_index * part_size_, part_size_);
+  }
+
+  std::string GetCopySourceRangeHeader(size_t part_index) const {
+    const uint64_t start = part_index * part_size_;
+    const uint64_t end = std::min<uint64_t>(start + part_size_, copy_size_);
+    return absl::StrCat("x-amz-copy-source-range: bytes=", start, "-",
+                        end - 1);
+  }
+
+  std::string GetCompleteRequestBody() const {
+    std::string body = "<CompleteMultipartUpload>";
+    for (size_t i = 0; i < etags_.size(); ++i) {
+      absl::StrAppend(&body, "<Part><PartNumber>", i + 1, "</PartNumber><ETag>",
+                      etags_[i], "</ETag></Part>");
+    }
+    absl::StrAppend(&body, "</CompleteMultipartUpload>");
+    return body;
+  }
+};
+
+/// A MultipartUploadRequest is a single request of a multipart upload.
+///
+/// Initiating the upload, uploading each part, and completing or aborting the
+/// upload are each admitted separately through the write rate limiter and the
+/// request concurrency limit, so that the parts of a value are uploaded in
+/// parallel and retried independently.  A failed upload is aborted so that
+/// S3 discards the uploaded parts.
+struct MultipartUploadRequest
+    : public RateLimiterNode,
+      public internal::AtomicReferenceCount<MultipartUploadRequest> {
+  enum Kind {
+    kInitiate,
+    kUploadPart,
+    // S3 doesn't support conditional writes, so the if-match condition is
+    // tested again before completing the upload.
+    kPeek,
+    kComplete,
+    kAbort,
+  };
+
+  IntrusivePtr<MultipartUploadState> state;
+  Kind kind;
+  size_t part_index;
+  int attempt_ = 0;
+
+  MultipartUploadRequest(IntrusivePtr<MultipartUploadState> state, Kind kind,
+                         size_t part_index)
+      : state(std::move(state)), kind(kind), part_index(part_index) {}
+
+  ~MultipartUploadRequest() { state->owner->admission_queue().Finish(this); }
+
+  /// Starts a multipart upload of `state->value`.
+  static void StartUpload(IntrusivePtr<MultipartUploadState> state) {
+    if (state->copy_source_.empty()) s3_multipart_write.Increment();
+    size_t num_parts = CeilOfRatio<uint64_t>(state->size(), state->part_size_);
+    state->etags_.resize(num_parts);
+    state->remaining_parts_ = num_parts;
+    state->start_time_ = absl::Now();
+    Issue(std::move(state), kInitiate);
+  }
+
+  static void Issue(IntrusivePtr<MultipartUploadState> state, Kind kind,
+                    size_t part_index = 0) {
+    auto& owner = *state->owner;
+    auto request = internal::MakeIntrusivePtr<MultipartUploadRequest>(
+        std::move(state), kind, part_index);
+    // adopted by MultipartUploadRequest::Start.
+    intrusive_ptr_increment(request.get());
+    owner.write_rate_limiter().Admit(request.get(),
+                                     &MultipartUploadRequest::Start);
+  }
+
+  static void Start(void* task) {
+    auto* self = reinterpret_cast<MultipartUploadRequest*>(task);
+    self->state->owner->write_rate_limiter().Finish(self);
+    self->state->owner->admission_queue().Admit(self,
+                                                &MultipartUploadRequest::Admit);
+  }
+
+  static void Admit(void* task) {
+    auto* self = reinterpret_cast<MultipartUploadRequest*>(task);
+    self->state->owner->executor()(
+        [self = IntrusivePtr<MultipartUploadRequest>(
+             self, internal::adopt_object_ref)] { self->Retry(); });
+  }
+
+  void Retry() {
+    auto& owner = *state->owner;
+    if (kind != kAbort && !state->promise.result_needed()) {
+      Abort();
+      return;
+    }
+
+    AwsCredentials credentials;
+    if (auto maybe_credentials = owner.GetCredentials();
+        !maybe_credentials.ok()) {
+      Fail(maybe_credentials.status());
+      return;
+    } else if (maybe_credentials.value().has_value()) {
+      credentials = std::move(*maybe_credentials.value());
+    }
+
+    absl::Cord payload;
+    std::optional<S3RequestBuilder> builder;
+    switch (kind) {
+      case kInitiate:
+        builder.emplace("POST", state->upload_url_);
+        builder->AddHeader("Content-Type: application/octet-stream")
+            .AddQueryParameter("uploads", "");
+        break;
+      case kUploadPart:
+        builder.emplace("PUT", state->upload_url_);
+        builder->AddQueryParameter("partNumber", absl::StrCat(part_index + 1))
+            .AddQueryParameter("uploadId", state->upload_id_);
+        if (state->copy_source_.empty()) {
+          payload = state->GetPart(part_index);
+        } else {
+          builder
+              ->AddHeader(
+                  absl::StrCat("x-amz-copy-source: ", state->copy_source_))
+              .AddHeader(state->GetCopySourceRangeHeader(part_index));
+        }
+        break;
+      case kPeek:
+        builder.emplace("HEAD", state->upload_url_);
+        AddGenerationHeader(&*builder, "if-match", state->options.if_equal);
+        break;
+      case kComplete:
+        payload = absl::Cord(state->GetCompleteRequestBody());
+        builder.emplace("POST", state->upload_url_);
+        builder->AddHeader("Content-Type: application/xml")
+            .AddQueryParameter("uploadId", state->upload_id_);
+        break;
+      case kAbort:
+        builder.emplace("DELETE", state->upload_url_);
+        builder->AddQueryParameter("uploadId", state->upload_id_);
+        break;
+    }
+    if (!payload.empty()) {
+      builder->AddHeader(absl::StrCat("Content-Length: ", payload.size()));
+    }
+
+    const auto& ehr = state->endpoint_region_.value();
+    auto request =
+        builder->MaybeAddRequesterPayer(owner.spec_.requester_pays)
+            .BuildRequest(owner.host_header_, credentials, ehr.aws_region,
+                          payload.empty() ? std::string(kEmptySha256)
+                                          : payload_sha256(payload),
+                          absl::Now());
+
+    ABSL_LOG_IF(INFO, s3_logging)
+        << "MultipartUploadRequest: " << request << " size=" << payload.size();
+
+    auto future = owner.transport_->IssueRequest(request, std::move(payload));
+    future.ExecuteWhenReady(
+        [self = IntrusivePtr<MultipartUploadRequest>(this)](
+            ReadyFuture<HttpResponse> response) {
+          self->OnResponse(response.result());
+        });
+  }
+
+  void OnResponse(const Result<HttpResponse>& response) {
+    ABSL_LOG_IF(INFO, s3_logging.Level(1) && response.ok())
+        << "MultipartUploadRequest " << *response;
+    if (kind != kAbort && !state->promise.result_needed()) {
+      Abort();
+      return;
+    }
+
+    // The peek response code is interpreted by `HandleResponse`.
+    absl::Status status = !response.ok()   ? response.status()
+                          : kind == kPeek ? absl::OkStatus()
+                                          : HttpResponseCodeToStatus(*response);
+    if (status.ok()) {
+      status = HandleResponse(*response);
+    }
+    if (!status.ok() && IsRetriable(status)) {
+      status = state->owner->BackoffForAttemptAsync(std::move(status),
+                                                    attempt_++, this);
+      if (status.ok()) {
+        return;
+      }
+    }
+    if (!status.ok()) {
+      if (kind == kAbort) {
+        ABSL_LOG_IF(INFO, s3_logging)
+            << "Failed to abort multipart upload: " << status;
+        return;
+      }
+      Fail(std::move(status));
+    }
+  }
+
+  absl::Status HandleResponse(const HttpResponse& response) {
+    switch (kind) {
+      case kInitiate: {
+        TENSORSTORE_ASSIGN_OR_RETURN(
+            state->upload_id_,
+            GetXmlResponseElement(response.payload,
+                                  "InitiateMultipartUploadResult", "UploadId"));
+        if (state->upload_id_.empty()) {
+          return absl::InvalidArgumentError(
+              "Malformed InitiateMultipartUploadResult response: missing "
+              "<UploadId>");
+        }
+        for (size_t i = 0; i < state->etags_.size(); ++i) {
+          Issue(state, kUploadPart, i);
+        }
+        return absl::OkStatus();
+      }
+      case kUploadPart: {
+        if (!state->copy_source_.empty()) {
+          // UploadPartCopy returns the ETag in the response body.
+          TENSORSTORE_ASSIGN_OR_RETURN(
+              state->etags_[part_index],
+              GetXmlResponseElement(response.payload, "CopyPartResult",
+                                    "ETag"));
+        } else {
+          auto it = response.headers.find("etag");
+          if (it == response.headers.end()) {
+            return absl::NotFoundError("etag not found in response headers");
+          }
+          state->etags_[part_index] = it->second;
+        }
+        if (--state->remaining_parts_ == 0) {
+          Issue(state, StorageGeneration::IsUnknown(state->options.if_equal)
+                           ? kComplete
+                           : kPeek);
+        }
+        return absl::OkStatus();
+      }
+      case kPeek: {
+        bool mismatch = false;
+        switch (response.status_code) {
+          case 304:
+            // Not modified implies that the generation did not match.
+            [[fallthrough]];
+          case 412:
+            // Failed precondition implies the generation did not match.
+            mismatch = true;
+            break;
+          case 404:
+            mismatch = !StorageGeneration::IsNoValue(state->options.if_equal);
+            break;
+          default:
+            break;
+        }
+        if (mismatch) {
+          state->promise.SetResult(TimestampedStorageGeneration{
+              StorageGeneration::Unknown(), absl::Now()});
+          Abort();
+        } else {
+          Issue(state, kComplete);
+        }
+        return absl::OkStatus();
+      }
+      case kComplete: {
+        TimestampedStorageGeneration r;
+        r.time = state->start_time_;
+        if (auto generation = StorageGenerationFromHeaders(response.headers);
+            generation.ok()) {
+          r.generation = *std::move(generation);
+        } else {
+          TENSORSTORE_ASSIGN_OR_RETURN(
+              auto etag,
+              GetXmlResponseElement(response.payload,
+                                    "CompleteMultipartUploadResult", "ETag"));
+          if (etag.empty()) return generation.status();
+          r.generation = StorageGeneration::FromString(etag);
+        }
+        auto latency = absl::Now() - state->start_time_;
+        s3_write_latency_ms.Observe(absl::ToInt64Milliseconds(latency));
+        s3_bytes_written.IncrementBy(state->value.size());
+        state->promise.SetResult(std::move(r));
+        return absl::OkStatus();
+      }
+      case kAbort:
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  void Fail(absl::Status status) {
+    state->promise.SetResult(std::move(status));
+    Abort();
+  }
+
+  /// Aborts the upload, if it was initiated, to discard any uploaded parts.
+  void Abort() {
+    if (state->upload_id_.empty() || state->aborted_.exchange(true)) return;
+    Issue(state, kAbort);
+  }
+};
+
 /// A WriteTask is a function object used to satisfy a
 /// S3KeyValueStore::Write request.
 struct WriteTask : public RateLimiterNode,
@@ -739,6 +1259,26 @@ struct WriteTask : public RateLimiterNode,
   }
 
   void DoPut() {
+    const auto& spec = owner->spec_;
+    if (spec.multipart_threshold != 0 &&
+        value.size() >= spec.multipart_threshold) {
+      // The upload continues independently of this task, which releases its
+      // admission to the request concurrency limit so that the parts can be
+      // admitted.
+      auto state = internal::MakeIntrusivePtr<MultipartUploadState>();
+      state->owner = owner;
+      state->value = std::move(value);
+      state->options = std::move(options);
+      state->promise = std::move(promise);
+      state->upload_url_ = upload_url_;
+      state->endpoint_region_ = endpoint_region_;
+      state->part_size_ =
+          std::max(spec.multipart_part_size,
+                   CeilOfRatio(state->value.size(), kMaxMultipartParts));
+      MultipartUploadRequest::StartUpload(std::move(state));
+      return;
+    }
+
     // NOTE: This was changed from POST to PUT as a basic POST does not work
     // Some more headers need to be added to allow POST to work:
     // https://docs.aws.amazon.com/AmazonS3/latest/API/sigv4-authentication-HTTPPOST.html
@@ -995,6 +1535,136 @@ struct DeleteTask : public RateLimiterNode,
   }
 };
 
+/// A CopyTask is a function object used to satisfy a
+/// S3KeyValueStore::CopyObject request.
+///
+/// The object is copied by S3 using a single CopyObject request, or, if it is
+/// larger than `kMaxCopyObjectSize`, using a multipart upload of
+/// UploadPartCopy requests.
+struct CopyTask : public RateLimiterNode,
+                  public internal::AtomicReferenceCount<CopyTask> {
+  IntrusivePtr<S3KeyValueStore> owner;
+  std::string copy_source;
+  std::string object_name;
+  uint64_t size;
+  Promise<TimestampedStorageGeneration> promise;
+
+  std::string upload_url_;
+  ReadyFuture<const S3EndpointRegion> endpoint_region_;
+
+  int attempt_ = 0;
+  absl::Time start_time_;
+
+  CopyTask(IntrusivePtr<S3KeyValueStore> owner, std::string copy_source,
+           std::string object_name, uint64_t size,
+           Promise<TimestampedStorageGeneration> promise)
+      : owner(std::move(owner)),
+        copy_source(std::move(copy_source)),
+        object_name(std::move(object_name)),
+        size(size),
+        promise(std::move(promise)) {}
+
+  ~CopyTask() { owner->admission_queue().Finish(this); }
+
+  static void Start(void* task) {
+    auto* self = reinterpret_cast<CopyTask*>(task);
+    self->owner->write_rate_limiter().Finish(self);
+    self->owner->admission_queue().Admit(self, &CopyTask::Admit);
+  }
+
+  static void Admit(void* task) {
+    auto* self = reinterpret_cast<CopyTask*>(task);
+    self->owner->executor()(
+        [state = IntrusivePtr<CopyTask>(self, internal::adopt_object_ref)] {
+          state->Retry();
+        });
+  }
+
+  void Retry() {
+    if (!promise.result_needed()) {
+      return;
+    }
+    if (size > kMaxCopyObjectSize) {
+      // As for large writes, the upload continues independently of this task.
+      auto state = internal::MakeIntrusivePtr<MultipartUploadState>();
+      state->owner = owner;
+      state->copy_source_ = copy_source;
+      state->copy_size_ = size;
+      state->promise = std::move(promise);
+      state->upload_url_ = upload_url_;
+      state->endpoint_region_ = endpoint_region_;
+      state->part_size_ =
+          std::max<uint64_t>(kMultipartCopyPartSize,
+                             CeilOfRatio<uint64_t>(size, kMaxMultipartParts));
+      MultipartUploadRequest::StartUpload(std::move(state));
+      return;
+    }
+
+    AwsCredentials credentials;
+    if (auto maybe_credentials = owner->GetCredentials();
+        !maybe_credentials.ok()) {
+      promise.SetResult(maybe_credentials.status());
+      return;
+    } else if (maybe_credentials.value().has_value()) {
+      credentials = std::move(*maybe_credentials.value());
+    }
+
+    start_time_ = absl::Now();
+    const auto& ehr = endpoint_region_.value();
+    auto request =
+        S3RequestBuilder("PUT", upload_url_)
+            .AddHeader(absl::StrCat("x-amz-copy-source: ", copy_source))
+            .MaybeAddRequesterPayer(owner->spec_.requester_pays)
+            .BuildRequest(owner->host_header_, credentials, ehr.aws_region,
+                          kEmptySha256, start_time_);
+
+    ABSL_LOG_IF(INFO, s3_logging) << "CopyTask: " << request;
+
+    auto future = owner->transport_->IssueRequest(request, {});
+    future.ExecuteWhenReady([self = IntrusivePtr<CopyTask>(this)](
+                                ReadyFuture<HttpResponse> response) {
+      self->OnResponse(response.result());
+    });
+  }
+
+  void OnResponse(const Result<HttpResponse>& response) {
+    if (!promise.result_needed()) {
+      return;
+    }
+    ABSL_LOG_IF(INFO, s3_logging.Level(1) && response.ok())
+        << "CopyTask " << *response;
+
+    // CopyObject may fail after returning a 200 status code, in which case
+    // the body contains an <Error> element.
+    Result<std::string> etag = [&]() -> Result<std::string> {
+      if (!response.ok()) return response.status();
+      TENSORSTORE_RETURN_IF_ERROR(HttpResponseCodeToStatus(*response));
+      return GetXmlResponseElement(response->payload, "CopyObjectResult",
+                                   "ETag");
+    }();
+
+    absl::Status status = etag.status();
+    if (!status.ok() && IsRetriable(status)) {
+      status =
+          owner->BackoffForAttemptAsync(std::move(status), attempt_++, this);
+      if (status.ok()) {
+        return;
+      }
+    }
+    if (!status.ok()) {
+      promise.SetResult(status);
+      return;
+    }
+    if (etag->empty()) {
+      promise.SetResult(absl::InvalidArgumentError(
+          "Malformed CopyObjectResult response: missing <ETag>"));
+      return;
+    }
+    promise.SetResult(TimestampedStorageGeneration{
+        StorageGeneration::FromString(*etag), start_time_});
+  }
+};
+
 Future<TimestampedStorageGeneration> S3KeyValueStore::Write(
     Key key, std::optional<Value> value, WriteOptions options) {
   s3_write.Increment();
@@ -1006,8 +1676,10 @@ Future<TimestampedStorageGeneration> S3KeyValueStore::Write(
   }
 
   auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  std::optional<int64_t> bytes;
 
   if (value) {
+    bytes = value->size();
     auto state = internal::MakeIntrusivePtr<WriteTask>(
         IntrusivePtr<S3KeyValueStore>(this), key, std::move(*value),
         std::move(options), std::move(op.promise));
@@ -1045,6 +1717,36 @@ Future<TimestampedStorageGeneration> S3KeyValueStore::Write(
                                                    &DeleteTask::Start);
         });
   }
+  return internal_kvstore::RecordWriteMetrics(S3KeyValueStoreSpec::id, bytes,
+                                              std::move(op.future));
+}
+
+Future<TimestampedStorageGeneration> S3KeyValueStore::CopyObject(
+    std::string_view source_bucket, std::string_view source_key,
+    Key target_key, uint64_t size) {
+  s3_copy.Increment();
+  if (!IsValidObjectName(target_key)) {
+    return absl::InvalidArgumentError("Invalid S3 object name");
+  }
+  auto op = PromiseFuturePair<TimestampedStorageGeneration>::Make();
+  auto state = internal::MakeIntrusivePtr<CopyTask>(
+      IntrusivePtr<S3KeyValueStore>(this),
+      tensorstore::StrCat(source_bucket, "/",
+                          S3UriObjectKeyEncode(source_key)),
+      std::move(target_key), size, std::move(op.promise));
+  MaybeResolveRegion().ExecuteWhenReady(
+      [state = std::move(state)](ReadyFuture<const S3EndpointRegion> ready) {
+        if (!ready.status().ok()) {
+          state->promise.SetResult(ready.status());
+          return;
+        }
+        state->upload_url_ = tensorstore::StrCat(ready.value().endpoint, "/",
+                                                 state->object_name);
+        state->endpoint_region_ = std::move(ready);
+        intrusive_ptr_increment(state.get());  // adopted by CopyTask::Start.
+        state->owner->write_rate_limiter().Admit(state.get(),
+                                                 &CopyTask::Start);
+      });
   return std::move(op.future);
 }
 
@@ -1255,7 +1957,8 @@ void S3KeyValueStore::ListImpl(ListOptions options, ListReceiver receiver) {
 
   auto state = internal::MakeIntrusivePtr<ListTask>(
       IntrusivePtr<S3KeyValueStore>(this), std::move(options),
-      std::move(receiver));
+      internal_kvstore::RecordListMetrics(S3KeyValueStoreSpec::id,
+                                          std::move(receiver)));
 
   MaybeResolveRegion().ExecuteWhenReady(
       [state = std::move(state)](ReadyFuture<const S3EndpointRegion> ready) {
@@ -1310,7 +2013,78 @@ Future<const void> S3KeyValueStore::DeleteRange(KeyRange range) {
   ListImpl(list_options, DeleteRangeListReceiver{
                              internal::IntrusivePtr<S3KeyValueStore>(this),
                              std::move(op.promise)});
-  return std::move(op.future);
+  return internal_kvstore::RecordDeleteRangeMetrics(S3KeyValueStoreSpec::id,
+                                                    std::move(op.future));
+}
+
+// Receiver used by `ExperimentalCopyRangeFrom` for processing the results from
+// `List` on the source.
+struct CopyRangeListReceiver {
+  IntrusivePtr<S3KeyValueStore> owner_;
+  std::string source_bucket_;
+  size_t source_prefix_length_;
+  std::string target_prefix_;
+  Promise<void> promise_;
+  FutureCallbackRegistration cancel_registration_;
+
+  void set_starting(AnyCancelReceiver cancel) {
+    cancel_registration_ = promise_.ExecuteWhenNotNeeded(std::move(cancel));
+  }
+
+  void set_value(ListEntry entry) {
+    if (!entry.has_size()) {
+      SetDeferredResult(promise_,
+                        absl::InvalidArgumentError(tensorstore::StrCat(
+                            "Size of ", QuoteString(entry.key), " is unknown")));
+      return;
+    }
+    std::string target_key = tensorstore::StrCat(
+        target_prefix_,
+        std::string_view(entry.key).substr(
+            std::min(source_prefix_length_, entry.key.size())));
+    LinkError(promise_, owner_->CopyObject(source_bucket_, entry.key,
+                                           std::move(target_key), entry.size));
+  }
+
+  void set_error(absl::Status error) {
+    SetDeferredResult(promise_, std::move(error));
+    promise_ = Promise<void>();
+  }
+
+  void set_done() { promise_ = Promise<void>(); }
+
+  void set_stopping() { cancel_registration_.Unregister(); }
+};
+
+Future<const void> S3KeyValueStore::ExperimentalCopyRangeFrom(
+    const internal::OpenTransactionPtr& transaction, const KvStore& source,
+    Key target_prefix, kvstore::CopyRangeOptions options) {
+  // Objects may be copied by S3 if both stores are accessed through the same
+  // endpoint with the same credentials; otherwise the generic implementation
+  // is used.
+  if (typeid(*source.driver) == typeid(S3KeyValueStore) && !transaction &&
+      source.transaction == no_transaction) {
+    auto& source_driver = static_cast<S3KeyValueStore&>(*source.driver);
+    if (source_driver.spec_.endpoint == spec_.endpoint &&
+        source_driver.host_header_ == host_header_ &&
+        source_driver.spec_.aws_credentials == spec_.aws_credentials &&
+        source_driver.spec_.requester_pays == spec_.requester_pays) {
+      auto op = PromiseFuturePair<void>::Make(tensorstore::MakeResult());
+      ListOptions list_options;
+      list_options.range =
+          KeyRange::AddPrefix(source.path, std::move(options.source_range));
+      list_options.staleness_bound = options.source_staleness_bound;
+      source_driver.ListImpl(
+          std::move(list_options),
+          CopyRangeListReceiver{IntrusivePtr<S3KeyValueStore>(this),
+                                source_driver.spec_.bucket, source.path.size(),
+                                std::move(target_prefix),
+                                std::move(op.promise)});
+      return std::move(op.future);
+    }
+  }
+  return kvstore::Driver::ExperimentalCopyRangeFrom(
+      transaction, source, std::move(target_prefix), std::move(options));
 }
 
 // Resolves the region endpoint for the bucket.
@@ -1346,6 +2120,10 @@ Future<kvstore::DriverPtr> S3KeyValueStoreSpec::DoOpen() const {
   if (data_.rate_limiter.has_value()) {
     ABSL_LOG(INFO) << "Using experimental_s3_rate_limiter";
   }
+  if (data_.read_hedging) {
+    driver->read_hedger_ =
+        std::make_shared<internal_http::RequestHedger>(*data_.read_hedging);
+  }
 
   auto result = internal_kvstore_s3::ValidateEndpoint(
       data_.bucket, data_.aws_region, data_.endpoint.value_or(std::string{}),
@@ -1385,6 +2163,9 @@ Result<kvstore::Spec> ParseS3Url(std::string_view url) {
   auto driver_spec = internal::MakeIntrusivePtr<S3KeyValueStoreSpec>();
   driver_spec->data_.bucket = bucket;
   driver_spec->data_.requester_pays = false;
+  driver_spec->data_.multipart_threshold = kDefaultMultipartThreshold;
+  driver_spec->data_.multipart_part_size = kDefaultMultipartPartSize;
+  driver_spec->data_.parallel_read_part_size = 0;
 
   driver_spec->data_.aws_credentials =
       Context::Resource<AwsCredentialsResource>::DefaultSpec();
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -118,6 +121,14 @@ TEST(S3KeyValueStoreTest, InvalidSpec) {
   EXPECT_THAT(
       kvstore::Open({{"driver", "s3"}, {"bucket", "a"}}, context).result(),
       MatchesStatus(absl::StatusCode::kInvalidArgument));
+
+  // Test with too small `"multipart_part_size"`.
+  EXPECT_THAT(kvstore::Open({{"driver", "s3"},
+                             {"bucket", "my-bucket"},
+                             {"multipart_part_size", 1024}},
+                            context)
+                  .result(),
+              MatchesStatus(absl::StatusCode::kInvalidArgument));
 }
 
 // Mock-based tests for s3.
@@ -137,8 +148,16 @@ class MyMockTransport : public HttpTransport {
       absl::MutexLock lock(&mutex_);
       requests_.push_back(request);
     }
-    auto it = url_to_response_.find(
-        tensorstore::StrCat(request.method, " ", request.url));
+    auto key = tensorstore::StrCat(request.method, " ", request.url);
+    for (const auto& header : request.headers) {
+      // Byte range requests may have a separate response.
+      if (!absl::StartsWith(header, "Range: ")) continue;
+      auto it = url_to_response_.find(tensorstore::StrCat(key, " ", header));
+      if (it != url_to_response_.end()) {
+        return it->second;
+      }
+    }
+    auto it = url_to_response_.find(key);
     if (it != url_to_response_.end()) {
       return it->second;
     }
@@ -326,6 +345,169 @@ TEST(S3KeyValueStoreTest, SimpleMock_Endpoint) {
   EXPECT_THAT(host_header_validated, testing::Ge(2));
 }
 
+TEST(S3KeyValueStoreTest, SimpleMock_MultipartUpload) {
+  constexpr char kUrl[] = "https://my-bucket.s3.us-east-1.amazonaws.com/tmp/";
+  absl::flat_hash_map<std::string, HttpResponse> url_to_response{
+      {"HEAD https://my-bucket.s3.amazonaws.com",
+       HttpResponse{200, absl::Cord(), {{"x-amz-bucket-region", "us-east-1"}}}},
+
+      {tensorstore::StrCat("PUT ", kUrl, "small"),
+       HttpResponse{200, absl::Cord(), {{"etag", "\"small\""}}}},
+
+      {tensorstore::StrCat("POST ", kUrl, "large?uploads"),
+       HttpResponse{200,
+                    absl::Cord("<InitiateMultipartUploadResult>"
+                               "<UploadId>abc</UploadId>"
+                               "</InitiateMultipartUploadResult>"),
+                    {}}},
+      {tensorstore::StrCat("POST ", kUrl, "large?uploadId=abc"),
+       HttpResponse{200,
+                    absl::Cord("<CompleteMultipartUploadResult>"
+                               "<ETag>&quot;large-3&quot;</ETag>"
+                               "</CompleteMultipartUploadResult>"),
+                    {}}},
+  };
+  for (int i = 1; i <= 3; ++i) {
+    url_to_response[tensorstore::StrCat("PUT ", kUrl, "large?partNumber=", i,
+                                        "&uploadId=abc")] =
+        HttpResponse{200,
+                     absl::Cord(),
+                     {{"etag", tensorstore::StrCat("\"", i, "\"")}}};
+  }
+
+  auto mock_transport = std::make_shared<MyMockTransport>(url_to_response);
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  auto context = DefaultTestContext();
+  constexpr size_t kPartSize = 5 * 1024 * 1024;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "s3"},
+                                 {"bucket", "my-bucket"},
+                                 {"path", "tmp/"},
+                                 {"multipart_threshold", kPartSize + 1},
+                                 {"multipart_part_size", kPartSize}},
+                                context)
+                      .result());
+
+  // Values below the threshold are written with a single PUT.
+  EXPECT_THAT(
+      kvstore::Write(store, "small", absl::Cord(std::string(kPartSize, 'x')))
+          .result(),
+      MatchesTimestampedStorageGeneration(
+          StorageGeneration::FromString("\"small\"")));
+
+  absl::Cord value(std::string(2 * kPartSize + 1, 'x'));
+  EXPECT_THAT(kvstore::Write(store, "large", value).result(),
+              MatchesTimestampedStorageGeneration(
+                  StorageGeneration::FromString("\"large-3\"")));
+
+  // The if-match condition is tested before completing the upload.
+  kvstore::WriteOptions options;
+  options.if_equal = StorageGeneration::NoValue();
+  EXPECT_THAT(kvstore::Write(store, "large", value, options).result(),
+              MatchesTimestampedStorageGeneration(
+                  StorageGeneration::FromString("\"large-3\"")));
+  options.if_equal = StorageGeneration::FromString("\"other\"");
+  EXPECT_THAT(
+      kvstore::Write(store, "large", value, options).result(),
+      MatchesTimestampedStorageGeneration(StorageGeneration::Unknown()));
+
+  int num_parts = 0;
+  for (const auto& request : mock_transport->requests_) {
+    if (absl::StrContains(request.url, "partNumber=")) {
+      EXPECT_EQ("PUT", request.method);
+      num_parts++;
+    }
+  }
+  EXPECT_EQ(6, num_parts);
+}
+
+TEST(S3KeyValueStoreTest, SimpleMock_MultipartUploadFailure) {
+  constexpr char kUrl[] = "https://my-bucket.s3.us-east-1.amazonaws.com/tmp/";
+  absl::flat_hash_map<std::string, HttpResponse> url_to_response{
+      {"HEAD https://my-bucket.s3.amazonaws.com",
+       HttpResponse{200, absl::Cord(), {{"x-amz-bucket-region", "us-east-1"}}}},
+      {tensorstore::StrCat("POST ", kUrl, "large?uploads"),
+       HttpResponse{200,
+                    absl::Cord("<InitiateMultipartUploadResult>"
+                               "<UploadId>abc</UploadId>"
+                               "</InitiateMultipartUploadResult>"),
+                    {}}},
+      {tensorstore::StrCat("PUT ", kUrl, "large?partNumber=1&uploadId=abc"),
+       HttpResponse{200, absl::Cord(), {{"etag", "\"1\""}}}},
+      // Part 2 is not found.
+  };
+
+  auto mock_transport = std::make_shared<MyMockTransport>(url_to_response);
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  auto context = DefaultTestContext();
+  constexpr size_t kPartSize = 5 * 1024 * 1024;
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "s3"},
+                                 {"bucket", "my-bucket"},
+                                 {"path", "tmp/"},
+                                 {"multipart_threshold", kPartSize + 1},
+                                 {"multipart_part_size", kPartSize}},
+                                context)
+                      .result());
+
+  EXPECT_THAT(
+      kvstore::Write(store, "large",
+                     absl::Cord(std::string(2 * kPartSize, 'x')))
+          .result(),
+      MatchesStatus(absl::StatusCode::kNotFound));
+}
+
+TEST(S3KeyValueStoreTest, SimpleMock_ParallelRead) {
+  constexpr char kUrl[] = "https://my-bucket.s3.us-east-1.amazonaws.com/tmp/a";
+  const auto range_response = [](int first, int last, std::string data) {
+    return HttpResponse{
+        206,
+        absl::Cord(data),
+        {{"etag", "\"abc\""},
+         {"content-range",
+          tensorstore::StrCat("bytes ", first, "-", last, "/10")}}};
+  };
+  absl::flat_hash_map<std::string, HttpResponse> url_to_response{
+      {"HEAD https://my-bucket.s3.amazonaws.com",
+       HttpResponse{200, absl::Cord(), {{"x-amz-bucket-region", "us-east-1"}}}},
+      {tensorstore::StrCat("GET ", kUrl, " Range: bytes=0-3"),
+       range_response(0, 3, "0123")},
+      {tensorstore::StrCat("GET ", kUrl, " Range: bytes=4-7"),
+       range_response(4, 7, "4567")},
+      {tensorstore::StrCat("GET ", kUrl, " Range: bytes=8-9"),
+       range_response(8, 9, "89")},
+  };
+
+  auto mock_transport = std::make_shared<MyMockTransport>(url_to_response);
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store, kvstore::Open({{"driver", "s3"},
+                                 {"bucket", "my-bucket"},
+                                 {"path", "tmp/"},
+                                 {"parallel_read_part_size", 4}},
+                                context)
+                      .result());
+
+  EXPECT_THAT(kvstore::Read(store, "a").result(),
+              MatchesKvsReadResult(absl::Cord("0123456789"),
+                                   StorageGeneration::FromString("\"abc\"")));
+
+  // The remaining parts are conditioned on the etag of the first part.
+  int num_parts = 0;
+  for (const auto& request : mock_transport->requests_) {
+    if (request.method != "GET") continue;
+    ++num_parts;
+    EXPECT_EQ(num_parts > 1,
+              std::find(request.headers.begin(), request.headers.end(),
+                        "if-match: \"abc\"") != request.headers.end());
+  }
+  EXPECT_EQ(3, num_parts);
+}
+
 TEST(S3KeyValueStoreTest, SimpleMock_List) {
   const auto kListResultA =
       "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"                            //
@@ -463,6 +645,102 @@ TEST(S3KeyValueStoreTest, SimpleMock_ListPrefix) {
                                                   MatchesListEntry("b/b")));
 }
 
+TEST(S3KeyValueStoreTest, SimpleMock_CopyRange) {
+  constexpr uint64_t kLargeSize = uint64_t{6} << 30;
+  const auto kListResult = tensorstore::StrCat(
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"                            //
+      "<ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"  //
+      "<Name>bucket</Name>"                                                   //
+      "<Prefix>a</Prefix>"                                                    //
+      "<KeyCount>2</KeyCount>"                                                //
+      "<MaxKeys>1000</MaxKeys>"                                               //
+      "<IsTruncated>false</IsTruncated>"                                      //
+      "<Contents><Key>a1</Key>"                                               //
+      "<Size>3</Size><StorageClass>STANDARD</StorageClass></Contents>"        //
+      "<Contents><Key>abig</Key>"                                             //
+      "<Size>",
+      kLargeSize,
+      "</Size><StorageClass>STANDARD</StorageClass></Contents>"  //
+      "</ListBucketResult>");
+
+  constexpr char kUrl[] = "https://my-bucket.s3.us-east-1.amazonaws.com/";
+  absl::flat_hash_map<std::string, HttpResponse> url_to_response{
+      {"HEAD https://my-bucket.s3.amazonaws.com",
+       HttpResponse{200, absl::Cord(), {{"x-amz-bucket-region", "us-east-1"}}}},
+      {tensorstore::StrCat("GET ", kUrl, "?list-type=2&prefix=a"),
+       HttpResponse{200, absl::Cord(kListResult), {}}},
+
+      // Small objects are copied with a single CopyObject request.
+      {tensorstore::StrCat("PUT ", kUrl, "copy-a1"),
+       HttpResponse{200,
+                    absl::Cord("<CopyObjectResult>"
+                               "<ETag>&quot;a1&quot;</ETag>"
+                               "</CopyObjectResult>"),
+                    {}}},
+
+      // Large objects are copied with UploadPartCopy requests.
+      {tensorstore::StrCat("POST ", kUrl, "copy-abig?uploads"),
+       HttpResponse{200,
+                    absl::Cord("<InitiateMultipartUploadResult>"
+                               "<UploadId>abc</UploadId>"
+                               "</InitiateMultipartUploadResult>"),
+                    {}}},
+      {tensorstore::StrCat("POST ", kUrl, "copy-abig?uploadId=abc"),
+       HttpResponse{200,
+                    absl::Cord("<CompleteMultipartUploadResult>"
+                               "<ETag>&quot;abig-12&quot;</ETag>"
+                               "</CompleteMultipartUploadResult>"),
+                    {}}},
+  };
+  for (int i = 1; i <= 12; ++i) {
+    url_to_response[tensorstore::StrCat("PUT ", kUrl, "copy-abig?partNumber=",
+                                        i, "&uploadId=abc")] =
+        HttpResponse{200,
+                     absl::Cord(tensorstore::StrCat(
+                         "<CopyPartResult><ETag>&quot;", i,
+                         "&quot;</ETag></CopyPartResult>")),
+                     {}};
+  }
+
+  auto mock_transport = std::make_shared<MyMockTransport>(url_to_response);
+  DefaultHttpTransportSetter mock_transport_setter{mock_transport};
+
+  auto context = DefaultTestContext();
+  TENSORSTORE_ASSERT_OK_AND_ASSIGN(
+      auto store,
+      kvstore::Open({{"driver", "s3"}, {"bucket", "my-bucket"}}, context)
+          .result());
+
+  kvstore::CopyRangeOptions options;
+  options.source_range = tensorstore::KeyRange::Prefix("a");
+  TENSORSTORE_ASSERT_OK(kvstore::ExperimentalCopyRange(
+                            store, store.WithPathSuffix("copy-"), options)
+                            .result());
+
+  // The values are copied by S3 rather than read by the client.
+  int num_parts = 0;
+  for (const auto& request : mock_transport->requests_) {
+    if (request.method == "GET") {
+      EXPECT_THAT(request.url, ::testing::HasSubstr("list-type"));
+    }
+    for (const auto& header : request.headers) {
+      if (absl::StartsWith(header, "x-amz-copy-source: ")) {
+        EXPECT_THAT(header,
+                    ::testing::AnyOf("x-amz-copy-source: my-bucket/a1",
+                                     "x-amz-copy-source: my-bucket/abig"));
+      }
+      if (absl::StartsWith(header, "x-amz-copy-source-range: ")) {
+        ++num_parts;
+        if (absl::StrContains(request.url, "partNumber=12&")) {
+          EXPECT_EQ("x-amz-copy-source-range: bytes=5905580032-6442450943",
+                    header);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(12, num_parts);
+}
+
 // TODO: Add mocking to satisfy kvstore testing methods, such as:
 // tensorstore::internal::TestKeyValueStoreReadOps
 // tensorstore::internal::TestKeyValueReadWriteOps
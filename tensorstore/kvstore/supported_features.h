@@ -32,6 +32,10 @@ enum class SupportedFeatures : uint64_t {
   /// i.e. `WriteOptions::if_equal` is handled race-free.  This implies
   /// `kSingleKeyAtomicReadModifyWrite`.
   kSingleKeyAtomicReadModifyWrite = 8,
+
+  /// Indicates if generations are derived from the value, such that equal
+  /// generations imply equal values even if they are from different stores.
+  kContentDerivedGenerations = 16,
 };
 
 constexpr inline SupportedFeatures operator&(SupportedFeatures a,
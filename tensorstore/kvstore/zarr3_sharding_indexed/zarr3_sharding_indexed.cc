@@ -17,7 +17,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -26,6 +28,7 @@
 #include <vector>
 
 #include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/str_format.h"
@@ -33,6 +36,7 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include <nlohmann/json.hpp>
+#include "tensorstore/batch.h"
 #include "tensorstore/context.h"
 #include "tensorstore/driver/zarr3/codec/codec_chain_spec.h"
 #include "tensorstore/index.h"
@@ -49,6 +53,7 @@
 #include "tensorstore/internal/json_binding/json_binding.h"
 #include "tensorstore/internal/mutex.h"
 #include "tensorstore/json_serialization_options_base.h"
+#include "tensorstore/kvstore/batch_util.h"
 #include "tensorstore/kvstore/byte_range.h"
 #include "tensorstore/kvstore/driver.h"
 #include "tensorstore/kvstore/generation.h"
@@ -867,6 +872,57 @@ ShardedKeyValueStore::ShardedKeyValueStore(
       });
 }
 
+/// Determines the byte range of the shard that must be read to satisfy a read
+/// of `entry_id` with `options`, given the shard index `shard_index` (or
+/// `nullptr` if the shard does not exist) as of `stamp`.
+///
+/// If no read of the shard is required, resolves `promise` and returns
+/// `std::nullopt`.
+std::optional<ByteRange> GetShardByteRangeForRead(
+    ShardIndexCache::Entry& entry, const TimestampedStorageGeneration& stamp,
+    const ShardIndex* shard_index, EntryId entry_id,
+    const kvstore::ReadOptions& options,
+    const Promise<kvstore::ReadResult>& promise) {
+  ShardIndexEntry index_entry = ShardIndexEntry::Missing();
+  kvstore::ReadResult::State state;
+  if (!StorageGeneration::IsNoValue(stamp.generation) &&
+      (options.if_not_equal == stamp.generation ||
+       (!StorageGeneration::IsUnknown(options.if_equal) &&
+        options.if_equal != stamp.generation))) {
+    state = kvstore::ReadResult::kUnspecified;
+  } else {
+    if (shard_index) {
+      index_entry = (*shard_index)[entry_id];
+    }
+    state = kvstore::ReadResult::kMissing;
+  }
+  if (index_entry.IsMissing()) {
+    promise.SetResult(kvstore::ReadResult{state, {}, stamp});
+    return std::nullopt;
+  }
+  assert(!StorageGeneration::IsUnknown(stamp.generation));
+  assert(options.byte_range.SatisfiesInvariants());
+  TENSORSTORE_RETURN_IF_ERROR(
+      index_entry.Validate(entry_id),
+      (promise.SetResult(entry.AnnotateError(_, /*reading=*/true)),
+       std::nullopt));
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      auto validated_byte_range,
+      options.byte_range.Validate(index_entry.length),
+      (promise.SetResult(_), std::nullopt));
+  if (validated_byte_range.inclusive_min ==
+      validated_byte_range.exclusive_max) {
+    // Zero-length read request, no need to issue actual read.
+    promise.SetResult(
+        kvstore::ReadResult{kvstore::ReadResult::kValue, absl::Cord(), stamp});
+    return std::nullopt;
+  }
+  return ByteRange{static_cast<int64_t>(index_entry.offset +
+                                        validated_byte_range.inclusive_min),
+                   static_cast<int64_t>(index_entry.offset +
+                                        validated_byte_range.exclusive_max)};
+}
+
 /// Asynchronous state and associated methods for  `ShardedKeyValueStore::Read`.
 struct ReadOperationState {
   internal::PinnedCacheEntry<ShardIndexCache> entry_;
@@ -885,75 +941,27 @@ struct ReadOperationState {
 
   static Future<kvstore::ReadResult> Start(ShardedKeyValueStore& store,
                                            kvstore::Key&& key,
-                                           kvstore::ReadOptions&& options) {
-    TENSORSTORE_ASSIGN_OR_RETURN(
-        EntryId entry_id,
-        KeyToEntryIdOrError(key, store.shard_index_params().grid_shape()));
-    auto shard_index_cache_entry =
-        GetCacheEntry(store.shard_index_cache(), std::string_view{});
-    auto shard_index_read_future =
-        shard_index_cache_entry->Read(options.staleness_bound);
-    return PromiseFuturePair<kvstore::ReadResult>::LinkValue(
-               OnShardIndexReadyCallback(std::unique_ptr<ReadOperationState>(
-                   new ReadOperationState{std::move(shard_index_cache_entry),
-                                          entry_id, std::move(options)})),
-               std::move(shard_index_read_future))
-        .future;
-  }
+                                           kvstore::ReadOptions&& options);
 
   static void OnShardIndexReady(std::unique_ptr<ReadOperationState> self,
                                 Promise<kvstore::ReadResult> promise) {
-    ShardIndexEntry index_entry = ShardIndexEntry::Missing();
     TimestampedStorageGeneration stamp;
-    kvstore::ReadResult::State state;
+    std::shared_ptr<const ShardIndex> shard_index;
     {
       auto lock = internal::AsyncCache::ReadLock<ShardIndexCache::ReadData>(
           *self->entry_);
       stamp = lock.stamp();
-      if (!StorageGeneration::IsNoValue(stamp.generation) &&
-          (self->options_.if_not_equal == stamp.generation ||
-           (!StorageGeneration::IsUnknown(self->options_.if_equal) &&
-            self->options_.if_equal != stamp.generation))) {
-        state = kvstore::ReadResult::kUnspecified;
-      } else {
-        if (lock.data()) {
-          const auto& shard_index = *lock.data();
-          index_entry = shard_index[self->entry_id_];
-        }
-        state = kvstore::ReadResult::kMissing;
-      }
-    }
-    if (index_entry.IsMissing()) {
-      promise.SetResult(kvstore::ReadResult{state, {}, std::move(stamp)});
-      return;
+      shard_index = lock.shared_data();
     }
-    assert(!StorageGeneration::IsUnknown(stamp.generation));
+    auto byte_range =
+        GetShardByteRangeForRead(*self->entry_, stamp, shard_index.get(),
+                                 self->entry_id_, self->options_, promise);
+    if (!byte_range) return;
     auto& cache = GetOwningCache(*self->entry_);
-    assert(self->options_.byte_range.SatisfiesInvariants());
-    TENSORSTORE_RETURN_IF_ERROR(
-        index_entry.Validate(self->entry_id_),
-        static_cast<void>(
-            promise.SetResult(self->entry_->AnnotateError(_,
-                                                          /*reading=*/true))));
-    TENSORSTORE_ASSIGN_OR_RETURN(
-        auto validated_byte_range,
-        self->options_.byte_range.Validate(index_entry.length),
-        static_cast<void>(promise.SetResult(_)));
-    if (validated_byte_range.inclusive_min ==
-        validated_byte_range.exclusive_max) {
-      // Zero-length read request, no need to issue actual read.
-      promise.SetResult(kvstore::ReadResult{kvstore::ReadResult::kValue,
-                                            absl::Cord(), std::move(stamp)});
-      return;
-    }
     kvstore::ReadOptions kvs_read_options;
     kvs_read_options.if_equal = stamp.generation;
     kvs_read_options.staleness_bound = self->options_.staleness_bound;
-    kvs_read_options.byte_range =
-        ByteRange{static_cast<int64_t>(index_entry.offset +
-                                       validated_byte_range.inclusive_min),
-                  static_cast<int64_t>(index_entry.offset +
-                                       validated_byte_range.exclusive_max)};
+    kvs_read_options.byte_range = *byte_range;
     LinkValue(
         [self = std::move(self)](
             Promise<kvstore::ReadResult> promise,
@@ -982,6 +990,156 @@ struct ReadOperationState {
   }
 };
 
+/// Combines the reads of a single shard added to a batch.
+///
+/// When the batch is submitted, the shard index is read once for all of the
+/// reads, and then the entries are read from the shard using as few byte range
+/// reads of the base kvstore as possible.
+class BatchReadEntry : public Batch::Entry {
+ public:
+  explicit BatchReadEntry(internal::PinnedCacheEntry<ShardIndexCache> entry)
+      : entry_(std::move(entry)) {}
+
+  void Add(EntryId entry_id, kvstore::ReadOptions options,
+           Promise<kvstore::ReadResult> promise) {
+    absl::MutexLock lock(&mutex_);
+    requests_.push_back(
+        Request{entry_id, std::move(options), std::move(promise)});
+  }
+
+  void Submit() override {
+    auto self = std::make_shared<Requests>();
+    {
+      absl::MutexLock lock(&mutex_);
+      self->requests.swap(requests_);
+    }
+    self->entry = std::move(entry_);
+    absl::Time staleness_bound = absl::InfinitePast();
+    for (const auto& request : self->requests) {
+      staleness_bound =
+          std::max(staleness_bound, request.options.staleness_bound);
+    }
+    auto& executor = GetOwningCache(*self->entry).executor();
+    self->entry->Read(staleness_bound)
+        .ExecuteWhenReady(WithExecutor(
+            executor, [self = std::move(self)](ReadyFuture<const void> future) {
+              OnShardIndexReady(*self, future.status());
+            }));
+  }
+
+ private:
+  struct Request {
+    EntryId entry_id;
+    kvstore::ReadOptions options;
+    Promise<kvstore::ReadResult> promise;
+  };
+
+  struct Requests {
+    internal::PinnedCacheEntry<ShardIndexCache> entry;
+    std::vector<Request> requests;
+  };
+
+  static void OnShardIndexReady(Requests& self, const absl::Status& status) {
+    if (!status.ok()) {
+      for (auto& request : self.requests) {
+        request.promise.SetResult(status);
+      }
+      return;
+    }
+    TimestampedStorageGeneration stamp;
+    std::shared_ptr<const ShardIndex> shard_index;
+    {
+      auto lock = internal::AsyncCache::ReadLock<ShardIndexCache::ReadData>(
+          *self.entry);
+      stamp = lock.stamp();
+      shard_index = lock.shared_data();
+    }
+    kvstore::ReadOptions kvs_read_options;
+    kvs_read_options.if_equal = stamp.generation;
+    kvs_read_options.staleness_bound = absl::InfinitePast();
+    std::vector<internal_kvstore_batch::ByteRangeReadRequest>
+        byte_range_requests;
+    for (auto& request : self.requests) {
+      if (!request.promise.result_needed()) continue;
+      auto byte_range = GetShardByteRangeForRead(
+          *self.entry, stamp, shard_index.get(), request.entry_id,
+          request.options, request.promise);
+      if (!byte_range) continue;
+      kvs_read_options.staleness_bound = std::max(
+          kvs_read_options.staleness_bound, request.options.staleness_bound);
+      // Concurrent modification of the shard is handled in the same way as for
+      // a non-batched read.
+      auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+      LinkValue(
+          [state = std::unique_ptr<ReadOperationState>(new ReadOperationState{
+               self.entry, request.entry_id, std::move(request.options)})](
+              Promise<kvstore::ReadResult> promise,
+              ReadyFuture<kvstore::ReadResult> future) mutable {
+            ReadOperationState::OnValueReady(std::move(state),
+                                             std::move(promise),
+                                             std::move(future.value()));
+          },
+          std::move(request.promise), std::move(future));
+      byte_range_requests.push_back({*byte_range, std::move(promise)});
+    }
+    auto& cache = GetOwningCache(*self.entry);
+    internal_kvstore_batch::CoalesceByteRangeRequests(
+        byte_range_requests, internal_kvstore_batch::kDefaultMaxGapBytes,
+        [&](OptionalByteRangeRequest merged,
+            span<internal_kvstore_batch::ByteRangeReadRequest> group) {
+          kvs_read_options.byte_range = merged;
+          auto future = cache.base_kvstore_driver()->Read(
+              std::string(cache.base_kvstore_path()), kvs_read_options);
+          if (group.size() == 1) {
+            LinkResult(std::move(group[0].promise), std::move(future));
+            return;
+          }
+          using Request = internal_kvstore_batch::ByteRangeReadRequest;
+          future.ExecuteWhenReady(
+              [merged, group = std::vector<Request>(
+                           std::make_move_iterator(group.begin()),
+                           std::make_move_iterator(group.end()))](
+                  ReadyFuture<kvstore::ReadResult> future) mutable {
+                internal_kvstore_batch::ResolveCoalescedRequests(
+                    merged, group, future.result());
+              });
+        });
+  }
+
+  internal::PinnedCacheEntry<ShardIndexCache> entry_;
+  absl::Mutex mutex_;
+  std::vector<Request> requests_ ABSL_GUARDED_BY(mutex_);
+};
+
+Future<kvstore::ReadResult> ReadOperationState::Start(
+    ShardedKeyValueStore& store, kvstore::Key&& key,
+    kvstore::ReadOptions&& options) {
+  TENSORSTORE_ASSIGN_OR_RETURN(
+      EntryId entry_id,
+      KeyToEntryIdOrError(key, store.shard_index_params().grid_shape()));
+  auto shard_index_cache_entry =
+      GetCacheEntry(store.shard_index_cache(), std::string_view{});
+  if (options.batch) {
+    // The shard index is read when the batch is submitted.
+    const Batch batch = std::move(options.batch);
+    options.batch = no_batch;
+    auto& batch_entry = batch.GetEntry<BatchReadEntry>(
+        shard_index_cache_entry.get(),
+        [&] { return new BatchReadEntry(shard_index_cache_entry); });
+    auto [promise, future] = PromiseFuturePair<kvstore::ReadResult>::Make();
+    batch_entry.Add(entry_id, std::move(options), std::move(promise));
+    return std::move(future);
+  }
+  auto shard_index_read_future =
+      shard_index_cache_entry->Read(options.staleness_bound);
+  return PromiseFuturePair<kvstore::ReadResult>::LinkValue(
+             OnShardIndexReadyCallback(std::unique_ptr<ReadOperationState>(
+                 new ReadOperationState{std::move(shard_index_cache_entry),
+                                        entry_id, std::move(options)})),
+             std::move(shard_index_read_future))
+      .future;
+}
+
 Future<kvstore::ReadResult> ShardedKeyValueStore::Read(Key key,
                                                        ReadOptions options) {
   return ReadOperationState::Start(*this, std::move(key), std::move(options));
@@ -1109,8 +1267,11 @@ std::string ShardedKeyValueStore::DescribeKey(std::string_view key) {
 
 kvstore::SupportedFeatures ShardedKeyValueStore::GetSupportedFeatures(
     const KeyRange& key_range) const {
+  // Generations are derived from the generation of the entire shard.
   return base_kvstore_driver()->GetSupportedFeatures(
-      KeyRange::Singleton(base_kvstore_path()));
+             KeyRange::Singleton(base_kvstore_path())) &
+         (kvstore::SupportedFeatures::kSingleKeyAtomicReadModifyWrite |
+          kvstore::SupportedFeatures::kAtomicWriteWithoutOverwrite);
 }
 
 Result<KvStore> ShardedKeyValueStore::GetBase(
@@ -39,6 +39,7 @@
 #include "riegeli/bytes/cord_writer.h"
 #include "riegeli/bytes/write.h"
 #include "riegeli/digests/crc32c_digester.h"
+#include "tensorstore/batch.h"
 #include "tensorstore/context.h"
 #include "tensorstore/driver/zarr3/codec/codec_chain_spec.h"
 #include "tensorstore/index.h"
@@ -789,6 +790,77 @@ TEST_F(UnderlyingKeyValueStoreTest, Read) {
 }
 
 // Verify that a read-only transaction does not do any I/O on commit.
+// Tests that reads added to a batch result in a single read of the shard index
+// and a single combined read of the data.
+TEST_F(UnderlyingKeyValueStoreTest, BatchRead) {
+  std::vector<Future<ReadResult>> futures;
+  {
+    auto batch = tensorstore::Batch::New();
+    kvstore::ReadOptions options;
+    options.batch = batch;
+    for (EntryId entry_id : {0, 1, 2, 3}) {
+      futures.push_back(
+          store->Read(EntryIdToKey(entry_id, grid_shape), options));
+    }
+    // No reads are issued until the batch is submitted.
+    EXPECT_EQ(0, mock_store->read_requests.size());
+  }
+  absl::Time read_time;
+  {
+    auto req = mock_store->read_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    EXPECT_EQ(OptionalByteRangeRequest::SuffixLength(5 * 16 + 4),
+              req.options.byte_range);
+    EXPECT_FALSE(req.options.batch);
+    req.promise.SetResult(
+        ReadResult{ReadResult::kValue,
+                   WithCrc32c(Bytes({
+                       // entries[0].offset
+                       0, 0, 0, 0, 0, 0, 0, 0,  //
+                       // entries[0].length
+                       5, 0, 0, 0, 0, 0, 0, 0,  //
+                       // entries[1].offset
+                       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,  //
+                       // entries[1].length
+                       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,  //
+                       // entries[2].offset
+                       10, 0, 0, 0, 0, 0, 0, 0,  //
+                       // entries[2].length
+                       5, 0, 0, 0, 0, 0, 0, 0,  //
+                       // entries[3].offset
+                       20, 0, 0, 0, 0, 0, 0, 0,  //
+                       // entries[3].length
+                       2, 0, 0, 0, 0, 0, 0, 0,  //
+                       // entries[4].offset
+                       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,  //
+                       // entries[4].length
+                       0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,  //
+                   })),
+                   {StorageGeneration::FromString("g0"), absl::Now()}});
+  }
+  {
+    auto req = mock_store->read_requests.pop_nonblock().value();
+    ASSERT_EQ(0, mock_store->read_requests.size());
+    EXPECT_EQ("shard_path", req.key);
+    EXPECT_EQ(StorageGeneration::FromString("g0"), req.options.if_equal);
+    EXPECT_EQ(OptionalByteRangeRequest(0, 22), req.options.byte_range);
+    read_time = absl::Now();
+    req.promise.SetResult(ReadResult{
+        ReadResult::kValue,
+        Bytes({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
+               18, 19, 20, 21}),
+        {StorageGeneration::FromString("g0"), read_time}});
+  }
+  const auto g0 = StorageGeneration::FromString("g0");
+  EXPECT_THAT(futures[0].result(),
+              MatchesKvsReadResult(Bytes({0, 1, 2, 3, 4}), g0, read_time));
+  EXPECT_THAT(futures[1].result(), MatchesKvsReadResultNotFound());
+  EXPECT_THAT(futures[2].result(),
+              MatchesKvsReadResult(Bytes({10, 11, 12, 13, 14}), g0, read_time));
+  EXPECT_THAT(futures[3].result(),
+              MatchesKvsReadResult(Bytes({20, 21}), g0, read_time));
+}
+
 TEST_F(UnderlyingKeyValueStoreTest, TransactionReadThenCommit) {
   tensorstore::Transaction txn(tensorstore::isolated);
   auto memory_store = tensorstore::GetMemoryKeyValueStore();
@@ -137,7 +137,11 @@ class ZipKvStore
 
   kvstore::SupportedFeatures GetSupportedFeatures(
       const KeyRange& key_range) const final {
-    return base_.driver->GetSupportedFeatures(KeyRange::Singleton(base_.path));
+    // Generations are derived from the generation of the entire archive.
+    return base_.driver->GetSupportedFeatures(
+               KeyRange::Singleton(base_.path)) &
+           (kvstore::SupportedFeatures::kSingleKeyAtomicReadModifyWrite |
+            kvstore::SupportedFeatures::kAtomicWriteWithoutOverwrite);
   }
 
   Result<KvStore> GetBase(std::string_view path,
@@ -303,6 +303,9 @@ TEST(SpecTest, SetContextAndKvstore) {
                {"driver", "file"},
                {"path", "/tmp/"},
                {"file_io_concurrency", {"file_io_concurrency#a"}},
+               {"file_io_engine", {"file_io_engine"}},
+               {"file_io_group_commit", {"file_io_group_commit"}},
+               {"file_io_mmap", {"file_io_mmap"}},
                {"file_io_sync", {"file_io_sync"}},
            }},
           {"dtype", "uint8"},
@@ -317,6 +320,9 @@ TEST(SpecTest, SetContextAndKvstore) {
                {"data_copy_concurrency", ::nlohmann::json::object_t()},
                {"cache_pool", ::nlohmann::json::object_t()},
                {"file_io_concurrency#a", {{"limit", 5}}},
+               {"file_io_engine", ::nlohmann::json::object_t()},
+               {"file_io_group_commit", false},
+               {"file_io_mmap", false},
                {"file_io_sync", true},
            }},
       })));